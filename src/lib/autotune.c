@@ -0,0 +1,555 @@
+/*
+The copyright in this software is being made available under the BSD
+License, included below. This software may be subject to other third party
+and contributor rights, including patent rights, and no such rights are
+granted under this license.
+
+
+Copyright(c) 2011 - 2015, Parabola Research Limited
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met :
+
+* Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+this list of conditions and the following disclaimer in the documentation
+and / or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its contributors may
+be used to endorse or promote products derived from this software without
+specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "autotune.h"
+#include "hevcasm_test.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+
+typedef void kernel(void);
+
+
+static kernel *get_slot(const hevcasm_context *context, size_t slot)
+{
+	kernel *k;
+	memcpy(&k, (const char *)&context->sad + slot * sizeof(k), sizeof(k));
+	return k;
+}
+
+
+static void set_slot(hevcasm_context *context, size_t slot, kernel *k)
+{
+	memcpy((char *)&context->sad + slot * sizeof(k), &k, sizeof(k));
+}
+
+
+/* Tables of the context, including those nested in pred_batch, for locating the entry whose kernel a test reports */
+#define TABLE(member) { offsetof(hevcasm_context, member), sizeof(((hevcasm_context *)0)->member), 0 }
+#define NESTED_TABLE(member) { offsetof(hevcasm_context, member), sizeof(((hevcasm_context *)0)->member), 1 }
+
+static const struct
+{
+	size_t offset;
+	size_t size;
+	int nested;
+}
+tables[] =
+{
+	TABLE(sad),
+	TABLE(sad_multiref),
+	TABLE(ssd),
+	TABLE(ssd_residual),
+	TABLE(ssd_plane),
+	TABLE(ssim_4x4_sums),
+	TABLE(variance),
+	TABLE(pred_intra),
+	TABLE(hadamard_satd),
+	TABLE(satd),
+	TABLE(satd_multiref),
+	TABLE(quantize_inverse),
+	TABLE(quantize),
+	TABLE(quantize_reconstruct),
+	TABLE(transform_domain_ssd),
+	TABLE(rdoq_candidates),
+	TABLE(rdoq),
+	TABLE(residual_scan),
+	TABLE(residual_unscan),
+	TABLE(residual_rate_sub_blocks),
+	TABLE(pred_uni_8to8),
+	TABLE(pred_bi_8to8),
+	TABLE(pred_uni_nv12),
+	TABLE(pred_bi_nv12),
+	TABLE(pred_uni_8to16),
+	TABLE(pred_uni_weighted_16to8),
+	TABLE(pred_bi_weighted_16to8),
+	TABLE(pred_batch),
+	NESTED_TABLE(pred_batch.uni),
+	NESTED_TABLE(pred_batch.bi),
+	TABLE(deblock_luma),
+	TABLE(deblock_chroma),
+	TABLE(deblock_bs),
+	TABLE(sao),
+	TABLE(sao_collect),
+	TABLE(pad_horizontal),
+	TABLE(pad_vertical),
+	TABLE(inverse_transform_add),
+	TABLE(inverse_transform_add_encoder),
+	TABLE(transform),
+	TABLE(transform_skip),
+	TABLE(inverse_transform_skip_add),
+	TABLE(transquant_bypass_add),
+};
+
+#undef TABLE
+#undef NESTED_TABLE
+
+
+static uint32_t hash_word(uint32_t hash, size_t word)
+{
+	for (int i = 0; i < 4; ++i)
+	{
+		hash ^= (uint32_t)(word >> (8 * i)) & 0xff;
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+
+/* FNV-1a hash of the position and size of every table: profiles are only valid for the layout they were made with */
+static uint32_t layout_hash(void)
+{
+	uint32_t hash = hash_word(2166136261u, HEVCASM_AUTOTUNE_SLOTS);
+	for (size_t j = 0; j < sizeof(tables) / sizeof(tables[0]); ++j)
+	{
+		hash = hash_word(hash, tables[j].offset);
+		hash = hash_word(hash, tables[j].size);
+	}
+	return hash;
+}
+
+
+/* Self tests whose bounds report the kernel they call (see hevcasm_test_report_kernel()). Bounds of composite
+functions (e.g. pred_batch, residual_coding()) report none and are not timed. */
+static hevcasm_test_function *const tests[] =
+{
+	hevcasm_test_sad_multiref,
+	hevcasm_test_sad,
+	hevcasm_test_ssd,
+	hevcasm_test_ssd_residual,
+	hevcasm_test_ssd_plane,
+	hevcasm_test_ssim_4x4_sums,
+	hevcasm_test_variance,
+	hevcasm_test_pred_intra,
+	hevcasm_test_hadamard_satd,
+	hevcasm_test_satd,
+	hevcasm_test_satd_multiref,
+	hevcasm_test_quantize_inverse,
+	hevcasm_test_quantize,
+	hevcasm_test_quantize_reconstruct,
+	hevcasm_test_transform_domain_ssd,
+	hevcasm_test_rdoq_candidates,
+	hevcasm_test_rdoq,
+	hevcasm_test_residual_scan,
+	hevcasm_test_residual_unscan,
+	hevcasm_test_residual_rate_sub_blocks,
+	hevcasm_test_pred_uni,
+	hevcasm_test_pred_bi,
+	hevcasm_test_pred_uni_nv12,
+	hevcasm_test_pred_bi_nv12,
+	hevcasm_test_pred_uni_8to16,
+	hevcasm_test_pred_uni_weighted,
+	hevcasm_test_pred_bi_weighted,
+	hevcasm_test_deblock_luma,
+	hevcasm_test_deblock_chroma,
+	hevcasm_test_deblock_bs,
+	hevcasm_test_sao,
+	hevcasm_test_sao_collect,
+	hevcasm_test_pad_horizontal,
+	hevcasm_test_pad_vertical,
+	hevcasm_test_inverse_transform_add,
+	hevcasm_test_transform,
+	hevcasm_test_transform_skip,
+	hevcasm_test_inverse_transform_skip_add,
+	hevcasm_test_transquant_bypass_add,
+};
+
+
+typedef struct
+{
+	hevcasm_context candidate[HEVCASM_INSTRUCTION_SET_COUNT]; /* populated by each instruction set alone */
+	uint8_t found[HEVCASM_AUTOTUNE_SLOTS];
+	uint8_t used[HEVCASM_AUTOTUNE_SLOTS];
+	double cycles[HEVCASM_AUTOTUNE_SLOTS][HEVCASM_INSTRUCTION_SET_COUNT]; /* summed over the tests using a slot */
+	int count[HEVCASM_AUTOTUNE_SLOTS][HEVCASM_INSTRUCTION_SET_COUNT];
+	int mismatch[HEVCASM_AUTOTUNE_SLOTS]; /* bit per instruction set */
+	hevcasm_timestamp deadline;
+}
+tuner;
+
+
+/* Marks the slots holding the reported kernel, as populated by instruction set i alone, at the reported entry of a
+table of the reported size. Returns the number of slots found. */
+static int find_slots(tuner *t, int i, const hevcasm_test_kernel *reported)
+{
+	int n = 0;
+
+	memset(t->found, 0, sizeof(t->found));
+
+	for (size_t j = 0; reported->kernel && j < sizeof(tables) / sizeof(tables[0]); ++j)
+	{
+		if (tables[j].size != reported->size) continue;
+
+		const size_t slot = (tables[j].offset + reported->offset - offsetof(hevcasm_context, sad)) / sizeof(kernel *);
+		if (get_slot(&t->candidate[i], slot) == reported->kernel)
+		{
+			t->found[slot] = 1;
+			++n;
+		}
+	}
+
+	return n;
+}
+
+
+/* Best of several timed runs: robust to interrupts and cheap enough for startup */
+static int measure(hevcasm_bound_invoke *invoke, void *bound)
+{
+	for (int i = 0; i < 8; ++i) invoke(bound, 4);
+
+	hevcasm_timestamp best = 0;
+	for (int i = 0; i < 32; ++i)
+	{
+		const hevcasm_timestamp start = hevcasm_get_timestamp();
+		invoke(bound, 4);
+		const hevcasm_timestamp duration = hevcasm_get_timestamp() - start;
+		if (i == 0 || duration < best) best = duration;
+	}
+
+	return (int)((best + 2) / 4);
+}
+
+
+/* Replaces hevcasm_test(): measures the kernel each instruction set's bound calls and attributes the results to the
+slot that holds that kernel for every instruction set measured */
+static int tune(void *state, void *ref, void *test, hevcasm_bound_get *get, hevcasm_bound_invoke *invoke, hevcasm_bound_mismatch *mismatch, hevcasm_instruction_set mask)
+{
+	tuner *t = state;
+
+	if (hevcasm_get_timestamp() > t->deadline) return 0;
+
+	hevcasm_test_kernel reported;
+	if (!hevcasm_test_get_kernel(get, ref, HEVCASM_C_REF, &reported)) return 0;
+
+	if (!reported.kernel)
+	{
+		hevcasm_test_printf(" not timed\n");
+		return 0;
+	}
+
+	invoke(ref, 1);
+
+	int cycles[HEVCASM_INSTRUCTION_SET_COUNT];
+	int measured = 0;
+	int errors = 0;
+	memset(t->used, 1, sizeof(t->used));
+
+	for (int i = 1; i < HEVCASM_INSTRUCTION_SET_COUNT; ++i)
+	{
+		const hevcasm_instruction_set set = 1 << i;
+
+		if (!(set & mask) || !hevcasm_test_get_kernel(get, test, set, &reported)) continue;
+
+		if (!find_slots(t, i, &reported)) continue;
+		for (size_t slot = 0; slot < HEVCASM_AUTOTUNE_SLOTS; ++slot) t->used[slot] &= t->found[slot];
+
+		cycles[i] = measure(invoke, test);
+		measured |= set;
+
+		invoke(ref, 1);
+		if (mismatch(ref, test)) errors |= set;
+
+		hevcasm_test_printf(" %s:%d%s", hevcasm_instruction_set_as_text(set), cycles[i], (errors & set) ? "-MISMATCH" : "");
+	}
+
+	int best = 0;
+	for (int i = 1; i < HEVCASM_INSTRUCTION_SET_COUNT; ++i)
+	{
+		if ((measured & ~errors & (1 << i)) && (!best || cycles[i] < cycles[best])) best = i;
+	}
+	if (best) hevcasm_test_printf(" -> %s", hevcasm_instruction_set_as_text(1 << best));
+	hevcasm_test_printf("\n");
+
+	if (!measured) return 0;
+
+	for (size_t slot = 0; slot < HEVCASM_AUTOTUNE_SLOTS; ++slot)
+	{
+		if (!t->used[slot]) continue;
+
+		for (int i = 1; i < HEVCASM_INSTRUCTION_SET_COUNT; ++i)
+		{
+			if (!(measured & (1 << i))) continue;
+			t->cycles[slot][i] += cycles[i];
+			++t->count[slot][i];
+		}
+		t->mismatch[slot] |= errors;
+	}
+
+	int error_count = 0;
+	for (; errors; errors &= errors - 1) ++error_count;
+	return error_count;
+}
+
+
+void HEVCASM_API hevcasm_autotune(hevcasm_autotune_profile *profile, hevcasm_instruction_set mask, int budget_mcycles, FILE *log)
+{
+	memset(profile, 0, sizeof(*profile));
+	hevcasm_processor_signature(profile->processor);
+	profile->mask = mask;
+	memset(profile->set, HEVCASM_AUTOTUNE_DEFAULT, sizeof(profile->set));
+
+	tuner *t = calloc(1, sizeof(tuner));
+	if (!t) return;
+
+	t->deadline = hevcasm_get_timestamp() + (hevcasm_timestamp)budget_mcycles * 1000000;
+
+	for (int i = 0; i < HEVCASM_INSTRUCTION_SET_COUNT; ++i)
+	{
+		hevcasm_populate_context(&t->candidate[i], 1 << i);
+	}
+
+	/* the tests run on this thread with its own output and random numbers, leaving the caller's untouched */
+	FILE *output = hevcasm_test_set_output(log);
+	const uint64_t random = hevcasm_test_srand(1);
+	hevcasm_test_set_hook(tune, t);
+
+	int error_count = 0;
+	for (size_t k = 0; k < sizeof(tests) / sizeof(tests[0]) && hevcasm_get_timestamp() <= t->deadline; ++k)
+	{
+		tests[k](&error_count, mask);
+	}
+
+	hevcasm_test_set_hook(0, 0);
+	hevcasm_test_srand(random);
+	hevcasm_test_set_output(output);
+
+	/* fastest matching kernel among the instruction sets measured by every test of the slot */
+	for (size_t slot = 0; slot < HEVCASM_AUTOTUNE_SLOTS; ++slot)
+	{
+		int n = 0;
+		for (int i = 0; i < HEVCASM_INSTRUCTION_SET_COUNT; ++i) if (t->count[slot][i] > n) n = t->count[slot][i];
+
+		int best = -1;
+		for (int i = 0; i < HEVCASM_INSTRUCTION_SET_COUNT; ++i)
+		{
+			if (!n || t->count[slot][i] != n || (t->mismatch[slot] & (1 << i)) || !get_slot(&t->candidate[i], slot)) continue;
+			if (best < 0 || t->cycles[slot][i] < t->cycles[slot][best]) best = i;
+		}
+
+		profile->set[slot] = best < 0 ? HEVCASM_AUTOTUNE_DEFAULT : (uint8_t)best;
+	}
+
+	free(t);
+}
+
+
+void HEVCASM_API hevcasm_populate_context_autotuned(hevcasm_context *context, const hevcasm_autotune_profile *profile)
+{
+	hevcasm_populate_context(context, profile->mask);
+
+	hevcasm_context *candidate = malloc(sizeof(hevcasm_context));
+
+	for (int i = 0; i < HEVCASM_INSTRUCTION_SET_COUNT; ++i)
+	{
+		if (!(profile->mask & (1 << i))) continue;
+
+		int populated = 0;
+		for (size_t slot = 0; slot < HEVCASM_AUTOTUNE_SLOTS; ++slot)
+		{
+			if (profile->set[slot] != i) continue;
+
+			if (!populated) hevcasm_populate_context(candidate, 1 << i);
+			populated = 1;
+
+			if (get_slot(candidate, slot)) set_slot(context, slot, get_slot(candidate, slot));
+		}
+	}
+
+	free(candidate);
+}
+
+
+int HEVCASM_API hevcasm_autotune_save(const hevcasm_autotune_profile *profile, const char *filename)
+{
+	FILE *f = fopen(filename, "w");
+	if (!f) return 0;
+
+	fprintf(f, "hevcasm autotune profile\n");
+	fprintf(f, "processor %s\n", profile->processor);
+	fprintf(f, "mask %x\n", (unsigned)profile->mask);
+	fprintf(f, "slots %d\n", (int)HEVCASM_AUTOTUNE_SLOTS);
+	fprintf(f, "layout %08x\n", (unsigned)layout_hash());
+
+	for (size_t slot = 0; slot < HEVCASM_AUTOTUNE_SLOTS; ++slot)
+	{
+		if (profile->set[slot] < HEVCASM_INSTRUCTION_SET_COUNT)
+		{
+			fprintf(f, "%d %s\n", (int)slot, hevcasm_instruction_set_as_text(1 << profile->set[slot]));
+		}
+	}
+
+	return !fclose(f);
+}
+
+
+int HEVCASM_API hevcasm_autotune_load(hevcasm_autotune_profile *profile, const char *filename)
+{
+	FILE *f = fopen(filename, "r");
+	if (!f) return 0;
+
+	memset(profile, 0, sizeof(*profile));
+	memset(profile->set, HEVCASM_AUTOTUNE_DEFAULT, sizeof(profile->set));
+
+	char processor[HEVCASM_PROCESSOR_SIGNATURE_SIZE];
+	hevcasm_processor_signature(processor);
+
+	unsigned mask;
+	int slots;
+	unsigned layout;
+	int ok = fscanf(f, "hevcasm autotune profile processor %31s mask %x slots %d layout %x", profile->processor, &mask, &slots, &layout) == 4;
+
+	/* profiles only apply to the processor and context layout they were made for */
+	ok = ok && !strcmp(profile->processor, processor);
+	ok = ok && slots == (int)HEVCASM_AUTOTUNE_SLOTS && layout == layout_hash();
+	ok = ok && !(mask & ~(unsigned)hevcasm_instruction_set_support());
+	profile->mask = (hevcasm_instruction_set)mask;
+
+	int slot;
+	char name[16];
+	while (ok && fscanf(f, "%d %15s", &slot, name) == 2)
+	{
+		int i = 0;
+		while (i < HEVCASM_INSTRUCTION_SET_COUNT && strcmp(name, hevcasm_instruction_set_as_text(1 << i))) ++i;
+
+		ok = slot >= 0 && slot < slots && i < HEVCASM_INSTRUCTION_SET_COUNT && (mask & (1 << i));
+		if (ok) profile->set[slot] = (uint8_t)i;
+	}
+	ok = ok && feof(f);
+
+	fclose(f);
+	return ok;
+}
+
+
+void HEVCASM_API hevcasm_autotune_context(hevcasm_context *context, const char *filename, int budget_mcycles)
+{
+	hevcasm_autotune_profile profile;
+
+	if (!filename || !hevcasm_autotune_load(&profile, filename))
+	{
+		hevcasm_autotune(&profile, hevcasm_instruction_set_support(), budget_mcycles, 0);
+		if (filename) hevcasm_autotune_save(&profile, filename);
+	}
+
+	hevcasm_populate_context_autotuned(context, &profile);
+}
+
+
+void HEVCASM_API hevcasm_test_autotune(int *error_count, hevcasm_instruction_set mask)
+{
+	hevcasm_test_printf("\nhevcasm_autotune - startup kernel selection\n");
+
+	hevcasm_autotune_profile profile;
+
+	const hevcasm_timestamp start = hevcasm_get_timestamp();
+	hevcasm_autotune(&profile, mask, 1500, 0);
+	const int elapsed = (int)((hevcasm_get_timestamp() - start) / 1000000);
+
+	int errors = 0;
+	int tuned = 0;
+
+	/* the table list covers every slot once */
+	size_t end = offsetof(hevcasm_context, sad);
+	for (size_t j = 0; j < sizeof(tables) / sizeof(tables[0]); ++j)
+	{
+		if (tables[j].nested) continue;
+		if (tables[j].offset != end) ++errors;
+		end += tables[j].size;
+	}
+	if (end != offsetof(hevcasm_context, sad) + HEVCASM_AUTOTUNE_SLOTS * sizeof(kernel *)) ++errors;
+
+	/* tuned slots take the chosen instruction set's kernel, others keep precedence order */
+	hevcasm_context *context = malloc(sizeof(hevcasm_context));
+	hevcasm_context *expected = malloc(sizeof(hevcasm_context));
+
+	hevcasm_populate_context_autotuned(context, &profile);
+	if (context->mask != mask) ++errors;
+
+	hevcasm_populate_context(expected, mask);
+	for (size_t slot = 0; slot < HEVCASM_AUTOTUNE_SLOTS; ++slot)
+	{
+		if (profile.set[slot] == HEVCASM_AUTOTUNE_DEFAULT && get_slot(context, slot) != get_slot(expected, slot)) ++errors;
+	}
+
+	for (int i = 0; i < HEVCASM_INSTRUCTION_SET_COUNT; ++i)
+	{
+		hevcasm_populate_context(expected, 1 << i);
+		for (size_t slot = 0; slot < HEVCASM_AUTOTUNE_SLOTS; ++slot)
+		{
+			if (profile.set[slot] != i) continue;
+			++tuned;
+			if (!(mask & (1 << i)) || !get_slot(expected, slot) || get_slot(context, slot) != get_slot(expected, slot)) ++errors;
+		}
+	}
+
+	/* round trip through a profile file in the temporary directory, which is rejected on another processor or
+	with another context layout */
+	const char *directory = getenv("TMPDIR");
+	if (!directory) directory = getenv("TEMP");
+	if (!directory) directory = getenv("TMP");
+#ifdef WIN32
+	if (!directory || strlen(directory) > FILENAME_MAX - 64) directory = ".";
+#else
+	if (!directory || strlen(directory) > FILENAME_MAX - 64) directory = "/tmp";
+#endif
+	char filename[FILENAME_MAX];
+	sprintf(filename, "%s/hevcasm_autotune_%08x.txt", directory, (unsigned)hevcasm_get_timestamp());
+
+	hevcasm_autotune_profile loaded;
+	if (!hevcasm_autotune_save(&profile, filename)) ++errors;
+	if (!hevcasm_autotune_load(&loaded, filename)) ++errors;
+	if (strcmp(loaded.processor, profile.processor) || loaded.mask != profile.mask || memcmp(loaded.set, profile.set, sizeof(profile.set))) ++errors;
+
+	FILE *f = fopen(filename, "w");
+	if (f)
+	{
+		fprintf(f, "hevcasm autotune profile\nprocessor %s\nmask %x\nslots %d\nlayout %08x\n", profile.processor, (unsigned)profile.mask, (int)HEVCASM_AUTOTUNE_SLOTS, (unsigned)layout_hash() ^ 1);
+		fclose(f);
+	}
+	if (hevcasm_autotune_load(&loaded, filename)) ++errors;
+
+	strcpy(profile.processor, "other");
+	if (!hevcasm_autotune_save(&profile, filename)) ++errors;
+	if (hevcasm_autotune_load(&loaded, filename)) ++errors;
+	remove(filename);
+
+	hevcasm_test_printf("\t%d of %d slots tuned in %d Mcycles, profile saved and reloaded%s\n", tuned, (int)HEVCASM_AUTOTUNE_SLOTS, elapsed, errors ? "-MISMATCH" : "");
+
+	*error_count += errors;
+	free(expected);
+	free(context);
+}
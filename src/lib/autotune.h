@@ -0,0 +1,96 @@
+/*
+The copyright in this software is being made available under the BSD
+License, included below. This software may be subject to other third party
+and contributor rights, including patent rights, and no such rights are
+granted under this license.
+
+
+Copyright(c) 2011 - 2015, Parabola Research Limited
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met :
+
+* Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+this list of conditions and the following disclaimer in the documentation
+and / or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its contributors may
+be used to endorse or promote products derived from this software without
+specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/* Startup auto-tuning: fastest bit-exact kernel for each dispatch context slot on the running processor */
+
+
+#ifndef INCLUDED_autotune_h
+#define INCLUDED_autotune_h
+
+#include "hevcasm.h"
+#include "context.h"
+
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+// A context's kernel pointers (all fields after its mask) are its slots, numbered in declaration order.
+#define HEVCASM_AUTOTUNE_SLOTS ((offsetof(hevcasm_context, transquant_bypass_add) + sizeof(hevcasm_table_transquant_bypass_add) - offsetof(hevcasm_context, sad)) / sizeof(void (*)(void)))
+
+// Value of set[] for slots left to instruction set precedence, as hevcasm_populate_context()
+#define HEVCASM_AUTOTUNE_DEFAULT 0xff
+
+// Kernel choice per slot. set[] holds the index of the chosen instruction set (HEVCASM_INSTRUCTION_SET_XMACRO
+// value): the slot takes the kernel populated by that instruction set alone.
+typedef struct
+{
+	char processor[HEVCASM_PROCESSOR_SIGNATURE_SIZE];
+	hevcasm_instruction_set mask;
+	uint8_t set[HEVCASM_AUTOTUNE_SLOTS];
+}
+hevcasm_autotune_profile;
+
+// Benchmarks, on the running processor, the kernel of each instruction set in mask for every slot exercised by the
+// self tests and chooses the fastest whose output matches C_REF. Measurement stops once budget_mcycles million
+// hevcasm_get_timestamp() ticks (elapsed time stamp counter cycles) have passed; remaining slots are left to
+// precedence. Writes measurements, as the self test does, to log unless it is null. Uses only state of the calling
+// thread (see hevcasm_test.h) so may run concurrently on several threads, though measurements then interfere.
+void HEVCASM_API hevcasm_autotune(hevcasm_autotune_profile *profile, hevcasm_instruction_set mask, int budget_mcycles, FILE *log);
+
+// Populates a context for profile->mask, then replaces the kernels of tuned slots by those chosen.
+void HEVCASM_API hevcasm_populate_context_autotuned(hevcasm_context *context, const hevcasm_autotune_profile *profile);
+
+// Profile files are text, one line per tuned slot. Returns zero on failure. Loading also fails if the file was
+// written on a processor with a different signature or by a library with a different context layout (checked by a
+// hash of the position and size of each table).
+int HEVCASM_API hevcasm_autotune_save(const hevcasm_autotune_profile *profile, const char *filename);
+
+int HEVCASM_API hevcasm_autotune_load(hevcasm_autotune_profile *profile, const char *filename);
+
+// Startup entry point: loads the profile in filename if it matches this processor, otherwise tunes all supported
+// instruction sets within budget_mcycles and saves the profile to filename (if not null), then populates context.
+void HEVCASM_API hevcasm_autotune_context(hevcasm_context *context, const char *filename, int budget_mcycles);
+
+void HEVCASM_API hevcasm_test_autotune(int *error_count, hevcasm_instruction_set mask);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
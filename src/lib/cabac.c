@@ -0,0 +1,2524 @@
+/*
+The copyright in this software is being made available under the BSD
+License, included below. This software may be subject to other third party
+and contributor rights, including patent rights, and no such rights are
+granted under this license.
+
+
+Copyright(c) 2011 - 2015, Parabola Research Limited
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met :
+
+* Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+this list of conditions and the following disclaimer in the documentation
+and / or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its contributors may
+be used to endorse or promote products derived from this software without
+specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "cabac.h"
+#include "static_dispatch.h"
+#include "hevcasm_test.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <assert.h>
+
+
+/* Context initialisation (9.3.2.2): initValue per initType */
+
+static const uint8_t init_sig_coeff_flag[3][42] =
+{
+	{ 111, 111, 125, 110, 110, 94, 124, 108, 124, 107, 125, 141, 179, 153, 125, 107, 125, 141, 179, 153, 125, 107, 125, 141, 179, 153, 125, 140, 139, 182, 182, 152, 136, 152, 136, 153, 136, 139, 111, 136, 139, 111 },
+	{ 155, 154, 139, 153, 139, 123, 123, 63, 153, 166, 183, 140, 136, 153, 154, 166, 183, 140, 136, 153, 154, 166, 183, 140, 136, 153, 154, 170, 153, 123, 123, 107, 121, 107, 121, 167, 151, 183, 140, 151, 183, 140 },
+	{ 170, 154, 139, 153, 139, 123, 123, 63, 124, 166, 183, 140, 136, 153, 154, 166, 183, 140, 136, 153, 154, 166, 183, 140, 136, 153, 154, 170, 153, 138, 138, 122, 121, 122, 121, 167, 151, 183, 140, 151, 183, 140 },
+};
+
+static const uint8_t init_coded_sub_block_flag[3][4] =
+{
+	{ 91, 171, 134, 141 },
+	{ 121, 140, 61, 154 },
+	{ 121, 140, 61, 154 },
+};
+
+static const uint8_t init_last_sig_coeff_prefix[3][18] =
+{
+	{ 110, 110, 124, 125, 140, 153, 125, 127, 140, 109, 111, 143, 127, 111, 79, 108, 123, 63 },
+	{ 125, 110, 94, 110, 95, 79, 125, 111, 110, 78, 110, 111, 111, 95, 94, 108, 123, 108 },
+	{ 125, 110, 124, 110, 95, 94, 125, 111, 111, 79, 125, 126, 111, 111, 79, 108, 123, 93 },
+};
+
+static const uint8_t init_coeff_abs_level_greater1_flag[3][24] =
+{
+	{ 140, 92, 137, 138, 140, 152, 138, 139, 153, 74, 149, 92, 139, 107, 122, 152, 140, 179, 166, 182, 140, 227, 122, 197 },
+	{ 154, 196, 167, 167, 154, 152, 167, 182, 182, 134, 149, 136, 153, 121, 136, 122, 169, 208, 166, 167, 154, 152, 167, 182 },
+	{ 154, 196, 196, 167, 154, 152, 167, 182, 182, 134, 149, 136, 153, 121, 136, 137, 169, 194, 166, 167, 154, 167, 137, 182 },
+};
+
+static const uint8_t init_coeff_abs_level_greater2_flag[3][6] =
+{
+	{ 138, 153, 136, 167, 152, 152 },
+	{ 107, 167, 91, 122, 107, 167 },
+	{ 107, 167, 91, 107, 107, 167 },
+};
+
+
+static void init_contexts(uint8_t *contexts, const uint8_t *initValue, int n, int qp)
+{
+	for (int i = 0; i < n; ++i)
+	{
+		const int m = (initValue[i] >> 4) * 5 - 45;
+		const int c = ((initValue[i] & 15) << 3) - 16;
+		int preCtxState = ((m * qp) >> 4) + c;
+		preCtxState = preCtxState < 1 ? 1 : preCtxState > 126 ? 126 : preCtxState;
+		const int valMps = preCtxState > 63;
+		const int pStateIdx = valMps ? preCtxState - 64 : 63 - preCtxState;
+		contexts[i] = (uint8_t)((pStateIdx << 1) | valMps);
+	}
+}
+
+
+void HEVCASM_API hevcasm_init_residual_contexts(hevcasm_residual_contexts *contexts, int initType, int qp)
+{
+	qp = qp < 0 ? 0 : qp > 51 ? 51 : qp;
+
+	init_contexts(contexts->sig_coeff_flag, init_sig_coeff_flag[initType], 42, qp);
+	init_contexts(contexts->coded_sub_block_flag, init_coded_sub_block_flag[initType], 4, qp);
+	init_contexts(contexts->last_sig_coeff_x_prefix, init_last_sig_coeff_prefix[initType], 18, qp);
+	init_contexts(contexts->last_sig_coeff_y_prefix, init_last_sig_coeff_prefix[initType], 18, qp);
+	init_contexts(contexts->coeff_abs_level_greater1_flag, init_coeff_abs_level_greater1_flag[initType], 24, qp);
+	init_contexts(contexts->coeff_abs_level_greater2_flag, init_coeff_abs_level_greater2_flag[initType], 6, qp);
+}
+
+
+/* Arithmetic encoder */
+
+/* rangeTabLps (Table 9-46), indexed by pStateIdx and qRangeIdx */
+static const uint8_t cabac_range_lps[64][4] =
+{
+	{ 128, 176, 208, 240 }, { 128, 167, 197, 227 }, { 128, 158, 187, 216 }, { 123, 150, 178, 205 },
+	{ 116, 142, 169, 195 }, { 111, 135, 160, 185 }, { 105, 128, 152, 175 }, { 100, 122, 144, 166 },
+	{ 95, 116, 137, 158 }, { 90, 110, 130, 150 }, { 85, 104, 123, 142 }, { 81, 99, 117, 135 },
+	{ 77, 94, 111, 128 }, { 73, 89, 105, 122 }, { 69, 85, 100, 116 }, { 66, 80, 95, 110 },
+	{ 62, 76, 90, 104 }, { 59, 72, 86, 99 }, { 56, 69, 81, 94 }, { 53, 65, 77, 89 },
+	{ 51, 62, 73, 85 }, { 48, 59, 69, 80 }, { 46, 56, 66, 76 }, { 43, 53, 63, 72 },
+	{ 41, 50, 59, 69 }, { 39, 48, 56, 65 }, { 37, 45, 54, 62 }, { 35, 43, 51, 59 },
+	{ 33, 41, 48, 56 }, { 32, 39, 46, 53 }, { 30, 37, 43, 50 }, { 29, 35, 41, 48 },
+	{ 27, 33, 39, 45 }, { 26, 31, 37, 43 }, { 24, 30, 35, 41 }, { 23, 28, 33, 39 },
+	{ 22, 27, 32, 37 }, { 21, 26, 30, 35 }, { 20, 24, 29, 33 }, { 19, 23, 27, 31 },
+	{ 18, 22, 26, 30 }, { 17, 21, 25, 28 }, { 16, 20, 23, 27 }, { 15, 19, 22, 25 },
+	{ 14, 18, 21, 24 }, { 14, 17, 20, 23 }, { 13, 16, 19, 22 }, { 12, 15, 18, 21 },
+	{ 12, 14, 17, 20 }, { 11, 14, 16, 19 }, { 11, 13, 15, 18 }, { 10, 12, 15, 17 },
+	{ 10, 12, 14, 16 }, { 9, 11, 13, 15 }, { 9, 11, 12, 14 }, { 8, 10, 12, 14 },
+	{ 8, 9, 11, 13 }, { 7, 9, 11, 12 }, { 7, 9, 10, 12 }, { 7, 8, 10, 11 },
+	{ 6, 8, 9, 11 }, { 6, 7, 9, 10 }, { 6, 7, 8, 9 }, { 2, 2, 2, 2 },
+};
+
+/*
+Context state after coding a bin, indexed by ((pStateIdx << 1) | valMps) ^ binVal, that is by pStateIdx and whether
+the bin was the LPS. Entries are (pStateIdx' << 1) | valMps' with binVal already removed so that the updated context
+is the entry XOR binVal (Table 9-47).
+*/
+static const uint8_t cabac_next_state[128] =
+{
+	2, 0, 4, 1, 6, 3, 8, 5, 10, 5, 12, 9, 14, 9, 16, 11,
+	18, 13, 20, 15, 22, 17, 24, 19, 26, 19, 28, 23, 30, 23, 32, 25,
+	34, 27, 36, 27, 38, 31, 40, 31, 42, 33, 44, 33, 46, 37, 48, 37,
+	50, 39, 52, 39, 54, 43, 56, 43, 58, 45, 60, 45, 62, 47, 64, 49,
+	66, 49, 68, 51, 70, 53, 72, 53, 74, 55, 76, 55, 78, 57, 80, 59,
+	82, 59, 84, 61, 86, 61, 88, 61, 90, 63, 92, 65, 94, 65, 96, 67,
+	98, 67, 100, 67, 102, 69, 104, 69, 106, 71, 108, 71, 110, 71, 112, 73,
+	114, 73, 116, 73, 118, 75, 120, 75, 122, 75, 124, 77, 124, 77, 124, 127,
+};
+
+/* renormalisation shift indexed by ivlCurrRange >> 3: after any regular bin the range is at least 6 */
+static const uint8_t cabac_renorm_shift[64] =
+{
+	6, 5, 4, 4, 3, 3, 3, 3, 2, 2, 2, 2, 2, 2, 2, 2,
+	1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+};
+
+
+static void cabac_put_byte(hevcasm_cabac_encoder *encoder, int byte)
+{
+	if (encoder->count < encoder->size) encoder->buffer[encoder->count] = (uint8_t)byte;
+	++encoder->count;
+}
+
+
+/*
+Moves whole bytes from the top of low to the output until at most 16 bits remain pending. A byte can still be
+changed by a carry until a later byte differs from 0xff, so runs of 0xff are counted in buffered_count after the
+byte that precedes them.
+*/
+static void cabac_write_out(hevcasm_cabac_encoder *encoder)
+{
+	do
+	{
+		const int lead = (int)(encoder->low >> (56 - encoder->bits_left));
+		encoder->bits_left += 8;
+		encoder->low &= UINT64_MAX >> encoder->bits_left;
+
+		if (lead == 0xff)
+		{
+			++encoder->buffered_count;
+		}
+		else if (encoder->buffered_count > 0)
+		{
+			const int carry = lead >> 8;
+			cabac_put_byte(encoder, encoder->buffered_byte + carry);
+			encoder->buffered_byte = lead & 0xff;
+			while (encoder->buffered_count > 1)
+			{
+				cabac_put_byte(encoder, (0xff + carry) & 0xff);
+				--encoder->buffered_count;
+			}
+		}
+		else
+		{
+			encoder->buffered_count = 1;
+			encoder->buffered_byte = lead;
+		}
+	}
+	while (encoder->bits_left <= 47);
+}
+
+
+/* after this, low has room for at least 32 more bits */
+static void cabac_test_and_write_out(hevcasm_cabac_encoder *encoder)
+{
+	if (encoder->bits_left < 33) cabac_write_out(encoder);
+}
+
+
+static void cabac_encode_bin(hevcasm_cabac_encoder *encoder, uint8_t *context, int binVal)
+{
+	const int state = *context;
+	const uint32_t lps = cabac_range_lps[state >> 1][(encoder->range >> 6) & 3];
+
+	/* all ones when the bin is the LPS: selects low + rMps and range rLps without a branch */
+	const uint32_t mask = 0 - (uint32_t)((state ^ binVal) & 1);
+	encoder->range -= lps;
+	encoder->low += encoder->range & mask;
+	encoder->range ^= (encoder->range ^ lps) & mask;
+
+	*context = (uint8_t)(cabac_next_state[state ^ binVal] ^ binVal);
+
+	const int shift = cabac_renorm_shift[encoder->range >> 3];
+	encoder->low <<= shift;
+	encoder->range <<= shift;
+	encoder->bits_left -= shift;
+
+	cabac_test_and_write_out(encoder);
+}
+
+
+/* n bypass bins cost a shift and one multiply: each bin adds range to low, scaled by its weight */
+static void cabac_encode_bypass(hevcasm_cabac_encoder *encoder, uint32_t bins, int n)
+{
+	encoder->low = (encoder->low << n) + (uint64_t)encoder->range * bins;
+	encoder->bits_left -= n;
+
+	cabac_test_and_write_out(encoder);
+}
+
+
+static void cabac_encode_terminate(hevcasm_cabac_encoder *encoder, int binVal)
+{
+	encoder->range -= 2;
+	if (binVal)
+	{
+		encoder->low += encoder->range;
+		encoder->low <<= 7;
+		encoder->range = 2 << 7;
+		encoder->bits_left -= 7;
+	}
+	else if (encoder->range < 256)
+	{
+		encoder->low <<= 1;
+		encoder->range <<= 1;
+		--encoder->bits_left;
+	}
+
+	cabac_test_and_write_out(encoder);
+}
+
+
+void HEVCASM_API hevcasm_cabac_encoder_init(hevcasm_cabac_encoder *encoder, uint8_t *buffer, size_t size)
+{
+	encoder->low = 0;
+	encoder->range = 510;
+	encoder->bits_left = 55;
+	encoder->buffered_byte = 0xff;
+	encoder->buffered_count = 0;
+	encoder->buffer = buffer;
+	encoder->size = size;
+	encoder->count = 0;
+}
+
+
+void HEVCASM_API hevcasm_cabac_encode_bin(hevcasm_cabac_encoder *encoder, uint8_t *context, int binVal)
+{
+	cabac_encode_bin(encoder, context, binVal);
+}
+
+
+void HEVCASM_API hevcasm_cabac_encode_bypass(hevcasm_cabac_encoder *encoder, uint32_t bins, int n)
+{
+	assert(n <= 32);
+	cabac_encode_bypass(encoder, bins, n);
+}
+
+
+void HEVCASM_API hevcasm_cabac_encode_terminate(hevcasm_cabac_encoder *encoder, int binVal)
+{
+	cabac_encode_terminate(encoder, binVal);
+}
+
+
+size_t HEVCASM_API hevcasm_cabac_encoder_finish(hevcasm_cabac_encoder *encoder)
+{
+	if (encoder->low >> (64 - encoder->bits_left))
+	{
+		cabac_put_byte(encoder, encoder->buffered_byte + 1);
+		while (encoder->buffered_count > 1)
+		{
+			cabac_put_byte(encoder, 0x00);
+			--encoder->buffered_count;
+		}
+		encoder->low -= (uint64_t)1 << (64 - encoder->bits_left);
+	}
+	else
+	{
+		if (encoder->buffered_count > 0) cabac_put_byte(encoder, encoder->buffered_byte);
+		while (encoder->buffered_count > 1)
+		{
+			cabac_put_byte(encoder, 0xff);
+			--encoder->buffered_count;
+		}
+	}
+
+	{
+		/* remaining bits of low followed by rbsp_stop_one_bit and alignment */
+		const int n = 56 - encoder->bits_left + 1;
+		const int aligned = (n + 7) & ~7;
+		const uint64_t bits = (((encoder->low >> 8) << 1) | 1) << (aligned - n);
+		for (int i = aligned - 8; i >= 0; i -= 8)
+		{
+			cabac_put_byte(encoder, (int)(bits >> i) & 0xff);
+		}
+	}
+
+	encoder->buffered_count = 0;
+	return encoder->count;
+}
+
+
+/* Arithmetic decoder */
+
+static void cabac_refill(hevcasm_cabac_decoder *decoder)
+{
+	while (decoder->bits <= 47)
+	{
+		decoder->value = (decoder->value << 8) | (decoder->p < decoder->end ? *decoder->p++ : 0);
+		decoder->bits += 8;
+	}
+}
+
+
+static int cabac_decode_bin(hevcasm_cabac_decoder *decoder, uint8_t *context)
+{
+	const int state = *context;
+	const uint32_t lps = cabac_range_lps[state >> 1][(decoder->range >> 6) & 3];
+
+	/* all ones when the offset lies in the LPS interval */
+	decoder->range -= lps;
+	const uint64_t scaled = (uint64_t)decoder->range << decoder->bits;
+	const uint64_t mask = 0 - (uint64_t)(decoder->value >= scaled);
+	decoder->value -= scaled & mask;
+	decoder->range ^= (decoder->range ^ lps) & (uint32_t)mask;
+
+	const int binVal = (state ^ (int)mask) & 1;
+	*context = (uint8_t)(cabac_next_state[state ^ binVal] ^ binVal);
+
+	const int shift = cabac_renorm_shift[decoder->range >> 3];
+	decoder->range <<= shift;
+	decoder->bits -= shift;
+
+	if (decoder->bits < 32) cabac_refill(decoder);
+	return binVal;
+}
+
+
+/* there are always at least 32 bits read ahead, so a batch of bypass bins needs no refill until it is complete */
+static uint32_t cabac_decode_bypass(hevcasm_cabac_decoder *decoder, int n)
+{
+	uint32_t bins = 0;
+	for (int i = 0; i < n; ++i)
+	{
+		--decoder->bits;
+		const uint64_t scaled = (uint64_t)decoder->range << decoder->bits;
+		const uint64_t mask = 0 - (uint64_t)(decoder->value >= scaled);
+		decoder->value -= scaled & mask;
+		bins = (bins << 1) - (uint32_t)mask;
+	}
+
+	if (decoder->bits < 32) cabac_refill(decoder);
+	return bins;
+}
+
+
+static int cabac_decode_terminate(hevcasm_cabac_decoder *decoder)
+{
+	decoder->range -= 2;
+	if (decoder->value >= (uint64_t)decoder->range << decoder->bits) return 1;
+
+	if (decoder->range < 256)
+	{
+		decoder->range <<= 1;
+		--decoder->bits;
+		if (decoder->bits < 32) cabac_refill(decoder);
+	}
+	return 0;
+}
+
+
+void HEVCASM_API hevcasm_cabac_decoder_init(hevcasm_cabac_decoder *decoder, const uint8_t *data, size_t size)
+{
+	decoder->value = 0;
+	decoder->range = 510;
+	decoder->bits = -9;
+	decoder->p = data;
+	decoder->end = data + size;
+	cabac_refill(decoder);
+}
+
+
+int HEVCASM_API hevcasm_cabac_decode_bin(hevcasm_cabac_decoder *decoder, uint8_t *context)
+{
+	return cabac_decode_bin(decoder, context);
+}
+
+
+uint32_t HEVCASM_API hevcasm_cabac_decode_bypass(hevcasm_cabac_decoder *decoder, int n)
+{
+	assert(n <= 32);
+	return cabac_decode_bypass(decoder, n);
+}
+
+
+int HEVCASM_API hevcasm_cabac_decode_terminate(hevcasm_cabac_decoder *decoder)
+{
+	return cabac_decode_terminate(decoder);
+}
+
+
+/* Coefficient scan */
+
+/* positions, (yP << 2) + xP, of 4x4 up-right diagonal, horizontal and vertical scans (6.5.3 to 6.5.5) */
+static const uint8_t residual_scan_4x4[3][16] =
+{
+	{ 0, 4, 1, 8, 5, 2, 12, 9, 6, 3, 13, 10, 7, 14, 11, 15 },
+	{ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 },
+	{ 0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15 },
+};
+
+/* sub-block positions, (yS << 4) + xS, in scan order */
+static const uint8_t residual_scan_sub_block_1x1[1] = { 0x00 };
+
+static const uint8_t residual_scan_sub_block_2x2[3][4] =
+{
+	{ 0x00, 0x10, 0x01, 0x11 },
+	{ 0x00, 0x01, 0x10, 0x11 },
+	{ 0x00, 0x10, 0x01, 0x11 },
+};
+
+static const uint8_t residual_scan_sub_block_4x4[16] =
+{
+	0x00, 0x10, 0x01, 0x20, 0x11, 0x02, 0x30, 0x21, 0x12, 0x03, 0x31, 0x22, 0x13, 0x32, 0x23, 0x33
+};
+
+static const uint8_t residual_scan_sub_block_8x8[64] =
+{
+	0x00, 0x10, 0x01, 0x20, 0x11, 0x02, 0x30, 0x21, 0x12, 0x03, 0x40, 0x31, 0x22, 0x13, 0x04, 0x50,
+	0x41, 0x32, 0x23, 0x14, 0x05, 0x60, 0x51, 0x42, 0x33, 0x24, 0x15, 0x06, 0x70, 0x61, 0x52, 0x43,
+	0x34, 0x25, 0x16, 0x07, 0x71, 0x62, 0x53, 0x44, 0x35, 0x26, 0x17, 0x72, 0x63, 0x54, 0x45, 0x36,
+	0x27, 0x73, 0x64, 0x55, 0x46, 0x37, 0x74, 0x65, 0x56, 0x47, 0x75, 0x66, 0x57, 0x76, 0x67, 0x77,
+};
+
+
+/* horizontal and vertical scans are only used in 4x4 and 8x8 blocks */
+static const uint8_t *residual_scan_sub_block(int log2TrafoSize, int scanIdx)
+{
+	switch (log2TrafoSize)
+	{
+	case 2: return residual_scan_sub_block_1x1;
+	case 3: return residual_scan_sub_block_2x2[scanIdx];
+	case 4: return residual_scan_sub_block_4x4;
+	default: return residual_scan_sub_block_8x8;
+	}
+}
+
+
+static void hevcasm_residual_scan_c_ref(hevcasm_residual_block *block, const int16_t *src, int log2TrafoSize, int scanIdx)
+{
+	const uint8_t *scanSb = residual_scan_sub_block(log2TrafoSize, scanIdx);
+	const uint8_t *scanPos = residual_scan_4x4[scanIdx];
+
+	for (int i = 0; i < 1 << (2 * (log2TrafoSize - 2)); ++i)
+	{
+		const int xS = scanSb[i] & 15;
+		const int yS = scanSb[i] >> 4;
+		const int16_t *s = &src[((yS << 2) << log2TrafoSize) + (xS << 2)];
+		int sig = 0;
+
+		for (int n = 0; n < 16; ++n)
+		{
+			const int16_t level = s[((scanPos[n] >> 2) << log2TrafoSize) + (scanPos[n] & 3)];
+			block->level[16 * i + n] = level;
+			if (level) sig |= 1 << n;
+		}
+
+		block->sig[i] = (uint16_t)sig;
+	}
+}
+
+
+#ifdef HEVCASM_X64
+
+/* pshufb masks per scan: 4x4 rows 0-1 and 2-3 into scan positions 0-7, then the same into positions 8-15 */
+static const uint8_t residual_scan_shuffle[3][64] =
+{
+	{
+		0, 1, 8, 9, 2, 3, 0x80, 0x80, 10, 11, 4, 5, 0x80, 0x80, 0x80, 0x80,
+		0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0, 1, 0x80, 0x80, 0x80, 0x80, 8, 9, 2, 3,
+		12, 13, 6, 7, 0x80, 0x80, 0x80, 0x80, 14, 15, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+		0x80, 0x80, 0x80, 0x80, 10, 11, 4, 5, 0x80, 0x80, 12, 13, 6, 7, 14, 15,
+	},
+	{
+		0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
+		0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+		0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+		0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
+	},
+	{
+		0, 1, 8, 9, 0x80, 0x80, 0x80, 0x80, 2, 3, 10, 11, 0x80, 0x80, 0x80, 0x80,
+		0x80, 0x80, 0x80, 0x80, 0, 1, 8, 9, 0x80, 0x80, 0x80, 0x80, 2, 3, 10, 11,
+		4, 5, 12, 13, 0x80, 0x80, 0x80, 0x80, 6, 7, 14, 15, 0x80, 0x80, 0x80, 0x80,
+		0x80, 0x80, 0x80, 0x80, 4, 5, 12, 13, 0x80, 0x80, 0x80, 0x80, 6, 7, 14, 15,
+	},
+};
+
+void hevcasm_residual_scan_sub_blocks_ssse3(hevcasm_residual_block *block, const int16_t *src, ptrdiff_t stride, const uint8_t *scanSb, const uint8_t *shuffle, int n);
+
+void hevcasm_residual_scan_ssse3(hevcasm_residual_block *block, const int16_t *src, int log2TrafoSize, int scanIdx)
+{
+	hevcasm_residual_scan_sub_blocks_ssse3(block, src, (ptrdiff_t)1 << log2TrafoSize, residual_scan_sub_block(log2TrafoSize, scanIdx), residual_scan_shuffle[scanIdx], 1 << (2 * (log2TrafoSize - 2)));
+}
+
+#endif
+
+
+void HEVCASM_API hevcasm_populate_residual_scan(hevcasm_table_residual_scan *table, hevcasm_instruction_set mask)
+{
+	*hevcasm_get_residual_scan(table) = 0;
+
+	if (mask & (HEVCASM_C_REF | HEVCASM_C_OPT))
+	{
+		*hevcasm_get_residual_scan(table) = hevcasm_residual_scan_c_ref;
+	}
+
+#ifdef HEVCASM_X64
+	if (mask & HEVCASM_SSSE3)
+	{
+		*hevcasm_get_residual_scan(table) = hevcasm_residual_scan_ssse3;
+	}
+#endif
+}
+
+
+/* quantized levels as written by hevcasm_quantize: mostly small, decaying with frequency, with occasional extremes */
+static void residual_test_levels(int16_t *dst, int log2TrafoSize, double amplitude)
+{
+	const int nCbS = 1 << log2TrafoSize;
+	for (int y = 0; y < nCbS; ++y)
+	{
+		for (int x = 0; x < nCbS; ++x)
+		{
+			const double u = (hevcasm_test_rand() + 1.0) / (HEVCASM_TEST_RAND_MAX + 2.0);
+			int level = (int)(-log(u) * amplitude / (1 + x + y));
+			if (level > 32767) level = 32767;
+			dst[x + y * nCbS] = (int16_t)(hevcasm_test_rand() & 1 ? -level : level);
+			if (!(hevcasm_test_rand() & 0x3ff)) dst[x + y * nCbS] = hevcasm_test_rand() & 1 ? 32767 : -32768;
+		}
+	}
+	dst[0] |= !dst[0];
+}
+
+
+typedef struct
+{
+	HEVCASM_ALIGN(32, int16_t, src[32 * 32]);
+	hevcasm_residual_block block;
+	hevcasm_residual_scan *f;
+	int log2TrafoSize;
+	int scanIdx;
+}
+bound_residual_scan;
+
+
+int init_residual_scan(void *p, hevcasm_instruction_set mask)
+{
+	bound_residual_scan *s = p;
+	hevcasm_table_residual_scan table;
+	hevcasm_populate_residual_scan(&table, mask);
+	hevcasm_residual_scan **entry = hevcasm_get_residual_scan(&table);
+	hevcasm_test_report_kernel(&table, sizeof(table), entry);
+	s->f = *entry;
+	if (s->f && mask == HEVCASM_C_REF)
+	{
+		const int nCbS = 1 << s->log2TrafoSize;
+		hevcasm_test_printf("\t%dx%d scanIdx=%d : ", nCbS, nCbS, s->scanIdx);
+	}
+	return !!s->f;
+}
+
+
+void invoke_residual_scan(void *p, int n)
+{
+	bound_residual_scan *s = p;
+	while (n--)
+	{
+		s->f(&s->block, s->src, s->log2TrafoSize, s->scanIdx);
+	}
+}
+
+
+int mismatch_residual_scan(void *boundRef, void *boundTest)
+{
+	bound_residual_scan *ref = boundRef;
+	bound_residual_scan *test = boundTest;
+
+	const int n = 1 << (2 * ref->log2TrafoSize);
+
+	return memcmp(ref->block.level, test->block.level, n * sizeof(int16_t)) || memcmp(ref->block.sig, test->block.sig, n / 16 * sizeof(uint16_t));
+}
+
+
+void HEVCASM_API hevcasm_test_residual_scan(int *error_count, hevcasm_instruction_set mask)
+{
+	hevcasm_test_printf("\nhevcasm_residual_scan - quantized levels to sub-block scan order\n");
+
+	bound_residual_scan b[2];
+
+	for (b[0].log2TrafoSize = 2; b[0].log2TrafoSize <= 5; ++b[0].log2TrafoSize)
+	{
+		for (b[0].scanIdx = 0; b[0].scanIdx < 3; ++b[0].scanIdx)
+		{
+			if (b[0].scanIdx && b[0].log2TrafoSize > 3) continue;
+
+			residual_test_levels(b[0].src, b[0].log2TrafoSize, 4.0);
+			b[1] = b[0];
+			*error_count += hevcasm_test(&b[0], &b[1], init_residual_scan, invoke_residual_scan, mismatch_residual_scan, mask, 100000);
+		}
+	}
+}
+
+
+static void hevcasm_residual_unscan_c_ref(int16_t *dst, const hevcasm_residual_block *block, int log2TrafoSize, int scanIdx)
+{
+	const uint8_t *scanSb = residual_scan_sub_block(log2TrafoSize, scanIdx);
+	const uint8_t *scanPos = residual_scan_4x4[scanIdx];
+
+	for (int i = 0; i < 1 << (2 * (log2TrafoSize - 2)); ++i)
+	{
+		const int xS = scanSb[i] & 15;
+		const int yS = scanSb[i] >> 4;
+		int16_t *d = &dst[((yS << 2) << log2TrafoSize) + (xS << 2)];
+
+		for (int n = 0; n < 16; ++n)
+		{
+			d[((scanPos[n] >> 2) << log2TrafoSize) + (scanPos[n] & 3)] = block->level[16 * i + n];
+		}
+	}
+}
+
+
+#ifdef HEVCASM_X64
+
+/* pshufb masks per scan: scan positions 0-7 and 8-15 into 4x4 rows 0-1, then the same into rows 2-3 */
+static const uint8_t residual_unscan_shuffle[3][64] =
+{
+	{
+		0, 1, 4, 5, 10, 11, 0x80, 0x80, 2, 3, 8, 9, 0x80, 0x80, 0x80, 0x80,
+		0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 2, 3, 0x80, 0x80, 0x80, 0x80, 0, 1, 8, 9,
+		6, 7, 14, 15, 0x80, 0x80, 0x80, 0x80, 12, 13, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+		0x80, 0x80, 0x80, 0x80, 6, 7, 12, 13, 0x80, 0x80, 4, 5, 10, 11, 14, 15,
+	},
+	{
+		0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
+		0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+		0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+		0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
+	},
+	{
+		0, 1, 8, 9, 0x80, 0x80, 0x80, 0x80, 2, 3, 10, 11, 0x80, 0x80, 0x80, 0x80,
+		0x80, 0x80, 0x80, 0x80, 0, 1, 8, 9, 0x80, 0x80, 0x80, 0x80, 2, 3, 10, 11,
+		4, 5, 12, 13, 0x80, 0x80, 0x80, 0x80, 6, 7, 14, 15, 0x80, 0x80, 0x80, 0x80,
+		0x80, 0x80, 0x80, 0x80, 4, 5, 12, 13, 0x80, 0x80, 0x80, 0x80, 6, 7, 14, 15,
+	},
+};
+
+void hevcasm_residual_unscan_sub_blocks_ssse3(int16_t *dst, const hevcasm_residual_block *block, ptrdiff_t stride, const uint8_t *scanSb, const uint8_t *shuffle, int n);
+
+void hevcasm_residual_unscan_ssse3(int16_t *dst, const hevcasm_residual_block *block, int log2TrafoSize, int scanIdx)
+{
+	hevcasm_residual_unscan_sub_blocks_ssse3(dst, block, (ptrdiff_t)1 << log2TrafoSize, residual_scan_sub_block(log2TrafoSize, scanIdx), residual_unscan_shuffle[scanIdx], 1 << (2 * (log2TrafoSize - 2)));
+}
+
+#endif
+
+
+void HEVCASM_API hevcasm_populate_residual_unscan(hevcasm_table_residual_unscan *table, hevcasm_instruction_set mask)
+{
+	*hevcasm_get_residual_unscan(table) = 0;
+
+	if (mask & (HEVCASM_C_REF | HEVCASM_C_OPT))
+	{
+		*hevcasm_get_residual_unscan(table) = hevcasm_residual_unscan_c_ref;
+	}
+
+#ifdef HEVCASM_X64
+	if (mask & HEVCASM_SSSE3)
+	{
+		*hevcasm_get_residual_unscan(table) = hevcasm_residual_unscan_ssse3;
+	}
+#endif
+}
+
+
+typedef struct
+{
+	hevcasm_residual_block block;
+	HEVCASM_ALIGN(32, int16_t, dst[32 * 32]);
+	hevcasm_residual_unscan *f;
+	int log2TrafoSize;
+	int scanIdx;
+}
+bound_residual_unscan;
+
+
+int init_residual_unscan(void *p, hevcasm_instruction_set mask)
+{
+	bound_residual_unscan *s = p;
+	hevcasm_table_residual_unscan table;
+	hevcasm_populate_residual_unscan(&table, mask);
+	hevcasm_residual_unscan **entry = hevcasm_get_residual_unscan(&table);
+	hevcasm_test_report_kernel(&table, sizeof(table), entry);
+	s->f = *entry;
+	if (s->f && mask == HEVCASM_C_REF)
+	{
+		const int nCbS = 1 << s->log2TrafoSize;
+		hevcasm_test_printf("\t%dx%d scanIdx=%d : ", nCbS, nCbS, s->scanIdx);
+	}
+	return !!s->f;
+}
+
+
+void invoke_residual_unscan(void *p, int n)
+{
+	bound_residual_unscan *s = p;
+	while (n--)
+	{
+		s->f(s->dst, &s->block, s->log2TrafoSize, s->scanIdx);
+	}
+}
+
+
+int mismatch_residual_unscan(void *boundRef, void *boundTest)
+{
+	bound_residual_unscan *ref = boundRef;
+	bound_residual_unscan *test = boundTest;
+
+	return memcmp(ref->dst, test->dst, (1 << (2 * ref->log2TrafoSize)) * sizeof(int16_t));
+}
+
+
+void HEVCASM_API hevcasm_test_residual_unscan(int *error_count, hevcasm_instruction_set mask)
+{
+	hevcasm_test_printf("\nhevcasm_residual_unscan - sub-block scan order to raster order\n");
+
+	bound_residual_unscan b[2];
+
+	for (b[0].log2TrafoSize = 2; b[0].log2TrafoSize <= 5; ++b[0].log2TrafoSize)
+	{
+		for (b[0].scanIdx = 0; b[0].scanIdx < 3; ++b[0].scanIdx)
+		{
+			if (b[0].scanIdx && b[0].log2TrafoSize > 3) continue;
+
+			for (int i = 0; i < 32 * 32; ++i)
+			{
+				b[0].block.level[i] = (int16_t)(hevcasm_test_rand() - HEVCASM_TEST_RAND_MAX / 2);
+			}
+			b[1] = b[0];
+			*error_count += hevcasm_test(&b[0], &b[1], init_residual_unscan, invoke_residual_unscan, mismatch_residual_unscan, mask, 100000);
+		}
+	}
+}
+
+
+/* residual_coding() */
+
+static const uint8_t residual_group_idx[32] = { 0, 1, 2, 3, 4, 4, 5, 5, 6, 6, 6, 6, 7, 7, 7, 7, 8, 8, 8, 8, 8, 8, 8, 8, 9, 9, 9, 9, 9, 9, 9, 9 };
+
+static const uint8_t residual_min_in_group[10] = { 0, 1, 2, 3, 4, 6, 8, 12, 16, 24 };
+
+/* sigCtx within a sub-block (9.3.4.2.5) by prevCsbf, then ctxIdxMap of 4x4 blocks, indexed by (yP << 2) + xP */
+static const uint8_t residual_sig_ctx[5][16] =
+{
+	{ 2, 1, 1, 0, 1, 1, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0 },
+	{ 2, 2, 2, 2, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0 },
+	{ 2, 1, 0, 0, 2, 1, 0, 0, 2, 1, 0, 0, 2, 1, 0, 0 },
+	{ 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2 },
+	{ 0, 1, 4, 5, 2, 3, 4, 5, 6, 6, 8, 8, 7, 7, 8, 8 },
+};
+
+
+static void write_last_sig_coeff_prefix(hevcasm_cabac_encoder *encoder, uint8_t *contexts, int prefix, int log2TrafoSize, int cIdx)
+{
+	const int ctxOffset = cIdx ? 15 : 3 * (log2TrafoSize - 2) + ((log2TrafoSize - 1) >> 2);
+	const int ctxShift = cIdx ? log2TrafoSize - 2 : (log2TrafoSize + 1) >> 2;
+	const int cMax = (log2TrafoSize << 1) - 1;
+
+	for (int i = 0; i < prefix; ++i)
+	{
+		cabac_encode_bin(encoder, &contexts[ctxOffset + (i >> ctxShift)], 1);
+	}
+	if (prefix < cMax)
+	{
+		cabac_encode_bin(encoder, &contexts[ctxOffset + (prefix >> ctxShift)], 0);
+	}
+}
+
+
+/* coeff_abs_level_remaining (9.3.3.11) in the equivalent form used by HM, prefix and suffix in one bypass batch */
+static void write_coeff_abs_level_remaining(hevcasm_cabac_encoder *encoder, int symbol, int cRiceParam)
+{
+	if (symbol < (3 << cRiceParam))
+	{
+		const int length = symbol >> cRiceParam;
+		const uint32_t bins = (((1u << length) - 1) << (1 + cRiceParam)) | (symbol & ((1 << cRiceParam) - 1));
+		cabac_encode_bypass(encoder, bins, length + 1 + cRiceParam);
+	}
+	else
+	{
+		int k = cRiceParam;
+		symbol -= 3 << cRiceParam;
+		while (symbol >= (1 << k))
+		{
+			symbol -= 1 << k;
+			++k;
+		}
+
+		/* at most 32 bins as levels are 16-bit */
+		const int prefixLength = 3 + k + 1 - cRiceParam;
+		assert(prefixLength + k <= 32);
+		cabac_encode_bypass(encoder, (((1u << prefixLength) - 2) << k) | symbol, prefixLength + k);
+	}
+}
+
+
+void HEVCASM_API hevcasm_cabac_write_residual_coding(hevcasm_cabac_encoder *encoder, hevcasm_residual_contexts *contexts, const hevcasm_residual_block *block, int log2TrafoSize, int cIdx, int scanIdx, int sign_hiding)
+{
+	const uint8_t *scanSb = residual_scan_sub_block(log2TrafoSize, scanIdx);
+	const uint8_t *scanPos = residual_scan_4x4[scanIdx];
+
+	int lastSubBlock = (1 << (2 * (log2TrafoSize - 2))) - 1;
+	while (!block->sig[lastSubBlock]) --lastSubBlock;
+
+	int lastScanPos = 15;
+	while (!(block->sig[lastSubBlock] & (1 << lastScanPos))) --lastScanPos;
+
+	{
+		int x = ((scanSb[lastSubBlock] & 15) << 2) + (scanPos[lastScanPos] & 3);
+		int y = ((scanSb[lastSubBlock] >> 4) << 2) + (scanPos[lastScanPos] >> 2);
+		if (scanIdx == 2)
+		{
+			const int t = x;
+			x = y;
+			y = t;
+		}
+
+		const int prefixX = residual_group_idx[x];
+		const int prefixY = residual_group_idx[y];
+		write_last_sig_coeff_prefix(encoder, contexts->last_sig_coeff_x_prefix, prefixX, log2TrafoSize, cIdx);
+		write_last_sig_coeff_prefix(encoder, contexts->last_sig_coeff_y_prefix, prefixY, log2TrafoSize, cIdx);
+
+		/* last_sig_coeff_x_suffix and last_sig_coeff_y_suffix in one batch */
+		uint32_t suffix = 0;
+		int n = 0;
+		if (prefixX > 3)
+		{
+			n = (prefixX >> 1) - 1;
+			suffix = x - residual_min_in_group[prefixX];
+		}
+		if (prefixY > 3)
+		{
+			const int m = (prefixY >> 1) - 1;
+			suffix = (suffix << m) | (y - residual_min_in_group[prefixY]);
+			n += m;
+		}
+		if (n) cabac_encode_bypass(encoder, suffix, n);
+	}
+
+	uint8_t *ctxSig = contexts->sig_coeff_flag + (cIdx ? 27 : 0);
+	uint8_t *ctxCsbf = contexts->coded_sub_block_flag + (cIdx ? 2 : 0);
+	uint8_t *ctxGreater1 = contexts->coeff_abs_level_greater1_flag + (cIdx ? 16 : 0);
+	uint8_t *ctxGreater2 = contexts->coeff_abs_level_greater2_flag + (cIdx ? 4 : 0);
+
+	/* coded_sub_block_flag of each row of sub-blocks, with a zero row below the block */
+	uint16_t csbf[9] = { 0 };
+
+	/* greater1Ctx at the end of the previous sub-block with levels: zero once a level greater than 1 was seen */
+	int c1 = 1;
+
+	for (int i = lastSubBlock; i >= 0; --i)
+	{
+		const int xS = scanSb[i] & 15;
+		const int yS = scanSb[i] >> 4;
+		const int sig = block->sig[i];
+		const int prevCsbf = ((csbf[yS] >> (xS + 1)) & 1) | (((csbf[yS + 1] >> xS) & 1) << 1);
+
+		int inferSbDcSigCoeffFlag = 0;
+		if (i < lastSubBlock && i > 0)
+		{
+			cabac_encode_bin(encoder, &ctxCsbf[prevCsbf != 0], sig != 0);
+			if (!sig) continue;
+			inferSbDcSigCoeffFlag = 1;
+		}
+		csbf[yS] |= (uint16_t)((sig != 0) << xS);
+
+		/* sig_coeff_flag */
+		{
+			const uint8_t *sigCtx = residual_sig_ctx[log2TrafoSize == 2 ? 4 : prevCsbf];
+			uint8_t *ctx = ctxSig;
+			if (log2TrafoSize > 2)
+			{
+				if (cIdx) ctx += log2TrafoSize == 3 ? 9 : 12;
+				else ctx += (i ? 3 : 0) + (log2TrafoSize == 3 ? (scanIdx == 0 ? 9 : 15) : 21);
+			}
+
+			int n = (i == lastSubBlock) ? lastScanPos - 1 : 15;
+			for (; n > 0; --n)
+			{
+				cabac_encode_bin(encoder, &ctx[sigCtx[scanPos[n]]], (sig >> n) & 1);
+			}
+
+			/* the DC flag is inferred when no other flag of a coded sub-block is set; the block's DC has its own context */
+			if (n == 0 && !(inferSbDcSigCoeffFlag && !(sig & 0xfffe)))
+			{
+				cabac_encode_bin(encoder, i ? &ctx[sigCtx[0]] : ctxSig, sig & 1);
+			}
+		}
+
+		if (!sig) continue;
+
+		int absLevel[16];
+		uint32_t signs = 0;
+		int numSigCoeff = 0;
+		int firstSigScanPos = 16;
+		int lastSigScanPos = -1;
+		for (int n = 15; n >= 0; --n)
+		{
+			if ((sig >> n) & 1)
+			{
+				const int level = block->level[16 * i + n];
+				absLevel[numSigCoeff++] = level < 0 ? -level : level;
+				signs = (signs << 1) | (level < 0);
+				if (lastSigScanPos < 0) lastSigScanPos = n;
+				firstSigScanPos = n;
+			}
+		}
+
+		/* coeff_abs_level_greater1_flag and coeff_abs_level_greater2_flag */
+		int ctxSet = (i == 0 || cIdx) ? 0 : 2;
+		if (c1 == 0) ++ctxSet;
+		c1 = 1;
+
+		int firstGreater1 = -1;
+		const int numGreater1Flag = numSigCoeff < 8 ? numSigCoeff : 8;
+		for (int k = 0; k < numGreater1Flag; ++k)
+		{
+			const int greater1 = absLevel[k] > 1;
+			cabac_encode_bin(encoder, &ctxGreater1[4 * ctxSet + c1], greater1);
+			if (greater1)
+			{
+				c1 = 0;
+				if (firstGreater1 < 0) firstGreater1 = k;
+			}
+			else if (c1 > 0 && c1 < 3)
+			{
+				++c1;
+			}
+		}
+
+		if (firstGreater1 >= 0)
+		{
+			cabac_encode_bin(encoder, &ctxGreater2[ctxSet], absLevel[firstGreater1] > 2);
+		}
+
+		/* coeff_sign_flag: the sign at firstSigScanPos is the last bin and is dropped when hidden */
+		{
+			const int signHidden = sign_hiding && lastSigScanPos - firstSigScanPos > 3;
+			cabac_encode_bypass(encoder, signs >> signHidden, numSigCoeff - signHidden);
+		}
+
+		/* coeff_abs_level_remaining */
+		int cRiceParam = 0;
+		for (int k = 0; k < numSigCoeff; ++k)
+		{
+			const int baseLevel = k < 8 ? (k == firstGreater1 ? 3 : 2) : 1;
+			if (absLevel[k] >= baseLevel)
+			{
+				write_coeff_abs_level_remaining(encoder, absLevel[k] - baseLevel, cRiceParam);
+				if (absLevel[k] > (3 << cRiceParam) && cRiceParam < 4) ++cRiceParam;
+			}
+		}
+	}
+}
+
+
+/* residual_sig_ctx permuted into each scan order, indexed by scan position */
+static const uint8_t residual_sig_ctx_scan[3][5][16] =
+{
+	{
+		{ 2, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 },
+		{ 2, 1, 2, 0, 1, 2, 0, 0, 1, 2, 0, 0, 1, 0, 0, 0 },
+		{ 2, 2, 1, 2, 1, 0, 2, 1, 0, 0, 1, 0, 0, 0, 0, 0 },
+		{ 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2 },
+		{ 0, 2, 1, 6, 3, 4, 7, 6, 4, 5, 7, 8, 5, 8, 8, 8 },
+	},
+	{
+		{ 2, 1, 1, 0, 1, 1, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0 },
+		{ 2, 2, 2, 2, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0 },
+		{ 2, 1, 0, 0, 2, 1, 0, 0, 2, 1, 0, 0, 2, 1, 0, 0 },
+		{ 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2 },
+		{ 0, 1, 4, 5, 2, 3, 4, 5, 6, 6, 8, 8, 7, 7, 8, 8 },
+	},
+	{
+		{ 2, 1, 1, 0, 1, 1, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0 },
+		{ 2, 1, 0, 0, 2, 1, 0, 0, 2, 1, 0, 0, 2, 1, 0, 0 },
+		{ 2, 2, 2, 2, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0 },
+		{ 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2 },
+		{ 0, 2, 6, 7, 1, 3, 6, 7, 4, 4, 8, 8, 5, 5, 8, 8 },
+	},
+};
+
+
+static int read_last_sig_coeff_prefix(hevcasm_cabac_decoder *decoder, uint8_t *contexts, int log2TrafoSize, int cIdx)
+{
+	const int ctxOffset = cIdx ? 15 : 3 * (log2TrafoSize - 2) + ((log2TrafoSize - 1) >> 2);
+	const int ctxShift = cIdx ? log2TrafoSize - 2 : (log2TrafoSize + 1) >> 2;
+	const int cMax = (log2TrafoSize << 1) - 1;
+
+	int prefix = 0;
+	while (prefix < cMax && cabac_decode_bin(decoder, &contexts[ctxOffset + (prefix >> ctxShift)])) ++prefix;
+	return prefix;
+}
+
+
+/* Longest coeff_abs_level_remaining prefix of a level within the 16-bit range, as HM's longestPossiblePrefix:
+32 - (COEF_REMAIN_BIN_REDUCTION + maxLog2TrDynamicRange) + COEF_REMAIN_BIN_REDUCTION */
+#define RESIDUAL_PREFIX_MAX 17
+
+
+/* coeff_abs_level_remaining: unary prefix a bin at a time, then the suffix in one bypass batch. Returns -1 for a
+prefix longer than RESIDUAL_PREFIX_MAX, which keeps the suffix length within 32 bits */
+static int read_coeff_abs_level_remaining(hevcasm_cabac_decoder *decoder, int cRiceParam)
+{
+	int prefix = 0;
+	while (prefix <= RESIDUAL_PREFIX_MAX && cabac_decode_bypass(decoder, 1)) ++prefix;
+
+	if (prefix > RESIDUAL_PREFIX_MAX) return -1;
+
+	if (prefix < 3)
+	{
+		return (prefix << cRiceParam) + (int)cabac_decode_bypass(decoder, cRiceParam);
+	}
+
+	const int k = prefix - 3 + cRiceParam;
+	return (((1 << (prefix - 3)) + 2) << cRiceParam) + (int)cabac_decode_bypass(decoder, k);
+}
+
+
+int HEVCASM_API hevcasm_cabac_read_residual_coding(hevcasm_table_residual_unscan *table, hevcasm_cabac_decoder *decoder, hevcasm_residual_contexts *contexts, int16_t *coeffs, int log2TrafoSize, int cIdx, int scanIdx, int sign_hiding)
+{
+	const uint8_t *scanSb = residual_scan_sub_block(log2TrafoSize, scanIdx);
+	const uint8_t *scanPos = residual_scan_4x4[scanIdx];
+
+	hevcasm_residual_block block;
+
+	int lastSubBlock = 0;
+	int lastScanPos = 0;
+	{
+		const int prefixX = read_last_sig_coeff_prefix(decoder, contexts->last_sig_coeff_x_prefix, log2TrafoSize, cIdx);
+		const int prefixY = read_last_sig_coeff_prefix(decoder, contexts->last_sig_coeff_y_prefix, log2TrafoSize, cIdx);
+
+		/* last_sig_coeff_x_suffix and last_sig_coeff_y_suffix in one batch */
+		const int nX = prefixX > 3 ? (prefixX >> 1) - 1 : 0;
+		const int nY = prefixY > 3 ? (prefixY >> 1) - 1 : 0;
+		const uint32_t suffix = (nX + nY) ? cabac_decode_bypass(decoder, nX + nY) : 0;
+
+		int x = residual_min_in_group[prefixX] + (int)(suffix >> nY);
+		int y = residual_min_in_group[prefixY] + (int)(suffix & ((1u << nY) - 1));
+		if (scanIdx == 2)
+		{
+			const int t = x;
+			x = y;
+			y = t;
+		}
+
+		while (scanSb[lastSubBlock] != (((y >> 2) << 4) | (x >> 2))) ++lastSubBlock;
+		while (scanPos[lastScanPos] != (((y & 3) << 2) | (x & 3))) ++lastScanPos;
+	}
+
+	{
+		const int n = 1 << (2 * (log2TrafoSize - 2));
+		memset(&block.level[16 * (lastSubBlock + 1)], 0, 16 * (n - lastSubBlock - 1) * sizeof(int16_t));
+	}
+
+	uint8_t *ctxSig = contexts->sig_coeff_flag + (cIdx ? 27 : 0);
+	uint8_t *ctxCsbf = contexts->coded_sub_block_flag + (cIdx ? 2 : 0);
+	uint8_t *ctxGreater1 = contexts->coeff_abs_level_greater1_flag + (cIdx ? 16 : 0);
+	uint8_t *ctxGreater2 = contexts->coeff_abs_level_greater2_flag + (cIdx ? 4 : 0);
+
+	uint8_t *ctx = ctxSig;
+	if (log2TrafoSize > 2)
+	{
+		if (cIdx) ctx += log2TrafoSize == 3 ? 9 : 12;
+		else ctx += log2TrafoSize == 3 ? (scanIdx == 0 ? 9 : 15) : 21;
+	}
+
+	/* coded_sub_block_flag of each row of sub-blocks, with a zero row below the block */
+	uint16_t csbf[9] = { 0 };
+
+	/* greater1Ctx at the end of the previous sub-block with levels: zero once a level greater than 1 was seen */
+	int c1 = 1;
+
+	for (int i = lastSubBlock; i >= 0; --i)
+	{
+		const int xS = scanSb[i] & 15;
+		const int yS = scanSb[i] >> 4;
+		const int prevCsbf = ((csbf[yS] >> (xS + 1)) & 1) | (((csbf[yS + 1] >> xS) & 1) << 1);
+		int16_t *level = &block.level[16 * i];
+
+		int inferSbDcSigCoeffFlag = 0;
+		if (i < lastSubBlock && i > 0)
+		{
+			if (!cabac_decode_bin(decoder, &ctxCsbf[prevCsbf != 0]))
+			{
+				memset(level, 0, 16 * sizeof(int16_t));
+				block.sig[i] = 0;
+				continue;
+			}
+			inferSbDcSigCoeffFlag = 1;
+		}
+		csbf[yS] |= (uint16_t)(1 << xS);
+
+		/* sig_coeff_flag */
+		int sig = 0;
+		{
+			const uint8_t *sigCtx = residual_sig_ctx_scan[scanIdx][log2TrafoSize == 2 ? 4 : prevCsbf];
+			uint8_t *ctxSb = ctx + ((i && !cIdx && log2TrafoSize > 2) ? 3 : 0);
+
+			int n = 15;
+			if (i == lastSubBlock)
+			{
+				sig = 1 << lastScanPos;
+				n = lastScanPos - 1;
+			}
+			for (; n > 0; --n)
+			{
+				sig |= cabac_decode_bin(decoder, &ctxSb[sigCtx[n]]) << n;
+			}
+
+			if (n == 0)
+			{
+				if (inferSbDcSigCoeffFlag && !sig) sig = 1;
+				else sig |= cabac_decode_bin(decoder, i ? &ctxSb[sigCtx[0]] : ctxSig);
+			}
+		}
+		block.sig[i] = (uint16_t)sig;
+
+		memset(level, 0, 16 * sizeof(int16_t));
+		if (!sig) continue;
+
+		int absLevel[16];
+		int position[16];
+		int numSigCoeff = 0;
+		for (int n = 15; n >= 0; --n)
+		{
+			if ((sig >> n) & 1) position[numSigCoeff++] = n;
+		}
+		const int lastSigScanPos = position[0];
+		const int firstSigScanPos = position[numSigCoeff - 1];
+
+		/* coeff_abs_level_greater1_flag and coeff_abs_level_greater2_flag */
+		int ctxSet = (i == 0 || cIdx) ? 0 : 2;
+		if (c1 == 0) ++ctxSet;
+		c1 = 1;
+
+		int firstGreater1 = -1;
+		const int numGreater1Flag = numSigCoeff < 8 ? numSigCoeff : 8;
+		for (int k = 0; k < numGreater1Flag; ++k)
+		{
+			const int greater1 = cabac_decode_bin(decoder, &ctxGreater1[4 * ctxSet + c1]);
+			absLevel[k] = 1 + greater1;
+			if (greater1)
+			{
+				c1 = 0;
+				if (firstGreater1 < 0) firstGreater1 = k;
+			}
+			else if (c1 > 0 && c1 < 3)
+			{
+				++c1;
+			}
+		}
+		for (int k = numGreater1Flag; k < numSigCoeff; ++k) absLevel[k] = 1;
+
+		if (firstGreater1 >= 0)
+		{
+			absLevel[firstGreater1] += cabac_decode_bin(decoder, &ctxGreater2[ctxSet]);
+		}
+
+		/* coeff_sign_flag: the sign at firstSigScanPos is the last bin and is absent when hidden */
+		const int signHidden = sign_hiding && lastSigScanPos - firstSigScanPos > 3;
+		const uint32_t signs = cabac_decode_bypass(decoder, numSigCoeff - signHidden) << signHidden;
+
+		/* coeff_abs_level_remaining: present where all flags coded so far were set */
+		int cRiceParam = 0;
+		int sumAbsLevel = 0;
+		for (int k = 0; k < numSigCoeff; ++k)
+		{
+			const int baseLevel = k < 8 ? (k == firstGreater1 ? 3 : 2) : 1;
+			if (absLevel[k] == baseLevel)
+			{
+				const int remaining = read_coeff_abs_level_remaining(decoder, cRiceParam);
+				if (remaining < 0 || baseLevel + remaining > 32768) return 1;
+				absLevel[k] = baseLevel + remaining;
+				if (absLevel[k] > (3 << cRiceParam) && cRiceParam < 4) ++cRiceParam;
+			}
+			sumAbsLevel += absLevel[k];
+		}
+
+		for (int k = 0; k < numSigCoeff; ++k)
+		{
+			int negative = (signs >> (numSigCoeff - 1 - k)) & 1;
+			if (signHidden && k == numSigCoeff - 1) negative = sumAbsLevel & 1;
+			/* a positive 32768 is out of range for int16_t: clip it as HM does rather than let it wrap */
+			level[position[k]] = (int16_t)(negative ? -absLevel[k] : (absLevel[k] > 32767 ? 32767 : absLevel[k]));
+		}
+	}
+
+	(*hevcasm_static_get_residual_unscan(table))(coeffs, &block, log2TrafoSize, scanIdx);
+
+	return 0;
+}
+
+
+/* Rate estimation */
+
+/*
+Cost in 1/4096 bit of a bin, indexed by ((pStateIdx << 1) | valMps) ^ binVal: -log2 of the probability of the MPS or
+LPS given by rangeTabLps averaged over qRangeIdx.
+*/
+static const int16_t residual_rate_bits[128] =
+{
+	3934, 4262, 3711, 4508, 3514, 4742, 3291, 5028, 3065, 5346, 2870, 5644, 2679, 5963, 2513, 6264,
+	2362, 6561, 2214, 6873, 2070, 7203, 1951, 7496, 1835, 7804, 1725, 8116, 1628, 8414, 1533, 8724,
+	1438, 9054, 1360, 9348, 1284, 9653, 1207, 9978, 1147, 10251, 1078, 10587, 1023, 10868, 963, 11198,
+	908, 11514, 860, 11813, 815, 12110, 771, 12417, 727, 12741, 693, 13005, 650, 13363, 620, 13626,
+	582, 13988, 552, 14281, 522, 14600, 493, 14926, 472, 15168, 448, 15470, 423, 15797, 398, 16134,
+	381, 16384, 361, 16697, 340, 17035, 320, 17385, 303, 17696, 292, 17916, 275, 18257, 259, 18618,
+	247, 18876, 235, 19170, 224, 19455, 211, 19798, 204, 19990, 188, 20480, 181, 20696, 171, 21014,
+	160, 21406, 152, 21721, 148, 21863, 141, 22165, 132, 22547, 124, 22886, 117, 23214, 32, 30854,
+};
+
+
+/* index of the sig_coeff_flag lanes of a block size, component and scan: 32x32 shares the contexts of 16x16 */
+static int residual_rate_sig_set(int log2TrafoSize, int cIdx, int scanIdx)
+{
+	if (log2TrafoSize == 2) return (cIdx ? 7 : 0) + scanIdx;
+	if (log2TrafoSize == 3) return (cIdx ? 10 : 3) + scanIdx;
+	return cIdx ? 13 : 6;
+}
+
+
+static void init_rate(int16_t (*rate)[2], const uint8_t *contexts, int n)
+{
+	for (int i = 0; i < n; ++i)
+	{
+		rate[i][0] = residual_rate_bits[contexts[i]];
+		rate[i][1] = residual_rate_bits[contexts[i] ^ 1];
+	}
+}
+
+
+void HEVCASM_API hevcasm_init_residual_rate(hevcasm_residual_rate *rate, const hevcasm_residual_contexts *contexts)
+{
+	for (int cIdx = 0; cIdx < 2; ++cIdx)
+	{
+		for (int log2TrafoSize = 2; log2TrafoSize <= 4; ++log2TrafoSize)
+		{
+			for (int scanIdx = 0; scanIdx < (log2TrafoSize < 4 ? 3 : 1); ++scanIdx)
+			{
+				const uint8_t *ctxSig = contexts->sig_coeff_flag + (cIdx ? 27 : 0);
+				const int ctxOffset = cIdx ? (log2TrafoSize == 3 ? 9 : 12) : (log2TrafoSize == 3 ? (scanIdx == 0 ? 9 : 15) : 21);
+
+				for (int pattern = 0; pattern < 8; ++pattern)
+				{
+					const int first = pattern >> 2;
+					const uint8_t *sigCtx = residual_sig_ctx_scan[scanIdx][log2TrafoSize == 2 ? 4 : pattern & 3];
+					int16_t *lanes = rate->sig_coeff_flag[residual_rate_sig_set(log2TrafoSize, cIdx, scanIdx)][pattern];
+
+					for (int n = 0; n < 16; ++n)
+					{
+						int ctxInc = sigCtx[n];
+						if (log2TrafoSize > 2)
+						{
+							ctxInc += ctxOffset + ((first || cIdx) ? 0 : 3);
+							if (first && n == 0) ctxInc = 0;
+						}
+						lanes[n] = residual_rate_bits[ctxSig[ctxInc]];
+						lanes[16 + n] = residual_rate_bits[ctxSig[ctxInc] ^ 1];
+					}
+				}
+			}
+		}
+	}
+
+	init_rate(rate->coded_sub_block_flag, contexts->coded_sub_block_flag, 4);
+	init_rate(rate->last_sig_coeff_x_prefix, contexts->last_sig_coeff_x_prefix, 18);
+	init_rate(rate->last_sig_coeff_y_prefix, contexts->last_sig_coeff_y_prefix, 18);
+	init_rate(rate->coeff_abs_level_greater1_flag, contexts->coeff_abs_level_greater1_flag, 24);
+	init_rate(rate->coeff_abs_level_greater2_flag, contexts->coeff_abs_level_greater2_flag, 6);
+}
+
+
+static int32_t hevcasm_residual_rate_sub_blocks_c_ref(uint16_t *greater, const hevcasm_residual_block *block, const uint16_t *coded, const uint8_t *pattern, const int16_t *cost, int n)
+{
+	int32_t rate = 0;
+	for (int i = 0; i < n; ++i)
+	{
+		const int16_t *lanes = cost + 32 * pattern[i];
+		int greater1 = 0;
+		int greater2 = 0;
+		for (int k = 0; k < 16; ++k)
+		{
+			const int level = block->level[16 * i + k];
+			const int absLevel = level < 0 ? -level : level;
+			if ((coded[i] >> k) & 1) rate += lanes[(level ? 16 : 0) + k];
+			greater1 |= (absLevel > 1) << k;
+			greater2 |= (absLevel > 2) << k;
+		}
+		greater[2 * i] = (uint16_t)greater1;
+		greater[2 * i + 1] = (uint16_t)greater2;
+	}
+	return rate;
+}
+
+
+void HEVCASM_API hevcasm_populate_residual_rate_sub_blocks(hevcasm_table_residual_rate_sub_blocks *table, hevcasm_instruction_set mask)
+{
+	*hevcasm_get_residual_rate_sub_blocks(table) = 0;
+
+	if (mask & (HEVCASM_C_REF | HEVCASM_C_OPT))
+	{
+		*hevcasm_get_residual_rate_sub_blocks(table) = hevcasm_residual_rate_sub_blocks_c_ref;
+	}
+
+#ifdef HEVCASM_X64
+	if (mask & HEVCASM_SSSE3)
+	{
+		*hevcasm_get_residual_rate_sub_blocks(table) = hevcasm_residual_rate_sub_blocks_ssse3;
+	}
+#endif
+}
+
+
+static int residual_popcount(unsigned x)
+{
+	x = x - ((x >> 1) & 0x5555);
+	x = (x & 0x3333) + ((x >> 2) & 0x3333);
+	x = (x + (x >> 4)) & 0x0f0f;
+	return (x + (x >> 8)) & 0x1f;
+}
+
+
+static int residual_msb(uint32_t x)
+{
+	int n = 0;
+	if (x & 0xffff0000) { n += 16; x >>= 16; }
+	if (x & 0xff00) { n += 8; x >>= 8; }
+	if (x & 0xf0) { n += 4; x >>= 4; }
+	if (x & 0xc) { n += 2; x >>= 2; }
+	return n + (int)(x >> 1);
+}
+
+
+static int32_t rate_last_sig_coeff_prefix(const int16_t (*rate)[2], int position, int log2TrafoSize, int cIdx)
+{
+	const int ctxOffset = cIdx ? 15 : 3 * (log2TrafoSize - 2) + ((log2TrafoSize - 1) >> 2);
+	const int ctxShift = cIdx ? log2TrafoSize - 2 : (log2TrafoSize + 1) >> 2;
+	const int cMax = (log2TrafoSize << 1) - 1;
+	const int prefix = residual_group_idx[position];
+
+	int32_t cost = 0;
+	for (int i = 0; i < prefix; ++i)
+	{
+		cost += rate[ctxOffset + (i >> ctxShift)][1];
+	}
+	if (prefix < cMax)
+	{
+		cost += rate[ctxOffset + (prefix >> ctxShift)][0];
+	}
+	if (prefix > 3)
+	{
+		cost += ((prefix >> 1) - 1) << 12;
+	}
+	return cost;
+}
+
+
+/* cost of n coeff_abs_level_greater1_flag bins equal to zero, greater1Ctx being 1, 2, 3, 3... */
+static int32_t rate_greater1_zeros(const int16_t (*rate)[2], int n)
+{
+	int32_t cost = 0;
+	if (n > 0) cost += rate[1][0];
+	if (n > 1) cost += rate[2][0];
+	if (n > 2) cost += (n - 2) * rate[3][0];
+	return cost;
+}
+
+
+static int32_t rate_coeff_abs_level_remaining(int symbol, int cRiceParam)
+{
+	if (symbol < (3 << cRiceParam))
+	{
+		return ((symbol >> cRiceParam) + 1 + cRiceParam) << 12;
+	}
+	const int k = residual_msb(symbol - (3 << cRiceParam) + (1 << cRiceParam));
+	return (4 + 2 * k - cRiceParam) << 12;
+}
+
+
+/*
+Significance flag costs come from the vectorised sub-block function. The greater1 flags of a sub-block are costed
+from bit masks: greater1Ctx counts flags up to the first set one, after which it is zero. Only the Rice-coded
+remainders, present for few levels, are visited one at a time.
+*/
+int32_t HEVCASM_API hevcasm_residual_rate_estimate(hevcasm_table_residual_scan *scan, hevcasm_table_residual_rate_sub_blocks *table, const hevcasm_residual_rate *rate, const int16_t *coeffs, int log2TrafoSize, int cIdx, int scanIdx, int sign_hiding)
+{
+	const uint8_t *scanSb = residual_scan_sub_block(log2TrafoSize, scanIdx);
+	const uint8_t *scanPos = residual_scan_4x4[scanIdx];
+
+	hevcasm_residual_block block;
+	(*hevcasm_static_get_residual_scan(scan))(&block, coeffs, log2TrafoSize, scanIdx);
+
+	int lastSubBlock = (1 << (2 * (log2TrafoSize - 2))) - 1;
+	while (lastSubBlock >= 0 && !block.sig[lastSubBlock]) --lastSubBlock;
+	if (lastSubBlock < 0) return 0;
+
+	const int lastScanPos = residual_msb(block.sig[lastSubBlock]);
+
+	int32_t cost;
+	{
+		int x = ((scanSb[lastSubBlock] & 15) << 2) + (scanPos[lastScanPos] & 3);
+		int y = ((scanSb[lastSubBlock] >> 4) << 2) + (scanPos[lastScanPos] >> 2);
+		if (scanIdx == 2)
+		{
+			const int t = x;
+			x = y;
+			y = t;
+		}
+		cost = rate_last_sig_coeff_prefix(rate->last_sig_coeff_x_prefix, x, log2TrafoSize, cIdx);
+		cost += rate_last_sig_coeff_prefix(rate->last_sig_coeff_y_prefix, y, log2TrafoSize, cIdx);
+	}
+
+	/* coded_sub_block_flag, and the scan positions whose sig_coeff_flag is coded */
+	uint16_t coded[64];
+	uint8_t pattern[64];
+	{
+		const int16_t (*rateCsbf)[2] = rate->coded_sub_block_flag + (cIdx ? 2 : 0);
+		uint16_t csbf[9] = { 0 };
+
+		for (int i = lastSubBlock; i >= 0; --i)
+		{
+			const int xS = scanSb[i] & 15;
+			const int yS = scanSb[i] >> 4;
+			const int sig = block.sig[i];
+			const int prevCsbf = ((csbf[yS] >> (xS + 1)) & 1) | (((csbf[yS + 1] >> xS) & 1) << 1);
+
+			pattern[i] = (uint8_t)((i ? 0 : 4) + prevCsbf);
+			coded[i] = 0xffff;
+			if (i == lastSubBlock)
+			{
+				coded[i] = (uint16_t)((1 << lastScanPos) - 1);
+			}
+			else if (i > 0)
+			{
+				cost += rateCsbf[prevCsbf != 0][sig != 0];
+				if (!sig) coded[i] = 0;
+				else if (!(sig & 0xfffe)) coded[i] = 0xfffe;
+			}
+			csbf[yS] |= (uint16_t)((sig != 0) << xS);
+		}
+	}
+
+	uint16_t greater[128];
+	cost += (*hevcasm_static_get_residual_rate_sub_blocks(table))(greater, &block, coded, pattern, rate->sig_coeff_flag[residual_rate_sig_set(log2TrafoSize, cIdx, scanIdx)][0], lastSubBlock + 1);
+
+	/* greater1Ctx of the previous sub-block with levels ended at zero */
+	int previousGreater1 = 0;
+
+	for (int i = lastSubBlock; i >= 0; --i)
+	{
+		const int sig = block.sig[i];
+		if (!sig) continue;
+
+		const int numSigCoeff = residual_popcount(sig);
+
+		/* coeff_sign_flag */
+		const int signHidden = sign_hiding && residual_msb(sig) - residual_msb(sig & -sig) > 3;
+		cost += (numSigCoeff - signHidden) << 12;
+
+		/* the first eight levels in reverse scan order have coeff_abs_level_greater1_flag */
+		int flagged = sig;
+		for (int k = numSigCoeff; k > 8; --k) flagged &= flagged - 1;
+
+		int ctxSet = (i == 0 || cIdx) ? 0 : 2;
+		if (previousGreater1) ++ctxSet;
+		const int16_t (*rateGreater1)[2] = rate->coeff_abs_level_greater1_flag + (cIdx ? 16 : 0) + 4 * ctxSet;
+
+		const int greater1 = greater[2 * i] & flagged;
+		previousGreater1 = greater1 != 0;
+
+		int remaining = sig & ~flagged;
+		int firstGreater1 = -1;
+		if (!greater1)
+		{
+			cost += rate_greater1_zeros(rateGreater1, residual_popcount(flagged));
+		}
+		else
+		{
+			firstGreater1 = residual_msb(greater1);
+			const int before = residual_popcount(flagged >> firstGreater1) - 1;
+			cost += rate_greater1_zeros(rateGreater1, before) + rateGreater1[before < 2 ? before + 1 : 3][1];
+
+			const int after = residual_popcount(flagged & ((1 << firstGreater1) - 1));
+			const int ones = residual_popcount(greater1) - 1;
+			cost += ones * rateGreater1[0][1] + (after - ones) * rateGreater1[0][0];
+
+			/* coeff_abs_level_greater2_flag */
+			const int greater2 = (greater[2 * i + 1] >> firstGreater1) & 1;
+			cost += rate->coeff_abs_level_greater2_flag[(cIdx ? 4 : 0) + ctxSet][greater2];
+
+			remaining |= (greater1 & ~(1 << firstGreater1)) | (greater2 << firstGreater1);
+		}
+
+		/* coeff_abs_level_remaining in reverse scan order, adapting the Rice parameter */
+		int cRiceParam = 0;
+		while (remaining)
+		{
+			const int n = residual_msb(remaining);
+			remaining ^= 1 << n;
+
+			const int level = block.level[16 * i + n];
+			const int absLevel = level < 0 ? -level : level;
+			const int baseLevel = ((flagged >> n) & 1) ? (n == firstGreater1 ? 3 : 2) : 1;
+			cost += rate_coeff_abs_level_remaining(absLevel - baseLevel, cRiceParam);
+			if (absLevel > (3 << cRiceParam) && cRiceParam < 4) ++cRiceParam;
+		}
+	}
+
+	return cost;
+}
+
+
+typedef struct
+{
+	hevcasm_residual_block block;
+	hevcasm_residual_rate rate;
+	uint16_t coded[64];
+	uint8_t pattern[64];
+	int n;
+	hevcasm_residual_rate_sub_blocks *f;
+	uint16_t greater[128];
+	int32_t cost;
+}
+bound_residual_rate_sub_blocks;
+
+
+int init_residual_rate_sub_blocks(void *p, hevcasm_instruction_set mask)
+{
+	bound_residual_rate_sub_blocks *s = p;
+	hevcasm_table_residual_rate_sub_blocks table;
+	hevcasm_populate_residual_rate_sub_blocks(&table, mask);
+	hevcasm_residual_rate_sub_blocks **entry = hevcasm_get_residual_rate_sub_blocks(&table);
+	hevcasm_test_report_kernel(&table, sizeof(table), entry);
+	s->f = *entry;
+	if (s->f && mask == HEVCASM_C_REF)
+	{
+		hevcasm_test_printf("\t%d sub-blocks : ", s->n);
+	}
+	return !!s->f;
+}
+
+
+void invoke_residual_rate_sub_blocks(void *p, int n)
+{
+	bound_residual_rate_sub_blocks *s = p;
+	while (n--)
+	{
+		s->cost = s->f(s->greater, &s->block, s->coded, s->pattern, s->rate.sig_coeff_flag[6][0], s->n);
+	}
+}
+
+
+int mismatch_residual_rate_sub_blocks(void *boundRef, void *boundTest)
+{
+	bound_residual_rate_sub_blocks *ref = boundRef;
+	bound_residual_rate_sub_blocks *test = boundTest;
+
+	return ref->cost != test->cost || memcmp(ref->greater, test->greater, 2 * ref->n * sizeof(uint16_t));
+}
+
+
+void HEVCASM_API hevcasm_test_residual_rate_sub_blocks(int *error_count, hevcasm_instruction_set mask)
+{
+	hevcasm_test_printf("\nhevcasm_residual_rate_sub_blocks - significance map rate and level masks\n");
+
+	hevcasm_residual_contexts contexts;
+	hevcasm_init_residual_contexts(&contexts, 1, 32);
+
+	bound_residual_rate_sub_blocks b[2];
+	hevcasm_init_residual_rate(&b[0].rate, &contexts);
+
+	for (b[0].n = 1; b[0].n <= 64; b[0].n *= 4)
+	{
+		int16_t levels[32 * 32];
+		const int log2TrafoSize = b[0].n == 1 ? 2 : b[0].n == 4 ? 3 : b[0].n == 16 ? 4 : 5;
+		residual_test_levels(levels, log2TrafoSize, 8.0);
+		hevcasm_residual_scan_c_ref(&b[0].block, levels, log2TrafoSize, 0);
+
+		for (int i = 0; i < b[0].n; ++i)
+		{
+			b[0].coded[i] = (uint16_t)(hevcasm_test_rand() ^ (hevcasm_test_rand() << 8));
+			b[0].pattern[i] = (uint8_t)(hevcasm_test_rand() & 7);
+		}
+
+		b[1] = b[0];
+		*error_count += hevcasm_test(&b[0], &b[1], init_residual_rate_sub_blocks, invoke_residual_rate_sub_blocks, mismatch_residual_rate_sub_blocks, mask, 100000);
+	}
+}
+
+
+/* Arithmetic encoder as specified (9.3.4.3), one bin and one bit at a time */
+typedef struct
+{
+	uint32_t low;
+	uint32_t range;
+	int first_bit_flag;
+	int bits_outstanding;
+	uint8_t *buffer;
+	size_t size;
+	size_t bits;
+	int bins;
+	/* when set, rate accumulates the estimated cost of each bin given the states of the same contexts in snapshot */
+	const uint8_t *snapshot;
+	const uint8_t *contexts;
+	int32_t rate;
+}
+cabac_reference_encoder;
+
+
+static void cabac_reference_write_bit(cabac_reference_encoder *e, int b)
+{
+	if (e->bits < 8 * e->size) e->buffer[e->bits >> 3] |= (uint8_t)(b << (7 - (e->bits & 7)));
+	++e->bits;
+}
+
+
+static void cabac_reference_put_bit(cabac_reference_encoder *e, int b)
+{
+	if (e->first_bit_flag)
+	{
+		e->first_bit_flag = 0;
+	}
+	else
+	{
+		cabac_reference_write_bit(e, b);
+	}
+
+	while (e->bits_outstanding > 0)
+	{
+		cabac_reference_write_bit(e, 1 - b);
+		--e->bits_outstanding;
+	}
+}
+
+
+static void cabac_reference_renorm(cabac_reference_encoder *e)
+{
+	while (e->range < 256)
+	{
+		if (e->low < 256)
+		{
+			cabac_reference_put_bit(e, 0);
+		}
+		else if (e->low >= 512)
+		{
+			e->low -= 512;
+			cabac_reference_put_bit(e, 1);
+		}
+		else
+		{
+			e->low -= 256;
+			++e->bits_outstanding;
+		}
+		e->range <<= 1;
+		e->low <<= 1;
+	}
+}
+
+
+static void cabac_reference_init(cabac_reference_encoder *e, uint8_t *buffer, size_t size)
+{
+	e->low = 0;
+	e->range = 510;
+	e->first_bit_flag = 1;
+	e->bits_outstanding = 0;
+	e->buffer = buffer;
+	e->size = size;
+	e->bits = 0;
+	e->bins = 0;
+	e->snapshot = 0;
+	e->rate = 0;
+	memset(buffer, 0, size);
+}
+
+
+static void cabac_reference_decision(cabac_reference_encoder *e, uint8_t *context, int binVal)
+{
+	static const uint8_t transIdxLps[64] =
+	{
+		0, 0, 1, 2, 2, 4, 4, 5, 6, 7, 8, 9, 9, 11, 11, 12, 13, 13, 15, 15, 16, 16, 18, 18, 19, 19, 21, 21, 22, 22, 23, 24,
+		24, 25, 26, 26, 27, 27, 28, 29, 29, 30, 30, 30, 31, 32, 32, 33, 33, 33, 34, 34, 35, 35, 35, 36, 36, 36, 37, 37, 37, 38, 38, 63
+	};
+
+	if (e->snapshot) e->rate += residual_rate_bits[e->snapshot[context - e->contexts] ^ binVal];
+
+	int pStateIdx = *context >> 1;
+	int valMps = *context & 1;
+
+	const uint32_t rLps = cabac_range_lps[pStateIdx][(e->range >> 6) & 3];
+	e->range -= rLps;
+	if (binVal != valMps)
+	{
+		e->low += e->range;
+		e->range = rLps;
+		if (pStateIdx == 0) valMps = 1 - valMps;
+		pStateIdx = transIdxLps[pStateIdx];
+	}
+	else if (pStateIdx < 62)
+	{
+		++pStateIdx;
+	}
+	*context = (uint8_t)((pStateIdx << 1) | valMps);
+
+	cabac_reference_renorm(e);
+	++e->bins;
+}
+
+
+static void cabac_reference_bypass(cabac_reference_encoder *e, int binVal)
+{
+	e->rate += 1 << 12;
+
+	e->low <<= 1;
+	if (binVal) e->low += e->range;
+
+	if (e->low >= 1024)
+	{
+		cabac_reference_put_bit(e, 1);
+		e->low -= 1024;
+	}
+	else if (e->low < 512)
+	{
+		cabac_reference_put_bit(e, 0);
+	}
+	else
+	{
+		e->low -= 512;
+		++e->bits_outstanding;
+	}
+	++e->bins;
+}
+
+
+/* end_of_slice_segment_flag equal to 1, EncodeFlush and byte alignment: returns the number of bytes written */
+static size_t cabac_reference_finish(cabac_reference_encoder *e)
+{
+	e->range -= 2;
+	e->low += e->range;
+	e->range = 2;
+	cabac_reference_renorm(e);
+	cabac_reference_put_bit(e, (e->low >> 9) & 1);
+	cabac_reference_write_bit(e, (e->low >> 8) & 1);
+	cabac_reference_write_bit(e, 1);
+	++e->bins;
+	return (e->bits + 7) >> 3;
+}
+
+
+/* (x, y) of each position of a scan of a blkSize x blkSize array (6.5.3 to 6.5.5) */
+static void residual_reference_scan(uint8_t (*scan)[2], int blkSize, int scanIdx)
+{
+	int i = 0;
+	if (scanIdx == 0)
+	{
+		int x = 0;
+		int y = 0;
+		while (i < blkSize * blkSize)
+		{
+			while (y >= 0)
+			{
+				if (x < blkSize && y < blkSize)
+				{
+					scan[i][0] = (uint8_t)x;
+					scan[i][1] = (uint8_t)y;
+					++i;
+				}
+				--y;
+				++x;
+			}
+			y = x;
+			x = 0;
+		}
+	}
+	else
+	{
+		for (int a = 0; a < blkSize; ++a)
+		{
+			for (int b = 0; b < blkSize; ++b)
+			{
+				scan[i][0] = (uint8_t)(scanIdx == 1 ? b : a);
+				scan[i][1] = (uint8_t)(scanIdx == 1 ? a : b);
+				++i;
+			}
+		}
+	}
+}
+
+
+/* smallest LastSignificantCoeffX or LastSignificantCoeffY with the given prefix */
+static int last_sig_coeff_prefix_min(int prefix)
+{
+	return prefix < 4 ? prefix : (1 << ((prefix >> 1) - 1)) * (2 + (prefix & 1));
+}
+
+
+/* residual_coding() (7.3.8.11) from raster levels following the syntax table and the binarizations of 9.3.3 */
+static void residual_coding_reference(cabac_reference_encoder *e, hevcasm_residual_contexts *contexts, const int16_t *levels, int log2TrafoSize, int cIdx, int scanIdx, int sign_hiding)
+{
+	const int nCbS = 1 << log2TrafoSize;
+	const int log2SbSize = log2TrafoSize - 2;
+	const int sbWidth = 1 << log2SbSize;
+
+	uint8_t scanSb[64][2];
+	uint8_t scanPos[16][2];
+	residual_reference_scan(scanSb, sbWidth, log2TrafoSize == 3 ? scanIdx : 0);
+	residual_reference_scan(scanPos, 4, scanIdx);
+
+#define LEVEL(i, n) levels[((scanSb[i][1] << 2) + scanPos[n][1]) * nCbS + (scanSb[i][0] << 2) + scanPos[n][0]]
+
+	int lastSubBlock = (1 << (2 * log2SbSize)) - 1;
+	int lastScanPos = 16;
+	do
+	{
+		if (lastScanPos == 0)
+		{
+			lastScanPos = 16;
+			--lastSubBlock;
+		}
+		--lastScanPos;
+	}
+	while (!LEVEL(lastSubBlock, lastScanPos));
+
+	int LastSignificantCoeffX = (scanSb[lastSubBlock][0] << 2) + scanPos[lastScanPos][0];
+	int LastSignificantCoeffY = (scanSb[lastSubBlock][1] << 2) + scanPos[lastScanPos][1];
+	if (scanIdx == 2)
+	{
+		const int t = LastSignificantCoeffX;
+		LastSignificantCoeffX = LastSignificantCoeffY;
+		LastSignificantCoeffY = t;
+	}
+
+	{
+		int prefix[2];
+		int position[2] = { LastSignificantCoeffX, LastSignificantCoeffY };
+		uint8_t *ctx[2] = { contexts->last_sig_coeff_x_prefix, contexts->last_sig_coeff_y_prefix };
+		const int ctxOffset = cIdx ? 15 : 3 * (log2TrafoSize - 2) + ((log2TrafoSize - 1) >> 2);
+		const int ctxShift = cIdx ? log2TrafoSize - 2 : (log2TrafoSize + 1) >> 2;
+		const int cMax = (log2TrafoSize << 1) - 1;
+
+		for (int j = 0; j < 2; ++j)
+		{
+			prefix[j] = 0;
+			while (prefix[j] < 9 && position[j] >= last_sig_coeff_prefix_min(prefix[j] + 1)) ++prefix[j];
+			for (int k = 0; k < prefix[j]; ++k) cabac_reference_decision(e, &ctx[j][ctxOffset + (k >> ctxShift)], 1);
+			if (prefix[j] < cMax) cabac_reference_decision(e, &ctx[j][ctxOffset + (prefix[j] >> ctxShift)], 0);
+		}
+		for (int j = 0; j < 2; ++j)
+		{
+			if (prefix[j] > 3)
+			{
+				const int length = (prefix[j] >> 1) - 1;
+				const int suffix = position[j] - (1 << length) * (2 + (prefix[j] & 1));
+				for (int k = length - 1; k >= 0; --k) cabac_reference_bypass(e, (suffix >> k) & 1);
+			}
+		}
+	}
+
+	uint8_t coded_sub_block_flag[8][8] = { { 0 } };
+	int previousGreater1Ctx = -1;
+	int previousGreater1Flag = 0;
+
+	for (int i = lastSubBlock; i >= 0; --i)
+	{
+		const int xS = scanSb[i][0];
+		const int yS = scanSb[i][1];
+		int inferSbDcSigCoeffFlag = 0;
+
+		int csbfCtx = 0;
+		if (xS < sbWidth - 1) csbfCtx += coded_sub_block_flag[xS + 1][yS];
+		if (yS < sbWidth - 1) csbfCtx += coded_sub_block_flag[xS][yS + 1];
+
+		if (i < lastSubBlock && i > 0)
+		{
+			int flag = 0;
+			for (int n = 0; n < 16; ++n) flag |= LEVEL(i, n) != 0;
+			cabac_reference_decision(e, &contexts->coded_sub_block_flag[(csbfCtx < 1 ? csbfCtx : 1) + (cIdx ? 2 : 0)], flag);
+			coded_sub_block_flag[xS][yS] = (uint8_t)flag;
+			inferSbDcSigCoeffFlag = 1;
+		}
+		else
+		{
+			coded_sub_block_flag[xS][yS] = 1;
+		}
+
+		int sig_coeff_flag[16] = { 0 };
+		for (int n = (i == lastSubBlock) ? lastScanPos - 1 : 15; n >= 0; --n)
+		{
+			const int xC = (xS << 2) + scanPos[n][0];
+			const int yC = (yS << 2) + scanPos[n][1];
+			if (coded_sub_block_flag[xS][yS] && (n > 0 || !inferSbDcSigCoeffFlag))
+			{
+				static const uint8_t ctxIdxMap[16] = { 0, 1, 4, 5, 2, 3, 4, 5, 6, 6, 8, 8, 7, 7, 8, 8 };
+				int sigCtx;
+				if (log2TrafoSize == 2)
+				{
+					sigCtx = ctxIdxMap[(yC << 2) + xC];
+				}
+				else if (xC + yC == 0)
+				{
+					sigCtx = 0;
+				}
+				else
+				{
+					const int xP = xC & 3;
+					const int yP = yC & 3;
+					const int prevCsbf = ((xS < sbWidth - 1) ? coded_sub_block_flag[xS + 1][yS] : 0) + (((yS < sbWidth - 1) ? coded_sub_block_flag[xS][yS + 1] : 0) << 1);
+					if (prevCsbf == 0) sigCtx = (xP + yP == 0) ? 2 : (xP + yP < 3) ? 1 : 0;
+					else if (prevCsbf == 1) sigCtx = (yP == 0) ? 2 : (yP == 1) ? 1 : 0;
+					else if (prevCsbf == 2) sigCtx = (xP == 0) ? 2 : (xP == 1) ? 1 : 0;
+					else sigCtx = 2;
+					if (cIdx == 0)
+					{
+						if (xS + yS > 0) sigCtx += 3;
+						sigCtx += (log2TrafoSize == 3) ? (scanIdx == 0 ? 9 : 15) : 21;
+					}
+					else
+					{
+						sigCtx += (log2TrafoSize == 3) ? 9 : 12;
+					}
+				}
+
+				sig_coeff_flag[n] = LEVEL(i, n) != 0;
+				cabac_reference_decision(e, &contexts->sig_coeff_flag[cIdx ? 27 + sigCtx : sigCtx], sig_coeff_flag[n]);
+				if (sig_coeff_flag[n]) inferSbDcSigCoeffFlag = 0;
+			}
+			else
+			{
+				sig_coeff_flag[n] = (n == 0 && inferSbDcSigCoeffFlag && coded_sub_block_flag[xS][yS]) || (i == lastSubBlock && n == lastScanPos);
+			}
+		}
+		if (i == lastSubBlock) sig_coeff_flag[lastScanPos] = 1;
+
+		int firstSigScanPos = 16;
+		int lastSigScanPos = -1;
+		int numGreater1Flag = 0;
+		int lastGreater1ScanPos = -1;
+		int greater1_flag[16] = { 0 };
+		int greater2_flag[16] = { 0 };
+		int ctxSet = 0;
+		int greater1Ctx = 1;
+		for (int n = 15; n >= 0; --n)
+		{
+			if (!sig_coeff_flag[n]) continue;
+
+			const int absLevel = abs(LEVEL(i, n));
+			if (numGreater1Flag < 8)
+			{
+				if (numGreater1Flag == 0)
+				{
+					ctxSet = (i == 0 || cIdx > 0) ? 0 : 2;
+					int lastGreater1Ctx = previousGreater1Ctx < 0 ? 1 : previousGreater1Ctx;
+					if (lastGreater1Ctx > 0 && previousGreater1Ctx >= 0 && previousGreater1Flag) lastGreater1Ctx = 0;
+					if (lastGreater1Ctx == 0) ++ctxSet;
+					greater1Ctx = 1;
+				}
+				else if (greater1Ctx > 0)
+				{
+					greater1Ctx = previousGreater1Flag ? 0 : greater1Ctx + 1;
+				}
+
+				greater1_flag[n] = absLevel > 1;
+				cabac_reference_decision(e, &contexts->coeff_abs_level_greater1_flag[ctxSet * 4 + (greater1Ctx < 3 ? greater1Ctx : 3) + (cIdx ? 16 : 0)], greater1_flag[n]);
+				previousGreater1Ctx = greater1Ctx;
+				previousGreater1Flag = greater1_flag[n];
+
+				++numGreater1Flag;
+				if (greater1_flag[n] && lastGreater1ScanPos == -1) lastGreater1ScanPos = n;
+			}
+			if (lastSigScanPos == -1) lastSigScanPos = n;
+			firstSigScanPos = n;
+		}
+
+		const int signHidden = sign_hiding && lastSigScanPos - firstSigScanPos > 3;
+
+		if (lastGreater1ScanPos != -1)
+		{
+			greater2_flag[lastGreater1ScanPos] = abs(LEVEL(i, lastGreater1ScanPos)) > 2;
+			cabac_reference_decision(e, &contexts->coeff_abs_level_greater2_flag[ctxSet + (cIdx ? 4 : 0)], greater2_flag[lastGreater1ScanPos]);
+		}
+
+		for (int n = 15; n >= 0; --n)
+		{
+			if (sig_coeff_flag[n] && (!signHidden || n != firstSigScanPos))
+			{
+				cabac_reference_bypass(e, LEVEL(i, n) < 0);
+			}
+		}
+
+		int numSigCoeff = 0;
+		int cLastAbsLevel = 0;
+		int cLastRiceParam = 0;
+		for (int n = 15; n >= 0; --n)
+		{
+			if (!sig_coeff_flag[n]) continue;
+
+			const int baseLevel = 1 + greater1_flag[n] + greater2_flag[n];
+			if (baseLevel == ((numSigCoeff < 8) ? ((n == lastGreater1ScanPos) ? 3 : 2) : 1))
+			{
+				int cRiceParam = cLastRiceParam + (cLastAbsLevel > 3 * (1 << cLastRiceParam));
+				if (cRiceParam > 4) cRiceParam = 4;
+
+				const int value = abs(LEVEL(i, n)) - baseLevel;
+				const int cMax = 4 << cRiceParam;
+				const int prefixVal = value < cMax ? value : cMax;
+
+				/* prefix: TR with cMax 4 << cRiceParam */
+				for (int k = 0; k < prefixVal >> cRiceParam; ++k) cabac_reference_bypass(e, 1);
+				if (prefixVal < cMax)
+				{
+					cabac_reference_bypass(e, 0);
+					for (int k = cRiceParam - 1; k >= 0; --k) cabac_reference_bypass(e, (prefixVal >> k) & 1);
+				}
+				else
+				{
+					/* suffix: EGk with k = cRiceParam + 1 */
+					int suffixVal = value - cMax;
+					int k = cRiceParam + 1;
+					while (suffixVal >= (1 << k))
+					{
+						cabac_reference_bypass(e, 1);
+						suffixVal -= 1 << k;
+						++k;
+					}
+					cabac_reference_bypass(e, 0);
+					while (k--) cabac_reference_bypass(e, (suffixVal >> k) & 1);
+				}
+
+				cLastAbsLevel = baseLevel + value;
+				cLastRiceParam = cRiceParam;
+			}
+			++numSigCoeff;
+		}
+	}
+
+#undef LEVEL
+}
+
+
+#define CABAC_TEST_BLOCKS 64
+#define CABAC_TEST_BUFFER_SIZE (CABAC_TEST_BLOCKS * 32 * 32 * 6)
+
+typedef struct
+{
+	HEVCASM_ALIGN(32, int16_t, levels[32 * 32]);
+	int log2TrafoSize;
+	int cIdx;
+	int scanIdx;
+	int sign_hiding;
+}
+cabac_test_block;
+
+typedef struct
+{
+	const cabac_test_block *blocks;
+	int initType;
+	int qp;
+	hevcasm_residual_scan *f;
+	hevcasm_residual_block block;
+	uint8_t *buffer;
+	size_t size;
+	int bins;
+}
+bound_cabac_write_residual_coding;
+
+
+int init_cabac_write_residual_coding(void *p, hevcasm_instruction_set mask)
+{
+	bound_cabac_write_residual_coding *s = p;
+	hevcasm_table_residual_scan table;
+	hevcasm_populate_residual_scan(&table, mask);
+	s->f = *hevcasm_get_residual_scan(&table);
+	if (s->f && mask == HEVCASM_C_REF)
+	{
+		hevcasm_test_printf("\t%d blocks, initType=%d, QP %d : ", CABAC_TEST_BLOCKS, s->initType, s->qp);
+		s->f = 0;
+		return 1;
+	}
+	return !!s->f;
+}
+
+
+void invoke_cabac_write_residual_coding(void *p, int n)
+{
+	bound_cabac_write_residual_coding *s = p;
+	while (n--)
+	{
+		hevcasm_residual_contexts contexts;
+		hevcasm_init_residual_contexts(&contexts, s->initType, s->qp);
+
+		if (!s->f)
+		{
+			cabac_reference_encoder e;
+			cabac_reference_init(&e, s->buffer, CABAC_TEST_BUFFER_SIZE);
+			for (int i = 0; i < CABAC_TEST_BLOCKS; ++i)
+			{
+				const cabac_test_block *b = &s->blocks[i];
+				residual_coding_reference(&e, &contexts, b->levels, b->log2TrafoSize, b->cIdx, b->scanIdx, b->sign_hiding);
+			}
+			s->size = cabac_reference_finish(&e);
+			s->bins = e.bins;
+		}
+		else
+		{
+			hevcasm_cabac_encoder e;
+			hevcasm_cabac_encoder_init(&e, s->buffer, CABAC_TEST_BUFFER_SIZE);
+			for (int i = 0; i < CABAC_TEST_BLOCKS; ++i)
+			{
+				const cabac_test_block *b = &s->blocks[i];
+				s->f(&s->block, b->levels, b->log2TrafoSize, b->scanIdx);
+				hevcasm_cabac_write_residual_coding(&e, &contexts, &s->block, b->log2TrafoSize, b->cIdx, b->scanIdx, b->sign_hiding);
+			}
+			hevcasm_cabac_encode_terminate(&e, 1);
+			s->size = hevcasm_cabac_encoder_finish(&e);
+		}
+	}
+}
+
+
+int mismatch_cabac_write_residual_coding(void *boundRef, void *boundTest)
+{
+	bound_cabac_write_residual_coding *ref = boundRef;
+	bound_cabac_write_residual_coding *test = boundTest;
+
+	return ref->size != test->size || memcmp(ref->buffer, test->buffer, ref->size);
+}
+
+
+/* levels whose parity already determines the sign of the first non-zero level of each sub-block that hides it */
+static void cabac_test_hide_signs(cabac_test_block *b)
+{
+	const int nCbS = 1 << b->log2TrafoSize;
+	const int sbWidth = nCbS >> 2;
+
+	uint8_t scanPos[16][2];
+	residual_reference_scan(scanPos, 4, b->scanIdx);
+
+	for (int yS = 0; yS < sbWidth; ++yS)
+	{
+		for (int xS = 0; xS < sbWidth; ++xS)
+		{
+			int first = -1;
+			int last = -1;
+			int sum = 0;
+			for (int n = 0; n < 16; ++n)
+			{
+				const int level = b->levels[((yS << 2) + scanPos[n][1]) * nCbS + (xS << 2) + scanPos[n][0]];
+				if (!level) continue;
+				if (first < 0) first = n;
+				last = n;
+				sum += abs(level);
+			}
+			if (first >= 0 && last - first > 3)
+			{
+				int16_t *level = &b->levels[((yS << 2) + scanPos[first][1]) * nCbS + (xS << 2) + scanPos[first][0]];
+				int a = abs(*level);
+				if (a == 32768 && !(sum & 1))
+				{
+					a = 32767;
+					--sum;
+				}
+				*level = (int16_t)((sum & 1) ? -a : a);
+			}
+		}
+	}
+}
+
+
+/* low and high rate: blocks of all sizes, components and scans, with sign data hiding on half of them */
+static const struct { int initType; int qp; double amplitude; } cabac_test_cases[3] = { { 0, 37, 1.5 }, { 1, 27, 6.0 }, { 2, 22, 40.0 } };
+
+
+static void cabac_test_make_blocks(cabac_test_block *blocks, double amplitude)
+{
+	for (int i = 0; i < CABAC_TEST_BLOCKS; ++i)
+	{
+		cabac_test_block *block = &blocks[i];
+		block->log2TrafoSize = 2 + hevcasm_test_rand() % 4;
+		block->cIdx = block->log2TrafoSize < 5 ? hevcasm_test_rand() % 3 : 0;
+		block->scanIdx = 0;
+		if (block->log2TrafoSize == 2 || (block->log2TrafoSize == 3 && block->cIdx == 0)) block->scanIdx = hevcasm_test_rand() % 3;
+		block->sign_hiding = hevcasm_test_rand() & 1;
+		residual_test_levels(block->levels, block->log2TrafoSize, amplitude);
+		if (block->sign_hiding) cabac_test_hide_signs(block);
+	}
+}
+
+
+void HEVCASM_API hevcasm_test_cabac_write_residual_coding(int *error_count, hevcasm_instruction_set mask)
+{
+	hevcasm_test_printf("\nhevcasm_cabac_write_residual_coding - CABAC residual_coding() from quantized levels\n");
+
+	cabac_test_block *blocks = malloc(CABAC_TEST_BLOCKS * sizeof(cabac_test_block));
+
+	bound_cabac_write_residual_coding b[2];
+	b[0].blocks = blocks;
+	b[0].buffer = malloc(CABAC_TEST_BUFFER_SIZE);
+	b[1].buffer = malloc(CABAC_TEST_BUFFER_SIZE);
+
+	for (int k = 0; k < 3; ++k)
+	{
+		cabac_test_make_blocks(blocks, cabac_test_cases[k].amplitude);
+
+		b[0].initType = cabac_test_cases[k].initType;
+		b[0].qp = cabac_test_cases[k].qp;
+
+		uint8_t *buffer = b[1].buffer;
+		b[1] = b[0];
+		b[1].buffer = buffer;
+		*error_count += hevcasm_test(&b[0], &b[1], init_cabac_write_residual_coding, invoke_cabac_write_residual_coding, mismatch_cabac_write_residual_coding, mask, 1000);
+
+		/* throughput of the fastest path available */
+		if (init_cabac_write_residual_coding(&b[1], mask))
+		{
+			hevcasm_timestamp best = 0;
+			for (int j = 0; j < 100; ++j)
+			{
+				const hevcasm_timestamp start = hevcasm_get_timestamp();
+				invoke_cabac_write_residual_coding(&b[1], 1);
+				const hevcasm_timestamp duration = hevcasm_get_timestamp() - start;
+				if (j == 0 || duration < best) best = duration;
+			}
+			hevcasm_test_printf("\t\t%d bins, %d bytes: %.2f bins/cycle\n", b[0].bins, (int)b[0].size, (double)b[0].bins / (double)best);
+		}
+	}
+
+	free(b[1].buffer);
+	free(b[0].buffer);
+	free(blocks);
+}
+
+
+typedef struct
+{
+	const cabac_test_block *blocks;
+	int initType;
+	int qp;
+	const uint8_t *buffer;
+	size_t size;
+	hevcasm_table_residual_unscan table;
+	int16_t *coeffs;
+	int end_of_slice_segment_flag;
+}
+bound_cabac_read_residual_coding;
+
+
+int init_cabac_read_residual_coding(void *p, hevcasm_instruction_set mask)
+{
+	bound_cabac_read_residual_coding *s = p;
+	hevcasm_populate_residual_unscan(&s->table, mask);
+	if (*hevcasm_get_residual_unscan(&s->table) && mask == HEVCASM_C_REF)
+	{
+		hevcasm_test_printf("\t%d blocks, initType=%d, QP %d : ", CABAC_TEST_BLOCKS, s->initType, s->qp);
+	}
+	return !!*hevcasm_get_residual_unscan(&s->table);
+}
+
+
+void invoke_cabac_read_residual_coding(void *p, int n)
+{
+	bound_cabac_read_residual_coding *s = p;
+	while (n--)
+	{
+		hevcasm_residual_contexts contexts;
+		hevcasm_init_residual_contexts(&contexts, s->initType, s->qp);
+
+		hevcasm_cabac_decoder d;
+		hevcasm_cabac_decoder_init(&d, s->buffer, s->size);
+		for (int i = 0; i < CABAC_TEST_BLOCKS; ++i)
+		{
+			const cabac_test_block *b = &s->blocks[i];
+			hevcasm_cabac_read_residual_coding(&s->table, &d, &contexts, &s->coeffs[32 * 32 * i], b->log2TrafoSize, b->cIdx, b->scanIdx, b->sign_hiding);
+		}
+		s->end_of_slice_segment_flag = hevcasm_cabac_decode_terminate(&d);
+	}
+}
+
+
+/* the decoded levels must also match those encoded */
+int mismatch_cabac_read_residual_coding(void *boundRef, void *boundTest)
+{
+	bound_cabac_read_residual_coding *ref = boundRef;
+	bound_cabac_read_residual_coding *test = boundTest;
+
+	if (!ref->end_of_slice_segment_flag || !test->end_of_slice_segment_flag) return 1;
+
+	for (int i = 0; i < CABAC_TEST_BLOCKS; ++i)
+	{
+		const cabac_test_block *b = &ref->blocks[i];
+		const size_t size = (1 << (2 * b->log2TrafoSize)) * sizeof(int16_t);
+		if (memcmp(&ref->coeffs[32 * 32 * i], &test->coeffs[32 * 32 * i], size)) return 1;
+		if (memcmp(&ref->coeffs[32 * 32 * i], b->levels, size)) return 1;
+	}
+	return 0;
+}
+
+
+void HEVCASM_API hevcasm_test_cabac_read_residual_coding(int *error_count, hevcasm_instruction_set mask)
+{
+	hevcasm_test_printf("\nhevcasm_cabac_read_residual_coding - CABAC residual_coding() to raster levels\n");
+
+	cabac_test_block *blocks = malloc(CABAC_TEST_BLOCKS * sizeof(cabac_test_block));
+	uint8_t *buffer = malloc(CABAC_TEST_BUFFER_SIZE);
+
+	bound_cabac_read_residual_coding b[2];
+	b[0].blocks = blocks;
+	b[0].buffer = buffer;
+	b[0].coeffs = malloc(CABAC_TEST_BLOCKS * 32 * 32 * sizeof(int16_t));
+	b[1].coeffs = malloc(CABAC_TEST_BLOCKS * 32 * 32 * sizeof(int16_t));
+
+	for (int k = 0; k < 3; ++k)
+	{
+		cabac_test_make_blocks(blocks, cabac_test_cases[k].amplitude);
+
+		/* the bitstream comes from the reference encoder so that the parser is tested independently of the writer */
+		{
+			hevcasm_residual_contexts contexts;
+			hevcasm_init_residual_contexts(&contexts, cabac_test_cases[k].initType, cabac_test_cases[k].qp);
+
+			cabac_reference_encoder e;
+			cabac_reference_init(&e, buffer, CABAC_TEST_BUFFER_SIZE);
+			for (int i = 0; i < CABAC_TEST_BLOCKS; ++i)
+			{
+				const cabac_test_block *block = &blocks[i];
+				residual_coding_reference(&e, &contexts, block->levels, block->log2TrafoSize, block->cIdx, block->scanIdx, block->sign_hiding);
+			}
+			b[0].size = cabac_reference_finish(&e);
+		}
+
+		b[0].initType = cabac_test_cases[k].initType;
+		b[0].qp = cabac_test_cases[k].qp;
+
+		int16_t *coeffs = b[1].coeffs;
+		b[1] = b[0];
+		b[1].coeffs = coeffs;
+		*error_count += hevcasm_test(&b[0], &b[1], init_cabac_read_residual_coding, invoke_cabac_read_residual_coding, mismatch_cabac_read_residual_coding, mask, 1000);
+	}
+
+	/* the longest escape code of a 16-bit level decodes, one more prefix bin is rejected */
+	{
+		hevcasm_cabac_encoder e;
+		hevcasm_cabac_encoder_init(&e, buffer, CABAC_TEST_BUFFER_SIZE);
+		write_coeff_abs_level_remaining(&e, 32768 - 3, 0);
+		cabac_encode_bypass(&e, (1u << (RESIDUAL_PREFIX_MAX + 1)) - 1, RESIDUAL_PREFIX_MAX + 1);
+		cabac_encode_bypass(&e, 0, 32);
+		hevcasm_cabac_encode_terminate(&e, 1);
+		const size_t size = hevcasm_cabac_encoder_finish(&e);
+
+		hevcasm_cabac_decoder d;
+		hevcasm_cabac_decoder_init(&d, buffer, size);
+		const int longest = read_coeff_abs_level_remaining(&d, 0);
+		const int invalid = read_coeff_abs_level_remaining(&d, 0);
+		const int errors = longest != 32768 - 3 || invalid != -1;
+
+		hevcasm_test_printf("\tcoeff_abs_level_remaining prefix limit : %s\n", errors ? "MISMATCH" : "ok");
+		*error_count += errors;
+	}
+
+	free(b[1].coeffs);
+	free(b[0].coeffs);
+	free(buffer);
+	free(blocks);
+}
+
+
+typedef struct
+{
+	const cabac_test_block *blocks;
+	const hevcasm_residual_contexts *contexts;
+	const hevcasm_residual_rate *rate;
+	hevcasm_table_residual_scan scan;
+	hevcasm_table_residual_rate_sub_blocks table;
+	uint8_t *buffer;
+	int32_t cost[CABAC_TEST_BLOCKS];
+}
+bound_residual_rate_estimate;
+
+
+int init_residual_rate_estimate(void *p, hevcasm_instruction_set mask)
+{
+	bound_residual_rate_estimate *s = p;
+	hevcasm_populate_residual_scan(&s->scan, mask);
+	hevcasm_populate_residual_rate_sub_blocks(&s->table, mask);
+	if (mask == HEVCASM_C_REF)
+	{
+		hevcasm_test_printf("\t%d blocks : ", CABAC_TEST_BLOCKS);
+		return 1;
+	}
+	return *hevcasm_get_residual_scan(&s->scan) && *hevcasm_get_residual_rate_sub_blocks(&s->table);
+}
+
+
+void invoke_residual_rate_estimate(void *p, int n)
+{
+	bound_residual_rate_estimate *s = p;
+	while (n--)
+	{
+		for (int i = 0; i < CABAC_TEST_BLOCKS; ++i)
+		{
+			const cabac_test_block *b = &s->blocks[i];
+			if (s->buffer)
+			{
+				/* bin by bin through the reference encoder, its contexts adapting but the costs taken from the snapshot */
+				hevcasm_residual_contexts contexts = *s->contexts;
+				cabac_reference_encoder e;
+				cabac_reference_init(&e, s->buffer, 32 * 32 * 6);
+				e.snapshot = (const uint8_t *)s->contexts;
+				e.contexts = (const uint8_t *)&contexts;
+				residual_coding_reference(&e, &contexts, b->levels, b->log2TrafoSize, b->cIdx, b->scanIdx, b->sign_hiding);
+				s->cost[i] = e.rate;
+			}
+			else
+			{
+				s->cost[i] = hevcasm_residual_rate_estimate(&s->scan, &s->table, s->rate, b->levels, b->log2TrafoSize, b->cIdx, b->scanIdx, b->sign_hiding);
+			}
+		}
+	}
+}
+
+
+int mismatch_residual_rate_estimate(void *boundRef, void *boundTest)
+{
+	bound_residual_rate_estimate *ref = boundRef;
+	bound_residual_rate_estimate *test = boundTest;
+
+	return memcmp(ref->cost, test->cost, sizeof(ref->cost));
+}
+
+
+void HEVCASM_API hevcasm_test_residual_rate_estimate(int *error_count, hevcasm_instruction_set mask)
+{
+	hevcasm_test_printf("\nhevcasm_residual_rate_estimate - fractional-bit rate of residual_coding()\n");
+
+	cabac_test_block *blocks = malloc(CABAC_TEST_BLOCKS * sizeof(cabac_test_block));
+
+	hevcasm_residual_contexts contexts;
+	hevcasm_residual_rate *rate = malloc(sizeof(hevcasm_residual_rate));
+
+	bound_residual_rate_estimate b[2];
+	b[0].blocks = blocks;
+	b[0].contexts = &contexts;
+	b[0].rate = rate;
+	b[0].buffer = malloc(32 * 32 * 6);
+
+	for (int k = 0; k < 3; ++k)
+	{
+		cabac_test_make_blocks(blocks, cabac_test_cases[k].amplitude);
+
+		hevcasm_init_residual_contexts(&contexts, cabac_test_cases[k].initType, cabac_test_cases[k].qp);
+		hevcasm_init_residual_rate(rate, &contexts);
+
+		b[1] = b[0];
+		b[1].buffer = 0;
+		*error_count += hevcasm_test(&b[0], &b[1], init_residual_rate_estimate, invoke_residual_rate_estimate, mismatch_residual_rate_estimate, mask, 1000);
+	}
+
+	free(b[0].buffer);
+	free(rate);
+	free(blocks);
+}
+
+
+#undef CABAC_TEST_BUFFER_SIZE
+#undef CABAC_TEST_BLOCKS
+#undef RESIDUAL_PREFIX_MAX
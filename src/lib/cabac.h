@@ -0,0 +1,246 @@
+/*
+The copyright in this software is being made available under the BSD
+License, included below. This software may be subject to other third party
+and contributor rights, including patent rights, and no such rights are
+granted under this license.
+
+
+Copyright(c) 2011 - 2015, Parabola Research Limited
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met :
+
+* Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+this list of conditions and the following disclaimer in the documentation
+and / or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its contributors may
+be used to endorse or promote products derived from this software without
+specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/* HEVC CABAC entropy coding (8-bit Main profile residuals) */
+
+
+#ifndef INCLUDED_cabac_h
+#define INCLUDED_cabac_h
+
+#include "hevcasm.h"
+#include "rdoq.h"
+
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+// Initialises the residual_coding() context variables (9.3.2.2) for a slice. initType is 0 for I slices and 1 or 2
+// for P and B slices as selected by cabac_init_flag; qp is SliceQpY.
+void HEVCASM_API hevcasm_init_residual_contexts(hevcasm_residual_contexts *contexts, int initType, int qp);
+
+
+/* Arithmetic encoder (9.3.4.3) */
+
+// low holds the pending bits of the arithmetic code: a 64-bit register lets up to 32 bypass bins be encoded with
+// one multiply and output be written a few bytes at a time. Bytes equal to 0xff are held back until a carry can
+// no longer reach them.
+typedef struct
+{
+	uint64_t low;
+	uint32_t range;
+	int bits_left;
+	int buffered_byte;
+	int buffered_count;
+	uint8_t *buffer;
+	size_t size;
+	size_t count;
+}
+hevcasm_cabac_encoder;
+
+void HEVCASM_API hevcasm_cabac_encoder_init(hevcasm_cabac_encoder *encoder, uint8_t *buffer, size_t size);
+
+// Context-coded bin: context is packed as (pStateIdx << 1) | valMps and is updated.
+void HEVCASM_API hevcasm_cabac_encode_bin(hevcasm_cabac_encoder *encoder, uint8_t *context, int binVal);
+
+// n (at most 32) bypass bins, the first bin being the most significant bit of bins.
+void HEVCASM_API hevcasm_cabac_encode_bypass(hevcasm_cabac_encoder *encoder, uint32_t bins, int n);
+
+void HEVCASM_API hevcasm_cabac_encode_terminate(hevcasm_cabac_encoder *encoder, int binVal);
+
+// Completes the arithmetic code after a terminating bin equal to 1 and appends rbsp_stop_one_bit and alignment
+// zero bits. Returns the number of bytes written; a value greater than the buffer size means the output was
+// truncated.
+size_t HEVCASM_API hevcasm_cabac_encoder_finish(hevcasm_cabac_encoder *encoder);
+
+
+/* Arithmetic decoder (9.3.4.3) */
+
+// value holds the arithmetic decoder offset followed by up to 55 bits read ahead from the bitstream; bits is the
+// number of bits read ahead. Bytes past the end of the data are read as zero.
+typedef struct
+{
+	uint64_t value;
+	uint32_t range;
+	int bits;
+	const uint8_t *p;
+	const uint8_t *end;
+}
+hevcasm_cabac_decoder;
+
+void HEVCASM_API hevcasm_cabac_decoder_init(hevcasm_cabac_decoder *decoder, const uint8_t *data, size_t size);
+
+// Context-coded bin: context is packed as (pStateIdx << 1) | valMps and is updated.
+int HEVCASM_API hevcasm_cabac_decode_bin(hevcasm_cabac_decoder *decoder, uint8_t *context);
+
+// n (at most 32) bypass bins, the first bin decoded being the most significant bit of the result.
+uint32_t HEVCASM_API hevcasm_cabac_decode_bypass(hevcasm_cabac_decoder *decoder, int n);
+
+int HEVCASM_API hevcasm_cabac_decode_terminate(hevcasm_cabac_decoder *decoder);
+
+
+/* Coefficient scan */
+
+// Levels of a transform block in scan order with a significance map per 4x4 sub-block. Sub-block i, in sub-block
+// scan order, occupies level[16 * i] to level[16 * i + 15] in coefficient scan order and bit n of sig[i] is set
+// when level[16 * i + n] is non-zero.
+typedef struct
+{
+	HEVCASM_ALIGN(32, int16_t, level[32 * 32]);
+	uint16_t sig[64];
+}
+hevcasm_residual_block;
+
+// Reorders quantized levels, in raster order as written by hevcasm_quantize or hevcasm_rdoq, into a block.
+typedef void hevcasm_residual_scan(hevcasm_residual_block *block, const int16_t *src, int log2TrafoSize, int scanIdx);
+
+typedef struct
+{
+	hevcasm_residual_scan *p;
+}
+hevcasm_table_residual_scan;
+
+static hevcasm_residual_scan** hevcasm_get_residual_scan(hevcasm_table_residual_scan *table)
+{
+	return &table->p;
+}
+
+void HEVCASM_API hevcasm_populate_residual_scan(hevcasm_table_residual_scan *table, hevcasm_instruction_set mask);
+
+void HEVCASM_API hevcasm_test_residual_scan(int *error_count, hevcasm_instruction_set mask);
+
+#ifdef HEVCASM_X64
+hevcasm_residual_scan hevcasm_residual_scan_ssse3;
+#endif
+
+
+// Writes the levels of a block to a transform block in raster order, the layout read by hevcasm_quantize_inverse
+// and hevcasm_inverse_transform_add. Levels of sub-blocks without non-zero levels must be zero.
+typedef void hevcasm_residual_unscan(int16_t *dst, const hevcasm_residual_block *block, int log2TrafoSize, int scanIdx);
+
+typedef struct
+{
+	hevcasm_residual_unscan *p;
+}
+hevcasm_table_residual_unscan;
+
+static hevcasm_residual_unscan** hevcasm_get_residual_unscan(hevcasm_table_residual_unscan *table)
+{
+	return &table->p;
+}
+
+void HEVCASM_API hevcasm_populate_residual_unscan(hevcasm_table_residual_unscan *table, hevcasm_instruction_set mask);
+
+void HEVCASM_API hevcasm_test_residual_unscan(int *error_count, hevcasm_instruction_set mask);
+
+#ifdef HEVCASM_X64
+hevcasm_residual_unscan hevcasm_residual_unscan_ssse3;
+#endif
+
+
+/* residual_coding() */
+
+// Writes residual_coding() (7.3.8.11) of a block with at least one non-zero level. Sign data hiding applies when
+// sign_hiding is set (sign_data_hiding_enabled_flag and not cu_transquant_bypass_flag): levels must then already
+// satisfy the parity rule. transform_skip_flag is written by the caller.
+void HEVCASM_API hevcasm_cabac_write_residual_coding(hevcasm_cabac_encoder *encoder, hevcasm_residual_contexts *contexts, const hevcasm_residual_block *block, int log2TrafoSize, int cIdx, int scanIdx, int sign_hiding);
+
+void HEVCASM_API hevcasm_test_cabac_write_residual_coding(int *error_count, hevcasm_instruction_set mask);
+
+// Parses residual_coding() (7.3.8.11) and writes the levels of the whole transform block, zeros included, to coeffs
+// in raster order. Arguments are as for hevcasm_cabac_write_residual_coding. Returns zero, or non-zero without
+// writing coeffs if a coeff_abs_level_remaining is longer than any level in the 16-bit range allows.
+int HEVCASM_API hevcasm_cabac_read_residual_coding(hevcasm_table_residual_unscan *table, hevcasm_cabac_decoder *decoder, hevcasm_residual_contexts *contexts, int16_t *coeffs, int log2TrafoSize, int cIdx, int scanIdx, int sign_hiding);
+
+void HEVCASM_API hevcasm_test_cabac_read_residual_coding(int *error_count, hevcasm_instruction_set mask);
+
+
+/* Rate estimation */
+
+// Estimated costs, in units of 1/4096 bit, of each value of the context-coded bins of residual_coding() given a
+// snapshot of their contexts, for RDO decisions without a CABAC pass. sig_coeff_flag costs are stored as lanes: per
+// block size, component and scan, and per sub-block pattern (4 if the sub-block is the first in scan order, plus
+// prevCsbf), the cost of a zero flag at each of the 16 scan positions followed by the cost of a one.
+typedef struct
+{
+	HEVCASM_ALIGN(32, int16_t, sig_coeff_flag[14][8][32]);
+	int16_t coded_sub_block_flag[4][2];
+	int16_t last_sig_coeff_x_prefix[18][2];
+	int16_t last_sig_coeff_y_prefix[18][2];
+	int16_t coeff_abs_level_greater1_flag[24][2];
+	int16_t coeff_abs_level_greater2_flag[6][2];
+}
+hevcasm_residual_rate;
+
+void HEVCASM_API hevcasm_init_residual_rate(hevcasm_residual_rate *rate, const hevcasm_residual_contexts *contexts);
+
+// Vectorised part of the estimate for sub-blocks 0 to n - 1 of a block: returns the cost of the sig_coeff_flag bins
+// at the scan positions set in coded[i] using the lanes at cost + 32 * pattern[i], and writes masks of the levels of
+// sub-block i greater than 1 and greater than 2 to greater[2 * i] and greater[2 * i + 1].
+typedef int32_t hevcasm_residual_rate_sub_blocks(uint16_t *greater, const hevcasm_residual_block *block, const uint16_t *coded, const uint8_t *pattern, const int16_t *cost, int n);
+
+typedef struct
+{
+	hevcasm_residual_rate_sub_blocks *p;
+}
+hevcasm_table_residual_rate_sub_blocks;
+
+static hevcasm_residual_rate_sub_blocks** hevcasm_get_residual_rate_sub_blocks(hevcasm_table_residual_rate_sub_blocks *table)
+{
+	return &table->p;
+}
+
+void HEVCASM_API hevcasm_populate_residual_rate_sub_blocks(hevcasm_table_residual_rate_sub_blocks *table, hevcasm_instruction_set mask);
+
+void HEVCASM_API hevcasm_test_residual_rate_sub_blocks(int *error_count, hevcasm_instruction_set mask);
+
+#ifdef HEVCASM_X64
+hevcasm_residual_rate_sub_blocks hevcasm_residual_rate_sub_blocks_ssse3;
+#endif
+
+// Estimated cost of residual_coding() of a transform block whose levels are in raster order, as written by
+// hevcasm_quantize, or zero if all levels are zero. Other arguments are as for hevcasm_cabac_write_residual_coding.
+int32_t HEVCASM_API hevcasm_residual_rate_estimate(hevcasm_table_residual_scan *scan, hevcasm_table_residual_rate_sub_blocks *table, const hevcasm_residual_rate *rate, const int16_t *coeffs, int log2TrafoSize, int cIdx, int scanIdx, int sign_hiding);
+
+void HEVCASM_API hevcasm_test_residual_rate_estimate(int *error_count, hevcasm_instruction_set mask);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,231 @@
+; The copyright in this software is being made available under the BSD
+; License, included below. This software may be subject to other third party
+; and contributor rights, including patent rights, and no such rights are
+; granted under this license.
+; 
+; 
+; Copyright(c) 2011 - 2015, Parabola Research Limited
+; All rights reserved.
+; 
+; Redistribution and use in source and binary forms, with or without
+; modification, are permitted provided that the following conditions are met :
+; 
+; * Redistributions of source code must retain the above copyright notice,
+; this list of conditions and the following disclaimer.
+; * Redistributions in binary form must reproduce the above copyright notice,
+; this list of conditions and the following disclaimer in the documentation
+; and / or other materials provided with the distribution.
+; * Neither the name of the copyright holder nor the names of its contributors may
+; be used to endorse or promote products derived from this software without
+; specific prior written permission.
+; 
+; THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+; AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+; IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+; ARE DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+; BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+; CONSEQUENTIAL DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+; SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+; INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+; CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE)
+; ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+; THE POSSIBILITY OF SUCH DAMAGE.
+
+
+%define private_prefix hevcasm
+%include "x86inc.asm"
+
+
+%if ARCH_X86_64 == 1
+
+SECTION_RODATA 32
+
+; bit of a 16-bit mask tested by each word lane
+constant_residual_lane_bits:
+	dw 0x0001, 0x0002, 0x0004, 0x0008, 0x0010, 0x0020, 0x0040, 0x0080
+	dw 0x0100, 0x0200, 0x0400, 0x0800, 0x1000, 0x2000, 0x4000, 0x8000
+
+constant_times_8_dw_1:
+	times 8 dw 1
+
+constant_times_8_dw_2:
+	times 8 dw 2
+
+
+SECTION .text
+
+
+; void hevcasm_residual_scan_sub_blocks_ssse3(hevcasm_residual_block *block, const int16_t *src, ptrdiff_t stride, const uint8_t *scanSb, const uint8_t *shuffle, int n)
+; Each 4x4 sub-block is loaded as two registers of two rows and reordered into scan order by four pshufb;
+; the significance map is the movemask of the levels saturated to bytes and compared with zero.
+INIT_XMM ssse3
+cglobal residual_scan_sub_blocks, 6, 10, 8
+	movu m4, [r4]
+	movu m5, [r4 + 16]
+	movu m6, [r4 + 32]
+	movu m7, [r4 + 48]
+	add r2, r2
+	lea r4, [r2 * 4]
+	lea r7, [r2 * 3]
+	xor r8d, r8d
+.loop:
+	movzx r6d, byte [r3 + r8]
+	mov r9d, r6d
+	shr r9d, 4
+	and r6d, 15
+	imul r9, r4
+	lea r6, [r1 + 8 * r6]
+	add r6, r9
+
+	movq m0, [r6]
+	movhps m0, [r6 + r2]
+	movq m1, [r6 + 2 * r2]
+	movhps m1, [r6 + r7]
+
+	pshufb m2, m0, m4
+	pshufb m3, m1, m5
+	por m2, m3
+	pshufb m0, m6
+	pshufb m1, m7
+	por m0, m1
+
+	mov r6, r8
+	shl r6, 5
+	mova [r0 + r6], m2
+	mova [r0 + r6 + 16], m0
+
+	packsswb m2, m0
+	pxor m0, m0
+	pcmpeqb m2, m0
+	pmovmskb r9d, m2
+	xor r9d, 0xffff
+	mov [r0 + 2 * r8 + 2048], r9w
+
+	inc r8d
+	cmp r8d, r5d
+	jl .loop
+	RET
+
+
+; void hevcasm_residual_unscan_sub_blocks_ssse3(int16_t *dst, const hevcasm_residual_block *block, ptrdiff_t stride, const uint8_t *scanSb, const uint8_t *shuffle, int n)
+; The inverse of residual_scan_sub_blocks: each sub-block's 16 levels in scan order are reordered by four pshufb
+; into two registers of two rows and stored a row at a time.
+INIT_XMM ssse3
+cglobal residual_unscan_sub_blocks, 6, 10, 8
+	movu m4, [r4]
+	movu m5, [r4 + 16]
+	movu m6, [r4 + 32]
+	movu m7, [r4 + 48]
+	add r2, r2
+	lea r4, [r2 * 4]
+	lea r7, [r2 * 3]
+	xor r8d, r8d
+.loop:
+	mov r6, r8
+	shl r6, 5
+	mova m0, [r1 + r6]
+	mova m1, [r1 + r6 + 16]
+
+	pshufb m2, m0, m4
+	pshufb m3, m1, m5
+	por m2, m3
+	pshufb m0, m6
+	pshufb m1, m7
+	por m0, m1
+
+	movzx r6d, byte [r3 + r8]
+	mov r9d, r6d
+	shr r9d, 4
+	and r6d, 15
+	imul r9, r4
+	lea r6, [r0 + 8 * r6]
+	add r6, r9
+
+	movq [r6], m2
+	movhps [r6 + r2], m2
+	movq [r6 + 2 * r2], m0
+	movhps [r6 + r7], m0
+
+	inc r8d
+	cmp r8d, r5d
+	jl .loop
+	RET
+
+
+; int32_t hevcasm_residual_rate_sub_blocks_ssse3(uint16_t *greater, const hevcasm_residual_block *block, const uint16_t *coded, const uint8_t *pattern, const int16_t *cost, int n)
+; Per sub-block, the coded mask is expanded to word lanes, each lane selects the cost of a zero or a one flag and
+; pmaddwd accumulates the selected costs. Masks of levels greater than 1 and 2 come from saturating subtraction.
+INIT_XMM ssse3
+cglobal residual_rate_sub_blocks, 6, 8, 14
+	mova m10, [constant_residual_lane_bits]
+	mova m11, [constant_residual_lane_bits + 16]
+	mova m12, [constant_times_8_dw_1]
+	mova m13, [constant_times_8_dw_2]
+	pxor m8, m8
+	pxor m9, m9
+	xor r6d, r6d
+.loop:
+	movzx r7d, word [r2 + 2 * r6]
+	movd m0, r7d
+	pshuflw m0, m0, 0
+	punpcklqdq m0, m0
+	pand m1, m0, m11
+	pand m0, m10
+	pcmpeqw m0, m10
+	pcmpeqw m1, m11
+
+	mov r7, r6
+	shl r7, 5
+	mova m2, [r1 + r7]
+	mova m3, [r1 + r7 + 16]
+
+	movzx r7d, byte [r3 + r6]
+	shl r7d, 6
+	pcmpeqw m4, m2, m8
+	pcmpeqw m5, m3, m8
+	mova m6, [r4 + r7]
+	mova m7, [r4 + r7 + 16]
+	pand m6, m4
+	pand m7, m5
+	pandn m4, [r4 + r7 + 32]
+	pandn m5, [r4 + r7 + 48]
+	por m4, m6
+	por m5, m7
+	pand m4, m0
+	pand m5, m1
+	pmaddwd m4, m12
+	pmaddwd m5, m12
+	paddd m9, m4
+	paddd m9, m5
+
+	pabsw m2, m2
+	pabsw m3, m3
+	psubusw m4, m2, m12
+	psubusw m5, m3, m12
+	pcmpeqw m4, m8
+	pcmpeqw m5, m8
+	packsswb m4, m5
+	pmovmskb r7d, m4
+	xor r7d, 0xffff
+	mov [r0 + 4 * r6], r7w
+	psubusw m2, m13
+	psubusw m3, m13
+	pcmpeqw m2, m8
+	pcmpeqw m3, m8
+	packsswb m2, m3
+	pmovmskb r7d, m2
+	xor r7d, 0xffff
+	mov [r0 + 4 * r6 + 2], r7w
+
+	inc r6d
+	cmp r6d, r5d
+	jl .loop
+
+	pshufd m0, m9, q3232
+	paddd m9, m0
+	pshufd m0, m9, q1111
+	paddd m9, m0
+	movd eax, m9
+	RET
+
+%endif
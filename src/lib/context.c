@@ -0,0 +1,196 @@
+/*
+The copyright in this software is being made available under the BSD
+License, included below. This software may be subject to other third party
+and contributor rights, including patent rights, and no such rights are
+granted under this license.
+
+
+Copyright(c) 2011 - 2015, Parabola Research Limited
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met :
+
+* Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+this list of conditions and the following disclaimer in the documentation
+and / or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its contributors may
+be used to endorse or promote products derived from this software without
+specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "context.h"
+#include "hevcasm_test.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef WIN32
+#include <Windows.h>
+#else
+#include <pthread.h>
+#endif
+
+
+void HEVCASM_API hevcasm_populate_context(hevcasm_context *context, hevcasm_instruction_set mask)
+{
+	memset(context, 0, sizeof(*context));
+	context->mask = mask;
+
+	hevcasm_populate_sad(&context->sad, mask);
+	hevcasm_populate_sad_multiref(&context->sad_multiref, mask);
+	hevcasm_populate_ssd(&context->ssd, mask);
+	hevcasm_populate_ssd_residual(&context->ssd_residual, mask);
+	hevcasm_populate_ssd_plane(&context->ssd_plane, mask);
+	hevcasm_populate_ssim_4x4_sums(&context->ssim_4x4_sums, mask);
+	hevcasm_populate_variance(&context->variance, mask);
+	hevcasm_populate_pred_intra(&context->pred_intra, mask);
+	hevcasm_populate_hadamard_satd(&context->hadamard_satd, mask);
+	hevcasm_populate_satd(&context->satd, mask);
+	hevcasm_populate_satd_multiref(&context->satd_multiref, mask);
+	hevcasm_populate_quantize_inverse(&context->quantize_inverse, mask);
+	hevcasm_populate_quantize(&context->quantize, mask);
+	hevcasm_populate_quantize_reconstruct(&context->quantize_reconstruct, mask);
+	hevcasm_populate_transform_domain_ssd(&context->transform_domain_ssd, mask);
+	hevcasm_populate_rdoq_candidates(&context->rdoq_candidates, mask);
+	hevcasm_populate_rdoq(&context->rdoq, mask);
+	hevcasm_populate_residual_scan(&context->residual_scan, mask);
+	hevcasm_populate_residual_unscan(&context->residual_unscan, mask);
+	hevcasm_populate_residual_rate_sub_blocks(&context->residual_rate_sub_blocks, mask);
+	hevcasm_populate_pred_uni_8to8(&context->pred_uni_8to8, mask);
+	hevcasm_populate_pred_bi_8to8(&context->pred_bi_8to8, mask);
+	hevcasm_populate_pred_uni_nv12(&context->pred_uni_nv12, mask);
+	hevcasm_populate_pred_bi_nv12(&context->pred_bi_nv12, mask);
+	hevcasm_populate_pred_uni_8to16(&context->pred_uni_8to16, mask);
+	hevcasm_populate_pred_uni_weighted_16to8(&context->pred_uni_weighted_16to8, mask);
+	hevcasm_populate_pred_bi_weighted_16to8(&context->pred_bi_weighted_16to8, mask);
+	hevcasm_populate_pred_batch(&context->pred_batch, mask);
+	hevcasm_populate_deblock_luma(&context->deblock_luma, mask);
+	hevcasm_populate_deblock_chroma(&context->deblock_chroma, mask);
+	hevcasm_populate_deblock_bs(&context->deblock_bs, mask);
+	hevcasm_populate_sao(&context->sao, mask);
+	hevcasm_populate_sao_collect(&context->sao_collect, mask);
+	hevcasm_populate_pad_horizontal(&context->pad_horizontal, mask);
+	hevcasm_populate_pad_vertical(&context->pad_vertical, mask);
+	hevcasm_populate_inverse_transform_add(&context->inverse_transform_add, mask, 0);
+	hevcasm_populate_inverse_transform_add(&context->inverse_transform_add_encoder, mask, 1);
+	hevcasm_populate_transform(&context->transform, mask);
+	hevcasm_populate_transform_skip(&context->transform_skip, mask);
+	hevcasm_populate_inverse_transform_skip_add(&context->inverse_transform_skip_add, mask);
+	hevcasm_populate_transquant_bypass_add(&context->transquant_bypass_add, mask);
+}
+
+
+static HEVCASM_ALIGN(64, hevcasm_context, context);
+
+
+#ifdef WIN32
+
+static INIT_ONCE context_once = INIT_ONCE_STATIC_INIT;
+
+static BOOL CALLBACK context_init(PINIT_ONCE once, PVOID parameter, PVOID *p)
+{
+	hevcasm_populate_context(&context, hevcasm_instruction_set_support());
+	return TRUE;
+}
+
+#else
+
+static pthread_once_t context_once = PTHREAD_ONCE_INIT;
+
+static void context_init(void)
+{
+	hevcasm_populate_context(&context, hevcasm_instruction_set_support());
+}
+
+#endif
+
+
+hevcasm_context * HEVCASM_API hevcasm_get_context(void)
+{
+#ifdef WIN32
+	InitOnceExecuteOnce(&context_once, context_init, NULL, NULL);
+#else
+	pthread_once(&context_once, context_init);
+#endif
+	return &context;
+}
+
+
+#define CONTEXT_TEST_THREADS 8
+
+#ifdef WIN32
+static DWORD WINAPI context_test_thread(LPVOID p)
+#else
+static void *context_test_thread(void *p)
+#endif
+{
+	*(hevcasm_context **)p = hevcasm_get_context();
+	return 0;
+}
+
+
+void HEVCASM_API hevcasm_test_context(int *error_count, hevcasm_instruction_set mask)
+{
+	hevcasm_test_printf("\nhevcasm_context - global dispatch context\n");
+
+	/* first calls race from several threads: all must see the same, fully populated, context */
+	hevcasm_context *result[CONTEXT_TEST_THREADS];
+#ifdef WIN32
+	HANDLE thread[CONTEXT_TEST_THREADS];
+	for (int i = 0; i < CONTEXT_TEST_THREADS; ++i) thread[i] = CreateThread(NULL, 0, context_test_thread, &result[i], 0, NULL);
+	for (int i = 0; i < CONTEXT_TEST_THREADS; ++i)
+	{
+		WaitForSingleObject(thread[i], INFINITE);
+		CloseHandle(thread[i]);
+	}
+#else
+	pthread_t thread[CONTEXT_TEST_THREADS];
+	for (int i = 0; i < CONTEXT_TEST_THREADS; ++i) pthread_create(&thread[i], NULL, context_test_thread, &result[i]);
+	for (int i = 0; i < CONTEXT_TEST_THREADS; ++i) pthread_join(thread[i], NULL);
+#endif
+
+	hevcasm_context *expected = malloc(sizeof(hevcasm_context));
+	hevcasm_populate_context(expected, hevcasm_instruction_set_support());
+
+	int errors = 0;
+	for (int i = 0; i < CONTEXT_TEST_THREADS; ++i)
+	{
+		if (result[i] != hevcasm_get_context()) ++errors;
+	}
+	if (memcmp(hevcasm_get_context(), expected, sizeof(hevcasm_context))) ++errors;
+	if ((uintptr_t)hevcasm_get_context() & 63) ++errors;
+
+	/* cost of populating every table against that of fetching the shared context */
+	const hevcasm_timestamp start = hevcasm_get_timestamp();
+	hevcasm_populate_context(expected, mask);
+	const hevcasm_timestamp populate = hevcasm_get_timestamp() - start;
+
+	const hevcasm_timestamp start_get = hevcasm_get_timestamp();
+	hevcasm_context *volatile shared = hevcasm_get_context();
+	const hevcasm_timestamp get = hevcasm_get_timestamp() - start_get;
+	(void)shared;
+
+	hevcasm_test_printf("\t%d threads, %d bytes: populate %d cycles, get %d cycles%s\n", CONTEXT_TEST_THREADS, (int)sizeof(hevcasm_context), (int)populate, (int)get, errors ? "-MISMATCH" : "");
+
+	*error_count += errors;
+	free(expected);
+}
+
+
+#undef CONTEXT_TEST_THREADS
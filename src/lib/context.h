@@ -0,0 +1,129 @@
+/*
+The copyright in this software is being made available under the BSD
+License, included below. This software may be subject to other third party
+and contributor rights, including patent rights, and no such rights are
+granted under this license.
+
+
+Copyright(c) 2011 - 2015, Parabola Research Limited
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met :
+
+* Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+this list of conditions and the following disclaimer in the documentation
+and / or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its contributors may
+be used to endorse or promote products derived from this software without
+specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/* Global dispatch context: every kernel table, populated once */
+
+
+#ifndef INCLUDED_context_h
+#define INCLUDED_context_h
+
+#include "hevcasm.h"
+#include "cabac.h"
+#include "deblock.h"
+#include "hadamard.h"
+#include "metrics.h"
+#include "pad.h"
+#include "pred_inter.h"
+#include "pred_intra.h"
+#include "quantize.h"
+#include "rdoq.h"
+#include "residual_decode.h"
+#include "sad.h"
+#include "sao.h"
+#include "ssd.h"
+#include "variance.h"
+
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+// One table of each kernel family, aligned to a cache line. inverse_transform_add is populated for decoders (any
+// coefficients) and inverse_transform_add_encoder for encoders (see hevcasm_populate_inverse_transform_add).
+typedef struct
+{
+	HEVCASM_ALIGN(64, hevcasm_instruction_set, mask);
+	hevcasm_table_sad sad;
+	hevcasm_table_sad_multiref sad_multiref;
+	hevcasm_table_ssd ssd;
+	hevcasm_table_ssd_residual ssd_residual;
+	hevcasm_table_ssd_plane ssd_plane;
+	hevcasm_table_ssim_4x4_sums ssim_4x4_sums;
+	hevcasm_table_variance variance;
+	hevcasm_table_pred_intra pred_intra;
+	hevcasm_table_hadamard_satd hadamard_satd;
+	hevcasm_table_satd satd;
+	hevcasm_table_satd_multiref satd_multiref;
+	hevcasm_table_quantize_inverse quantize_inverse;
+	hevcasm_table_quantize quantize;
+	hevcasm_table_quantize_reconstruct quantize_reconstruct;
+	hevcasm_table_transform_domain_ssd transform_domain_ssd;
+	hevcasm_table_rdoq_candidates rdoq_candidates;
+	hevcasm_table_rdoq rdoq;
+	hevcasm_table_residual_scan residual_scan;
+	hevcasm_table_residual_unscan residual_unscan;
+	hevcasm_table_residual_rate_sub_blocks residual_rate_sub_blocks;
+	hevcasm_table_pred_uni_8to8 pred_uni_8to8;
+	hevcasm_table_pred_bi_8to8 pred_bi_8to8;
+	hevcasm_table_pred_uni_nv12 pred_uni_nv12;
+	hevcasm_table_pred_bi_nv12 pred_bi_nv12;
+	hevcasm_table_pred_uni_8to16 pred_uni_8to16;
+	hevcasm_table_pred_uni_weighted_16to8 pred_uni_weighted_16to8;
+	hevcasm_table_pred_bi_weighted_16to8 pred_bi_weighted_16to8;
+	hevcasm_table_pred_batch pred_batch;
+	hevcasm_table_deblock_luma deblock_luma;
+	hevcasm_table_deblock_chroma deblock_chroma;
+	hevcasm_table_deblock_bs deblock_bs;
+	hevcasm_table_sao sao;
+	hevcasm_table_sao_collect sao_collect;
+	hevcasm_table_pad_horizontal pad_horizontal;
+	hevcasm_table_pad_vertical pad_vertical;
+	hevcasm_table_inverse_transform_add inverse_transform_add;
+	hevcasm_table_inverse_transform_add inverse_transform_add_encoder;
+	hevcasm_table_transform transform;
+	hevcasm_table_transform_skip transform_skip;
+	hevcasm_table_inverse_transform_skip_add inverse_transform_skip_add;
+	hevcasm_table_transquant_bypass_add transquant_bypass_add;
+}
+hevcasm_context;
+
+// Populates every table of a context for the instruction sets in mask.
+void HEVCASM_API hevcasm_populate_context(hevcasm_context *context, hevcasm_instruction_set mask);
+
+// Returns the context of the instruction sets supported by the processor. The processor is queried and the context
+// populated by the first call only; concurrent first calls wait for that population to complete. The context is
+// shared by all callers and threads and must be treated as read-only.
+hevcasm_context * HEVCASM_API hevcasm_get_context(void);
+
+void HEVCASM_API hevcasm_test_context(int *error_count, hevcasm_instruction_set mask);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,755 @@
+/*
+The copyright in this software is being made available under the BSD
+License, included below. This software may be subject to other third party
+and contributor rights, including patent rights, and no such rights are
+granted under this license.
+
+
+Copyright(c) 2011 - 2015, Parabola Research Limited
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met :
+
+* Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+this list of conditions and the following disclaimer in the documentation
+and / or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its contributors may
+be used to endorse or promote products derived from this software without
+specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "deblock.h"
+#include "static_dispatch.h"
+#include "hevcasm_test.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+
+static int clip3(int min, int max, int x)
+{
+	return x < min ? min : x > max ? max : x;
+}
+
+
+static uint8_t clip1(int x)
+{
+	return (uint8_t)clip3(0, 255, x);
+}
+
+
+static const uint8_t beta_table[52] =
+{
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 20, 22, 24,
+	26, 28, 30, 32, 34, 36, 38, 40, 42, 44, 46, 48, 50, 52, 54, 56, 58, 60, 62, 64
+};
+
+
+static const uint8_t tc_table[54] =
+{
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 2, 2, 2, 2, 3,
+	3, 3, 3, 4, 4, 4, 5, 5, 6, 6, 7, 8, 9, 10, 11, 13, 14, 16, 18, 20, 22, 24
+};
+
+
+int HEVCASM_API hevcasm_deblock_beta(int qp, int beta_offset)
+{
+	return beta_table[clip3(0, 51, qp + beta_offset)];
+}
+
+
+int HEVCASM_API hevcasm_deblock_tc(int qp, int bS, int tc_offset)
+{
+	if (!bS) return 0;
+	return tc_table[clip3(0, 53, qp + 2 * (bS - 1) + tc_offset)];
+}
+
+
+/* xstride steps across the edge, ystride steps along it */
+static void deblock_luma_c(uint8_t *src, ptrdiff_t xstride, ptrdiff_t ystride, int beta, const int tc[2])
+{
+#define P(i, k) s[(k) * ystride - ((i) + 1) * xstride]
+#define Q(i, k) s[(k) * ystride + (i) * xstride]
+
+	for (int half = 0; half < 2; ++half)
+	{
+		uint8_t *s = src + 4 * half * ystride;
+		const int tC = tc[half];
+
+		if (!tC) continue;
+
+		const int dp0 = abs(P(2, 0) - 2 * P(1, 0) + P(0, 0));
+		const int dp3 = abs(P(2, 3) - 2 * P(1, 3) + P(0, 3));
+		const int dq0 = abs(Q(2, 0) - 2 * Q(1, 0) + Q(0, 0));
+		const int dq3 = abs(Q(2, 3) - 2 * Q(1, 3) + Q(0, 3));
+		const int dpq0 = dp0 + dq0;
+		const int dpq3 = dp3 + dq3;
+		const int dp = dp0 + dp3;
+		const int dq = dq0 + dq3;
+		const int d = dpq0 + dpq3;
+
+		if (d >= beta) continue;
+
+		int dSam[2];
+		for (int j = 0; j < 2; ++j)
+		{
+			const int k = 3 * j;
+			const int dpq = 2 * (j ? dpq3 : dpq0);
+			dSam[j] =
+				dpq < (beta >> 2) &&
+				abs(P(3, k) - P(0, k)) + abs(Q(0, k) - Q(3, k)) < (beta >> 3) &&
+				abs(P(0, k) - Q(0, k)) < ((5 * tC + 1) >> 1);
+		}
+
+		const int dE = dSam[0] && dSam[1] ? 2 : 1;
+		const int dEp = dp < ((beta + (beta >> 1)) >> 3);
+		const int dEq = dq < ((beta + (beta >> 1)) >> 3);
+
+		for (int k = 0; k < 4; ++k)
+		{
+			const int p0 = P(0, k), p1 = P(1, k), p2 = P(2, k), p3 = P(3, k);
+			const int q0 = Q(0, k), q1 = Q(1, k), q2 = Q(2, k), q3 = Q(3, k);
+
+			if (dE == 2)
+			{
+				P(0, k) = (uint8_t)clip3(p0 - 2 * tC, p0 + 2 * tC, (p2 + 2 * p1 + 2 * p0 + 2 * q0 + q1 + 4) >> 3);
+				P(1, k) = (uint8_t)clip3(p1 - 2 * tC, p1 + 2 * tC, (p2 + p1 + p0 + q0 + 2) >> 2);
+				P(2, k) = (uint8_t)clip3(p2 - 2 * tC, p2 + 2 * tC, (2 * p3 + 3 * p2 + p1 + p0 + q0 + 4) >> 3);
+				Q(0, k) = (uint8_t)clip3(q0 - 2 * tC, q0 + 2 * tC, (p1 + 2 * p0 + 2 * q0 + 2 * q1 + q2 + 4) >> 3);
+				Q(1, k) = (uint8_t)clip3(q1 - 2 * tC, q1 + 2 * tC, (p0 + q0 + q1 + q2 + 2) >> 2);
+				Q(2, k) = (uint8_t)clip3(q2 - 2 * tC, q2 + 2 * tC, (p0 + q0 + q1 + 3 * q2 + 2 * q3 + 4) >> 3);
+			}
+			else
+			{
+				int delta = (9 * (q0 - p0) - 3 * (q1 - p1) + 8) >> 4;
+
+				if (abs(delta) >= tC * 10) continue;
+
+				delta = clip3(-tC, tC, delta);
+				P(0, k) = clip1(p0 + delta);
+				Q(0, k) = clip1(q0 - delta);
+
+				if (dEp)
+				{
+					const int deltap = clip3(-(tC >> 1), tC >> 1, (((p2 + p0 + 1) >> 1) - p1 + delta) >> 1);
+					P(1, k) = clip1(p1 + deltap);
+				}
+
+				if (dEq)
+				{
+					const int deltaq = clip3(-(tC >> 1), tC >> 1, (((q2 + q0 + 1) >> 1) - q1 - delta) >> 1);
+					Q(1, k) = clip1(q1 + deltaq);
+				}
+			}
+		}
+	}
+
+#undef P
+#undef Q
+}
+
+
+static void hevcasm_deblock_luma_v_c_ref(uint8_t *src, ptrdiff_t stride, int beta, const int tc[2])
+{
+	deblock_luma_c(src, 1, stride, beta, tc);
+}
+
+
+static void hevcasm_deblock_luma_h_c_ref(uint8_t *src, ptrdiff_t stride, int beta, const int tc[2])
+{
+	deblock_luma_c(src, stride, 1, beta, tc);
+}
+
+
+static void deblock_chroma_c(uint8_t *src, ptrdiff_t xstride, ptrdiff_t ystride, const int tc[2])
+{
+	for (int k = 0; k < 8; ++k)
+	{
+		uint8_t *s = src + k * ystride;
+		const int tC = tc[k >> 2];
+		const int p0 = s[-xstride], p1 = s[-2 * xstride];
+		const int q0 = s[0], q1 = s[xstride];
+
+		const int delta = clip3(-tC, tC, (4 * (q0 - p0) + p1 - q1 + 4) >> 3);
+
+		s[-xstride] = clip1(p0 + delta);
+		s[0] = clip1(q0 - delta);
+	}
+}
+
+
+static void hevcasm_deblock_chroma_v_c_ref(uint8_t *src, ptrdiff_t stride, const int tc[2])
+{
+	deblock_chroma_c(src, 1, stride, tc);
+}
+
+
+static void hevcasm_deblock_chroma_h_c_ref(uint8_t *src, ptrdiff_t stride, const int tc[2])
+{
+	deblock_chroma_c(src, stride, 1, tc);
+}
+
+
+#ifdef HEVCASM_X64
+hevcasm_deblock_luma hevcasm_deblock_luma_v_sse4;
+hevcasm_deblock_luma hevcasm_deblock_luma_h_sse4;
+hevcasm_deblock_chroma hevcasm_deblock_chroma_v_sse4;
+hevcasm_deblock_chroma hevcasm_deblock_chroma_h_sse4;
+#endif
+
+
+void HEVCASM_API hevcasm_populate_deblock_luma(hevcasm_table_deblock_luma *table, hevcasm_instruction_set mask)
+{
+	*hevcasm_get_deblock_luma(table, 0) = 0;
+	*hevcasm_get_deblock_luma(table, 1) = 0;
+
+	if (mask & (HEVCASM_C_REF | HEVCASM_C_OPT))
+	{
+		*hevcasm_get_deblock_luma(table, 0) = hevcasm_deblock_luma_v_c_ref;
+		*hevcasm_get_deblock_luma(table, 1) = hevcasm_deblock_luma_h_c_ref;
+	}
+
+#ifdef HEVCASM_X64
+	if (mask & HEVCASM_SSE41)
+	{
+		*hevcasm_get_deblock_luma(table, 0) = hevcasm_deblock_luma_v_sse4;
+		*hevcasm_get_deblock_luma(table, 1) = hevcasm_deblock_luma_h_sse4;
+	}
+#endif
+}
+
+
+void HEVCASM_API hevcasm_populate_deblock_chroma(hevcasm_table_deblock_chroma *table, hevcasm_instruction_set mask)
+{
+	*hevcasm_get_deblock_chroma(table, 0) = 0;
+	*hevcasm_get_deblock_chroma(table, 1) = 0;
+
+	if (mask & (HEVCASM_C_REF | HEVCASM_C_OPT))
+	{
+		*hevcasm_get_deblock_chroma(table, 0) = hevcasm_deblock_chroma_v_c_ref;
+		*hevcasm_get_deblock_chroma(table, 1) = hevcasm_deblock_chroma_h_c_ref;
+	}
+
+#ifdef HEVCASM_X64
+	if (mask & HEVCASM_SSE41)
+	{
+		*hevcasm_get_deblock_chroma(table, 0) = hevcasm_deblock_chroma_v_sse4;
+		*hevcasm_get_deblock_chroma(table, 1) = hevcasm_deblock_chroma_h_sse4;
+	}
+#endif
+}
+
+
+static int mv_differ(int32_t a, int32_t b)
+{
+	const int dx = (int16_t)a - (int16_t)b;
+	const int dy = (a >> 16) - (b >> 16);
+	return abs(dx) >= 4 || abs(dy) >= 4;
+}
+
+
+/* boundary strength between blocks p and q (8.7.2.4) */
+static int deblock_bs_c(const hevcasm_deblock_metadata *m, ptrdiff_t p, ptrdiff_t q, int edge)
+{
+	const int flags = m->flags[p] | m->flags[q];
+	const int edge_flag = edge ? HEVCASM_DEBLOCK_EDGE_TOP : HEVCASM_DEBLOCK_EDGE_LEFT;
+	const int tu_edge_flag = edge ? HEVCASM_DEBLOCK_TU_EDGE_TOP : HEVCASM_DEBLOCK_TU_EDGE_LEFT;
+
+	if (!(m->flags[q] & edge_flag)) return 0;
+
+	if (flags & HEVCASM_DEBLOCK_INTRA) return 2;
+
+	if ((m->flags[q] & tu_edge_flag) && (flags & HEVCASM_DEBLOCK_CBF)) return 1;
+
+	const int refP0 = m->ref[0][p], refP1 = m->ref[1][p];
+	const int refQ0 = m->ref[0][q], refQ1 = m->ref[1][q];
+	const int nP = (refP0 >= 0) + (refP1 >= 0);
+	const int nQ = (refQ0 >= 0) + (refQ1 >= 0);
+
+	if (nP != nQ) return 1;
+
+	if (nP == 1)
+	{
+		const int list_p = refP0 < 0;
+		const int list_q = refQ0 < 0;
+		if (m->ref[list_p][p] != m->ref[list_q][q]) return 1;
+		return mv_differ(m->mv[list_p][p], m->mv[list_q][q]);
+	}
+
+	if (!((refP0 == refQ0 && refP1 == refQ1) || (refP0 == refQ1 && refP1 == refQ0))) return 1;
+
+	const int32_t mvP0 = m->mv[0][p], mvP1 = m->mv[1][p];
+	const int32_t mvQ0 = m->mv[0][q], mvQ1 = m->mv[1][q];
+
+	if (refP0 != refP1)
+	{
+		if (refP0 == refQ0) return mv_differ(mvP0, mvQ0) || mv_differ(mvP1, mvQ1);
+		return mv_differ(mvP0, mvQ1) || mv_differ(mvP1, mvQ0);
+	}
+
+	return
+		(mv_differ(mvP0, mvQ0) || mv_differ(mvP1, mvQ1)) &&
+		(mv_differ(mvP0, mvQ1) || mv_differ(mvP1, mvQ0));
+}
+
+
+static void hevcasm_deblock_bs_v_c_ref(uint8_t *bs, const hevcasm_deblock_metadata *metadata, ptrdiff_t offset, int n)
+{
+	for (int i = 0; i < n; ++i)
+	{
+		bs[i] = (uint8_t)deblock_bs_c(metadata, offset + i - 1, offset + i, 0);
+	}
+}
+
+
+static void hevcasm_deblock_bs_h_c_ref(uint8_t *bs, const hevcasm_deblock_metadata *metadata, ptrdiff_t offset, int n)
+{
+	for (int i = 0; i < n; ++i)
+	{
+		bs[i] = (uint8_t)deblock_bs_c(metadata, offset + i - metadata->stride, offset + i, 1);
+	}
+}
+
+
+#ifdef HEVCASM_X64
+hevcasm_deblock_bs hevcasm_deblock_bs_v_8n_avx2;
+hevcasm_deblock_bs hevcasm_deblock_bs_h_8n_avx2;
+
+#define MAKE_hevcasm_deblock_bs_avx2(edge) \
+void hevcasm_deblock_bs_ ## edge ## _avx2(uint8_t *bs, const hevcasm_deblock_metadata *metadata, ptrdiff_t offset, int n) \
+{ \
+	const int n8 = n & ~7; \
+	if (n8) hevcasm_deblock_bs_ ## edge ## _8n_avx2(bs, metadata, offset, n8); \
+	if (n8 < n) hevcasm_deblock_bs_ ## edge ## _4n_sse4(bs + n8, metadata, offset + n8, n - n8); \
+}
+
+MAKE_hevcasm_deblock_bs_avx2(v)
+MAKE_hevcasm_deblock_bs_avx2(h)
+#endif
+
+
+void HEVCASM_API hevcasm_populate_deblock_bs(hevcasm_table_deblock_bs *table, hevcasm_instruction_set mask)
+{
+	*hevcasm_get_deblock_bs(table, 0) = 0;
+	*hevcasm_get_deblock_bs(table, 1) = 0;
+
+	if (mask & (HEVCASM_C_REF | HEVCASM_C_OPT))
+	{
+		*hevcasm_get_deblock_bs(table, 0) = hevcasm_deblock_bs_v_c_ref;
+		*hevcasm_get_deblock_bs(table, 1) = hevcasm_deblock_bs_h_c_ref;
+	}
+
+#ifdef HEVCASM_X64
+	if (mask & HEVCASM_SSE41)
+	{
+		*hevcasm_get_deblock_bs(table, 0) = hevcasm_deblock_bs_v_4n_sse4;
+		*hevcasm_get_deblock_bs(table, 1) = hevcasm_deblock_bs_h_4n_sse4;
+	}
+
+	if (mask & HEVCASM_AVX2)
+	{
+		*hevcasm_get_deblock_bs(table, 0) = hevcasm_deblock_bs_v_avx2;
+		*hevcasm_get_deblock_bs(table, 1) = hevcasm_deblock_bs_h_avx2;
+	}
+#endif
+}
+
+
+void HEVCASM_API hevcasm_deblock_bs_ctu(hevcasm_table_deblock_bs *table, uint8_t *bs[2], ptrdiff_t stride_bs, const hevcasm_deblock_metadata *metadata, int log2CtuSize)
+{
+	const int n = 1 << (log2CtuSize - 2);
+
+	for (int y = 0; y < n; ++y)
+	{
+		uint8_t *ver = &bs[0][y * stride_bs];
+		uint8_t *hor = &bs[1][y * stride_bs];
+
+		(*hevcasm_static_get_deblock_bs(table, 0))(ver, metadata, y * metadata->stride, n);
+		for (int x = 1; x < n; x += 2) ver[x] = 0;
+
+		if (y & 1)
+		{
+			memset(hor, 0, n);
+		}
+		else
+		{
+			(*hevcasm_static_get_deblock_bs(table, 1))(hor, metadata, y * metadata->stride, n);
+		}
+	}
+}
+
+
+/* test picture: 8x8 grid of 8x8 blocks with a margin of 8 samples, every block edge filtered */
+#define DEBLOCK_TEST_STRIDE 80
+#define DEBLOCK_TEST_SEGMENTS 64
+
+
+static void deblock_test_picture(uint8_t *src)
+{
+	for (int by = 0; by < DEBLOCK_TEST_STRIDE / 8; ++by)
+	{
+		for (int bx = 0; bx < DEBLOCK_TEST_STRIDE / 8; ++bx)
+		{
+			/* flat and textured blocks with small and large steps between them, some close to the clipping limits */
+			static const int amplitude[5] = { 0, 1, 2, 4, 16 };
+			const int a = amplitude[hevcasm_test_rand() % 5];
+			const int level = hevcasm_test_rand() % 8 ? 96 + hevcasm_test_rand() % 64 : (hevcasm_test_rand() & 1) ? 2 : 253;
+			const int ramp = hevcasm_test_rand() % 3 - 1;
+
+			for (int y = 0; y < 8; ++y)
+			{
+				for (int x = 0; x < 8; ++x)
+				{
+					const int noise = a ? hevcasm_test_rand() % (2 * a + 1) - a : 0;
+					src[(8 * by + y) * DEBLOCK_TEST_STRIDE + 8 * bx + x] = clip1(level + ramp * (x + y) + noise);
+				}
+			}
+		}
+	}
+}
+
+
+static uint8_t *deblock_test_segment(uint8_t *dst, int i)
+{
+	const int x = 8 + 8 * (i % 8);
+	const int y = 8 + 8 * (i / 8);
+	return &dst[y * DEBLOCK_TEST_STRIDE + x];
+}
+
+
+typedef struct
+{
+	HEVCASM_ALIGN(32, uint8_t, src[DEBLOCK_TEST_STRIDE * DEBLOCK_TEST_STRIDE]);
+	HEVCASM_ALIGN(32, uint8_t, dst[DEBLOCK_TEST_STRIDE * DEBLOCK_TEST_STRIDE]);
+	int edge;
+	int beta[DEBLOCK_TEST_SEGMENTS];
+	int tc[DEBLOCK_TEST_SEGMENTS][2];
+	hevcasm_deblock_luma *f;
+}
+bound_deblock_luma;
+
+
+int init_deblock_luma(void *p, hevcasm_instruction_set mask)
+{
+	bound_deblock_luma *s = p;
+
+	hevcasm_table_deblock_luma table;
+	hevcasm_populate_deblock_luma(&table, mask);
+	hevcasm_deblock_luma **entry = hevcasm_get_deblock_luma(&table, s->edge);
+	hevcasm_test_report_kernel(&table, sizeof(table), entry);
+	s->f = *entry;
+
+	if (mask == HEVCASM_C_REF) hevcasm_test_printf("\t%s edges : ", s->edge ? "horizontal" : "vertical");
+
+	return !!s->f;
+}
+
+
+void invoke_deblock_luma(void *p, int n)
+{
+	bound_deblock_luma *s = p;
+	while (n--)
+	{
+		memcpy(s->dst, s->src, sizeof(s->dst));
+		for (int i = 0; i < DEBLOCK_TEST_SEGMENTS; ++i)
+		{
+			s->f(deblock_test_segment(s->dst, i), DEBLOCK_TEST_STRIDE, s->beta[i], s->tc[i]);
+		}
+	}
+}
+
+
+int mismatch_deblock_luma(void *boundRef, void *boundTest)
+{
+	bound_deblock_luma *ref = boundRef;
+	bound_deblock_luma *test = boundTest;
+
+	return memcmp(ref->dst, test->dst, sizeof(ref->dst));
+}
+
+
+void HEVCASM_API hevcasm_test_deblock_luma(int *error_count, hevcasm_instruction_set mask)
+{
+	hevcasm_test_printf("\nhevcasm_deblock_luma - Luma deblocking filter, 8-sample edge segments\n");
+
+	bound_deblock_luma b[2];
+
+	deblock_test_picture(b[0].src);
+
+	for (int i = 0; i < DEBLOCK_TEST_SEGMENTS; ++i)
+	{
+		const int qp = hevcasm_test_rand() % 52;
+		b[0].beta[i] = hevcasm_deblock_beta(qp, 0);
+		b[0].tc[i][0] = hevcasm_deblock_tc(qp, hevcasm_test_rand() % 3, 0);
+		b[0].tc[i][1] = hevcasm_deblock_tc(qp, hevcasm_test_rand() % 3, 0);
+	}
+
+	for (b[0].edge = 0; b[0].edge < 2; ++b[0].edge)
+	{
+		b[1] = b[0];
+		*error_count += hevcasm_test(&b[0], &b[1], init_deblock_luma, invoke_deblock_luma, mismatch_deblock_luma, mask, 1000);
+	}
+}
+
+
+typedef struct
+{
+	HEVCASM_ALIGN(32, uint8_t, src[DEBLOCK_TEST_STRIDE * DEBLOCK_TEST_STRIDE]);
+	HEVCASM_ALIGN(32, uint8_t, dst[DEBLOCK_TEST_STRIDE * DEBLOCK_TEST_STRIDE]);
+	int edge;
+	int tc[DEBLOCK_TEST_SEGMENTS][2];
+	hevcasm_deblock_chroma *f;
+}
+bound_deblock_chroma;
+
+
+int init_deblock_chroma(void *p, hevcasm_instruction_set mask)
+{
+	bound_deblock_chroma *s = p;
+
+	hevcasm_table_deblock_chroma table;
+	hevcasm_populate_deblock_chroma(&table, mask);
+	hevcasm_deblock_chroma **entry = hevcasm_get_deblock_chroma(&table, s->edge);
+	hevcasm_test_report_kernel(&table, sizeof(table), entry);
+	s->f = *entry;
+
+	if (mask == HEVCASM_C_REF) hevcasm_test_printf("\t%s edges : ", s->edge ? "horizontal" : "vertical");
+
+	return !!s->f;
+}
+
+
+void invoke_deblock_chroma(void *p, int n)
+{
+	bound_deblock_chroma *s = p;
+	while (n--)
+	{
+		memcpy(s->dst, s->src, sizeof(s->dst));
+		for (int i = 0; i < DEBLOCK_TEST_SEGMENTS; ++i)
+		{
+			s->f(deblock_test_segment(s->dst, i), DEBLOCK_TEST_STRIDE, s->tc[i]);
+		}
+	}
+}
+
+
+int mismatch_deblock_chroma(void *boundRef, void *boundTest)
+{
+	bound_deblock_chroma *ref = boundRef;
+	bound_deblock_chroma *test = boundTest;
+
+	return memcmp(ref->dst, test->dst, sizeof(ref->dst));
+}
+
+
+void HEVCASM_API hevcasm_test_deblock_chroma(int *error_count, hevcasm_instruction_set mask)
+{
+	hevcasm_test_printf("\nhevcasm_deblock_chroma - Chroma deblocking filter, 8-sample edge segments\n");
+
+	bound_deblock_chroma b[2];
+
+	deblock_test_picture(b[0].src);
+
+	for (int i = 0; i < DEBLOCK_TEST_SEGMENTS; ++i)
+	{
+		const int qp = hevcasm_test_rand() % 52;
+		b[0].tc[i][0] = hevcasm_deblock_tc(qp, hevcasm_test_rand() % 2 ? 2 : 0, 0);
+		b[0].tc[i][1] = hevcasm_deblock_tc(qp, hevcasm_test_rand() % 2 ? 2 : 0, 0);
+	}
+
+	for (b[0].edge = 0; b[0].edge < 2; ++b[0].edge)
+	{
+		b[1] = b[0];
+		*error_count += hevcasm_test(&b[0], &b[1], init_deblock_chroma, invoke_deblock_chroma, mismatch_deblock_chroma, mask, 1000);
+	}
+}
+
+#undef DEBLOCK_TEST_STRIDE
+#undef DEBLOCK_TEST_SEGMENTS
+
+
+/* metadata of a 64x64 area and its left and top neighbours, 17x17 blocks */
+#define DEBLOCK_TEST_BLOCKS 17
+
+typedef struct
+{
+	uint8_t flags[DEBLOCK_TEST_BLOCKS * DEBLOCK_TEST_BLOCKS];
+	int8_t ref[2][DEBLOCK_TEST_BLOCKS * DEBLOCK_TEST_BLOCKS];
+	int32_t mv[2][DEBLOCK_TEST_BLOCKS * DEBLOCK_TEST_BLOCKS];
+	hevcasm_deblock_metadata metadata;
+	int log2CtuSize;
+	hevcasm_table_deblock_bs table;
+	uint8_t bs[2][16 * 16];
+}
+bound_deblock_bs;
+
+
+static int32_t deblock_test_mv(void)
+{
+	const int16_t x = hevcasm_test_rand() % 4 ? hevcasm_test_rand() % 17 - 8 : hevcasm_test_rand() & 1 ? 32767 : -32768;
+	const int16_t y = hevcasm_test_rand() % 4 ? hevcasm_test_rand() % 17 - 8 : hevcasm_test_rand() & 1 ? 32767 : -32768;
+	return (int32_t)(((uint32_t)(uint16_t)y << 16) | (uint16_t)x);
+}
+
+
+static void deblock_test_metadata(bound_deblock_bs *s)
+{
+	/* 8x8 prediction units aligned to the CTU, whose top-left block is at (1, 1); many repeat their neighbour's
+	   motion so that all bS rules are exercised */
+#define DEBLOCK_TEST_PU(x, y) (((y) < 0 ? 0 : (y)) * DEBLOCK_TEST_BLOCKS + ((x) < 0 ? 0 : (x)))
+	for (int y = -1; y < DEBLOCK_TEST_BLOCKS; y += 2)
+	{
+		for (int x = -1; x < DEBLOCK_TEST_BLOCKS; x += 2)
+		{
+			const int copy = hevcasm_test_rand() % 8;
+			const int j = copy < 3 && x > 0 ? DEBLOCK_TEST_PU(x - 2, y) : copy < 6 && y > 0 ? DEBLOCK_TEST_PU(x, y - 2) : -1;
+			int8_t ref[2];
+			int32_t mv[2];
+
+			if (j >= 0)
+			{
+				for (int list = 0; list < 2; ++list)
+				{
+					ref[list] = s->ref[list][j];
+					mv[list] = s->mv[list][j];
+					if (ref[list] < 0) continue;
+					switch (hevcasm_test_rand() % 8)
+					{
+					case 0: mv[list] = (mv[list] & ~0xffff) | (uint16_t)((int16_t)mv[list] + hevcasm_test_rand() % 9 - 4); break;
+					case 1: mv[list] = (int32_t)((uint32_t)mv[list] + ((uint32_t)(hevcasm_test_rand() % 9 - 4) << 16)); break;
+					case 2: mv[list] ^= 0xffff; break;
+					case 3: mv[list] = (int32_t)((uint32_t)mv[list] ^ 0xffff0000); break;
+					case 4: mv[list] = (int32_t)((uint32_t)mv[list] ^ 0xffffffff); break;
+					}
+				}
+				if (hevcasm_test_rand() % 4 == 0)
+				{
+					/* same motion, lists swapped */
+					const int8_t t = ref[0]; ref[0] = ref[1]; ref[1] = t;
+					const int32_t u = mv[0]; mv[0] = mv[1]; mv[1] = u;
+				}
+			}
+			else
+			{
+				const int lists = 1 + hevcasm_test_rand() % 3;
+				for (int list = 0; list < 2; ++list)
+				{
+					ref[list] = (lists >> list) & 1 ? hevcasm_test_rand() % 2 : -1;
+					mv[list] = ref[list] >= 0 ? deblock_test_mv() : 0;
+				}
+			}
+
+			const int intra = hevcasm_test_rand() % 8 == 0;
+			for (int k = 0; k < 4; ++k)
+			{
+				const int xk = x + (k & 1);
+				const int yk = y + (k >> 1);
+				if (xk < 0 || yk < 0 || xk >= DEBLOCK_TEST_BLOCKS || yk >= DEBLOCK_TEST_BLOCKS) continue;
+				const int ik = yk * DEBLOCK_TEST_BLOCKS + xk;
+				int flags = intra ? HEVCASM_DEBLOCK_INTRA : 0;
+				if (hevcasm_test_rand() % 4 == 0) flags |= HEVCASM_DEBLOCK_CBF;
+				if ((xk & 1) && hevcasm_test_rand() % 8) flags |= HEVCASM_DEBLOCK_EDGE_LEFT | (hevcasm_test_rand() & 1 ? HEVCASM_DEBLOCK_TU_EDGE_LEFT : 0);
+				if ((yk & 1) && hevcasm_test_rand() % 8) flags |= HEVCASM_DEBLOCK_EDGE_TOP | (hevcasm_test_rand() & 1 ? HEVCASM_DEBLOCK_TU_EDGE_TOP : 0);
+				s->flags[ik] = (uint8_t)flags;
+				s->ref[0][ik] = intra ? -1 : ref[0];
+				s->ref[1][ik] = intra ? -1 : ref[1];
+				s->mv[0][ik] = intra ? 0 : mv[0];
+				s->mv[1][ik] = intra ? 0 : mv[1];
+			}
+		}
+	}
+#undef DEBLOCK_TEST_PU
+}
+
+
+int init_deblock_bs(void *p, hevcasm_instruction_set mask)
+{
+	bound_deblock_bs *s = p;
+
+	hevcasm_populate_deblock_bs(&s->table, mask);
+
+	s->metadata.flags = &s->flags[DEBLOCK_TEST_BLOCKS + 1];
+	s->metadata.ref[0] = &s->ref[0][DEBLOCK_TEST_BLOCKS + 1];
+	s->metadata.ref[1] = &s->ref[1][DEBLOCK_TEST_BLOCKS + 1];
+	s->metadata.mv[0] = &s->mv[0][DEBLOCK_TEST_BLOCKS + 1];
+	s->metadata.mv[1] = &s->mv[1][DEBLOCK_TEST_BLOCKS + 1];
+	s->metadata.stride = DEBLOCK_TEST_BLOCKS;
+
+	if (mask == HEVCASM_C_REF) hevcasm_test_printf("\t%dx%d CTUs : ", 1 << s->log2CtuSize, 1 << s->log2CtuSize);
+
+	return !!*hevcasm_get_deblock_bs(&s->table, 0);
+}
+
+
+void invoke_deblock_bs(void *p, int n)
+{
+	bound_deblock_bs *s = p;
+	const int blocks = 1 << (s->log2CtuSize - 2);
+	while (n--)
+	{
+		/* all CTUs of a 64x64 area */
+		for (int y = 0; y < 16; y += blocks)
+		{
+			for (int x = 0; x < 16; x += blocks)
+			{
+				const ptrdiff_t offset = y * DEBLOCK_TEST_BLOCKS + x;
+				hevcasm_deblock_metadata metadata = s->metadata;
+				metadata.flags += offset;
+				metadata.ref[0] += offset;
+				metadata.ref[1] += offset;
+				metadata.mv[0] += offset;
+				metadata.mv[1] += offset;
+				uint8_t *bs[2] = { &s->bs[0][16 * y + x], &s->bs[1][16 * y + x] };
+				hevcasm_deblock_bs_ctu(&s->table, bs, 16, &metadata, s->log2CtuSize);
+			}
+		}
+	}
+}
+
+
+int mismatch_deblock_bs(void *boundRef, void *boundTest)
+{
+	bound_deblock_bs *ref = boundRef;
+	bound_deblock_bs *test = boundTest;
+
+	return memcmp(ref->bs, test->bs, sizeof(ref->bs));
+}
+
+
+void HEVCASM_API hevcasm_test_deblock_bs(int *error_count, hevcasm_instruction_set mask)
+{
+	hevcasm_test_printf("\nhevcasm_deblock_bs - Deblocking boundary strength of a CTU\n");
+
+	bound_deblock_bs b[2];
+
+	deblock_test_metadata(&b[0]);
+
+	for (b[0].log2CtuSize = 4; b[0].log2CtuSize <= 6; ++b[0].log2CtuSize)
+	{
+		b[1] = b[0];
+		*error_count += hevcasm_test(&b[0], &b[1], init_deblock_bs, invoke_deblock_bs, mismatch_deblock_bs, mask, 10000);
+	}
+}
+
+#undef DEBLOCK_TEST_BLOCKS
@@ -0,0 +1,163 @@
+/*
+The copyright in this software is being made available under the BSD
+License, included below. This software may be subject to other third party
+and contributor rights, including patent rights, and no such rights are
+granted under this license.
+
+
+Copyright(c) 2011 - 2015, Parabola Research Limited
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met :
+
+* Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+this list of conditions and the following disclaimer in the documentation
+and / or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its contributors may
+be used to endorse or promote products derived from this software without
+specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/* HEVC deblocking filter (8-bit) */
+
+
+#ifndef INCLUDED_deblock_h
+#define INCLUDED_deblock_h
+
+#include "hevcasm.h"
+
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+// Edge filters operate on one 8-sample segment of an edge. src points to the first q0 sample: for a vertical edge
+// (edge == 0) p samples are to the left, for a horizontal edge (edge == 1) p samples are above. tc[i] is tC for
+// lines 4i to 4i+3 of the segment and is zero where bS is zero. Samples of PCM or transquant-bypass blocks that
+// must not be filtered are the responsibility of the caller.
+
+
+/* Luma: per four lines, decisions dE, dEp and dEq followed by the strong or normal filter */
+typedef void hevcasm_deblock_luma(uint8_t *src, ptrdiff_t stride, int beta, const int tc[2]);
+
+typedef struct
+{
+	hevcasm_deblock_luma *p[2];
+}
+hevcasm_table_deblock_luma;
+
+static hevcasm_deblock_luma** hevcasm_get_deblock_luma(hevcasm_table_deblock_luma *table, int edge)
+{
+	return &table->p[edge];
+}
+
+void HEVCASM_API hevcasm_populate_deblock_luma(hevcasm_table_deblock_luma *table, hevcasm_instruction_set mask);
+
+void HEVCASM_API hevcasm_test_deblock_luma(int *error_count, hevcasm_instruction_set mask);
+
+
+/* Chroma: edges with bS equal to 2 only */
+typedef void hevcasm_deblock_chroma(uint8_t *src, ptrdiff_t stride, const int tc[2]);
+
+typedef struct
+{
+	hevcasm_deblock_chroma *p[2];
+}
+hevcasm_table_deblock_chroma;
+
+static hevcasm_deblock_chroma** hevcasm_get_deblock_chroma(hevcasm_table_deblock_chroma *table, int edge)
+{
+	return &table->p[edge];
+}
+
+void HEVCASM_API hevcasm_populate_deblock_chroma(hevcasm_table_deblock_chroma *table, hevcasm_instruction_set mask);
+
+void HEVCASM_API hevcasm_test_deblock_chroma(int *error_count, hevcasm_instruction_set mask);
+
+
+/* Boundary strength (bS) */
+
+// Per-4x4 block flags
+#define HEVCASM_DEBLOCK_INTRA 0x1 /* block is in an intra CU */
+#define HEVCASM_DEBLOCK_CBF 0x2 /* block is in a luma transform block with non-zero coefficients */
+#define HEVCASM_DEBLOCK_EDGE_LEFT 0x4 /* left boundary is a prediction or transform block edge to be filtered */
+#define HEVCASM_DEBLOCK_TU_EDGE_LEFT 0x8 /* left boundary is a transform block edge */
+#define HEVCASM_DEBLOCK_EDGE_TOP 0x10 /* top boundary is a prediction or transform block edge to be filtered */
+#define HEVCASM_DEBLOCK_TU_EDGE_TOP 0x20 /* top boundary is a transform block edge */
+
+// Per-4x4 block metadata in structure-of-arrays layout. All arrays share one stride (in blocks) and must include the
+// column to the left of and the row above the area processed. ref[] identifies the reference picture used by each
+// list (same picture, same value regardless of list or index) and is negative where the list is unused, in which
+// case the corresponding mv[] must be zero. Motion vectors are packed as (y << 16) | (x & 0xffff), quarter samples.
+// Edge flags should be set only on the 8x8 luma grid and cleared where filtering is disabled (picture, slice and
+// tile boundaries as signalled).
+typedef struct
+{
+	const uint8_t *flags;
+	const int8_t *ref[2];
+	const int32_t *mv[2];
+	ptrdiff_t stride;
+}
+hevcasm_deblock_metadata;
+
+// Computes bS of the left (edge == 0) or top (edge == 1) boundary of n consecutive blocks in a row, starting at
+// block offset of the metadata arrays. n is a multiple of 4.
+typedef void hevcasm_deblock_bs(uint8_t *bs, const hevcasm_deblock_metadata *metadata, ptrdiff_t offset, int n);
+
+typedef struct
+{
+	hevcasm_deblock_bs *p[2];
+}
+hevcasm_table_deblock_bs;
+
+static hevcasm_deblock_bs** hevcasm_get_deblock_bs(hevcasm_table_deblock_bs *table, int edge)
+{
+	return &table->p[edge];
+}
+
+void HEVCASM_API hevcasm_populate_deblock_bs(hevcasm_table_deblock_bs *table, hevcasm_instruction_set mask);
+
+void HEVCASM_API hevcasm_test_deblock_bs(int *error_count, hevcasm_instruction_set mask);
+
+#ifdef HEVCASM_X64
+hevcasm_deblock_bs hevcasm_deblock_bs_v_4n_sse4;
+hevcasm_deblock_bs hevcasm_deblock_bs_h_4n_sse4;
+hevcasm_deblock_bs hevcasm_deblock_bs_v_avx2;
+hevcasm_deblock_bs hevcasm_deblock_bs_h_avx2;
+#endif
+
+// bS maps of one CTU whose top-left block is at metadata offset zero. bs[0] receives bS of vertical edges and
+// bs[1] of horizontal edges, one byte per 4x4 block and its left or top boundary; entries not on the 8x8 grid are
+// zero.
+void HEVCASM_API hevcasm_deblock_bs_ctu(hevcasm_table_deblock_bs *table, uint8_t *bs[2], ptrdiff_t stride_bs, const hevcasm_deblock_metadata *metadata, int log2CtuSize);
+
+
+// Thresholds (Table 8-11). qp is QpL, the average QP of the blocks either side of the edge (for chroma, QpC);
+// beta_offset and tc_offset are slice_beta_offset_div2 * 2 and slice_tc_offset_div2 * 2.
+int HEVCASM_API hevcasm_deblock_beta(int qp, int beta_offset);
+
+int HEVCASM_API hevcasm_deblock_tc(int qp, int bS, int tc_offset);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
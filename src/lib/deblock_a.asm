@@ -0,0 +1,651 @@
+; The copyright in this software is being made available under the BSD
+; License, included below. This software may be subject to other third party
+; and contributor rights, including patent rights, and no such rights are
+; granted under this license.
+; 
+; 
+; Copyright(c) 2011 - 2015, Parabola Research Limited
+; All rights reserved.
+; 
+; Redistribution and use in source and binary forms, with or without
+; modification, are permitted provided that the following conditions are met :
+; 
+; * Redistributions of source code must retain the above copyright notice,
+; this list of conditions and the following disclaimer.
+; * Redistributions in binary form must reproduce the above copyright notice,
+; this list of conditions and the following disclaimer in the documentation
+; and / or other materials provided with the distribution.
+; * Neither the name of the copyright holder nor the names of its contributors may
+; be used to endorse or promote products derived from this software without
+; specific prior written permission.
+; 
+; THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+; AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+; IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+; ARE DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+; BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+; CONSEQUENTIAL DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+; SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+; INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+; CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE)
+; ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+; THE POSSIBILITY OF SUCH DAMAGE.
+
+
+%define private_prefix hevcasm
+%include "x86inc.asm"
+
+
+%if ARCH_X86_64 == 1
+
+SECTION_RODATA 32
+
+%macro CONSTANT 3
+	constant_times_%1_%2_%3:
+		times %1 %2 %3
+%endmacro
+
+CONSTANT 8, dw, 1
+CONSTANT 8, dw, 2
+CONSTANT 8, dw, 4
+CONSTANT 8, dw, 8
+CONSTANT 8, dw, 0xffff
+CONSTANT 16, dw, 3
+CONSTANT 8, dd, 1
+CONSTANT 8, dd, 2
+CONSTANT 8, dd, 0x4
+CONSTANT 8, dd, 0x8
+CONSTANT 8, dd, 0x10
+CONSTANT 8, dd, 0x20
+
+constant_interleave_qwords:
+	db 0, 8, 1, 9, 2, 10, 3, 11, 4, 12, 5, 13, 6, 14, 7, 15
+
+
+SECTION .text
+
+
+; %1 = %1 ^ ((%1 ^ %2) & %3): selects words of %2 where mask %3 is set, destroys %2
+%macro BLEND 3
+	pxor %2, %1
+	pand %2, %3
+	pxor %1, %2
+%endmacro
+
+
+; %1 = %2 + Clip3(%4, %3, %1 - %2)
+%macro CLIP_AROUND 4
+	psubw %1, %2
+	pminsw %1, %3
+	pmaxsw %1, %4
+	paddw %1, %2
+%endmacro
+
+
+; %1 = %1 + Clip3(-(tc >> 1), tc >> 1, (((%2 + %3 + 1) >> 1) - %1 +/- delta) >> 1) where %4 is paddw or psubw
+; m12 is delta, m14 is tc, uses m11 and m15
+%macro LUMA_NORMAL_SIDE 4
+	mova m11, %2
+	pavgw m11, %3
+	psubw m11, %1
+	%4 m11, m12
+	psraw m11, 1
+	mova m15, m14
+	psraw m15, 1
+	pminsw m11, m15
+	psignw m15, [constant_times_8_dw_0xffff]
+	pmaxsw m11, m15
+	paddw m11, %1
+%endmacro
+
+
+; on entry, m0-m7 are words p3, p2, p1, p0, q0, q1, q2, q3 with one line per word, r2d is beta and r3 points to tc[2]
+; on exit, m1-m6 are filtered; jumps to .done if no line is filtered; uses r4 and m8-m15
+%macro LUMA_FILTER 0
+	movd m15, r2d
+	pshuflw m15, m15, 0
+	punpcklqdq m15, m15 ; beta
+
+	movq m14, [r3]
+	packssdw m14, m14
+	punpcklwd m14, m14
+	punpckldq m14, m14 ; tc for lines 0-3 and 4-7
+
+	; dp and dq of each line
+	mova m8, m1
+	paddw m8, m3
+	psubw m8, m2
+	psubw m8, m2
+	pabsw m8, m8
+	mova m9, m6
+	paddw m9, m4
+	psubw m9, m5
+	psubw m9, m5
+	pabsw m9, m9
+
+	; dp = dp0 + dp3 and dq = dq0 + dq3, broadcast to the four lines of each half
+	pshuflw m10, m8, q0123
+	pshufhw m10, m10, q0123
+	paddw m10, m8
+	pshuflw m10, m10, q0000
+	pshufhw m10, m10, q0000
+	pshuflw m11, m9, q0123
+	pshufhw m11, m11, q0123
+	paddw m11, m9
+	pshuflw m11, m11, q0000
+	pshufhw m11, m11, q0000
+
+	; dE != 0 where d < beta
+	mova m13, m10
+	paddw m13, m11
+	mova m12, m15
+	pcmpgtw m12, m13
+	pmovmskb r4d, m12
+	test r4d, r4d
+	jz .done
+
+	; first strong filter condition: 2 * dpq < (beta >> 2)
+	paddw m8, m9
+	paddw m8, m8
+	mova m9, m15
+	psraw m9, 2
+	pcmpgtw m9, m8
+
+	; dEp and dEq
+	mova m13, m15
+	psraw m13, 1
+	paddw m13, m15
+	psraw m13, 3
+	mova m8, m13
+	pcmpgtw m8, m10
+	pcmpgtw m13, m11
+
+	; |p3 - p0| + |q0 - q3| < (beta >> 3)
+	mova m10, m0
+	psubw m10, m3
+	pabsw m10, m10
+	mova m11, m4
+	psubw m11, m7
+	pabsw m11, m11
+	paddw m10, m11
+	mova m11, m15
+	psraw m11, 3
+	pcmpgtw m11, m10
+	pand m9, m11
+
+	; |p0 - q0| < ((5 * tc + 1) >> 1)
+	mova m10, m3
+	psubw m10, m4
+	pabsw m10, m10
+	mova m11, m14
+	psllw m11, 2
+	paddw m11, m14
+	paddw m11, [constant_times_8_dw_1]
+	psraw m11, 1
+	pcmpgtw m11, m10
+	pand m9, m11
+
+	; dE == 2 where lines 0 and 3 both meet the strong conditions
+	pshuflw m10, m9, q0123
+	pshufhw m10, m10, q0123
+	pand m9, m10
+	pshuflw m9, m9, q0000
+	pshufhw m9, m9, q0000
+
+	pand m9, m12 ; strong
+	mova m10, m9
+	pandn m10, m12 ; normal
+
+	pmovmskb r4d, m10
+	test r4d, r4d
+	jz .strong
+
+	; normal filter: delta = (9 * (q0 - p0) - 3 * (q1 - p1) + 8) >> 4
+	mova m11, m4
+	psubw m11, m3
+	mova m12, m11
+	psllw m12, 3
+	paddw m12, m11
+	mova m11, m5
+	psubw m11, m2
+	mova m15, m11
+	paddw m15, m11
+	paddw m15, m11
+	psubw m12, m15
+	paddw m12, [constant_times_8_dw_8]
+	psraw m12, 4
+
+	; lines with |delta| < tc * 10
+	pabsw m11, m12
+	mova m15, m14
+	psllw m15, 2
+	paddw m15, m14
+	paddw m15, m15
+	pcmpgtw m15, m11
+	pand m10, m15
+
+	pminsw m12, m14
+	pxor m11, m11
+	psubw m11, m14
+	pmaxsw m12, m11
+
+	pand m8, m10
+	pand m13, m10
+
+	LUMA_NORMAL_SIDE m2, m1, m3, paddw
+	BLEND m2, m11, m8
+	LUMA_NORMAL_SIDE m5, m6, m4, psubw
+	BLEND m5, m11, m13
+
+	mova m11, m3
+	paddw m11, m12
+	BLEND m3, m11, m10
+	mova m11, m4
+	psubw m11, m12
+	BLEND m4, m11, m10
+
+.strong:
+	pmovmskb r4d, m9
+	test r4d, r4d
+	jz .filtered
+
+	paddw m14, m14
+	mova m15, m14
+	psignw m15, [constant_times_8_dw_0xffff]
+
+	mova m10, m2
+	paddw m10, m3
+	paddw m10, m4 ; p1 + p0 + q0
+	mova m11, m3
+	paddw m11, m4
+	paddw m11, m5 ; p0 + q0 + q1
+
+	; q0' = (p1 + 2 * p0 + 2 * q0 + 2 * q1 + q2 + 4) >> 3
+	mova m12, m11
+	paddw m12, m11
+	paddw m12, m2
+	paddw m12, m6
+	paddw m12, [constant_times_8_dw_4]
+	psraw m12, 3
+	CLIP_AROUND m12, m4, m14, m15
+
+	; p1' = (p2 + p1 + p0 + q0 + 2) >> 2
+	mova m13, m10
+	paddw m13, m1
+	paddw m13, [constant_times_8_dw_2]
+	psraw m13, 2
+	CLIP_AROUND m13, m2, m14, m15
+
+	; p0' = (p2 + 2 * p1 + 2 * p0 + 2 * q0 + q1 + 4) >> 3
+	mova m8, m10
+	paddw m8, m10
+	paddw m8, m1
+	paddw m8, m5
+	paddw m8, [constant_times_8_dw_4]
+	psraw m8, 3
+	CLIP_AROUND m8, m3, m14, m15
+
+	; p2' = (2 * p3 + 3 * p2 + p1 + p0 + q0 + 4) >> 3
+	paddw m10, m0
+	paddw m10, m0
+	paddw m10, m1
+	paddw m10, m1
+	paddw m10, m1
+	paddw m10, [constant_times_8_dw_4]
+	psraw m10, 3
+	CLIP_AROUND m10, m1, m14, m15
+
+	BLEND m1, m10, m9
+	BLEND m2, m13, m9
+	BLEND m3, m8, m9
+
+	; q1' = (p0 + q0 + q1 + q2 + 2) >> 2
+	mova m10, m11
+	paddw m10, m6
+	paddw m10, [constant_times_8_dw_2]
+	psraw m10, 2
+	CLIP_AROUND m10, m5, m14, m15
+
+	; q2' = (p0 + q0 + q1 + 3 * q2 + 2 * q3 + 4) >> 3
+	paddw m11, m6
+	paddw m11, m6
+	paddw m11, m6
+	paddw m11, m7
+	paddw m11, m7
+	paddw m11, [constant_times_8_dw_4]
+	psraw m11, 3
+	CLIP_AROUND m11, m6, m14, m15
+
+	BLEND m4, m12, m9
+	BLEND m5, m10, m9
+	BLEND m6, m11, m9
+
+.filtered:
+%endmacro
+
+
+INIT_XMM sse4
+
+; void hevcasm_deblock_luma_h_sse4(uint8_t *src, ptrdiff_t stride, int beta, const int tc[2]);
+cglobal deblock_luma_h, 4, 6, 16
+	lea r4, [r1 * 3]
+	mov r5, r0
+	sub r0, r4
+	sub r0, r1
+	pmovzxbw m0, [r0]
+	pmovzxbw m1, [r0 + r1]
+	pmovzxbw m2, [r0 + 2 * r1]
+	pmovzxbw m3, [r0 + r4]
+	pmovzxbw m4, [r5]
+	pmovzxbw m5, [r5 + r1]
+	pmovzxbw m6, [r5 + 2 * r1]
+	pmovzxbw m7, [r5 + r4]
+
+	LUMA_FILTER
+
+	lea r4, [r1 * 3]
+	packuswb m1, m1
+	packuswb m2, m2
+	packuswb m3, m3
+	packuswb m4, m4
+	packuswb m5, m5
+	packuswb m6, m6
+	movq [r0 + r1], m1
+	movq [r0 + 2 * r1], m2
+	movq [r0 + r4], m3
+	movq [r5], m4
+	movq [r5 + r1], m5
+	movq [r5 + 2 * r1], m6
+.done:
+	RET
+
+
+; void hevcasm_deblock_luma_v_sse4(uint8_t *src, ptrdiff_t stride, int beta, const int tc[2]);
+cglobal deblock_luma_v, 4, 6, 16
+	sub r0, 4
+	lea r4, [r1 * 3]
+	lea r5, [r0 + 4 * r1]
+	movq m0, [r0]
+	movq m1, [r0 + r1]
+	movq m2, [r0 + 2 * r1]
+	movq m3, [r0 + r4]
+	movq m4, [r5]
+	movq m5, [r5 + r1]
+	movq m6, [r5 + 2 * r1]
+	movq m7, [r5 + r4]
+
+	; transpose so that each register holds one column
+	punpcklbw m0, m1
+	punpcklbw m2, m3
+	punpcklbw m4, m5
+	punpcklbw m6, m7
+	mova m1, m0
+	punpcklwd m0, m2
+	punpckhwd m1, m2
+	mova m5, m4
+	punpcklwd m4, m6
+	punpckhwd m5, m6
+	mova m2, m0
+	punpckldq m0, m4 ; columns 0 and 1
+	punpckhdq m2, m4 ; columns 2 and 3
+	mova m6, m1
+	punpckldq m1, m5 ; columns 4 and 5
+	punpckhdq m6, m5 ; columns 6 and 7
+	pxor m15, m15
+	mova m7, m6
+	punpckhbw m7, m15
+	pmovzxbw m6, m6
+	mova m5, m1
+	punpckhbw m5, m15
+	pmovzxbw m4, m1
+	mova m3, m2
+	punpckhbw m3, m15
+	pmovzxbw m2, m2
+	mova m1, m0
+	punpckhbw m1, m15
+	pmovzxbw m0, m0
+
+	LUMA_FILTER
+
+	; transpose back to rows
+	mova m8, [constant_interleave_qwords]
+	packuswb m0, m1
+	packuswb m2, m3
+	packuswb m4, m5
+	packuswb m6, m7
+	pshufb m0, m8
+	pshufb m2, m8
+	pshufb m4, m8
+	pshufb m6, m8
+	mova m1, m0
+	punpcklwd m0, m2
+	punpckhwd m1, m2
+	mova m3, m4
+	punpcklwd m4, m6
+	punpckhwd m3, m6
+	mova m2, m0
+	punpckldq m0, m4 ; rows 0 and 1
+	punpckhdq m2, m4 ; rows 2 and 3
+	mova m5, m1
+	punpckldq m1, m3 ; rows 4 and 5
+	punpckhdq m5, m3 ; rows 6 and 7
+
+	lea r4, [r1 * 3]
+	movq [r0], m0
+	movhps [r0 + r1], m0
+	movq [r0 + 2 * r1], m2
+	movhps [r0 + r4], m2
+	movq [r5], m1
+	movhps [r5 + r1], m1
+	movq [r5 + 2 * r1], m5
+	movhps [r5 + r4], m5
+.done:
+	RET
+
+
+; on entry, m0-m3 are words p1, p0, q0, q1 with one line per word and r2 points to tc[2]
+; on exit, m1 and m2 are filtered; uses m4-m6
+%macro CHROMA_FILTER 0
+	movq m5, [r2]
+	packssdw m5, m5
+	punpcklwd m5, m5
+	punpckldq m5, m5 ; tc for lines 0-3 and 4-7
+	pxor m6, m6
+	psubw m6, m5
+
+	; delta = Clip3(-tc, tc, ((((q0 - p0) << 2) + p1 - q1 + 4) >> 3))
+	mova m4, m2
+	psubw m4, m1
+	psllw m4, 2
+	paddw m4, m0
+	psubw m4, m3
+	paddw m4, [constant_times_8_dw_4]
+	psraw m4, 3
+	pminsw m4, m5
+	pmaxsw m4, m6
+
+	paddw m1, m4
+	psubw m2, m4
+%endmacro
+
+
+; void hevcasm_deblock_chroma_h_sse4(uint8_t *src, ptrdiff_t stride, const int tc[2]);
+cglobal deblock_chroma_h, 3, 4, 7
+	mov r3, r0
+	sub r3, r1
+	sub r3, r1
+	pmovzxbw m0, [r3]
+	pmovzxbw m1, [r3 + r1]
+	pmovzxbw m2, [r0]
+	pmovzxbw m3, [r0 + r1]
+
+	CHROMA_FILTER
+
+	packuswb m1, m1
+	packuswb m2, m2
+	movq [r3 + r1], m1
+	movq [r0], m2
+	RET
+
+
+; void hevcasm_deblock_chroma_v_sse4(uint8_t *src, ptrdiff_t stride, const int tc[2]);
+cglobal deblock_chroma_v, 3, 5, 8
+	sub r0, 2
+	lea r3, [r1 * 3]
+	lea r4, [r0 + 4 * r1]
+	movd m0, [r0]
+	movd m1, [r0 + r1]
+	movd m2, [r0 + 2 * r1]
+	movd m3, [r0 + r3]
+	movd m4, [r4]
+	movd m5, [r4 + r1]
+	movd m6, [r4 + 2 * r1]
+	movd m7, [r4 + r3]
+
+	; transpose so that each register holds one column
+	punpcklbw m0, m1
+	punpcklbw m2, m3
+	punpcklbw m4, m5
+	punpcklbw m6, m7
+	punpcklwd m0, m2
+	punpcklwd m4, m6
+	mova m2, m0
+	punpckldq m0, m4 ; columns 0 and 1
+	punpckhdq m2, m4 ; columns 2 and 3
+	pxor m7, m7
+	mova m1, m0
+	punpckhbw m1, m7
+	pmovzxbw m0, m0
+	mova m3, m2
+	punpckhbw m3, m7
+	pmovzxbw m2, m2
+
+	CHROMA_FILTER
+
+	; store p0 and q0 of each row
+	packuswb m1, m2
+	pshufb m1, [constant_interleave_qwords]
+	inc r0
+	inc r4
+	pextrw [r0], m1, 0
+	pextrw [r0 + r1], m1, 1
+	pextrw [r0 + 2 * r1], m1, 2
+	pextrw [r0 + r3], m1, 3
+	pextrw [r4], m1, 4
+	pextrw [r4 + r1], m1, 5
+	pextrw [r4 + 2 * r1], m1, 6
+	pextrw [r4 + r3], m1, 7
+	RET
+
+
+; %1 = dword mask of motion vectors %2 and %3 differing by less than 4 in both components; m15 is zero
+%macro MV_SAME 3
+	mova %1, %2
+	psubsw %1, %3
+	pabsw %1, %1
+	psubusw %1, [constant_times_16_dw_3]
+	pcmpeqd %1, m15
+%endmacro
+
+
+; void hevcasm_deblock_bs_%1_%4_xxx(uint8_t *bs, const hevcasm_deblock_metadata *metadata, ptrdiff_t offset, int n);
+; %2 and %3 are the edge and transform edge flags; processes mmsize / 4 blocks per iteration
+%macro DEBLOCK_BS 4
+cglobal deblock_bs_%1_%4, 4, 10, 16
+	mov r4, [r1] ; flags
+	mov r5, [r1 + 8] ; ref[0]
+	mov r6, [r1 + 16] ; ref[1]
+	mov r7, [r1 + 24] ; mv[0]
+	mov r8, [r1 + 32] ; mv[1]
+%ifidn %1, v
+	mov r9, -1
+%else
+	mov r9, [r1 + 40]
+	neg r9
+%endif
+	add r4, r2
+	add r5, r2
+	add r6, r2
+	lea r7, [r7 + 4 * r2]
+	lea r8, [r8 + 4 * r2]
+	pxor m15, m15
+.loop:
+		pmovzxbd m0, [r4]
+		pmovzxbd m1, [r4 + r9]
+		por m1, m0
+		mova m2, m1
+		pand m2, [constant_times_8_dd_1] ; intra, 0 or 1
+		pand m1, [constant_times_8_dd_2]
+		pcmpeqd m1, [constant_times_8_dd_2]
+		mova m3, m0
+		pand m3, [constant_times_8_dd_%3]
+		pcmpeqd m3, [constant_times_8_dd_%3]
+		pand m1, m3 ; transform edge with coefficients
+		pand m0, [constant_times_8_dd_%2]
+		pcmpeqd m0, [constant_times_8_dd_%2] ; edge
+
+		; pairings of reference pictures: P0 == Q0 and P1 == Q1, or P0 == Q1 and P1 == Q0
+		pmovsxbd m3, [r5]
+		pmovsxbd m4, [r6]
+		pmovsxbd m5, [r5 + r9]
+		pmovsxbd m6, [r6 + r9]
+		mova m7, m5
+		pcmpeqd m7, m3
+		mova m8, m6
+		pcmpeqd m8, m4
+		pand m7, m8
+		pcmpeqd m5, m4
+		pcmpeqd m6, m3
+		pand m5, m6
+
+		; unused lists have zero motion vectors so a pairing holds if its motion vectors are all close
+		movu m3, [r7]
+		movu m4, [r8]
+		movu m6, [r7 + 4 * r9]
+		movu m8, [r8 + 4 * r9]
+		MV_SAME m9, m6, m3
+		MV_SAME m10, m8, m4
+		pand m9, m10
+		pand m7, m9
+		MV_SAME m9, m6, m4
+		MV_SAME m10, m8, m3
+		pand m9, m10
+		pand m5, m9
+		por m5, m7 ; motion alone does not require filtering
+
+		; bS = edge ? intra + (intra | cbf | motion) : 0
+		pandn m1, m5
+		pandn m1, [constant_times_8_dd_1]
+		por m1, m2
+		paddd m1, m2
+		pand m1, m0
+		packssdw m1, m1
+		packuswb m1, m1
+%if mmsize == 32
+		vextracti128 xm2, m1, 1
+		movd [r0], xm1
+		movd [r0 + 4], xm2
+%else
+		movd [r0], m1
+%endif
+		add r0, mmsize / 4
+		add r4, mmsize / 4
+		add r5, mmsize / 4
+		add r6, mmsize / 4
+		add r7, mmsize
+		add r8, mmsize
+		sub r3d, mmsize / 4
+		jg .loop
+	RET
+%endmacro
+
+
+INIT_XMM sse4
+DEBLOCK_BS v, 0x4, 0x8, 4n
+DEBLOCK_BS h, 0x10, 0x20, 4n
+
+INIT_YMM avx2
+DEBLOCK_BS v, 0x4, 0x8, 8n
+DEBLOCK_BS h, 0x10, 0x20, 8n
+
+%endif
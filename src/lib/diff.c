@@ -84,7 +84,7 @@ int get_ssd_linear(void *p, hevcasm_instruction_set mask)
 
 	s->f = hevcasm_get_ssd_linear(BLOCK_SIZE, mask);
 
-	if (mask == HEVCASM_C_REF) printf("\t%d:", BLOCK_SIZE);
+	if (mask == HEVCASM_C_REF) hevcasm_test_printf("\t%d:", BLOCK_SIZE);
 
 	return !!s->f;
 }
@@ -111,7 +111,7 @@ int mismatch_ssd_linear(void *boundRef, void *boundTest)
 
 void HEVCASM_API hevcasm_test_ssd_linear(int *error_count, hevcasm_instruction_set mask)
 {
-	printf("\nhevcasm_ssd_linear - Linear Sum of Square Differences\n");
+	hevcasm_test_printf("\nhevcasm_ssd_linear - Linear Sum of Square Differences\n");
 
 	bound_ssd_linear b[2];
 
@@ -119,7 +119,7 @@ void HEVCASM_API hevcasm_test_ssd_linear(int *error_count, hevcasm_instruction_s
 	{
 		for (int x = 0; x < BLOCK_SIZE; ++x)
 		{
-			b[0].data[n][x] = rand();
+			b[0].data[n][x] = hevcasm_test_rand();
 		}
 	}
 
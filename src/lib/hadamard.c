@@ -179,12 +179,14 @@ int init_hadamard_satd(void *p, hevcasm_instruction_set mask)
 
 	hevcasm_populate_hadamard_satd(&table, mask);
 
-	s->f = *hevcasm_get_hadamard_satd(&table, s->log2TrafoSize);
+	hevcasm_hadamard_satd **entry = hevcasm_get_hadamard_satd(&table, s->log2TrafoSize);
+	hevcasm_test_report_kernel(&table, sizeof(table), entry);
+	s->f = *entry;
 
 	if (mask == HEVCASM_C_REF)
 	{
 		const int nCbS = 1 << s->log2TrafoSize;
-		printf("\t%dx%d : ", nCbS, nCbS);
+		hevcasm_test_printf("\t%dx%d : ", nCbS, nCbS);
 	}
 
 	return !!s->f;
@@ -213,15 +215,15 @@ int mismatch_hadamard_satd(void *boundRef, void *boundTest)
 
 void HEVCASM_API hevcasm_test_hadamard_satd(int *error_count, hevcasm_instruction_set mask)
 {
-	printf("\nhevcasm_hadamard_satd - Hadamard Sum of Absolute Transformed Differences\n");
+	hevcasm_test_printf("\nhevcasm_hadamard_satd - Hadamard Sum of Absolute Transformed Differences\n");
 
 	uint8_t  srcA[16 * 8];
 	uint8_t  srcB[16 * 8];
 
 	for (int i = 0; i < 16 * 8; ++i)
 	{
-		srcA[i] = rand() & 0xff;
-		srcB[i] = rand() & 0xff;
+		srcA[i] = hevcasm_test_rand() & 0xff;
+		srcB[i] = hevcasm_test_rand() & 0xff;
 	}
 
 	bound_hadamard_satd b[2];
@@ -235,3 +237,299 @@ void HEVCASM_API hevcasm_test_hadamard_satd(int *error_count, hevcasm_instructio
 		*error_count += hevcasm_test(&b[0], &b[1], init_hadamard_satd, invoke_hadamard_satd, mismatch_hadamard_satd, mask, 100000);
 	}
 }
+
+
+static int hevcasm_satd_c_ref(const uint8_t *srcA, ptrdiff_t stride_srcA, const uint8_t *srcB, ptrdiff_t stride_srcB, uint32_t rect)
+{
+	const int width = rect >> 8;
+	const int height = rect & 0xff;
+	const int n = (width % 8 == 0 && height % 8 == 0) ? 8 : 4;
+
+	int satd = 0;
+	for (int y = 0; y < height; y += n)
+	{
+		for (int x = 0; x < width; x += n)
+		{
+			satd += compute_satd(n, &srcA[x + y * stride_srcA], stride_srcA, &srcB[x + y * stride_srcB], stride_srcB);
+		}
+	}
+	return satd;
+}
+
+
+static void hevcasm_satd_multiref_4_c_ref(const uint8_t *srcA, ptrdiff_t stride_srcA, const uint8_t *srcB[], ptrdiff_t stride_srcB, int satd[], uint32_t rect)
+{
+	for (int way = 0; way < 4; ++way)
+	{
+		satd[way] = hevcasm_satd_c_ref(srcA, stride_srcA, srcB[way], stride_srcB, rect);
+	}
+}
+
+
+#ifdef HEVCASM_X64
+hevcasm_satd hevcasm_satd_8nx8n_sse4;
+hevcasm_satd hevcasm_satd_16nx8n_avx2;
+hevcasm_satd_multiref hevcasm_satd_multiref_4_8nx8n_sse4;
+hevcasm_satd_multiref hevcasm_satd_multiref_4_16nx8n_avx2;
+
+/* shapes that do not tile with 8x8 blocks (e.g. 8x4, 16x12 and 4x16) use the 4x4 kernel */
+static int hevcasm_satd_4nx4n_sse2(const uint8_t *srcA, ptrdiff_t stride_srcA, const uint8_t *srcB, ptrdiff_t stride_srcB, uint32_t rect)
+{
+	const int width = rect >> 8;
+	const int height = rect & 0xff;
+
+	int satd = 0;
+	for (int y = 0; y < height; y += 4)
+	{
+		for (int x = 0; x < width; x += 4)
+		{
+			satd += hevcasm_hadamard_satd_4x4_sse2(&srcA[x + y * stride_srcA], stride_srcA, &srcB[x + y * stride_srcB], stride_srcB);
+		}
+	}
+	return satd;
+}
+
+static void hevcasm_satd_multiref_4_4nx4n_sse2(const uint8_t *srcA, ptrdiff_t stride_srcA, const uint8_t *srcB[], ptrdiff_t stride_srcB, int satd[], uint32_t rect)
+{
+	for (int way = 0; way < 4; ++way)
+	{
+		satd[way] = hevcasm_satd_4nx4n_sse2(srcA, stride_srcA, srcB[way], stride_srcB, rect);
+	}
+}
+#endif
+
+
+static hevcasm_satd *get_satd(int width, int height, hevcasm_instruction_set mask)
+{
+	hevcasm_satd *f = 0;
+
+	if (mask & (HEVCASM_C_REF | HEVCASM_C_OPT))
+	{
+		f = hevcasm_satd_c_ref;
+	}
+
+#ifdef HEVCASM_X64
+	const int tiles8x8 = width % 8 == 0 && height % 8 == 0;
+
+	if (mask & HEVCASM_SSE2)
+	{
+		if (!tiles8x8) f = hevcasm_satd_4nx4n_sse2;
+	}
+
+	if (mask & HEVCASM_SSE41)
+	{
+		if (tiles8x8) f = hevcasm_satd_8nx8n_sse4;
+	}
+
+	if (mask & HEVCASM_AVX2)
+	{
+		if (tiles8x8 && width % 16 == 0) f = hevcasm_satd_16nx8n_avx2;
+	}
+#endif
+
+	return f;
+}
+
+
+void HEVCASM_API hevcasm_populate_satd(hevcasm_table_satd *table, hevcasm_instruction_set mask)
+{
+	for (int height = 4; height <= 64; height += 4)
+	{
+		for (int width = 4; width <= 64; width += 4)
+		{
+			*hevcasm_get_satd(table, width, height) = get_satd(width, height, mask);
+		}
+	}
+}
+
+
+static hevcasm_satd_multiref *get_satd_multiref(int width, int height, hevcasm_instruction_set mask)
+{
+	hevcasm_satd_multiref *f = 0;
+
+	if (mask & (HEVCASM_C_REF | HEVCASM_C_OPT))
+	{
+		f = hevcasm_satd_multiref_4_c_ref;
+	}
+
+#ifdef HEVCASM_X64
+	const int tiles8x8 = width % 8 == 0 && height % 8 == 0;
+
+	if (mask & HEVCASM_SSE2)
+	{
+		if (!tiles8x8) f = hevcasm_satd_multiref_4_4nx4n_sse2;
+	}
+
+	if (mask & HEVCASM_SSE41)
+	{
+		if (tiles8x8) f = hevcasm_satd_multiref_4_8nx8n_sse4;
+	}
+
+	if (mask & HEVCASM_AVX2)
+	{
+		if (tiles8x8 && width % 16 == 0) f = hevcasm_satd_multiref_4_16nx8n_avx2;
+	}
+#endif
+
+	return f;
+}
+
+
+void HEVCASM_API hevcasm_populate_satd_multiref(hevcasm_table_satd_multiref *table, hevcasm_instruction_set mask)
+{
+	for (int height = 4; height <= 64; height += 4)
+	{
+		for (int width = 4; width <= 64; width += 4)
+		{
+			*hevcasm_get_satd_multiref(table, 4, width, height) = get_satd_multiref(width, height, mask);
+		}
+	}
+}
+
+
+static const int partitions[][2] = {
+	{ 64, 64 },{ 64, 48 },{ 64, 32 },{ 64, 16 },
+	{ 48, 64 },
+	{ 32, 64 },{ 32, 32 },{ 32, 24 },{ 32, 16 },{ 32, 8 },
+	{ 24, 32 },
+	{ 16, 64 },{ 16, 32 },{ 16, 16 },{ 16, 12 },{ 16, 8 },{ 16, 4 },
+	{ 12, 16 },
+	{ 8, 32 },{ 8, 16 },{ 8, 8 },{ 8, 4 },
+	{ 4, 16 },{ 4, 8 },
+	{ 0, 0 } };
+
+
+typedef struct
+{
+	HEVCASM_ALIGN(32, uint8_t, srcA[128 * 128]);
+	HEVCASM_ALIGN(32, uint8_t, srcB[128 * 128]);
+	const uint8_t *srcB_array[4];
+	int width;
+	int height;
+	int satd[4];
+	hevcasm_satd *f;
+	hevcasm_satd_multiref *f_multiref;
+}
+bound_satd;
+
+
+int init_satd(void *p, hevcasm_instruction_set mask)
+{
+	bound_satd *s = p;
+
+	hevcasm_table_satd table;
+	hevcasm_populate_satd(&table, mask);
+
+	hevcasm_satd **entry = hevcasm_get_satd(&table, s->width, s->height);
+	hevcasm_test_report_kernel(&table, sizeof(table), entry);
+	s->f = *entry;
+
+	if (mask == HEVCASM_C_REF) hevcasm_test_printf("\t%dx%d : ", s->width, s->height);
+
+	return !!s->f;
+}
+
+
+void invoke_satd(void *p, int n)
+{
+	bound_satd *s = p;
+	while (n--)
+	{
+		s->satd[0] = s->f(s->srcA, 128, s->srcB_array[0], 128, HEVCASM_RECT(s->width, s->height));
+	}
+}
+
+
+int mismatch_satd(void *boundRef, void *boundTest)
+{
+	bound_satd *ref = boundRef;
+	bound_satd *test = boundTest;
+
+	return ref->satd[0] != test->satd[0];
+}
+
+
+void HEVCASM_API hevcasm_test_satd(int *error_count, hevcasm_instruction_set mask)
+{
+	hevcasm_test_printf("\nhevcasm_satd - Sum of Absolute Transformed Differences of prediction unit shapes\n");
+
+	bound_satd b[2];
+
+	for (int x = 0; x < 128 * 128; x++) b[0].srcA[x] = hevcasm_test_rand();
+	for (int x = 0; x < 128 * 128; x++) b[0].srcB[x] = hevcasm_test_rand();
+
+	b[0].srcB_array[0] = &b[0].srcB[1 + 1 * 128];
+
+	for (int i = 0; partitions[i][0]; ++i)
+	{
+		b[0].width = partitions[i][0];
+		b[0].height = partitions[i][1];
+		b[1] = b[0];
+		*error_count += hevcasm_test(&b[0], &b[1], init_satd, invoke_satd, mismatch_satd, mask, 10000);
+	}
+}
+
+
+int init_satd_multiref(void *p, hevcasm_instruction_set mask)
+{
+	bound_satd *s = p;
+
+	hevcasm_table_satd_multiref table;
+	hevcasm_populate_satd_multiref(&table, mask);
+
+	hevcasm_satd_multiref **entry = hevcasm_get_satd_multiref(&table, 4, s->width, s->height);
+	hevcasm_test_report_kernel(&table, sizeof(table), entry);
+	s->f_multiref = *entry;
+
+	if (mask == HEVCASM_C_REF) hevcasm_test_printf("\t4-way %dx%d : ", s->width, s->height);
+
+	return !!s->f_multiref;
+}
+
+
+void invoke_satd_multiref(void *p, int n)
+{
+	bound_satd *s = p;
+	while (n--)
+	{
+		s->f_multiref(s->srcA, 128, s->srcB_array, 128, s->satd, HEVCASM_RECT(s->width, s->height));
+	}
+}
+
+
+int mismatch_satd_multiref(void *boundRef, void *boundTest)
+{
+	bound_satd *ref = boundRef;
+	bound_satd *test = boundTest;
+
+	for (int way = 0; way < 4; ++way)
+	{
+		if (ref->satd[way] != test->satd[way]) return 1;
+	}
+
+	return 0;
+}
+
+
+void HEVCASM_API hevcasm_test_satd_multiref(int *error_count, hevcasm_instruction_set mask)
+{
+	hevcasm_test_printf("\nhevcasm_satd_multiref - Sum of Absolute Transformed Differences with multiple references (4 candidate references)\n");
+
+	bound_satd b[2];
+
+	for (int x = 0; x < 128 * 128; x++) b[0].srcA[x] = hevcasm_test_rand();
+	for (int x = 0; x < 128 * 128; x++) b[0].srcB[x] = hevcasm_test_rand();
+
+	b[0].srcB_array[0] = &b[0].srcB[1 + 2 * 128];
+	b[0].srcB_array[1] = &b[0].srcB[2 + 1 * 128];
+	b[0].srcB_array[2] = &b[0].srcB[3 + 2 * 128];
+	b[0].srcB_array[3] = &b[0].srcB[2 + 3 * 128];
+
+	for (int i = 0; partitions[i][0]; ++i)
+	{
+		b[0].width = partitions[i][0];
+		b[0].height = partitions[i][1];
+		b[1] = b[0];
+		*error_count += hevcasm_test(&b[0], &b[1], init_satd_multiref, invoke_satd_multiref, mismatch_satd_multiref, mask, 1000);
+	}
+}
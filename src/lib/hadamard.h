@@ -68,6 +68,47 @@ void HEVCASM_API hevcasm_populate_hadamard_satd(hevcasm_table_hadamard_satd *tab
 void HEVCASM_API hevcasm_test_hadamard_satd(int *error_count, hevcasm_instruction_set mask);
 
 
+/* Sum of absolute transformed differences of a width x height block. Blocks whose
+dimensions are multiples of 8 are the sum of normalised 8x8 SATDs (as hevcasm_hadamard_satd
+with log2TrafoSize = 3); otherwise the sum of normalised 4x4 SATDs. */
+typedef int hevcasm_satd(const uint8_t *srcA, ptrdiff_t stride_srcA, const uint8_t *srcB, ptrdiff_t stride_srcB, uint32_t rect);
+
+typedef struct
+{
+	hevcasm_satd *lookup[16][16];
+}
+hevcasm_table_satd;
+
+static hevcasm_satd** hevcasm_get_satd(hevcasm_table_satd *table, int width, int height)
+{
+	return &table->lookup[(width >> 2) - 1][(height >> 2) - 1];
+}
+
+void HEVCASM_API hevcasm_populate_satd(hevcasm_table_satd *table, hevcasm_instruction_set mask);
+
+void HEVCASM_API hevcasm_test_satd(int *error_count, hevcasm_instruction_set mask);
+
+
+/* SATD of one source block against four candidate blocks, e.g. for motion estimation refinement */
+typedef void hevcasm_satd_multiref(const uint8_t *srcA, ptrdiff_t stride_srcA, const uint8_t *srcB[], ptrdiff_t stride_srcB, int satd[], uint32_t rect);
+
+typedef struct
+{
+	hevcasm_satd_multiref *lookup[16][16];
+}
+hevcasm_table_satd_multiref;
+
+static hevcasm_satd_multiref** hevcasm_get_satd_multiref(hevcasm_table_satd_multiref *table, int ways, int width, int height)
+{
+	if (ways != 4) return 0;
+	return &table->lookup[(width >> 2) - 1][(height >> 2) - 1];
+}
+
+void HEVCASM_API hevcasm_populate_satd_multiref(hevcasm_table_satd_multiref *table, hevcasm_instruction_set mask);
+
+void HEVCASM_API hevcasm_test_satd_multiref(int *error_count, hevcasm_instruction_set mask);
+
+
 #ifdef __cplusplus
 }
 #endif
@@ -47,6 +47,7 @@ SECTION_RODATA 32
 %endmacro
 
 CONSTANT 16, dw, 1
+CONSTANT 8, dd, 2
 
 constant_010101010101010101ff01ff01ff01ff010101010101010101ff01ff01ff01ff:
 	times 4 db 1, 1
@@ -280,4 +281,237 @@ cglobal hadamard_satd_4x4, 4, 4, 8
 
 	RET
 
+; %1 - destination register number, difference of one row of srcA and srcB
+; uses m8, advances r5 and r9 by one row
+%macro SATD_LOAD_DIFF 1
+	pmovzxbw m%1, [r5]
+	pmovzxbw m8, [r9]
+	psubw m%1, m8
+	add r5, r1
+	add r9, r3
+%endmacro
+
+; %1 = %1 + %2, %2 = %2 - %1 (sign of the difference is irrelevant for SATD)
+%macro SUMSUB_BA 2
+	paddw m%1, m%2
+	paddw m%2, m%2
+	psubw m%2, m%1
+%endmacro
+
+; 8-point Hadamard transform across eight registers, output order permuted
+%macro HADAMARD_8_V 8
+	SUMSUB_BA %1, %5
+	SUMSUB_BA %2, %6
+	SUMSUB_BA %3, %7
+	SUMSUB_BA %4, %8
+	SUMSUB_BA %1, %3
+	SUMSUB_BA %2, %4
+	SUMSUB_BA %5, %7
+	SUMSUB_BA %6, %8
+	SUMSUB_BA %1, %2
+	SUMSUB_BA %3, %4
+	SUMSUB_BA %5, %6
+	SUMSUB_BA %7, %8
+%endmacro
+
+; transposes 8x8 words within each 128-bit lane: rows in m0..m7, columns out in m8..m15
+%macro TRANSPOSE_8x8W 0
+	punpcklwd m8, m0, m1
+	punpckhwd m9, m0, m1
+	punpcklwd m10, m2, m3
+	punpckhwd m11, m2, m3
+	punpcklwd m12, m4, m5
+	punpckhwd m13, m4, m5
+	punpcklwd m14, m6, m7
+	punpckhwd m15, m6, m7
+
+	punpckldq m0, m8, m10
+	punpckhdq m1, m8, m10
+	punpckldq m2, m9, m11
+	punpckhdq m3, m9, m11
+	punpckldq m4, m12, m14
+	punpckhdq m5, m12, m14
+	punpckldq m6, m13, m15
+	punpckhdq m7, m13, m15
+
+	punpcklqdq m8, m0, m4
+	punpckhqdq m9, m0, m4
+	punpcklqdq m10, m1, m5
+	punpckhqdq m11, m1, m5
+	punpcklqdq m12, m2, m6
+	punpckhqdq m13, m2, m6
+	punpcklqdq m14, m3, m7
+	punpckhqdq m15, m3, m7
+%endmacro
+
+; SATD of one 8x8 block of differences per 128-bit lane, rows in m0..m7
+; each block is normalised individually, as hevcasm_hadamard_satd_8x8, and the total left in the low dword of xm8
+%macro SATD_8x8_TRANSFORM 0
+	; vertical transform
+	HADAMARD_8_V 0, 1, 2, 3, 4, 5, 6, 7
+
+	TRANSPOSE_8x8W
+
+	; horizontal transform
+	HADAMARD_8_V 8, 9, 10, 11, 12, 13, 14, 15
+
+	pabsw m8, m8
+	pabsw m9, m9
+	pabsw m10, m10
+	pabsw m11, m11
+	pabsw m12, m12
+	pabsw m13, m13
+	pabsw m14, m14
+	pabsw m15, m15
+
+	paddw m8, m9
+	paddw m10, m11
+	paddw m12, m13
+	paddw m14, m15
+
+	pmaddwd m8, [constant_times_16_dw_1]
+	pmaddwd m10, [constant_times_16_dw_1]
+	pmaddwd m12, [constant_times_16_dw_1]
+	pmaddwd m14, [constant_times_16_dw_1]
+
+	paddd m8, m10
+	paddd m12, m14
+	paddd m8, m12
+
+	phaddd m8, m8
+	phaddd m8, m8
+	; m8 = sum of absolute transformed differences, one block per lane
+
+	paddd m8, [constant_times_8_dd_2]
+	psrld m8, 2
+%if mmsize == 32
+	vextracti128 xm9, m8, 1
+	paddd xm8, xm9
+%endif
+%endmacro
+
+; SATD of one 8x8 block per 128-bit lane at r10 (srcA) and r11 (srcB), added to r6d
+%macro SATD_8x8_PASS 0
+	mov r5, r10
+	mov r9, r11
+	SATD_LOAD_DIFF 0
+	SATD_LOAD_DIFF 1
+	SATD_LOAD_DIFF 2
+	SATD_LOAD_DIFF 3
+	SATD_LOAD_DIFF 4
+	SATD_LOAD_DIFF 5
+	SATD_LOAD_DIFF 6
+	SATD_LOAD_DIFF 7
+
+	SATD_8x8_TRANSFORM
+	movd r5d, xm8
+	add r6d, r5d
+%endmacro
+
+; SATD of a block whose width is a multiple of mmsize/2 and height a multiple of 8
+; r0 - srcA, r1 - stride_srcA, r2 - srcB, r3 - stride_srcB, r7 - HEVCASM_RECT(width, height)
+; returns result in r6d, uses r5, r9, r10, r11, r12, r13
+%macro SATD_BLOCK 0
+	xor r6d, r6d
+	mov r10, r0
+	mov r11, r2
+	movzx r13d, r7b
+%%row
+	mov r12d, r7d
+	shr r12d, 8
+%%column
+	SATD_8x8_PASS
+	add r10, mmsize / 2
+	add r11, mmsize / 2
+	sub r12d, mmsize / 2
+	jg %%column
+
+	mov r12d, r7d
+	shr r12d, 8
+	sub r10, r12
+	sub r11, r12
+	lea r10, [r10 + 8 * r1]
+	lea r11, [r11 + 8 * r3]
+	sub r13d, 8
+	jg %%row
+%endmacro
+
+%macro SATD_8NX8N 1
+; int hevcasm_satd_8nx8n_sse4(const uint8_t *srcA, ptrdiff_t stride_srcA, const uint8_t *srcB, ptrdiff_t stride_srcB, uint32_t rect);
+; int hevcasm_satd_16nx8n_avx2(const uint8_t *srcA, ptrdiff_t stride_srcA, const uint8_t *srcB, ptrdiff_t stride_srcB, uint32_t rect);
+cglobal satd_%1nx8n, 5, 14, 16
+	mov r7d, r4d
+	SATD_BLOCK
+	mov eax, r6d
+	RET
+
+; void hevcasm_satd_multiref_4_8nx8n_sse4(const uint8_t *srcA, ptrdiff_t stride_srcA, const uint8_t *srcB[], ptrdiff_t stride_srcB, int satd[], uint32_t rect);
+; void hevcasm_satd_multiref_4_16nx8n_avx2(const uint8_t *srcA, ptrdiff_t stride_srcA, const uint8_t *srcB[], ptrdiff_t stride_srcB, int satd[], uint32_t rect);
+; srcA rows of each block are loaded and widened once, then differenced with all four srcB blocks
+; r13 is left free for the stack pointer that x86inc keeps when it aligns the stack for ymm
+cglobal satd_multiref_4_%1nx8n, 6, 14, 16, 8 * mmsize
+	mov r7d, r5d
+	xor r5d, r5d
+	mov [r4], r5d
+	mov [r4 + 4], r5d
+	mov [r4 + 8], r5d
+	mov [r4 + 12], r5d
+	xor r8, r8
+	; r8 = offset of the block in each srcB
+	movzx r11d, r7b
+.row
+	mov r10d, r7d
+	shr r10d, 8
+.column
+	mov r5, r0
+%assign i 0
+%rep 8
+	pmovzxbw m8, [r5]
+	mova [rsp + i * mmsize], m8
+	add r5, r1
+%assign i i + 1
+%endrep
+
+	xor r6d, r6d
+.candidate
+	mov r9, [r2 + 8 * r6]
+	add r9, r8
+%assign i 0
+%rep 8
+	; srcB - srcA: the sign of the difference is irrelevant for SATD
+	pmovzxbw m %+ i, [r9]
+	psubw m %+ i, [rsp + i * mmsize]
+	add r9, r3
+%assign i i + 1
+%endrep
+
+	SATD_8x8_TRANSFORM
+	movd r5d, xm8
+	add [r4 + 4 * r6], r5d
+	inc r6d
+	cmp r6d, 4
+	jl .candidate
+
+	add r0, mmsize / 2
+	add r8, mmsize / 2
+	sub r10d, mmsize / 2
+	jg .column
+
+	mov r10d, r7d
+	shr r10d, 8
+	sub r0, r10
+	sub r8, r10
+	lea r0, [r0 + 8 * r1]
+	lea r8, [r8 + 8 * r3]
+	sub r11d, 8
+	jg .row
+	RET
+%endmacro
+
+INIT_XMM sse4
+SATD_8NX8N 8
+INIT_YMM avx2
+SATD_8NX8N 16
+
+
 %endif
\ No newline at end of file
@@ -34,14 +34,29 @@ THE POSSIBILITY OF SUCH DAMAGE.
 */
 
 
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "deblock.h"
+#include "metrics.h"
+#include "pad.h"
 #include "pred_inter.h"
 #include "pred_intra.h"
+#include "progress.h"
 #include "residual_decode.h"
 #include "sad.h"
+#include "sao.h"
 #include "ssd.h"
 #include "diff.h"
 #include "quantize.h"
+#include "rdoq.h"
+#include "cabac.h"
+#include "context.h"
+#include "autotune.h"
+#include "static_dispatch.h"
 #include "hadamard.h"
+#include "variance.h"
 #include "hevcasm.h"
 
 
@@ -50,6 +65,7 @@ THE POSSIBILITY OF SUCH DAMAGE.
 #endif
 
 #include <stdint.h>
+#include <string.h>
 
 
 #ifdef _MSC_VER
@@ -138,6 +154,28 @@ hevcasm_instruction_set hevcasm_instruction_set_support()
 }
 
 
+void hevcasm_processor_signature(char signature[HEVCASM_PROCESSOR_SIGNATURE_SIZE])
+{
+	int cpuInfo[4]; // eax ... edx
+
+	__cpuidex(cpuInfo, 0, 0);
+
+	char vendor[13];
+	memcpy(&vendor[0], &cpuInfo[1], 4);
+	memcpy(&vendor[4], &cpuInfo[3], 4);
+	memcpy(&vendor[8], &cpuInfo[2], 4);
+	vendor[12] = 0;
+	for (int i = 0; i < 12; ++i) if (vendor[i] == ' ') vendor[i] = '_';
+
+	const int max_standard_level = cpuInfo[0];
+
+	cpuInfo[0] = 0;
+	if (max_standard_level >= 1) __cpuidex(cpuInfo, 1, 0);
+
+	sprintf(signature, "%.12s-%08x-%03x", vendor, (unsigned)cpuInfo[0], (unsigned)hevcasm_instruction_set_support() & 0xfff);
+}
+
+
 void hevcasm_print_instruction_set_support(FILE *f, hevcasm_instruction_set mask)
 {
 	f = stdout;
@@ -169,15 +207,54 @@ int hevcasm_main(int argc, const char *argv[])
 	hevcasm_test_sad_multiref(&error_count, mask);
 	hevcasm_test_sad(&error_count, mask);
 	hevcasm_test_ssd(&error_count, mask);
+	hevcasm_test_ssd_residual(&error_count, mask);
+	hevcasm_test_ssd_linear(&error_count, mask);
+	hevcasm_test_ssd_plane(&error_count, mask);
+	hevcasm_test_ssim_4x4_sums(&error_count, mask);
+	hevcasm_test_metrics(&error_count, mask);
+	hevcasm_test_variance(&error_count, mask);
+	hevcasm_test_variance_plane(&error_count, mask);
 	hevcasm_test_pred_intra(&error_count, mask);
 	hevcasm_test_hadamard_satd(&error_count, mask);
+	hevcasm_test_satd(&error_count, mask);
+	hevcasm_test_satd_multiref(&error_count, mask);
 	hevcasm_test_quantize_inverse(&error_count, mask);
 	hevcasm_test_quantize(&error_count, mask);
 	hevcasm_test_quantize_reconstruct(&error_count, mask);
+	hevcasm_test_transform_domain_ssd(&error_count, mask);
+	hevcasm_test_rdoq_candidates(&error_count, mask);
+	hevcasm_test_rdoq(&error_count, mask);
+	hevcasm_test_residual_scan(&error_count, mask);
+	hevcasm_test_residual_unscan(&error_count, mask);
+	hevcasm_test_cabac_write_residual_coding(&error_count, mask);
+	hevcasm_test_cabac_read_residual_coding(&error_count, mask);
+	hevcasm_test_residual_rate_sub_blocks(&error_count, mask);
+	hevcasm_test_residual_rate_estimate(&error_count, mask);
 	hevcasm_test_pred_uni(&error_count, mask);
 	hevcasm_test_pred_bi(&error_count, mask);
+	hevcasm_test_pred_uni_nv12(&error_count, mask);
+	hevcasm_test_pred_bi_nv12(&error_count, mask);
+	hevcasm_test_pred_uni_8to16(&error_count, mask);
+	hevcasm_test_pred_uni_weighted(&error_count, mask);
+	hevcasm_test_pred_bi_weighted(&error_count, mask);
+	hevcasm_test_pred_batch(&error_count, mask);
+	hevcasm_test_deblock_luma(&error_count, mask);
+	hevcasm_test_deblock_chroma(&error_count, mask);
+	hevcasm_test_deblock_bs(&error_count, mask);
+	hevcasm_test_sao(&error_count, mask);
+	hevcasm_test_sao_collect(&error_count, mask);
+	hevcasm_test_pad_horizontal(&error_count, mask);
+	hevcasm_test_pad_vertical(&error_count, mask);
+	hevcasm_test_pad_rows(&error_count, mask);
+	hevcasm_test_progress(&error_count, mask);
 	hevcasm_test_inverse_transform_add(&error_count, mask);
 	hevcasm_test_transform(&error_count, mask);
+	hevcasm_test_transform_skip(&error_count, mask);
+	hevcasm_test_inverse_transform_skip_add(&error_count, mask);
+	hevcasm_test_transquant_bypass_add(&error_count, mask);
+	hevcasm_test_context(&error_count, mask);
+	hevcasm_test_autotune(&error_count, mask);
+	hevcasm_test_static_dispatch(&error_count, mask);
 
 	printf("\n");
 	printf("HEVCasm self test: %d errors\n", error_count);
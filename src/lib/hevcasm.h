@@ -71,6 +71,9 @@ static hevcasm_timestamp hevcasm_get_timestamp()
 #define HEVCASM_ALIGN(n, T, v) \
 	__declspec(align(n)) T v
 
+#define HEVCASM_PREFETCH(p) \
+	_mm_prefetch((const char *)(p), _MM_HINT_T0)
+
 #endif
 
 #ifdef __GNUC__
@@ -104,6 +107,9 @@ static hevcasm_timestamp hevcasm_get_timestamp(void)
 #define HEVCASM_ALIGN(n, T, v) \
 	T v __attribute__((aligned(n)))
 
+#define HEVCASM_PREFETCH(p) \
+	__builtin_prefetch(p)
+
 #define HEVCASM_API
 
 #endif
@@ -147,6 +153,15 @@ hevcasm_instruction_set HEVCASM_API hevcasm_instruction_set_support();
 void HEVCASM_API hevcasm_print_instruction_set_support(FILE *f, hevcasm_instruction_set mask);
 
 
+/*
+Queries processor via cpuid instruction and writes a string identifying its vendor, family, model and stepping
+and the instruction sets supported, e.g. "GenuineIntel-000306c3-1ff". The string has no spaces.
+*/
+#define HEVCASM_PROCESSOR_SIGNATURE_SIZE 32
+
+void HEVCASM_API hevcasm_processor_signature(char signature[HEVCASM_PROCESSOR_SIGNATURE_SIZE]);
+
+
 /*
 Library self-test entry point.
 */
@@ -35,6 +35,69 @@ THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "hevcasm_test.h"
 
+#include <stdarg.h>
+#include <string.h>
+
+
+#ifdef _MSC_VER
+#define HEVCASM_THREAD_LOCAL __declspec(thread)
+#else
+#define HEVCASM_THREAD_LOCAL __thread
+#endif
+
+
+typedef struct
+{
+	FILE *output;
+	int output_set; /* output is stdout until set */
+	uint64_t random;
+	hevcasm_test_hook *hook;
+	void *hook_state;
+	hevcasm_test_kernel kernel;
+}
+test_state;
+
+
+static HEVCASM_THREAD_LOCAL test_state state = { 0, 0, 1 };
+
+
+int hevcasm_test_printf(const char *format, ...)
+{
+	FILE *output = state.output_set ? state.output : stdout;
+	if (!output) return 0;
+
+	va_list args;
+	va_start(args, format);
+	const int result = vfprintf(output, format, args);
+	va_end(args);
+	return result;
+}
+
+
+FILE *hevcasm_test_set_output(FILE *output)
+{
+	FILE *previous = state.output_set ? state.output : stdout;
+	state.output = output;
+	state.output_set = 1;
+	return previous;
+}
+
+
+int hevcasm_test_rand(void)
+{
+	/* 64-bit linear congruential generator (Knuth's MMIX constants): the high bits have the longest periods */
+	state.random = state.random * 6364136223846793005ull + 1442695040888963407ull;
+	return (int)(state.random >> 33);
+}
+
+
+uint64_t hevcasm_test_srand(uint64_t seed)
+{
+	const uint64_t previous = state.random;
+	state.random = seed;
+	return previous;
+}
+
 
 
 int hevcasm_count_average_cycles(
@@ -81,11 +144,11 @@ int hevcasm_count_average_cycles(
 	{
 		const int average = (int)((sum + count / 2) / count);
 
-		printf(" %s:", hevcasm_instruction_set_as_text(set));
-		printf("%d", average);
+		hevcasm_test_printf(" %s:", hevcasm_instruction_set_as_text(set));
+		hevcasm_test_printf("%d", average);
 		if (*first_result != 0.0)
 		{
-			printf("(x%.2f)", *first_result / average);
+			hevcasm_test_printf("(x%.2f)", *first_result / average);
 		}
 		else
 		{
@@ -98,7 +161,7 @@ int hevcasm_count_average_cycles(
 		f(boundRef, 1);
 		if (m(boundRef, boundTest))
 		{
-			printf("-MISMATCH");
+			hevcasm_test_printf("-MISMATCH");
 			return 1;
 		}
 	}
@@ -107,6 +170,30 @@ int hevcasm_count_average_cycles(
 }
 
 
+void hevcasm_test_set_hook(hevcasm_test_hook *hook, void *hook_state)
+{
+	state.hook = hook;
+	state.hook_state = hook_state;
+}
+
+
+void hevcasm_test_report_kernel(const void *table, size_t size, const void *entry)
+{
+	memcpy(&state.kernel.kernel, entry, sizeof(state.kernel.kernel));
+	state.kernel.offset = (const char *)entry - (const char *)table;
+	state.kernel.size = size;
+}
+
+
+int hevcasm_test_get_kernel(hevcasm_bound_get *get, void *bound, hevcasm_instruction_set set, hevcasm_test_kernel *kernel)
+{
+	memset(&state.kernel, 0, sizeof(state.kernel));
+	const int result = get(bound, set);
+	*kernel = state.kernel;
+	return result;
+}
+
+
 int hevcasm_test(
 	void *ref, 
 	void *test, 
@@ -116,6 +203,8 @@ int hevcasm_test(
 	hevcasm_instruction_set mask, 
 	int iterations)
 {
+	if (state.hook) return state.hook(state.hook_state, ref, test, get, invoke, mismatch, mask);
+
 	int error_count = 0;
 
 	if (get(ref, HEVCASM_C_REF))
@@ -130,7 +219,7 @@ int hevcasm_test(
 				error_count += hevcasm_count_average_cycles(ref, test, invoke, mismatch, &first_result, set, iterations);
 			}
 		}
-		printf("\n");
+		hevcasm_test_printf("\n");
 	}
 
 	return error_count;
@@ -82,4 +82,48 @@ int hevcasm_test(
 	int iterations);
 
 
+// Self test state (output, random number generator, hook and reported kernel) is per thread, so that self tests
+// run on one thread do not affect those on another, nor the application's stdout and rand() stream.
+
+// printf() to the thread's self test output: stdout unless replaced by hevcasm_test_set_output().
+int hevcasm_test_printf(const char *format, ...);
+
+// Sets the thread's self test output (null discards it) and returns the previous output.
+FILE *hevcasm_test_set_output(FILE *output);
+
+#define HEVCASM_TEST_RAND_MAX 0x7fffffff
+
+// Replaces rand() in self tests: returns the next number, in [0, HEVCASM_TEST_RAND_MAX], of the thread's generator.
+int hevcasm_test_rand(void);
+
+// Seeds the thread's generator and returns its previous state.
+uint64_t hevcasm_test_srand(uint64_t seed);
+
+
+// Replaces measurement in hevcasm_test(): while a hook is set on a thread, hevcasm_test() on that thread passes each
+// pair of bounds to the hook and returns its result. Used by hevcasm_autotune() to benchmark kernels through the self
+// tests.
+typedef int hevcasm_test_hook(void *state, void *ref, void *test, hevcasm_bound_get *get, hevcasm_bound_invoke *invoke, hevcasm_bound_mismatch *mismatch, hevcasm_instruction_set mask);
+
+void hevcasm_test_set_hook(hevcasm_test_hook *hook, void *state);
+
+
+// The kernel a bound calls: the table entry at offset bytes into a dispatch table of size bytes, and its value.
+typedef struct
+{
+	void (*kernel)(void);
+	size_t offset;
+	size_t size;
+}
+hevcasm_test_kernel;
+
+// Called by get functions whose invoke function calls a single kernel: table is the table populated for the
+// instruction set and entry the result of its hevcasm_get_* lookup.
+void hevcasm_test_report_kernel(const void *table, size_t size, const void *entry);
+
+// For hooks: returns get(bound, set) and sets *kernel to the kernel reported by get (kernel->kernel is zero if
+// none was reported).
+int hevcasm_test_get_kernel(hevcasm_bound_get *get, void *bound, hevcasm_instruction_set set, hevcasm_test_kernel *kernel);
+
+
 #endif
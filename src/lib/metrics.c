@@ -0,0 +1,871 @@
+/*
+The copyright in this software is being made available under the BSD
+License, included below. This software may be subject to other third party
+and contributor rights, including patent rights, and no such rights are
+granted under this license.
+
+
+Copyright(c) 2011 - 2015, Parabola Research Limited
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met :
+
+* Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+this list of conditions and the following disclaimer in the documentation
+and / or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its contributors may
+be used to endorse or promote products derived from this software without
+specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "metrics.h"
+#include "progress.h"
+#include "hevcasm_test.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <math.h>
+#include <assert.h>
+
+#ifdef WIN32
+#include <Windows.h>
+#else
+#include <pthread.h>
+#endif
+
+
+static uint64_t hevcasm_ssd_plane_c_ref(const uint8_t *srcA, ptrdiff_t stride_srcA, const uint8_t *srcB, ptrdiff_t stride_srcB, int w, int h)
+{
+	uint64_t ssd = 0;
+	for (int y = 0; y < h; ++y)
+	{
+		for (int x = 0; x < w; ++x)
+		{
+			const int diff = srcA[x + y * stride_srcA] - srcB[x + y * stride_srcB];
+			ssd += diff * diff;
+		}
+	}
+	return ssd;
+}
+
+
+#ifdef HEVCASM_X64
+
+hevcasm_ssd_plane hevcasm_ssd_plane_16nxh_sse2;
+hevcasm_ssd_plane hevcasm_ssd_plane_16nxh_avx2;
+
+/* kernels process 16-sample columns, any remaining columns are processed in C */
+#define MAKE_hevcasm_ssd_plane(isa) \
+static uint64_t hevcasm_ssd_plane_ ## isa(const uint8_t *srcA, ptrdiff_t stride_srcA, const uint8_t *srcB, ptrdiff_t stride_srcB, int w, int h) \
+{ \
+	const int w16 = w & ~15; \
+	uint64_t ssd = 0; \
+	if (w16 && h) ssd += hevcasm_ssd_plane_16nxh_ ## isa(srcA, stride_srcA, srcB, stride_srcB, w16, h); \
+	if (w16 < w) ssd += hevcasm_ssd_plane_c_ref(srcA + w16, stride_srcA, srcB + w16, stride_srcB, w - w16, h); \
+	return ssd; \
+}
+
+MAKE_hevcasm_ssd_plane(sse2)
+MAKE_hevcasm_ssd_plane(avx2)
+
+#endif
+
+
+void HEVCASM_API hevcasm_populate_ssd_plane(hevcasm_table_ssd_plane *table, hevcasm_instruction_set mask)
+{
+	*hevcasm_get_ssd_plane(table) = 0;
+
+	if (mask & (HEVCASM_C_REF | HEVCASM_C_OPT))
+	{
+		*hevcasm_get_ssd_plane(table) = hevcasm_ssd_plane_c_ref;
+	}
+
+#ifdef HEVCASM_X64
+	if (mask & HEVCASM_SSE2)
+	{
+		*hevcasm_get_ssd_plane(table) = hevcasm_ssd_plane_sse2;
+	}
+
+	if (mask & HEVCASM_AVX2)
+	{
+		*hevcasm_get_ssd_plane(table) = hevcasm_ssd_plane_avx2;
+	}
+#endif
+}
+
+
+static void hevcasm_ssim_4x4_sums_c_ref(int32_t sums[][4], const uint8_t *srcA, ptrdiff_t stride_srcA, const uint8_t *srcB, ptrdiff_t stride_srcB, int n)
+{
+	for (int i = 0; i < n; ++i)
+	{
+		int32_t s1 = 0, s2 = 0, ss = 0, s12 = 0;
+		for (int y = 0; y < 4; ++y)
+		{
+			for (int x = 0; x < 4; ++x)
+			{
+				const int a = srcA[4 * i + x + y * stride_srcA];
+				const int b = srcB[4 * i + x + y * stride_srcB];
+				s1 += a;
+				s2 += b;
+				ss += a * a + b * b;
+				s12 += a * b;
+			}
+		}
+		sums[i][0] = s1;
+		sums[i][1] = s2;
+		sums[i][2] = ss;
+		sums[i][3] = s12;
+	}
+}
+
+
+#ifdef HEVCASM_X64
+
+hevcasm_ssim_4x4_sums hevcasm_ssim_4x4_sums_2n_ssse3;
+hevcasm_ssim_4x4_sums hevcasm_ssim_4x4_sums_4n_avx2;
+
+/* kernels process blocks in groups of n, any remaining blocks are processed in C */
+#define MAKE_hevcasm_ssim_4x4_sums(n, isa) \
+static void hevcasm_ssim_4x4_sums_ ## isa(int32_t sums[][4], const uint8_t *srcA, ptrdiff_t stride_srcA, const uint8_t *srcB, ptrdiff_t stride_srcB, int count) \
+{ \
+	const int m = count - count % n; \
+	if (m) hevcasm_ssim_4x4_sums_ ## n ## n_ ## isa(sums, srcA, stride_srcA, srcB, stride_srcB, m); \
+	hevcasm_ssim_4x4_sums_c_ref(sums + m, srcA + 4 * m, stride_srcA, srcB + 4 * m, stride_srcB, count - m); \
+}
+
+MAKE_hevcasm_ssim_4x4_sums(2, ssse3)
+MAKE_hevcasm_ssim_4x4_sums(4, avx2)
+
+#endif
+
+
+void HEVCASM_API hevcasm_populate_ssim_4x4_sums(hevcasm_table_ssim_4x4_sums *table, hevcasm_instruction_set mask)
+{
+	*hevcasm_get_ssim_4x4_sums(table) = 0;
+
+	if (mask & (HEVCASM_C_REF | HEVCASM_C_OPT))
+	{
+		*hevcasm_get_ssim_4x4_sums(table) = hevcasm_ssim_4x4_sums_c_ref;
+	}
+
+#ifdef HEVCASM_X64
+	if (mask & HEVCASM_SSSE3)
+	{
+		*hevcasm_get_ssim_4x4_sums(table) = hevcasm_ssim_4x4_sums_ssse3;
+	}
+
+	if (mask & HEVCASM_AVX2)
+	{
+		*hevcasm_get_ssim_4x4_sums(table) = hevcasm_ssim_4x4_sums_avx2;
+	}
+#endif
+}
+
+
+#define HEVCASM_METRICS_SCALES 5
+
+static const double ms_ssim_weights[HEVCASM_METRICS_SCALES] = { 0.0448, 0.2856, 0.3001, 0.2363, 0.1333 };
+
+
+typedef struct
+{
+	uint64_t ssd;
+	double ssim[HEVCASM_METRICS_SCALES]; /* sum over windows of SSIM */
+	double cs[HEVCASM_METRICS_SCALES]; /* sum over windows of the contrast-structure term */
+	int windows[HEVCASM_METRICS_SCALES];
+}
+metrics_band;
+
+
+typedef struct
+{
+	hevcasm_metrics *metrics;
+	int32_t (*sums)[4]; /* two rows of 4x4 block statistics */
+#ifdef WIN32
+	HANDLE thread;
+#else
+	pthread_t thread;
+#endif
+}
+metrics_worker;
+
+
+struct hevcasm_metrics
+{
+	hevcasm_ssd_plane *ssd_plane;
+	hevcasm_ssim_4x4_sums *ssim_4x4_sums;
+
+	int width[HEVCASM_METRICS_SCALES];
+	int height[HEVCASM_METRICS_SCALES];
+	int ctu_size;
+	int bands;
+	metrics_band *band;
+
+	/* planes A and B at each scale: scale 0 is the input, others are downsampled into buffer */
+	const uint8_t *plane[2][HEVCASM_METRICS_SCALES];
+	ptrdiff_t stride[2][HEVCASM_METRICS_SCALES];
+	uint8_t *scaled[2][HEVCASM_METRICS_SCALES];
+	uint8_t *buffer;
+
+	int threads;
+	metrics_worker *worker; /* worker[0] is the thread calling hevcasm_metrics_compute() */
+
+	/* job control: each job processes every band once, bands are claimed by incrementing next */
+	hevcasm_picture_progress start; /* generation of the most recently started job */
+	hevcasm_picture_progress done; /* generation of the most recently completed job */
+	volatile int32_t next;
+	volatile int32_t completed;
+	volatile int32_t generation;
+	volatile int32_t phase;
+	volatile int32_t quit;
+};
+
+
+static int32_t metrics_fetch_add(volatile int32_t *p, int32_t value)
+{
+#ifdef WIN32
+	return InterlockedExchangeAdd((volatile LONG *)p, value);
+#else
+	return __atomic_fetch_add(p, value, __ATOMIC_SEQ_CST);
+#endif
+}
+
+
+static void metrics_store(volatile int32_t *p, int32_t value)
+{
+#ifdef WIN32
+	InterlockedExchange((volatile LONG *)p, value);
+#else
+	__atomic_store_n(p, value, __ATOMIC_SEQ_CST);
+#endif
+}
+
+
+/* rows [*y0, *y1) of the plane at the given scale belong to band b */
+static void metrics_band_rows(const hevcasm_metrics *m, int b, int scale, int *y0, int *y1)
+{
+	*y0 = (b * m->ctu_size) >> scale;
+	*y1 = (b == m->bands - 1) ? m->height[scale] : ((b + 1) * m->ctu_size) >> scale;
+}
+
+
+/* accumulates SSIM and its contrast-structure term for an 8x8 window made of four 4x4 blocks */
+static void metrics_ssim_window(metrics_band *band, int scale, const int32_t *a, const int32_t *b, const int32_t *c, const int32_t *d)
+{
+	/* C1 = (0.01 * 255)^2 and C2 = (0.03 * 255)^2, scaled for sums over 64 samples */
+	const double c1 = 0.01 * 0.01 * 255 * 255 * 64 * 64;
+	const double c2 = 0.03 * 0.03 * 255 * 255 * 64 * 64;
+
+	const int64_t s1 = a[0] + b[0] + c[0] + d[0];
+	const int64_t s2 = a[1] + b[1] + c[1] + d[1];
+	const int64_t ss = a[2] + b[2] + c[2] + d[2];
+	const int64_t s12 = a[3] + b[3] + c[3] + d[3];
+
+	const int64_t vars = 64 * ss - s1 * s1 - s2 * s2;
+	const int64_t covar = 64 * s12 - s1 * s2;
+
+	const double luminance = (2.0 * (double)(s1 * s2) + c1) / ((double)(s1 * s1 + s2 * s2) + c1);
+	const double contrast_structure = (2.0 * (double)covar + c2) / ((double)vars + c2);
+
+	band->ssim[scale] += luminance * contrast_structure;
+	band->cs[scale] += contrast_structure;
+}
+
+
+/* SSIM over the windows whose top row lies in band b */
+static void metrics_band_ssim(hevcasm_metrics *m, int b, int scale, int32_t (*sums)[4])
+{
+	metrics_band *band = &m->band[b];
+	const int nx = m->width[scale] >> 2;
+	const uint8_t *srcA = m->plane[0][scale];
+	const uint8_t *srcB = m->plane[1][scale];
+	const ptrdiff_t stride_srcA = m->stride[0][scale];
+	const ptrdiff_t stride_srcB = m->stride[1][scale];
+
+	int y0, y1;
+	metrics_band_rows(m, b, scale, &y0, &y1);
+
+	band->ssim[scale] = 0.0;
+	band->cs[scale] = 0.0;
+	band->windows[scale] = 0;
+
+	if (nx < 2) return;
+
+	int32_t (*row[2])[4] = { sums, sums + nx };
+
+	int j = (y0 + 3) >> 2;
+	if (4 * j < y1 && 4 * j + 8 <= m->height[scale])
+	{
+		m->ssim_4x4_sums(row[0], &srcA[4 * j * stride_srcA], stride_srcA, &srcB[4 * j * stride_srcB], stride_srcB, nx);
+	}
+
+	for (; 4 * j < y1 && 4 * j + 8 <= m->height[scale]; ++j)
+	{
+		m->ssim_4x4_sums(row[1], &srcA[4 * (j + 1) * stride_srcA], stride_srcA, &srcB[4 * (j + 1) * stride_srcB], stride_srcB, nx);
+
+		for (int i = 0; i + 1 < nx; ++i)
+		{
+			metrics_ssim_window(band, scale, row[0][i], row[0][i + 1], row[1][i], row[1][i + 1]);
+		}
+		band->windows[scale] += nx - 1;
+
+		int32_t (*t)[4] = row[0];
+		row[0] = row[1];
+		row[1] = t;
+	}
+}
+
+
+/* 2x2 average of plane at scale - 1 into rows [y0, y1) of plane at scale */
+static void metrics_downsample(hevcasm_metrics *m, int k, int scale, int y0, int y1)
+{
+	uint8_t *dst = m->scaled[k][scale];
+	const ptrdiff_t stride_dst = m->stride[k][scale];
+	const uint8_t *src = m->plane[k][scale - 1];
+	const ptrdiff_t stride_src = m->stride[k][scale - 1];
+
+	for (int y = y0; y < y1; ++y)
+	{
+		const uint8_t *p = &src[2 * y * stride_src];
+		for (int x = 0; x < m->width[scale]; ++x)
+		{
+			dst[x + y * stride_dst] = (p[2 * x] + p[2 * x + 1] + p[2 * x + stride_src] + p[2 * x + 1 + stride_src] + 2) >> 2;
+		}
+	}
+}
+
+
+/* phase 0: SSD, full-resolution SSIM and downsampling; phase 1: SSIM of the downsampled scales */
+static void metrics_process_band(hevcasm_metrics *m, int b, int32_t (*sums)[4])
+{
+	int y0, y1;
+
+	if (m->phase == 0)
+	{
+		metrics_band_rows(m, b, 0, &y0, &y1);
+		m->band[b].ssd = m->ssd_plane(
+			&m->plane[0][0][y0 * m->stride[0][0]], m->stride[0][0],
+			&m->plane[1][0][y0 * m->stride[1][0]], m->stride[1][0],
+			m->width[0], y1 - y0);
+
+		metrics_band_ssim(m, b, 0, sums);
+
+		/* ctu_size is a multiple of 16 so each band downsamples only its own rows */
+		for (int scale = 1; scale < HEVCASM_METRICS_SCALES; ++scale)
+		{
+			metrics_band_rows(m, b, scale, &y0, &y1);
+			metrics_downsample(m, 0, scale, y0, y1);
+			metrics_downsample(m, 1, scale, y0, y1);
+		}
+	}
+	else
+	{
+		for (int scale = 1; scale < HEVCASM_METRICS_SCALES; ++scale)
+		{
+			metrics_band_ssim(m, b, scale, sums);
+		}
+	}
+}
+
+
+static void metrics_work(hevcasm_metrics *m, int32_t (*sums)[4])
+{
+	for (;;)
+	{
+		const int b = metrics_fetch_add(&m->next, 1);
+		if (b >= m->bands) break;
+
+		metrics_process_band(m, b, sums);
+
+		if (metrics_fetch_add(&m->completed, 1) + 1 == m->bands)
+		{
+			hevcasm_progress_set(&m->done, m->generation);
+		}
+	}
+}
+
+
+#ifdef WIN32
+static DWORD WINAPI metrics_thread(LPVOID p)
+#else
+static void *metrics_thread(void *p)
+#endif
+{
+	metrics_worker *w = p;
+	hevcasm_metrics *m = w->metrics;
+
+	for (int32_t generation = 1; ; ++generation)
+	{
+		hevcasm_progress_wait(&m->start, generation);
+		if (m->quit) break;
+		metrics_work(m, w->sums);
+	}
+
+	return 0;
+}
+
+
+static void metrics_run(hevcasm_metrics *m, int phase)
+{
+	/* generation is updated before bands can be claimed so that the last band completed reports it */
+	m->phase = phase;
+	++m->generation;
+	metrics_store(&m->completed, 0);
+	metrics_store(&m->next, 0);
+	hevcasm_progress_set(&m->start, m->generation);
+
+	metrics_work(m, m->worker[0].sums);
+
+	hevcasm_progress_wait(&m->done, m->generation);
+}
+
+
+hevcasm_metrics* HEVCASM_API hevcasm_metrics_create(int width, int height, int ctu_size, int threads, hevcasm_instruction_set mask)
+{
+	assert(ctu_size % 16 == 0);
+
+	hevcasm_metrics *m = calloc(1, sizeof(hevcasm_metrics));
+	if (!m) return 0;
+
+	hevcasm_table_ssd_plane table_ssd_plane;
+	hevcasm_populate_ssd_plane(&table_ssd_plane, mask);
+	m->ssd_plane = *hevcasm_get_ssd_plane(&table_ssd_plane);
+
+	hevcasm_table_ssim_4x4_sums table_ssim_4x4_sums;
+	hevcasm_populate_ssim_4x4_sums(&table_ssim_4x4_sums, mask);
+	m->ssim_4x4_sums = *hevcasm_get_ssim_4x4_sums(&table_ssim_4x4_sums);
+
+	m->ctu_size = ctu_size;
+	m->bands = (height + ctu_size - 1) / ctu_size;
+	m->threads = threads < 1 ? 1 : threads;
+
+	size_t size = 0;
+	for (int scale = 0; scale < HEVCASM_METRICS_SCALES; ++scale)
+	{
+		m->width[scale] = width >> scale;
+		m->height[scale] = height >> scale;
+		if (scale) size += 2 * (size_t)m->width[scale] * m->height[scale];
+	}
+
+	m->band = calloc(m->bands, sizeof(metrics_band));
+	m->buffer = malloc(size ? size : 1);
+	m->worker = calloc(m->threads, sizeof(metrics_worker));
+
+	if (!m->band || !m->buffer || !m->worker)
+	{
+		free(m->band);
+		free(m->buffer);
+		free(m->worker);
+		free(m);
+		return 0;
+	}
+
+	uint8_t *p = m->buffer;
+	for (int scale = 1; scale < HEVCASM_METRICS_SCALES; ++scale)
+	{
+		for (int k = 0; k < 2; ++k)
+		{
+			m->scaled[k][scale] = p;
+			m->plane[k][scale] = p;
+			m->stride[k][scale] = m->width[scale];
+			p += (size_t)m->width[scale] * m->height[scale];
+		}
+	}
+
+	hevcasm_progress_init(&m->start, INT_MAX);
+	hevcasm_progress_init(&m->done, INT_MAX);
+
+	for (int i = 0; i < m->threads; ++i)
+	{
+		metrics_worker *w = &m->worker[i];
+		w->metrics = m;
+		w->sums = malloc(2 * ((width >> 2) + 1) * sizeof(*w->sums));
+
+		if (!w->sums)
+		{
+			m->threads = i;
+			hevcasm_metrics_free(m);
+			return 0;
+		}
+
+		if (i == 0) continue;
+#ifdef WIN32
+		w->thread = CreateThread(NULL, 0, metrics_thread, w, 0, NULL);
+		const int started = w->thread != NULL;
+#else
+		const int started = !pthread_create(&w->thread, NULL, metrics_thread, w);
+#endif
+
+		/* results do not depend on the number of threads, so continue with those started */
+		if (!started)
+		{
+			free(w->sums);
+			m->threads = i;
+			break;
+		}
+	}
+
+	return m;
+}
+
+
+void HEVCASM_API hevcasm_metrics_free(hevcasm_metrics *m)
+{
+	if (!m) return;
+
+	m->quit = 1;
+	++m->generation;
+	hevcasm_progress_set(&m->start, m->generation);
+
+	for (int i = 0; i < m->threads; ++i)
+	{
+		metrics_worker *w = &m->worker[i];
+		if (i)
+		{
+#ifdef WIN32
+			WaitForSingleObject(w->thread, INFINITE);
+			CloseHandle(w->thread);
+#else
+			pthread_join(w->thread, NULL);
+#endif
+		}
+		free(w->sums);
+	}
+
+	free(m->worker);
+	free(m->buffer);
+	free(m->band);
+	free(m);
+}
+
+
+static double metrics_psnr(uint64_t ssd, uint64_t samples)
+{
+	if (!ssd) return 100.0;
+	return 10.0 * log10(255.0 * 255.0 * (double)samples / (double)ssd);
+}
+
+
+void HEVCASM_API hevcasm_metrics_compute(hevcasm_metrics *m, const uint8_t *srcA, ptrdiff_t stride_srcA, const uint8_t *srcB, ptrdiff_t stride_srcB, hevcasm_metrics_frame *frame, hevcasm_metrics_row *rows)
+{
+	m->plane[0][0] = srcA;
+	m->plane[1][0] = srcB;
+	m->stride[0][0] = stride_srcA;
+	m->stride[1][0] = stride_srcB;
+
+	metrics_run(m, 0);
+	metrics_run(m, 1);
+
+	/* reduce in band order so that results do not depend on the number of threads */
+	metrics_band total = { 0 };
+	for (int b = 0; b < m->bands; ++b)
+	{
+		const metrics_band *band = &m->band[b];
+
+		total.ssd += band->ssd;
+		for (int scale = 0; scale < HEVCASM_METRICS_SCALES; ++scale)
+		{
+			total.ssim[scale] += band->ssim[scale];
+			total.cs[scale] += band->cs[scale];
+			total.windows[scale] += band->windows[scale];
+		}
+
+		if (rows)
+		{
+			int y0, y1;
+			metrics_band_rows(m, b, 0, &y0, &y1);
+			rows[b].ssd = band->ssd;
+			rows[b].psnr = metrics_psnr(band->ssd, (uint64_t)m->width[0] * (y1 - y0));
+			rows[b].ssim = band->windows[0] ? band->ssim[0] / band->windows[0] : 1.0;
+		}
+	}
+
+	frame->ssd = total.ssd;
+	frame->psnr = metrics_psnr(total.ssd, (uint64_t)m->width[0] * m->height[0]);
+	frame->ssim = total.windows[0] ? total.ssim[0] / total.windows[0] : 1.0;
+	frame->ms_ssim = 0.0;
+
+	const int last = HEVCASM_METRICS_SCALES - 1;
+	if (total.windows[last])
+	{
+		double ms_ssim = pow(fmax(total.ssim[last] / total.windows[last], 0.0), ms_ssim_weights[last]);
+		for (int scale = 0; scale < last; ++scale)
+		{
+			ms_ssim *= pow(fmax(total.cs[scale] / total.windows[scale], 0.0), ms_ssim_weights[scale]);
+		}
+		frame->ms_ssim = ms_ssim;
+	}
+}
+
+
+typedef struct
+{
+	HEVCASM_ALIGN(32, uint8_t, srcA[416 * 64]);
+	HEVCASM_ALIGN(32, uint8_t, srcB[416 * 64]);
+	int width;
+	uint64_t ssd;
+	hevcasm_ssd_plane *f;
+}
+bound_ssd_plane;
+
+
+int init_ssd_plane(void *p, hevcasm_instruction_set mask)
+{
+	bound_ssd_plane *s = p;
+
+	hevcasm_table_ssd_plane table;
+	hevcasm_populate_ssd_plane(&table, mask);
+	hevcasm_ssd_plane **entry = hevcasm_get_ssd_plane(&table);
+	hevcasm_test_report_kernel(&table, sizeof(table), entry);
+	s->f = *entry;
+
+	if (mask == HEVCASM_C_REF) hevcasm_test_printf("\t%dx64 : ", s->width);
+
+	return !!s->f;
+}
+
+
+void invoke_ssd_plane(void *p, int n)
+{
+	bound_ssd_plane *s = p;
+	while (n--)
+	{
+		s->ssd = s->f(s->srcA, 416, s->srcB, 416, s->width, 64);
+	}
+}
+
+
+int mismatch_ssd_plane(void *boundRef, void *boundTest)
+{
+	bound_ssd_plane *ref = boundRef;
+	bound_ssd_plane *test = boundTest;
+
+	return ref->ssd != test->ssd;
+}
+
+
+void HEVCASM_API hevcasm_test_ssd_plane(int *error_count, hevcasm_instruction_set mask)
+{
+	hevcasm_test_printf("\nhevcasm_ssd_plane - Sum of Square Differences of plane region\n");
+
+	bound_ssd_plane b[2];
+
+	for (int i = 0; i < 416 * 64; ++i)
+	{
+		b[0].srcA[i] = hevcasm_test_rand();
+		b[0].srcB[i] = hevcasm_test_rand();
+	}
+
+	const int widths[] = { 416, 333, 64, 13 };
+	for (int i = 0; i < sizeof(widths) / sizeof(widths[0]); ++i)
+	{
+		b[0].width = widths[i];
+		b[1] = b[0];
+		*error_count += hevcasm_test(&b[0], &b[1], init_ssd_plane, invoke_ssd_plane, mismatch_ssd_plane, mask, 1000);
+	}
+}
+
+
+typedef struct
+{
+	HEVCASM_ALIGN(32, uint8_t, srcA[416 * 4]);
+	HEVCASM_ALIGN(32, uint8_t, srcB[416 * 4]);
+	int32_t sums[104][4];
+	int n;
+	hevcasm_ssim_4x4_sums *f;
+}
+bound_ssim_4x4_sums;
+
+
+int init_ssim_4x4_sums(void *p, hevcasm_instruction_set mask)
+{
+	bound_ssim_4x4_sums *s = p;
+
+	hevcasm_table_ssim_4x4_sums table;
+	hevcasm_populate_ssim_4x4_sums(&table, mask);
+	hevcasm_ssim_4x4_sums **entry = hevcasm_get_ssim_4x4_sums(&table);
+	hevcasm_test_report_kernel(&table, sizeof(table), entry);
+	s->f = *entry;
+
+	if (mask == HEVCASM_C_REF) hevcasm_test_printf("\t%d blocks : ", s->n);
+
+	return !!s->f;
+}
+
+
+void invoke_ssim_4x4_sums(void *p, int n)
+{
+	bound_ssim_4x4_sums *s = p;
+	while (n--)
+	{
+		s->f(s->sums, s->srcA, 416, s->srcB, 416, s->n);
+	}
+}
+
+
+int mismatch_ssim_4x4_sums(void *boundRef, void *boundTest)
+{
+	bound_ssim_4x4_sums *ref = boundRef;
+	bound_ssim_4x4_sums *test = boundTest;
+
+	return memcmp(ref->sums, test->sums, ref->n * sizeof(ref->sums[0]));
+}
+
+
+void HEVCASM_API hevcasm_test_ssim_4x4_sums(int *error_count, hevcasm_instruction_set mask)
+{
+	hevcasm_test_printf("\nhevcasm_ssim_4x4_sums - Statistics of 4x4 blocks for SSIM\n");
+
+	bound_ssim_4x4_sums b[2];
+
+	for (int i = 0; i < 416 * 4; ++i)
+	{
+		b[0].srcA[i] = hevcasm_test_rand();
+		b[0].srcB[i] = hevcasm_test_rand();
+	}
+
+	const int counts[] = { 104, 31, 2 };
+	for (int i = 0; i < sizeof(counts) / sizeof(counts[0]); ++i)
+	{
+		b[0].n = counts[i];
+		b[1] = b[0];
+		*error_count += hevcasm_test(&b[0], &b[1], init_ssim_4x4_sums, invoke_ssim_4x4_sums, mismatch_ssim_4x4_sums, mask, 1000);
+	}
+}
+
+
+#define METRICS_TEST_WIDTH 416
+#define METRICS_TEST_HEIGHT 240
+#define METRICS_TEST_CTU_SIZE 64
+#define METRICS_TEST_THREADS 4
+#define METRICS_TEST_BANDS ((METRICS_TEST_HEIGHT + METRICS_TEST_CTU_SIZE - 1) / METRICS_TEST_CTU_SIZE)
+
+typedef struct
+{
+	const uint8_t *srcA, *srcB;
+	hevcasm_metrics *metrics;
+	hevcasm_metrics_frame frame;
+	hevcasm_metrics_row rows[METRICS_TEST_BANDS];
+}
+bound_metrics;
+
+
+/* kernels selected by an instruction set and all those before it */
+static void metrics_test_kernels(void *kernels[2], hevcasm_instruction_set mask)
+{
+	hevcasm_table_ssd_plane table_ssd_plane;
+	hevcasm_populate_ssd_plane(&table_ssd_plane, mask | (mask - 1));
+	kernels[0] = (void *)*hevcasm_get_ssd_plane(&table_ssd_plane);
+
+	hevcasm_table_ssim_4x4_sums table_ssim_4x4_sums;
+	hevcasm_populate_ssim_4x4_sums(&table_ssim_4x4_sums, mask | (mask - 1));
+	kernels[1] = (void *)*hevcasm_get_ssim_4x4_sums(&table_ssim_4x4_sums);
+}
+
+
+int init_metrics(void *p, hevcasm_instruction_set mask)
+{
+	bound_metrics *s = p;
+
+	hevcasm_metrics_free(s->metrics);
+	s->metrics = 0;
+
+	if (!mask) return 0;
+
+	/* test an instruction set only where it changes a kernel; C_OPT tests the thread pool with C kernels */
+	if (mask > HEVCASM_C_OPT)
+	{
+		void *kernels[2], *previous[2];
+		metrics_test_kernels(kernels, mask);
+		metrics_test_kernels(previous, mask >> 1);
+		if (kernels[0] == previous[0] && kernels[1] == previous[1]) return 0;
+	}
+
+	/* the reference is single-threaded, all others use a pool of METRICS_TEST_THREADS threads */
+	const int threads = mask == HEVCASM_C_REF ? 1 : METRICS_TEST_THREADS;
+	s->metrics = hevcasm_metrics_create(METRICS_TEST_WIDTH, METRICS_TEST_HEIGHT, METRICS_TEST_CTU_SIZE, threads, mask | (mask - 1));
+
+	if (mask == HEVCASM_C_REF) hevcasm_test_printf("\t%dx%d (C_REF %d thread, others %d) : ", METRICS_TEST_WIDTH, METRICS_TEST_HEIGHT, threads, METRICS_TEST_THREADS);
+
+	return !!s->metrics;
+}
+
+
+void invoke_metrics(void *p, int n)
+{
+	bound_metrics *s = p;
+	while (n--)
+	{
+		hevcasm_metrics_compute(s->metrics, s->srcA, METRICS_TEST_WIDTH, s->srcB, METRICS_TEST_WIDTH, &s->frame, s->rows);
+	}
+}
+
+
+int mismatch_metrics(void *boundRef, void *boundTest)
+{
+	bound_metrics *ref = boundRef;
+	bound_metrics *test = boundTest;
+
+	if (memcmp(&ref->frame, &test->frame, sizeof(ref->frame))) return 1;
+
+	return memcmp(ref->rows, test->rows, sizeof(ref->rows));
+}
+
+
+void HEVCASM_API hevcasm_test_metrics(int *error_count, hevcasm_instruction_set mask)
+{
+	hevcasm_test_printf("\nhevcasm_metrics - Plane PSNR, SSIM and MS-SSIM\n");
+
+	uint8_t *srcA = malloc(METRICS_TEST_WIDTH * METRICS_TEST_HEIGHT);
+	uint8_t *srcB = malloc(METRICS_TEST_WIDTH * METRICS_TEST_HEIGHT);
+
+	/* smooth picture and a noisy copy of it */
+	for (int y = 0; y < METRICS_TEST_HEIGHT; ++y)
+	{
+		for (int x = 0; x < METRICS_TEST_WIDTH; ++x)
+		{
+			const int a = (x * x / 64 + y * 3 + ((x ^ y) & 16)) & 0xff;
+			const int b = a + (hevcasm_test_rand() % 17) - 8;
+			srcA[x + y * METRICS_TEST_WIDTH] = a;
+			srcB[x + y * METRICS_TEST_WIDTH] = b < 0 ? 0 : b > 255 ? 255 : b;
+		}
+	}
+
+	bound_metrics b[2];
+
+	b[0].srcA = srcA;
+	b[0].srcB = srcB;
+	b[0].metrics = 0;
+	b[1] = b[0];
+
+	*error_count += hevcasm_test(&b[0], &b[1], init_metrics, invoke_metrics, mismatch_metrics, mask, 4);
+
+	hevcasm_metrics_free(b[0].metrics);
+	hevcasm_metrics_free(b[1].metrics);
+
+	free(srcA);
+	free(srcB);
+}
+
+#undef METRICS_TEST_WIDTH
+#undef METRICS_TEST_HEIGHT
+#undef METRICS_TEST_CTU_SIZE
+#undef METRICS_TEST_THREADS
+#undef METRICS_TEST_BANDS
@@ -0,0 +1,129 @@
+/*
+The copyright in this software is being made available under the BSD
+License, included below. This software may be subject to other third party
+and contributor rights, including patent rights, and no such rights are
+granted under this license.
+
+
+Copyright(c) 2011 - 2015, Parabola Research Limited
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met :
+
+* Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+this list of conditions and the following disclaimer in the documentation
+and / or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its contributors may
+be used to endorse or promote products derived from this software without
+specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/* Picture quality metrics: PSNR, SSIM and MS-SSIM */
+
+
+#ifndef INCLUDED_metrics_h
+#define INCLUDED_metrics_h
+
+#include "hevcasm.h"
+
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+/* Sum of square differences of a plane region of any size, accumulated in 64 bits */
+typedef uint64_t hevcasm_ssd_plane(const uint8_t *srcA, ptrdiff_t stride_srcA, const uint8_t *srcB, ptrdiff_t stride_srcB, int w, int h);
+
+typedef struct
+{
+	hevcasm_ssd_plane *p;
+}
+hevcasm_table_ssd_plane;
+
+static hevcasm_ssd_plane** hevcasm_get_ssd_plane(hevcasm_table_ssd_plane *table)
+{
+	return &table->p;
+}
+
+void HEVCASM_API hevcasm_populate_ssd_plane(hevcasm_table_ssd_plane *table, hevcasm_instruction_set mask);
+
+void HEVCASM_API hevcasm_test_ssd_plane(int *error_count, hevcasm_instruction_set mask);
+
+
+/* Statistics of n horizontally adjacent 4x4 blocks for SSIM: sums[i] = { sum(a), sum(b), sum(a*a + b*b), sum(a*b) } */
+typedef void hevcasm_ssim_4x4_sums(int32_t sums[][4], const uint8_t *srcA, ptrdiff_t stride_srcA, const uint8_t *srcB, ptrdiff_t stride_srcB, int n);
+
+typedef struct
+{
+	hevcasm_ssim_4x4_sums *p;
+}
+hevcasm_table_ssim_4x4_sums;
+
+static hevcasm_ssim_4x4_sums** hevcasm_get_ssim_4x4_sums(hevcasm_table_ssim_4x4_sums *table)
+{
+	return &table->p;
+}
+
+void HEVCASM_API hevcasm_populate_ssim_4x4_sums(hevcasm_table_ssim_4x4_sums *table, hevcasm_instruction_set mask);
+
+void HEVCASM_API hevcasm_test_ssim_4x4_sums(int *error_count, hevcasm_instruction_set mask);
+
+
+// Plane metrics engine. The plane is split into bands of one CTU row which are processed in parallel by a pool
+// of worker threads. SSIM is the mean over 8x8 windows on a 4-sample grid; MS-SSIM uses five dyadic scales
+// (2x2 average downsampling) with the standard weights and is zero for planes smaller than 128x128.
+// Results are independent of the number of threads and of the instruction set.
+
+typedef struct
+{
+	uint64_t ssd;
+	double psnr; /* dB, 100 when identical */
+	double ssim; /* windows whose top row lies in this CTU row; 1 if there are none */
+}
+hevcasm_metrics_row;
+
+typedef struct
+{
+	uint64_t ssd;
+	double psnr;
+	double ssim;
+	double ms_ssim;
+}
+hevcasm_metrics_frame;
+
+typedef struct hevcasm_metrics hevcasm_metrics;
+
+// threads is the total number of threads, including the caller of hevcasm_metrics_compute(); fewer are used if not all
+// can be started. ctu_size must be a multiple of 16. Returns null on allocation failure.
+hevcasm_metrics* HEVCASM_API hevcasm_metrics_create(int width, int height, int ctu_size, int threads, hevcasm_instruction_set mask);
+
+void HEVCASM_API hevcasm_metrics_free(hevcasm_metrics *metrics);
+
+// Computes metrics of plane B against plane A. rows may be null, otherwise receives one entry per CTU row.
+void HEVCASM_API hevcasm_metrics_compute(hevcasm_metrics *metrics, const uint8_t *srcA, ptrdiff_t stride_srcA, const uint8_t *srcB, ptrdiff_t stride_srcB, hevcasm_metrics_frame *frame, hevcasm_metrics_row *rows);
+
+void HEVCASM_API hevcasm_test_metrics(int *error_count, hevcasm_instruction_set mask);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,178 @@
+; The copyright in this software is being made available under the BSD
+; License, included below. This software may be subject to other third party
+; and contributor rights, including patent rights, and no such rights are
+; granted under this license.
+; 
+; 
+; Copyright(c) 2011 - 2015, Parabola Research Limited
+; All rights reserved.
+; 
+; Redistribution and use in source and binary forms, with or without
+; modification, are permitted provided that the following conditions are met :
+; 
+; * Redistributions of source code must retain the above copyright notice,
+; this list of conditions and the following disclaimer.
+; * Redistributions in binary form must reproduce the above copyright notice,
+; this list of conditions and the following disclaimer in the documentation
+; and / or other materials provided with the distribution.
+; * Neither the name of the copyright holder nor the names of its contributors may
+; be used to endorse or promote products derived from this software without
+; specific prior written permission.
+; 
+; THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+; AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+; IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+; ARE DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+; BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+; CONSEQUENTIAL DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+; SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+; INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+; CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE)
+; ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+; THE POSSIBILITY OF SUCH DAMAGE.
+
+
+%define private_prefix hevcasm
+%include "x86inc.asm"
+
+%define ORDER(a, b, c, d) ((a << 6) | (b << 4) | (c << 2) | d)
+
+
+%if ARCH_X86_64 == 1
+
+SECTION_RODATA 32
+
+constant_times_16_dw_1:
+	times 16 dw 1
+
+
+SECTION .text
+
+
+; uint64_t hevcasm_ssd_plane_16nxh_sse2(const uint8_t *srcA, ptrdiff_t stride_srcA, const uint8_t *srcB, ptrdiff_t stride_srcB, int w, int h);
+; uint64_t hevcasm_ssd_plane_16nxh_avx2(const uint8_t *srcA, ptrdiff_t stride_srcA, const uint8_t *srcB, ptrdiff_t stride_srcB, int w, int h);
+; w must be a multiple of 16 and h greater than zero
+%macro SSD_PLANE 0
+cglobal ssd_plane_16nxh, 6, 7, 8
+	pxor m0, m0 ; q sum of all rows
+	pxor m7, m7
+.row:
+		pxor m6, m6 ; d sum of this row
+		xor r6d, r6d
+.column:
+%if mmsize == 32
+			pmovzxbw m1, [r0 + r6]
+			pmovzxbw m2, [r2 + r6]
+			psubw m1, m2
+			pmaddwd m1, m1
+			paddd m6, m1
+%else
+			movu m1, [r0 + r6]
+			movu m2, [r2 + r6]
+			punpckhbw m3, m1, m7
+			punpckhbw m4, m2, m7
+			punpcklbw m1, m7
+			punpcklbw m2, m7
+			psubw m1, m2
+			psubw m3, m4
+			pmaddwd m1, m1
+			pmaddwd m3, m3
+			paddd m6, m1
+			paddd m6, m3
+%endif
+			add r6d, 16
+			cmp r6d, r4d
+			jl .column
+
+		; widen row sum to 64 bits before it can overflow
+		punpckldq m1, m6, m7
+		punpckhdq m6, m7
+		paddq m0, m1
+		paddq m0, m6
+
+		add r0, r1
+		add r2, r3
+		dec r5d
+		jg .row
+
+%if mmsize == 32
+	vextracti128 xm1, m0, 1
+	paddq xm0, xm1
+%endif
+	movhlps xm1, xm0
+	paddq xm0, xm1
+	movq rax, xm0
+	RET
+%endmacro
+
+INIT_XMM sse2
+SSD_PLANE
+INIT_YMM avx2
+SSD_PLANE
+
+
+; void hevcasm_ssim_4x4_sums_2n_ssse3(int32_t sums[][4], const uint8_t *srcA, ptrdiff_t stride_srcA, const uint8_t *srcB, ptrdiff_t stride_srcB, int n);
+; void hevcasm_ssim_4x4_sums_4n_avx2(int32_t sums[][4], const uint8_t *srcA, ptrdiff_t stride_srcA, const uint8_t *srcB, ptrdiff_t stride_srcB, int n);
+; n must be a non-zero multiple of mmsize / 8
+%macro SSIM_4X4_SUMS 1
+cglobal ssim_4x4_sums_%1n, 6, 8, 8
+	pxor m7, m7
+.loop:
+		pxor m0, m0 ; w sum(a)
+		pxor m1, m1 ; w sum(b)
+		pxor m2, m2 ; d sum(a*a + b*b)
+		pxor m3, m3 ; d sum(a*b)
+		mov r6, r1
+		mov r7, r3
+%rep 4
+%if mmsize == 32
+		pmovzxbw m4, [r6]
+		pmovzxbw m5, [r7]
+%else
+		movq m4, [r6]
+		movq m5, [r7]
+		punpcklbw m4, m7
+		punpcklbw m5, m7
+%endif
+		paddw m0, m4
+		paddw m1, m5
+		pmaddwd m6, m4, m5
+		paddd m3, m6
+		pmaddwd m4, m4
+		pmaddwd m5, m5
+		paddd m2, m4
+		paddd m2, m5
+		add r6, r2
+		add r7, r4
+%endrep
+		pmaddwd m0, [constant_times_16_dw_1]
+		pmaddwd m1, [constant_times_16_dw_1]
+		phaddd m0, m1 ; per lane: s1 of blocks 0 and 1, s2 of blocks 0 and 1
+		phaddd m2, m3 ; per lane: ss of blocks 0 and 1, s12 of blocks 0 and 1
+		pshufd m0, m0, ORDER(3, 1, 2, 0)
+		pshufd m2, m2, ORDER(3, 1, 2, 0)
+		punpckhqdq m1, m0, m2 ; per lane: s1, s2, ss, s12 of block 1
+		punpcklqdq m0, m2 ; per lane: s1, s2, ss, s12 of block 0
+%if mmsize == 32
+		vperm2i128 m2, m0, m1, 0x20
+		vperm2i128 m1, m0, m1, 0x31
+		movu [r0], m2
+		movu [r0 + 32], m1
+%else
+		movu [r0], m0
+		movu [r0 + 16], m1
+%endif
+		add r0, 2 * mmsize
+		add r1, mmsize / 2
+		add r3, mmsize / 2
+		sub r5d, mmsize / 8
+		jg .loop
+	RET
+%endmacro
+
+INIT_XMM ssse3
+SSIM_4X4_SUMS 2
+INIT_YMM avx2
+SSIM_4X4_SUMS 4
+
+%endif
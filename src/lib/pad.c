@@ -0,0 +1,391 @@
+/*
+The copyright in this software is being made available under the BSD
+License, included below. This software may be subject to other third party
+and contributor rights, including patent rights, and no such rights are
+granted under this license.
+
+
+Copyright(c) 2011 - 2015, Parabola Research Limited
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met :
+
+* Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+this list of conditions and the following disclaimer in the documentation
+and / or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its contributors may
+be used to endorse or promote products derived from this software without
+specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "pad.h"
+#include "hevcasm_test.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+
+#ifdef HEVCASM_X64
+hevcasm_pad_horizontal hevcasm_pad_horizontal_sse2;
+hevcasm_pad_horizontal hevcasm_pad_horizontal_nv12_sse2;
+hevcasm_pad_horizontal hevcasm_pad_horizontal_avx2;
+hevcasm_pad_horizontal hevcasm_pad_horizontal_nv12_avx2;
+hevcasm_pad_vertical hevcasm_pad_vertical_sse2;
+hevcasm_pad_vertical hevcasm_pad_vertical_avx2;
+#endif
+
+
+static void hevcasm_pad_horizontal_c_ref(uint8_t *p, ptrdiff_t stride, int w, int h, int pad)
+{
+	while (h--)
+	{
+		memset(p - pad, p[0], pad);
+		memset(p + w, p[w - 1], pad);
+		p += stride;
+	}
+}
+
+
+static void hevcasm_pad_horizontal_nv12_c_ref(uint8_t *p, ptrdiff_t stride, int w, int h, int pad)
+{
+	while (h--)
+	{
+		for (int x = 0; x < pad; ++x)
+		{
+			p[x - pad] = p[x & 1];
+			p[w + x] = p[w - 2 + (x & 1)];
+		}
+		p += stride;
+	}
+}
+
+
+static hevcasm_pad_horizontal * get_pad_horizontal(int interleaved, hevcasm_instruction_set mask)
+{
+	hevcasm_pad_horizontal *f = 0;
+
+	if (mask & (HEVCASM_C_REF | HEVCASM_C_OPT)) f = interleaved ? hevcasm_pad_horizontal_nv12_c_ref : hevcasm_pad_horizontal_c_ref;
+
+#ifdef HEVCASM_X64
+	if (mask & HEVCASM_SSE2) f = interleaved ? hevcasm_pad_horizontal_nv12_sse2 : hevcasm_pad_horizontal_sse2;
+
+	if (mask & HEVCASM_AVX2) f = interleaved ? hevcasm_pad_horizontal_nv12_avx2 : hevcasm_pad_horizontal_avx2;
+#endif
+
+	return f;
+}
+
+
+void HEVCASM_API hevcasm_populate_pad_horizontal(hevcasm_table_pad_horizontal *table, hevcasm_instruction_set mask)
+{
+	for (int interleaved = 0; interleaved < 2; ++interleaved)
+	{
+		*hevcasm_get_pad_horizontal(table, interleaved) = get_pad_horizontal(interleaved, mask);
+	}
+}
+
+
+static void hevcasm_pad_vertical_c_ref(uint8_t *dst, ptrdiff_t stride, const uint8_t *src, int w, int n)
+{
+	while (n--)
+	{
+		memcpy(dst, src, w);
+		dst += stride;
+	}
+}
+
+
+static hevcasm_pad_vertical * get_pad_vertical(hevcasm_instruction_set mask)
+{
+	hevcasm_pad_vertical *f = 0;
+
+	if (mask & (HEVCASM_C_REF | HEVCASM_C_OPT)) f = hevcasm_pad_vertical_c_ref;
+
+#ifdef HEVCASM_X64
+	if (mask & HEVCASM_SSE2) f = hevcasm_pad_vertical_sse2;
+
+	if (mask & HEVCASM_AVX2) f = hevcasm_pad_vertical_avx2;
+#endif
+
+	return f;
+}
+
+
+void HEVCASM_API hevcasm_populate_pad_vertical(hevcasm_table_pad_vertical *table, hevcasm_instruction_set mask)
+{
+	*hevcasm_get_pad_vertical(table) = get_pad_vertical(mask);
+}
+
+
+void HEVCASM_API hevcasm_pad_rows(hevcasm_table_pad_horizontal *horizontal, hevcasm_table_pad_vertical *vertical, uint8_t *plane, ptrdiff_t stride, int w, int h, int pad_x, int pad_y, int interleaved, int y0, int y1)
+{
+	assert(0 <= y0 && y0 <= y1 && y1 <= h);
+
+	if (y1 > y0)
+	{
+		hevcasm_pad_horizontal *f = *hevcasm_get_pad_horizontal(horizontal, interleaved);
+		f(plane + y0 * stride, stride, w, y1 - y0, pad_x);
+	}
+
+	if (pad_y > 0)
+	{
+		hevcasm_pad_vertical *f = *hevcasm_get_pad_vertical(vertical);
+		uint8_t *row = plane - pad_x;
+
+		if (y0 == 0)
+		{
+			f(row - pad_y * stride, stride, row, w + 2 * pad_x, pad_y);
+		}
+
+		if (y1 == h)
+		{
+			f(row + h * stride, stride, row + (h - 1) * stride, w + 2 * pad_x, pad_y);
+		}
+	}
+}
+
+
+#define STRIDE_PAD 576
+
+typedef struct
+{
+	HEVCASM_ALIGN(32, uint8_t, buffer[48 * STRIDE_PAD]);
+	hevcasm_pad_horizontal *f_horizontal;
+	hevcasm_pad_vertical *f_vertical;
+	int interleaved;
+	int w;
+	int pad;
+	int n;
+}
+bound_pad;
+
+
+static int init_pad_horizontal(void *p, hevcasm_instruction_set mask)
+{
+	bound_pad *s = p;
+	hevcasm_table_pad_horizontal table;
+	hevcasm_populate_pad_horizontal(&table, mask);
+	hevcasm_pad_horizontal **entry = hevcasm_get_pad_horizontal(&table, s->interleaved);
+	hevcasm_test_report_kernel(&table, sizeof(table), entry);
+	s->f_horizontal = *entry;
+	assert(s->f_horizontal == get_pad_horizontal(s->interleaved, mask));
+	if (s->f_horizontal && mask == HEVCASM_C_REF)
+	{
+		hevcasm_test_printf("\t%s w=%d h=%d pad=%d : ", s->interleaved ? "CbCr" : "Y", s->w, s->n, s->pad);
+	}
+	return !!s->f_horizontal;
+}
+
+
+static void invoke_pad_horizontal(void *p, int iterations)
+{
+	bound_pad *s = p;
+	while (iterations--)
+	{
+		s->f_horizontal(s->buffer + 80, STRIDE_PAD, s->w, s->n, s->pad);
+	}
+}
+
+
+static int mismatch_pad(void *boundRef, void *boundTest)
+{
+	bound_pad *ref = boundRef;
+	bound_pad *test = boundTest;
+
+	return !!memcmp(ref->buffer, test->buffer, sizeof(ref->buffer));
+}
+
+
+void HEVCASM_API hevcasm_test_pad_horizontal(int *error_count, hevcasm_instruction_set mask)
+{
+	hevcasm_test_printf("\nhevcasm_pad_horizontal - Reference Picture Left and Right Border Extension\n");
+
+	bound_pad b[2];
+
+	for (int x = 0; x < 48 * STRIDE_PAD; ++x) b[0].buffer[x] = hevcasm_test_rand() & 0xff;
+
+	b[0].n = 48;
+
+	for (b[0].interleaved = 0; b[0].interleaved < 2; ++b[0].interleaved)
+	{
+		const int widths[3] = { 64, 126, 416 };
+
+		for (int k = 0; k < 3; ++k)
+		{
+			b[0].w = widths[k];
+			b[0].pad = b[0].interleaved ? 80 : 40 + 40 * (k & 1);
+			b[1] = b[0];
+			*error_count += hevcasm_test(&b[0], &b[1], init_pad_horizontal, invoke_pad_horizontal, mismatch_pad, mask, 1000);
+		}
+	}
+
+	/* no rows: nothing is written */
+	b[0].interleaved = 0;
+	b[0].w = 64;
+	b[0].pad = 40;
+	b[0].n = 0;
+	b[1] = b[0];
+	*error_count += hevcasm_test(&b[0], &b[1], init_pad_horizontal, invoke_pad_horizontal, mismatch_pad, mask, 1000);
+}
+
+
+static int init_pad_vertical(void *p, hevcasm_instruction_set mask)
+{
+	bound_pad *s = p;
+	hevcasm_table_pad_vertical table;
+	hevcasm_populate_pad_vertical(&table, mask);
+	hevcasm_pad_vertical **entry = hevcasm_get_pad_vertical(&table);
+	hevcasm_test_report_kernel(&table, sizeof(table), entry);
+	s->f_vertical = *entry;
+	assert(s->f_vertical == get_pad_vertical(mask));
+	if (s->f_vertical && mask == HEVCASM_C_REF)
+	{
+		hevcasm_test_printf("\tw=%d n=%d : ", s->w, s->n - 1);
+	}
+	return !!s->f_vertical;
+}
+
+
+static void invoke_pad_vertical(void *p, int iterations)
+{
+	bound_pad *s = p;
+	while (iterations--)
+	{
+		/* source row is the last row of the buffer; destination rows start at an unaligned address */
+		s->f_vertical(s->buffer + 3, STRIDE_PAD, s->buffer + (s->n - 1) * STRIDE_PAD + 3, s->w, s->n - 1);
+	}
+}
+
+
+void HEVCASM_API hevcasm_test_pad_vertical(int *error_count, hevcasm_instruction_set mask)
+{
+	hevcasm_test_printf("\nhevcasm_pad_vertical - Reference Picture Top and Bottom Border Extension\n");
+
+	bound_pad b[2];
+
+	for (int x = 0; x < 48 * STRIDE_PAD; ++x) b[0].buffer[x] = hevcasm_test_rand() & 0xff;
+
+	b[0].n = 48;
+
+	const int widths[3] = { 64 + 2 * 40, 126 + 2 * 80, 416 + 2 * 72 };
+
+	for (int k = 0; k < 3; ++k)
+	{
+		b[0].w = widths[k];
+		b[1] = b[0];
+		*error_count += hevcasm_test(&b[0], &b[1], init_pad_vertical, invoke_pad_vertical, mismatch_pad, mask, 1000);
+	}
+
+	/* no rows: nothing is written */
+	b[0].w = widths[0];
+	b[0].n = 1;
+	b[1] = b[0];
+	*error_count += hevcasm_test(&b[0], &b[1], init_pad_vertical, invoke_pad_vertical, mismatch_pad, mask, 1000);
+}
+
+
+#define ROWS_PAD 136
+
+typedef struct
+{
+	HEVCASM_ALIGN(32, uint8_t, buffer[ROWS_PAD * STRIDE_PAD]);
+	hevcasm_table_pad_horizontal horizontal;
+	hevcasm_table_pad_vertical vertical;
+	int interleaved;
+	int w;
+	int h;
+	int pad_x;
+	int pad_y;
+	int band;
+	int whole;
+}
+bound_pad_rows;
+
+
+static int init_pad_rows(void *p, hevcasm_instruction_set mask)
+{
+	bound_pad_rows *s = p;
+	hevcasm_populate_pad_horizontal(&s->horizontal, mask);
+	hevcasm_populate_pad_vertical(&s->vertical, mask);
+	const int ok = *hevcasm_get_pad_horizontal(&s->horizontal, s->interleaved) && *hevcasm_get_pad_vertical(&s->vertical);
+	if (ok && mask == HEVCASM_C_REF)
+	{
+		hevcasm_test_printf("\t%s %dx%d pad=%d,%d band=%d : ", s->interleaved ? "CbCr" : "Y", s->w, s->h, s->pad_x, s->pad_y, s->band);
+	}
+	return ok;
+}
+
+
+static void invoke_pad_rows(void *p, int iterations)
+{
+	bound_pad_rows *s = p;
+	uint8_t *plane = s->buffer + s->pad_y * STRIDE_PAD + 80;
+	while (iterations--)
+	{
+		const int band = s->whole ? s->h : s->band;
+		for (int y0 = 0; y0 < s->h; y0 += band)
+		{
+			const int y1 = y0 + band < s->h ? y0 + band : s->h;
+			hevcasm_pad_rows(&s->horizontal, &s->vertical, plane, STRIDE_PAD, s->w, s->h, s->pad_x, s->pad_y, s->interleaved, y0, y1);
+		}
+	}
+}
+
+
+static int mismatch_pad_rows(void *boundRef, void *boundTest)
+{
+	bound_pad_rows *ref = boundRef;
+	bound_pad_rows *test = boundTest;
+
+	return !!memcmp(ref->buffer, test->buffer, sizeof(ref->buffer));
+}
+
+
+void HEVCASM_API hevcasm_test_pad_rows(int *error_count, hevcasm_instruction_set mask)
+{
+	hevcasm_test_printf("\nhevcasm_pad_rows - Incremental Reference Picture Border Extension (bands vs. whole plane)\n");
+
+	bound_pad_rows b[2];
+
+	for (int x = 0; x < ROWS_PAD * STRIDE_PAD; ++x) b[0].buffer[x] = hevcasm_test_rand() & 0xff;
+
+	/* interleaved, w, h, pad_x, pad_y, band: band heights need not divide the plane height */
+	const int cases[3][6] = { { 0, 416, 72, 80, 32, 32 }, { 0, 126, 60, 40, 24, 16 }, { 1, 208, 36, 80, 16, 16 } };
+
+	for (int k = 0; k < 3; ++k)
+	{
+		b[0].interleaved = cases[k][0];
+		b[0].w = cases[k][1];
+		b[0].h = cases[k][2];
+		b[0].pad_x = cases[k][3];
+		b[0].pad_y = cases[k][4];
+		b[0].band = cases[k][5];
+		b[1] = b[0];
+
+		/* the reference pads the whole plane in a single call */
+		b[0].whole = 1;
+		b[1].whole = 0;
+
+		*error_count += hevcasm_test(&b[0], &b[1], init_pad_rows, invoke_pad_rows, mismatch_pad_rows, mask, 1000);
+	}
+}
+
+#undef ROWS_PAD
+
+#undef STRIDE_PAD
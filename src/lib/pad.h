@@ -0,0 +1,111 @@
+/*
+The copyright in this software is being made available under the BSD
+License, included below. This software may be subject to other third party
+and contributor rights, including patent rights, and no such rights are
+granted under this license.
+
+
+Copyright(c) 2011 - 2015, Parabola Research Limited
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met :
+
+* Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+this list of conditions and the following disclaimer in the documentation
+and / or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its contributors may
+be used to endorse or promote products derived from this software without
+specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/* Reference picture border extension (padding) */
+
+
+#ifndef INCLUDED_pad_h
+#define INCLUDED_pad_h
+
+#include "hevcasm.h"
+
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+// Motion vectors may point outside the picture so reference pictures carry a border of replicated samples around
+// each plane. Interleaved (NV12) chroma planes replicate CbCr sample pairs. All widths and padding sizes are in bytes.
+
+
+// Replicates the first and last samples of each of h rows, starting at p[0] and ending at p[w - 1], into the pad
+// bytes to the left and to the right of the row. h may be zero. pad is even for interleaved planes. Optimised
+// implementations require pad >= 32.
+
+typedef void hevcasm_pad_horizontal(uint8_t *p, ptrdiff_t stride, int w, int h, int pad);
+
+typedef struct
+{
+	hevcasm_pad_horizontal *p[2];
+}
+hevcasm_table_pad_horizontal;
+
+static hevcasm_pad_horizontal** hevcasm_get_pad_horizontal(hevcasm_table_pad_horizontal *table, int interleaved)
+{
+	return &table->p[interleaved ? 1 : 0];
+}
+
+void HEVCASM_API hevcasm_populate_pad_horizontal(hevcasm_table_pad_horizontal *table, hevcasm_instruction_set mask);
+
+void HEVCASM_API hevcasm_test_pad_horizontal(int *error_count, hevcasm_instruction_set mask);
+
+
+// Copies the w bytes at src to each of n rows starting at dst; n may be zero. Optimised implementations use
+// non-temporal stores as border rows are not read again until motion compensation and require w >= 32.
+
+typedef void hevcasm_pad_vertical(uint8_t *dst, ptrdiff_t stride, const uint8_t *src, int w, int n);
+
+typedef struct
+{
+	hevcasm_pad_vertical *p;
+}
+hevcasm_table_pad_vertical;
+
+static hevcasm_pad_vertical** hevcasm_get_pad_vertical(hevcasm_table_pad_vertical *table)
+{
+	return &table->p;
+}
+
+void HEVCASM_API hevcasm_populate_pad_vertical(hevcasm_table_pad_vertical *table, hevcasm_instruction_set mask);
+
+void HEVCASM_API hevcasm_test_pad_vertical(int *error_count, hevcasm_instruction_set mask);
+
+
+// Pads rows [y0, y1) of a w x h plane to the left and right by pad_x. The pad_y rows above the plane are written
+// when y0 is 0 and the pad_y rows below when y1 is h. Calling this as each CTU row becomes final (i.e. after
+// in-loop filtering) pads the picture incrementally; a single call with y0 = 0 and y1 = h pads the whole plane.
+
+void HEVCASM_API hevcasm_pad_rows(hevcasm_table_pad_horizontal *horizontal, hevcasm_table_pad_vertical *vertical, uint8_t *plane, ptrdiff_t stride, int w, int h, int pad_x, int pad_y, int interleaved, int y0, int y1);
+
+void HEVCASM_API hevcasm_test_pad_rows(int *error_count, hevcasm_instruction_set mask);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
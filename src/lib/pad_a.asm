@@ -0,0 +1,171 @@
+; The copyright in this software is being made available under the BSD
+; License, included below. This software may be subject to other third party
+; and contributor rights, including patent rights, and no such rights are
+; granted under this license.
+; 
+; 
+; Copyright(c) 2011 - 2015, Parabola Research Limited
+; All rights reserved.
+; 
+; Redistribution and use in source and binary forms, with or without
+; modification, are permitted provided that the following conditions are met :
+; 
+; * Redistributions of source code must retain the above copyright notice,
+; this list of conditions and the following disclaimer.
+; * Redistributions in binary form must reproduce the above copyright notice,
+; this list of conditions and the following disclaimer in the documentation
+; and / or other materials provided with the distribution.
+; * Neither the name of the copyright holder nor the names of its contributors may
+; be used to endorse or promote products derived from this software without
+; specific prior written permission.
+; 
+; THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+; AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+; IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+; ARE DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+; BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+; CONSEQUENTIAL DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+; SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+; INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+; CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE)
+; ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+; THE POSSIBILITY OF SUCH DAMAGE.
+
+
+%define private_prefix hevcasm
+%include "x86inc.asm"
+
+
+SECTION .text
+
+
+%if ARCH_X86_64 == 1
+
+%macro PAD_BROADCAST 3
+	; %1 destination register
+	; %2 bytes per sample: 1 (planar) or 2 (interleaved CbCr)
+	; %3 address of sample
+
+	%if mmsize == 32
+		%if %2 == 1
+			vpbroadcastb %1, byte %3
+		%else
+			vpbroadcastw %1, word %3
+		%endif
+	%else
+		%if %2 == 1
+			movzx r6d, byte %3
+			imul r6d, 0x01010101
+		%else
+			movzx r6d, word %3
+			imul r6d, 0x00010001
+		%endif
+		movd %1, r6d
+		pshufd %1, %1, 0
+	%endif
+%endmacro
+
+
+%macro PAD_HORIZONTAL 1
+	; %1 bytes per sample: 1 (planar) or 2 (interleaved CbCr)
+
+	; void hevcasm_pad_horizontal[_nv12]_isa(uint8_t *p, ptrdiff_t stride, int w, int h, int pad);
+	%if %1 == 1
+		cglobal pad_horizontal, 5, 7, 2
+	%else
+		cglobal pad_horizontal_nv12, 5, 7, 2
+	%endif
+		movsxd r2, r2d
+		movsxd r4, r4d
+		test r3d, r3d
+		jle .done
+		; no rows: nothing to write
+
+		.row
+			PAD_BROADCAST m0, %1, [r0]
+			PAD_BROADCAST m1, %1, [r0 + r2 - %1]
+			; m0 = first sample, m1 = last sample
+
+			mov r5, r0
+			sub r5, r4
+			movu [r5], m0
+			lea r6, [r0 - mmsize]
+			; r5 = p - pad
+
+			.left
+				movu [r6], m0
+				sub r6, mmsize
+				cmp r6, r5
+				ja .left
+
+			lea r6, [r0 + r2]
+			lea r5, [r6 + r4 - mmsize]
+			movu [r5], m1
+			; r5 = p + w + pad - mmsize
+
+			.right
+				movu [r6], m1
+				add r6, mmsize
+				cmp r6, r5
+				jb .right
+
+			add r0, r1
+			dec r3d
+			jg .row
+		.done
+		RET
+%endmacro
+
+
+; void hevcasm_pad_vertical_isa(uint8_t *dst, ptrdiff_t stride, const uint8_t *src, int w, int n);
+%macro PAD_VERTICAL 0
+	cglobal pad_vertical, 5, 7, 1
+		movsxd r3, r3d
+		lea r6, [r3 - mmsize]
+		; r6 = offset of the last store of each row
+
+		test r4d, r4d
+		jle .done
+		; no rows: nothing to write
+
+		.row
+			movu m0, [r2]
+			movu [r0], m0
+
+			mov r5, r0
+			neg r5
+			and r5, mmsize - 1
+			; r5 = offset of the first aligned store
+
+			jmp .test
+			.column
+				movu m0, [r2 + r5]
+				movntdq [r0 + r5], m0
+				add r5, mmsize
+			.test
+				cmp r5, r6
+				jle .column
+
+			movu m0, [r2 + r6]
+			movu [r0 + r6], m0
+
+			add r0, r1
+			dec r4d
+			jg .row
+		sfence
+		.done
+		RET
+%endmacro
+
+
+INIT_XMM sse2
+PAD_HORIZONTAL 1
+PAD_HORIZONTAL 2
+PAD_VERTICAL
+
+INIT_YMM avx2
+PAD_HORIZONTAL 1
+PAD_HORIZONTAL 2
+PAD_VERTICAL
+
+%endif
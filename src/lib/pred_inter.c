@@ -41,6 +41,14 @@ THE POSSIBILITY OF SUCH DAMAGE.
 #include <string.h>
 #include <assert.h>
 
+#ifdef WIN32
+#include <Windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#endif
+
 
 static int Clip3(int min, int max, int value)
 {
@@ -192,13 +200,28 @@ void hevcasm_pred_uni_8tap_8to8_hv(uint8_t *dst, ptrdiff_t stride_dst, const uin
 	hevcasm_pred_uni_ ## taps ## tap_16to8_v ## suffix(dst, stride_dst, intermediate + (taps/2-1) * 64, 64, nPbW, nPbH, 0, yFrac); \
 } \
 
+MAKE_hevcasm_pred_uni_xtap_8to8_hv(8, _4xh_sse4)
+MAKE_hevcasm_pred_uni_xtap_8to8_hv(8, _8xh_sse4)
 MAKE_hevcasm_pred_uni_xtap_8to8_hv(8, _16xh_sse4)
+MAKE_hevcasm_pred_uni_xtap_8to8_hv(8, _24xh_sse4)
 MAKE_hevcasm_pred_uni_xtap_8to8_hv(8, _32xh_sse4)
 MAKE_hevcasm_pred_uni_xtap_8to8_hv(8, _48xh_sse4)
 MAKE_hevcasm_pred_uni_xtap_8to8_hv(8, _64xh_sse4)
+MAKE_hevcasm_pred_uni_xtap_8to8_hv(4, _4xh_sse4)
+MAKE_hevcasm_pred_uni_xtap_8to8_hv(4, _8xh_sse4)
 MAKE_hevcasm_pred_uni_xtap_8to8_hv(4, _16xh_sse4)
+MAKE_hevcasm_pred_uni_xtap_8to8_hv(4, _24xh_sse4)
 MAKE_hevcasm_pred_uni_xtap_8to8_hv(4, _32xh_sse4)
 
+#ifdef HEVCASM_X64
+MAKE_hevcasm_pred_uni_xtap_8to8_hv(8, _16xh_avx2)
+MAKE_hevcasm_pred_uni_xtap_8to8_hv(8, _32xh_avx2)
+MAKE_hevcasm_pred_uni_xtap_8to8_hv(8, _48xh_avx2)
+MAKE_hevcasm_pred_uni_xtap_8to8_hv(8, _64xh_avx2)
+MAKE_hevcasm_pred_uni_xtap_8to8_hv(4, _16xh_avx2)
+MAKE_hevcasm_pred_uni_xtap_8to8_hv(4, _32xh_avx2)
+#endif
+
 
 void hevcasm_pred_uni_4tap_8to8_h(uint8_t *dst, ptrdiff_t stride_dst, const uint8_t *ref, ptrdiff_t stride_ref, int w, int h, int xFrac, int yFrac)
 {
@@ -308,7 +331,10 @@ static hevcasm_pred_uni_8to8* get_pred_uni_8to8(int taps, int w, int h, int xFra
 			if (w <= 64) f = hevcasm_pred_uni_8tap_8to8_h_64xh_sse4;
 			if (w <= 48) f = hevcasm_pred_uni_8tap_8to8_h_48xh_sse4;
 			if (w <= 32) f = hevcasm_pred_uni_8tap_8to8_h_32xh_sse4;
+			if (w <= 24) f = hevcasm_pred_uni_8tap_8to8_h_24xh_sse4;
 			if (w <= 16) f = hevcasm_pred_uni_8tap_8to8_h_16xh_sse4;
+			if (w <= 8) f = hevcasm_pred_uni_8tap_8to8_h_8xh_sse4;
+			if (w <= 4) f = hevcasm_pred_uni_8tap_8to8_h_4xh_sse4;
 		}
 		if (taps == 8 && !xFrac && yFrac)
 		{
@@ -318,18 +344,25 @@ static hevcasm_pred_uni_8to8* get_pred_uni_8to8(int taps, int w, int h, int xFra
 			if (w <= 24) f = hevcasm_pred_uni_8tap_8to8_v_24xh_sse4;
 			if (w <= 16) f = hevcasm_pred_uni_8tap_8to8_v_16xh_sse4;
 			if (w <= 8) f = hevcasm_pred_uni_8tap_8to8_v_8xh_sse4;
+			if (w <= 4) f = hevcasm_pred_uni_8tap_8to8_v_4xh_sse4;
 		}
 		if (taps == 8 && xFrac && yFrac)
 		{
 			if (w <= 64) f = hevcasm_pred_uni_8tap_8to8_hv_64xh_sse4;
 			if (w <= 48) f = hevcasm_pred_uni_8tap_8to8_hv_48xh_sse4;
 			if (w <= 32) f = hevcasm_pred_uni_8tap_8to8_hv_32xh_sse4;
+			if (w <= 24) f = hevcasm_pred_uni_8tap_8to8_hv_24xh_sse4;
 			if (w <= 16) f = hevcasm_pred_uni_8tap_8to8_hv_16xh_sse4;
+			if (w <= 8) f = hevcasm_pred_uni_8tap_8to8_hv_8xh_sse4;
+			if (w <= 4) f = hevcasm_pred_uni_8tap_8to8_hv_4xh_sse4;
 		}
 		if (taps == 4 && xFrac && !yFrac)
 		{
-			if (w <= 16) f = hevcasm_pred_uni_4tap_8to8_h_16xh_sse4;
 			if (w <= 32) f = hevcasm_pred_uni_4tap_8to8_h_32xh_sse4;
+			if (w <= 24) f = hevcasm_pred_uni_4tap_8to8_h_24xh_sse4;
+			if (w <= 16) f = hevcasm_pred_uni_4tap_8to8_h_16xh_sse4;
+			if (w <= 8) f = hevcasm_pred_uni_4tap_8to8_h_8xh_sse4;
+			if (w <= 4) f = hevcasm_pred_uni_4tap_8to8_h_4xh_sse4;
 		}
 		if (taps == 4 && !xFrac && yFrac)
 		{
@@ -337,13 +370,67 @@ static hevcasm_pred_uni_8to8* get_pred_uni_8to8(int taps, int w, int h, int xFra
 			if (w <= 24) f = hevcasm_pred_uni_4tap_8to8_v_24xh_sse4;
 			if (w <= 16) f = hevcasm_pred_uni_4tap_8to8_v_16xh_sse4;
 			if (w <= 8) f = hevcasm_pred_uni_4tap_8to8_v_8xh_sse4;
+			if (w <= 4) f = hevcasm_pred_uni_4tap_8to8_v_4xh_sse4;
 		}
 		if (taps == 4 && xFrac && yFrac)
 		{
 			if (w <= 32) f = hevcasm_pred_uni_4tap_8to8_hv_32xh_sse4;
+			if (w <= 24) f = hevcasm_pred_uni_4tap_8to8_hv_24xh_sse4;
 			if (w <= 16) f = hevcasm_pred_uni_4tap_8to8_hv_16xh_sse4;
+			if (w <= 8) f = hevcasm_pred_uni_4tap_8to8_hv_8xh_sse4;
+			if (w <= 4) f = hevcasm_pred_uni_4tap_8to8_hv_4xh_sse4;
+		}
+	}
+
+#ifdef HEVCASM_X64
+	if (mask & HEVCASM_AVX2)
+	{
+		if (!xFrac && !yFrac)
+		{
+			if (w <= 64) f = hevcasm_pred_uni_copy_8to8_64xh_avx2;
+			if (w <= 48) f = hevcasm_pred_uni_copy_8to8_48xh_avx2;
+			if (w <= 32) f = hevcasm_pred_uni_copy_8to8_32xh_avx2;
+			if (w <= 16) f = hevcasm_pred_uni_copy_8to8_16xh_sse2;
+		}
+		if (taps == 8 && xFrac && !yFrac && w > 8)
+		{
+			if (w <= 64) f = hevcasm_pred_uni_8tap_8to8_h_64xh_avx2;
+			if (w <= 48) f = hevcasm_pred_uni_8tap_8to8_h_48xh_avx2;
+			if (w <= 32) f = hevcasm_pred_uni_8tap_8to8_h_32xh_avx2;
+			if (w <= 16) f = hevcasm_pred_uni_8tap_8to8_h_16xh_avx2;
+		}
+		if (taps == 8 && !xFrac && yFrac && w > 8)
+		{
+			if (w <= 64) f = hevcasm_pred_uni_8tap_8to8_v_64xh_avx2;
+			if (w <= 48) f = hevcasm_pred_uni_8tap_8to8_v_48xh_avx2;
+			if (w <= 32) f = hevcasm_pred_uni_8tap_8to8_v_32xh_avx2;
+			if (w <= 16) f = hevcasm_pred_uni_8tap_8to8_v_16xh_avx2;
+		}
+		if (taps == 8 && xFrac && yFrac && w > 8)
+		{
+			if (w <= 64) f = hevcasm_pred_uni_8tap_8to8_hv_64xh_avx2;
+			if (w <= 48) f = hevcasm_pred_uni_8tap_8to8_hv_48xh_avx2;
+			if (w <= 32) f = hevcasm_pred_uni_8tap_8to8_hv_32xh_avx2;
+			if (w <= 16) f = hevcasm_pred_uni_8tap_8to8_hv_16xh_avx2;
+		}
+		if (taps == 4 && xFrac && !yFrac && w > 8)
+		{
+			if (w <= 32) f = hevcasm_pred_uni_4tap_8to8_h_32xh_avx2;
+			if (w <= 16) f = hevcasm_pred_uni_4tap_8to8_h_16xh_avx2;
+		}
+		if (taps == 4 && !xFrac && yFrac && w > 8)
+		{
+			if (w <= 32) f = hevcasm_pred_uni_4tap_8to8_v_32xh_avx2;
+			if (w <= 16) f = hevcasm_pred_uni_4tap_8to8_v_16xh_avx2;
+		}
+		if (taps == 4 && xFrac && yFrac && w > 8)
+		{
+			if (w <= 32) f = hevcasm_pred_uni_4tap_8to8_hv_32xh_avx2;
+			if (w <= 16) f = hevcasm_pred_uni_4tap_8to8_hv_16xh_avx2;
 		}
 	}
+#endif
+
 	return f;
 }
 
@@ -352,7 +439,7 @@ void hevcasm_populate_pred_uni_8to8(hevcasm_table_pred_uni_8to8 *table, hevcasm_
 {
 	for (int taps = 4; taps <= 8; taps += 4)
 	{
-		for (int w = 0; w <= 8 * taps; w += taps)
+		for (int w = 0; w <= 8 * taps; w += 4)
 		{
 			for (int xFrac = 0; xFrac < 2; ++xFrac)
 			{
@@ -394,13 +481,15 @@ static int get_pred_uni(void *p, hevcasm_instruction_set mask)
 
 	hevcasm_populate_pred_uni_8to8(&table, mask);
 
-	s->f = *hevcasm_get_pred_uni_8to8(&table, s->taps, s->w, s->h, s->xFrac, s->yFrac);
+	hevcasm_pred_uni_8to8 **entry = hevcasm_get_pred_uni_8to8(&table, s->taps, s->w, s->h, s->xFrac, s->yFrac);
+	hevcasm_test_report_kernel(&table, sizeof(table), entry);
+	s->f = *entry;
 
 	assert(s->f == get_pred_uni_8to8(s->taps, s->w, s->h, s->xFrac, s->yFrac, mask));
 
 	if (s->f && mask == HEVCASM_C_REF)
 	{
-		printf("\t%dx%d %d-tap %s%s : ", s->w, s->h, s->taps, s->xFrac ? "H" : "", s->yFrac ? "V" : "");
+		hevcasm_test_printf("\t%dx%d %d-tap %s%s : ", s->w, s->h, s->taps, s->xFrac ? "H" : "", s->yFrac ? "V" : "");
 	}
 
 	memset(s->dst, 0, 64 * s->stride_dst);
@@ -460,7 +549,7 @@ static void test_partitions(int *error_count, bound_pred_uni *b, hevcasm_instruc
 
 void HEVCASM_API hevcasm_test_pred_uni(int *error_count, hevcasm_instruction_set mask)
 {
-	printf("\nhevcasm_pred_uni - Unireference Inter Prediction (single-reference motion compensation)\n");
+	hevcasm_test_printf("\nhevcasm_pred_uni - Unireference Inter Prediction (single-reference motion compensation)\n");
 
 	bound_pred_uni b[2];
 
@@ -472,7 +561,7 @@ void HEVCASM_API hevcasm_test_pred_uni(int *error_count, hevcasm_instruction_set
 #undef STRIDE_DST
 #undef STRIDE_REF
 
-	for (int x = 0; x < 80 * b[0].stride_ref; x++) ref[x] = rand() & 0xff;
+	for (int x = 0; x < 80 * b[0].stride_ref; x++) ref[x] = hevcasm_test_rand() & 0xff;
 
 	for (b[0].taps = 8; b[0].taps >= 4; b[0].taps -= 4)
 	{
@@ -530,29 +619,60 @@ MAKE_hevcasm_pred_bi_xtap_8to8(8)
 MAKE_hevcasm_pred_bi_xtap_8to8(4)
 
 
-#define MAKE_hevcasm_pred_bi_xtap_8to8_sse4(taps, width) \
+/* Height of the row strips processed by the SIMD bi prediction wrappers */
+#define HEVCASM_PRED_BI_STRIP 16
+
+
+#define MAKE_hevcasm_pred_bi_xtap_8to8_hv(taps, suffix) \
 	\
-	void hevcasm_pred_bi_ ## taps ## tap_8to8_ ## width ## xh_sse4(uint8_t *dst, ptrdiff_t stride_dst, const uint8_t *ref0, const uint8_t *ref1, ptrdiff_t stride_ref, int w, int h, int xFrac0, int yFrac0, int xFrac1, int yFrac1) \
+	void hevcasm_pred_bi_ ## taps ## tap_8to8 ## suffix(uint8_t *dst, ptrdiff_t stride_dst, const uint8_t *ref0, const uint8_t *ref1, ptrdiff_t stride_ref, int w, int h, int xFrac0, int yFrac0, int xFrac1, int yFrac1) \
 { \
-	HEVCASM_ALIGN(32, int16_t, intermediate[2][(64 + taps - 1) * 64]); /* todo: can reduce stack usage here by making array size function of width */ \
-	\
-	/* Horizontal filter */ \
-	hevcasm_pred_uni_ ## taps ## tap_8to16_h_ ## width ## xh_sse4(intermediate[0], 64, ref0 - (taps/2-1) * stride_ref, stride_ref, w, h + taps - 1, xFrac0, 0); \
-	 \
-	/* Horizontal filter */ \
-	hevcasm_pred_uni_ ## taps ## tap_8to16_h_ ## width ## xh_sse4(intermediate[1], 64, ref1 - (taps/2-1) * stride_ref, stride_ref, w, h + taps - 1, xFrac1, 0); \
+	/* Each intermediate holds one strip of rows plus the taps - 1 rows of context it shares with the next strip */ \
+	HEVCASM_ALIGN(32, int16_t, intermediate[2][(HEVCASM_PRED_BI_STRIP + taps - 1) * 64]); \
 	\
-	/* Two vertical filters and combine their output for bi pred */ \
-	hevcasm_pred_bi_v_ ## taps ## tap_16to16_ ## width ## xh_sse4(dst, stride_dst, intermediate[0], intermediate[1], 64, w, h, yFrac0, yFrac1); \
+	for (int y = 0; y < h; y += HEVCASM_PRED_BI_STRIP) \
+	{ \
+		const int n = h - y < HEVCASM_PRED_BI_STRIP ? h - y : HEVCASM_PRED_BI_STRIP; \
+		const int carried = y ? taps - 1 : 0; \
+		\
+		/* Slide the context rows of the previous strip to the top */ \
+		memcpy(intermediate[0], intermediate[0] + HEVCASM_PRED_BI_STRIP * 64, carried * 64 * sizeof(int16_t)); \
+		memcpy(intermediate[1], intermediate[1] + HEVCASM_PRED_BI_STRIP * 64, carried * 64 * sizeof(int16_t)); \
+		\
+		/* Horizontal filter */ \
+		hevcasm_pred_uni_ ## taps ## tap_8to16_h ## suffix(intermediate[0] + carried * 64, 64, ref0 + (y + carried - (taps/2-1)) * stride_ref, stride_ref, w, n + taps - 1 - carried, xFrac0, 0); \
+		\
+		/* Horizontal filter */ \
+		hevcasm_pred_uni_ ## taps ## tap_8to16_h ## suffix(intermediate[1] + carried * 64, 64, ref1 + (y + carried - (taps/2-1)) * stride_ref, stride_ref, w, n + taps - 1 - carried, xFrac1, 0); \
+		\
+		/* Two vertical filters and combine their output for bi pred */ \
+		hevcasm_pred_bi_v_ ## taps ## tap_16to16 ## suffix(dst + y * stride_dst, stride_dst, intermediate[0], intermediate[1], 64, w, n, yFrac0, yFrac1); \
+	} \
 } \
 
-MAKE_hevcasm_pred_bi_xtap_8to8_sse4(8, 16)
-MAKE_hevcasm_pred_bi_xtap_8to8_sse4(8, 32)
-MAKE_hevcasm_pred_bi_xtap_8to8_sse4(8, 48)
-MAKE_hevcasm_pred_bi_xtap_8to8_sse4(8, 64)
+MAKE_hevcasm_pred_bi_xtap_8to8_hv(8, _4xh_sse4)
+MAKE_hevcasm_pred_bi_xtap_8to8_hv(8, _8xh_sse4)
+MAKE_hevcasm_pred_bi_xtap_8to8_hv(8, _16xh_sse4)
+MAKE_hevcasm_pred_bi_xtap_8to8_hv(8, _24xh_sse4)
+MAKE_hevcasm_pred_bi_xtap_8to8_hv(8, _32xh_sse4)
+MAKE_hevcasm_pred_bi_xtap_8to8_hv(8, _48xh_sse4)
+MAKE_hevcasm_pred_bi_xtap_8to8_hv(8, _64xh_sse4)
+
+MAKE_hevcasm_pred_bi_xtap_8to8_hv(4, _4xh_sse4)
+MAKE_hevcasm_pred_bi_xtap_8to8_hv(4, _8xh_sse4)
+MAKE_hevcasm_pred_bi_xtap_8to8_hv(4, _16xh_sse4)
+MAKE_hevcasm_pred_bi_xtap_8to8_hv(4, _24xh_sse4)
+MAKE_hevcasm_pred_bi_xtap_8to8_hv(4, _32xh_sse4)
 
-MAKE_hevcasm_pred_bi_xtap_8to8_sse4(4, 16)
-MAKE_hevcasm_pred_bi_xtap_8to8_sse4(4, 32)
+#ifdef HEVCASM_X64
+MAKE_hevcasm_pred_bi_xtap_8to8_hv(8, _16xh_avx2)
+MAKE_hevcasm_pred_bi_xtap_8to8_hv(8, _32xh_avx2)
+MAKE_hevcasm_pred_bi_xtap_8to8_hv(8, _48xh_avx2)
+MAKE_hevcasm_pred_bi_xtap_8to8_hv(8, _64xh_avx2)
+
+MAKE_hevcasm_pred_bi_xtap_8to8_hv(4, _16xh_avx2)
+MAKE_hevcasm_pred_bi_xtap_8to8_hv(4, _32xh_avx2)
+#endif
 
 
 hevcasm_pred_bi_8to8* get_pred_bi_8to8(int taps, int w, int h, int xFracA, int yFracA, int xFracB, int yFracB, hevcasm_instruction_set mask)
@@ -583,14 +703,45 @@ hevcasm_pred_bi_8to8* get_pred_bi_8to8(int taps, int w, int h, int xFracA, int y
 			if (w <= 64) f = hevcasm_pred_bi_8tap_8to8_64xh_sse4;
 			if (w <= 48) f = hevcasm_pred_bi_8tap_8to8_48xh_sse4;
 			if (w <= 32) f = hevcasm_pred_bi_8tap_8to8_32xh_sse4;
+			if (w <= 24) f = hevcasm_pred_bi_8tap_8to8_24xh_sse4;
 			if (w <= 16) f = hevcasm_pred_bi_8tap_8to8_16xh_sse4;
+			if (w <= 8) f = hevcasm_pred_bi_8tap_8to8_8xh_sse4;
+			if (w <= 4) f = hevcasm_pred_bi_8tap_8to8_4xh_sse4;
 		}
 		if (taps == 4 && (xFracA || yFracA || xFracB || yFracB))
 		{
 			if (w <= 32) f = hevcasm_pred_bi_4tap_8to8_32xh_sse4;
+			if (w <= 24) f = hevcasm_pred_bi_4tap_8to8_24xh_sse4;
 			if (w <= 16) f = hevcasm_pred_bi_4tap_8to8_16xh_sse4;
+			if (w <= 8) f = hevcasm_pred_bi_4tap_8to8_8xh_sse4;
+			if (w <= 4) f = hevcasm_pred_bi_4tap_8to8_4xh_sse4;
+		}
+	}
+
+#ifdef HEVCASM_X64
+	if (mask & HEVCASM_AVX2)
+	{
+		if (!xFracA && !yFracA && !xFracB && !yFracB)
+		{
+			if (w <= 64) f = hevcasm_pred_bi_8to8_copy_64xh_avx2;
+			if (w <= 48) f = hevcasm_pred_bi_8to8_copy_48xh_avx2;
+			if (w <= 32) f = hevcasm_pred_bi_8to8_copy_32xh_avx2;
+			if (w <= 16) f = hevcasm_pred_bi_8to8_copy_16xh_sse2;
+		}
+		if (taps == 8 && (xFracA || yFracA || xFracB || yFracB) && w > 8)
+		{
+			if (w <= 64) f = hevcasm_pred_bi_8tap_8to8_64xh_avx2;
+			if (w <= 48) f = hevcasm_pred_bi_8tap_8to8_48xh_avx2;
+			if (w <= 32) f = hevcasm_pred_bi_8tap_8to8_32xh_avx2;
+			if (w <= 16) f = hevcasm_pred_bi_8tap_8to8_16xh_avx2;
+		}
+		if (taps == 4 && (xFracA || yFracA || xFracB || yFracB) && w > 8)
+		{
+			if (w <= 32) f = hevcasm_pred_bi_4tap_8to8_32xh_avx2;
+			if (w <= 16) f = hevcasm_pred_bi_4tap_8to8_16xh_avx2;
 		}
 	}
+#endif
 
 	return f;
 }
@@ -600,7 +751,7 @@ void hevcasm_populate_pred_bi_8to8(hevcasm_table_pred_bi_8to8 *table, hevcasm_in
 {
 	for (int taps = 4; taps <= 8; taps += 4)
 	{
-		for (int w = 0; w <= 8 * taps; w += 2 * taps)
+		for (int w = 0; w <= 8 * taps; w += 4)
 		{
 			for (int frac = 0; frac < 2; ++frac)
 			{
@@ -642,13 +793,15 @@ int init_pred_bi_8to8(void *p, hevcasm_instruction_set mask)
 
 	hevcasm_populate_pred_bi_8to8(&table, mask);
 
-	s->f = *hevcasm_get_pred_bi_8to8(&table, s->taps, s->w, s->h, s->xFracA, s->yFracA, s->xFracB, s->yFracB);
+	hevcasm_pred_bi_8to8 **entry = hevcasm_get_pred_bi_8to8(&table, s->taps, s->w, s->h, s->xFracA, s->yFracA, s->xFracB, s->yFracB);
+	hevcasm_test_report_kernel(&table, sizeof(table), entry);
+	s->f = *entry;
 
 	assert(s->f == get_pred_bi_8to8(s->taps, s->w, s->h, s->xFracA, s->yFracA, s->xFracB, s->yFracB, mask));
 
 	if (s->f && mask == HEVCASM_C_REF)
 	{
-		printf("\t%dx%d %d-tap %s%s %s%s : ", s->w, s->h, s->taps, s->xFracA ? "H" : "", s->yFracA ? "V" : "", s->xFracB ? "H" : "", s->yFracB ? "V" : "");
+		hevcasm_test_printf("\t%dx%d %d-tap %s%s %s%s : ", s->w, s->h, s->taps, s->xFracA ? "H" : "", s->yFracA ? "V" : "", s->xFracB ? "H" : "", s->yFracB ? "V" : "");
 	}
 
 	memset(s->dst, 0, 64 * s->stride_dst);
@@ -709,7 +862,7 @@ static void test_partitions_bi(int *error_count, bound_pred_bi *b, hevcasm_instr
 
 void HEVCASM_API hevcasm_test_pred_bi(int *error_count, hevcasm_instruction_set mask)
 {
-	printf("\nhevcasm_pred_bi - Bireference Inter Prediction (two-reference motion compensation)\n");
+	hevcasm_test_printf("\nhevcasm_pred_bi - Bireference Inter Prediction (two-reference motion compensation)\n");
 
 	bound_pred_bi b[2];
 
@@ -722,8 +875,8 @@ void HEVCASM_API hevcasm_test_pred_bi(int *error_count, hevcasm_instruction_set
 
 	for (int x = 0; x < 80 * b[0].stride_ref; x++)
 	{
-		ref[0][x] = rand() & 0xff;
-		ref[1][x] = rand() & 0xff;
+		ref[0][x] = hevcasm_test_rand() & 0xff;
+		ref[1][x] = hevcasm_test_rand() & 0xff;
 	}
 
 	b[0].refA = ref[0] + 8 * b[0].stride_ref;
@@ -738,3 +891,1386 @@ void HEVCASM_API hevcasm_test_pred_bi(int *error_count, hevcasm_instruction_set
 		test_partitions_bi(error_count, b, mask);
 	}
 }
+
+
+void hevcasm_pred_uni_nv12_8to8_c_ref(uint8_t *dst, ptrdiff_t stride_dst, const uint8_t *ref, ptrdiff_t stride_ref, int nPbW, int nPbH, int xFrac, int yFrac)
+{
+	int16_t intermediate[(32 + 3) * 64];
+
+	/* Horizontal filter: taps of each component are two bytes apart (exact when xFrac is zero) */
+	hevcasm_pred_uni_generic(intermediate, 2, 64, ref - stride_ref, 1, stride_ref, 2 * nPbW, nPbH + 3, 2, 4, xFrac, 0, 0);
+
+	/* Vertical filter: Cb and Cr share yFrac so this is planar filtering of a block twice as wide */
+	hevcasm_pred_uni_generic(dst, 1, stride_dst, intermediate + 64, 2, 64, 2 * nPbW, nPbH, 64, 4, yFrac, 12, 1);
+}
+
+
+#define MAKE_hevcasm_pred_uni_nv12_8to8_hv(width, width2, isa) \
+ \
+static void hevcasm_pred_uni_nv12_8to8_hv_ ## width ## xh_ ## isa(uint8_t *dst, ptrdiff_t stride_dst, const uint8_t *ref, ptrdiff_t stride_ref, int nPbW, int nPbH, int xFrac, int yFrac) \
+{ \
+	HEVCASM_ALIGN(32, int16_t, intermediate[(32 + 3) * 64]); \
+	 \
+	/* Horizontal filter */ \
+	hevcasm_pred_uni_nv12_8to16_h_ ## width ## xh_sse4(intermediate, 64, ref - stride_ref, stride_ref, nPbW, nPbH + 3, xFrac, 0); \
+	 \
+	/* Vertical filter */ \
+	hevcasm_pred_uni_4tap_16to8_v_ ## width2 ## xh_ ## isa(dst, stride_dst, intermediate + 64, 64, 2 * nPbW, nPbH, 0, yFrac); \
+} \
+
+MAKE_hevcasm_pred_uni_nv12_8to8_hv(4, 8, sse4)
+MAKE_hevcasm_pred_uni_nv12_8to8_hv(8, 16, sse4)
+MAKE_hevcasm_pred_uni_nv12_8to8_hv(12, 24, sse4)
+MAKE_hevcasm_pred_uni_nv12_8to8_hv(16, 32, sse4)
+MAKE_hevcasm_pred_uni_nv12_8to8_hv(24, 48, sse4)
+MAKE_hevcasm_pred_uni_nv12_8to8_hv(32, 64, sse4)
+
+#ifdef HEVCASM_X64
+MAKE_hevcasm_pred_uni_nv12_8to8_hv(16, 32, avx2)
+MAKE_hevcasm_pred_uni_nv12_8to8_hv(24, 48, avx2)
+MAKE_hevcasm_pred_uni_nv12_8to8_hv(32, 64, avx2)
+#endif
+
+
+/* Copying or vertically filtering interleaved samples is the planar operation on a block of twice the width.
+The width-specialised planar kernels ignore nPbW so can be selected directly. */
+static hevcasm_pred_uni_8to8* get_pred_uni_nv12(int w, int h, int xFrac, int yFrac, hevcasm_instruction_set mask)
+{
+	hevcasm_pred_uni_8to8 *f = 0;
+
+	if (mask & (HEVCASM_C_REF | HEVCASM_C_OPT))
+	{
+		f = hevcasm_pred_uni_nv12_8to8_c_ref;
+	}
+
+	if (mask & HEVCASM_SSE2)
+	{
+		if (!xFrac && !yFrac)
+		{
+			if (w <= 32) f = hevcasm_pred_uni_copy_8to8_64xh_sse2;
+			if (w <= 24) f = hevcasm_pred_uni_copy_8to8_48xh_sse2;
+			if (w <= 16) f = hevcasm_pred_uni_copy_8to8_32xh_sse2;
+			if (w <= 8) f = hevcasm_pred_uni_copy_8to8_16xh_sse2;
+		}
+	}
+
+	if (mask & HEVCASM_SSE41)
+	{
+		if (xFrac && !yFrac)
+		{
+			if (w <= 32) f = hevcasm_pred_uni_nv12_8to8_h_32xh_sse4;
+			if (w <= 24) f = hevcasm_pred_uni_nv12_8to8_h_24xh_sse4;
+			if (w <= 16) f = hevcasm_pred_uni_nv12_8to8_h_16xh_sse4;
+			if (w <= 12) f = hevcasm_pred_uni_nv12_8to8_h_12xh_sse4;
+			if (w <= 8) f = hevcasm_pred_uni_nv12_8to8_h_8xh_sse4;
+			if (w <= 4) f = hevcasm_pred_uni_nv12_8to8_h_4xh_sse4;
+		}
+		if (!xFrac && yFrac)
+		{
+			if (w <= 32) f = hevcasm_pred_uni_4tap_8to8_v_64xh_sse4;
+			if (w <= 24) f = hevcasm_pred_uni_4tap_8to8_v_48xh_sse4;
+			if (w <= 16) f = hevcasm_pred_uni_4tap_8to8_v_32xh_sse4;
+			if (w <= 12) f = hevcasm_pred_uni_4tap_8to8_v_24xh_sse4;
+			if (w <= 8) f = hevcasm_pred_uni_4tap_8to8_v_16xh_sse4;
+			if (w <= 4) f = hevcasm_pred_uni_4tap_8to8_v_8xh_sse4;
+		}
+		if (xFrac && yFrac)
+		{
+			if (w <= 32) f = hevcasm_pred_uni_nv12_8to8_hv_32xh_sse4;
+			if (w <= 24) f = hevcasm_pred_uni_nv12_8to8_hv_24xh_sse4;
+			if (w <= 16) f = hevcasm_pred_uni_nv12_8to8_hv_16xh_sse4;
+			if (w <= 12) f = hevcasm_pred_uni_nv12_8to8_hv_12xh_sse4;
+			if (w <= 8) f = hevcasm_pred_uni_nv12_8to8_hv_8xh_sse4;
+			if (w <= 4) f = hevcasm_pred_uni_nv12_8to8_hv_4xh_sse4;
+		}
+	}
+
+#ifdef HEVCASM_X64
+	if (mask & HEVCASM_AVX2)
+	{
+		if (!xFrac && !yFrac && w > 8)
+		{
+			if (w <= 32) f = hevcasm_pred_uni_copy_8to8_64xh_avx2;
+			if (w <= 24) f = hevcasm_pred_uni_copy_8to8_48xh_avx2;
+			if (w <= 16) f = hevcasm_pred_uni_copy_8to8_32xh_avx2;
+		}
+		if (!xFrac && yFrac && w > 12)
+		{
+			if (w <= 32) f = hevcasm_pred_uni_4tap_8to8_v_64xh_avx2;
+			if (w <= 24) f = hevcasm_pred_uni_4tap_8to8_v_48xh_avx2;
+			if (w <= 16) f = hevcasm_pred_uni_4tap_8to8_v_32xh_avx2;
+		}
+		if (xFrac && yFrac && w > 12)
+		{
+			if (w <= 32) f = hevcasm_pred_uni_nv12_8to8_hv_32xh_avx2;
+			if (w <= 24) f = hevcasm_pred_uni_nv12_8to8_hv_24xh_avx2;
+			if (w <= 16) f = hevcasm_pred_uni_nv12_8to8_hv_16xh_avx2;
+		}
+	}
+#endif
+
+	return f;
+}
+
+
+void hevcasm_populate_pred_uni_nv12(hevcasm_table_pred_uni_nv12 *table, hevcasm_instruction_set mask)
+{
+	for (int w = 0; w <= 32; w += 4)
+	{
+		for (int xFrac = 0; xFrac < 2; ++xFrac)
+		{
+			for (int yFrac = 0; yFrac < 2; ++yFrac)
+			{
+				*hevcasm_get_pred_uni_nv12(table, w, 0, xFrac, yFrac)
+					= get_pred_uni_nv12(w, 0, xFrac, yFrac, mask);
+			}
+		}
+	}
+}
+
+
+static const int nv12_partitions[24][2] =
+{
+	{ 4, 2 }, { 4, 4 }, { 2, 4 },
+	{ 8, 2 }, { 8, 4 }, { 8, 6 }, { 8, 8 }, { 6, 8 }, { 4, 8 }, { 2, 8 },
+	{ 16, 4 }, { 16, 8 }, { 16, 12 }, { 16, 16 }, { 12, 16 }, { 8, 16 }, { 4, 16 },
+	{ 32, 8 }, { 32, 16 }, { 32, 24 }, { 32, 32 }, { 24, 32 }, { 16, 32 }, { 8, 32 },
+};
+
+
+static int init_pred_uni_nv12(void *p, hevcasm_instruction_set mask)
+{
+	bound_pred_uni *s = p;
+
+	hevcasm_table_pred_uni_nv12 table;
+
+	hevcasm_populate_pred_uni_nv12(&table, mask);
+
+	hevcasm_pred_uni_8to8 **entry = hevcasm_get_pred_uni_nv12(&table, s->w, s->h, s->xFrac, s->yFrac);
+	hevcasm_test_report_kernel(&table, sizeof(table), entry);
+	s->f = *entry;
+
+	assert(s->f == get_pred_uni_nv12(s->w, s->h, s->xFrac, s->yFrac, mask));
+
+	if (s->f && mask == HEVCASM_C_REF)
+	{
+		hevcasm_test_printf("\t%dx%d CbCr %s%s : ", s->w, s->h, s->xFrac ? "H" : "", s->yFrac ? "V" : "");
+	}
+
+	memset(s->dst, 0, 64 * s->stride_dst);
+
+	return !!s->f;
+}
+
+
+static int mismatch_pred_uni_nv12(void *boundRef, void *boundTest)
+{
+	bound_pred_uni *ref = boundRef;
+	bound_pred_uni *test = boundTest;
+
+	for (int y = 0; y < ref->h; ++y)
+	{
+		if (memcmp(&ref->dst[y*ref->stride_dst], &test->dst[y*test->stride_dst], 2 * ref->w)) return 1;
+	}
+
+	return 0;
+}
+
+
+void HEVCASM_API hevcasm_test_pred_uni_nv12(int *error_count, hevcasm_instruction_set mask)
+{
+	hevcasm_test_printf("\nhevcasm_pred_uni_nv12 - Unireference Inter Prediction of interleaved 4:2:0 chroma\n");
+
+	bound_pred_uni b[2];
+
+#define STRIDE_DST 192
+#define STRIDE_REF 192
+	HEVCASM_ALIGN(32, uint8_t, ref[80 * STRIDE_REF]);
+	b[0].stride_dst = STRIDE_DST;
+	b[0].stride_ref = STRIDE_REF;
+	b[0].ref = ref + 8 * b[0].stride_ref + 16;
+#undef STRIDE_DST
+#undef STRIDE_REF
+
+	for (int x = 0; x < 80 * b[0].stride_ref; x++) ref[x] = hevcasm_test_rand() & 0xff;
+
+	b[0].taps = 4;
+
+	for (int frac = 0; frac < 4; ++frac)
+	{
+		/* arbitrary eighth-sample positions */
+		b[0].xFrac = (frac & 1) ? 3 : 0;
+		b[0].yFrac = (frac & 2) ? 5 : 0;
+
+		for (int k = 0; k < 24; ++k)
+		{
+			b[0].w = nv12_partitions[k][0];
+			b[0].h = nv12_partitions[k][1];
+
+			b[1] = b[0];
+
+			*error_count += hevcasm_test(&b[0], &b[1], init_pred_uni_nv12, invoke_pred_uni, mismatch_pred_uni_nv12, mask, 1000);
+		}
+	}
+}
+
+
+void hevcasm_pred_bi_nv12_8to8_c_ref(uint8_t *dst, ptrdiff_t stride_dst, const uint8_t *ref0, const uint8_t *ref1, ptrdiff_t stride_ref, int nPbW, int nPbH, int xFrac0, int yFrac0, int xFrac1, int yFrac1)
+{
+	int16_t intermediate[4][(32 + 3) * 64];
+
+	/* Horizontal filter */
+	hevcasm_pred_uni_generic(intermediate[2], 2, 64, ref0 - stride_ref, 1, stride_ref, 2 * nPbW, nPbH + 3, 2, 4, xFrac0, 0, 0);
+
+	/* Vertical filter */
+	hevcasm_pred_uni_generic(intermediate[0], 2, 64, intermediate[2] + 64, 2, 64, 2 * nPbW, nPbH, 64, 4, yFrac0, 6, 0);
+
+	/* Horizontal filter */
+	hevcasm_pred_uni_generic(intermediate[3], 2, 64, ref1 - stride_ref, 1, stride_ref, 2 * nPbW, nPbH + 3, 2, 4, xFrac1, 0, 0);
+
+	/* Vertical filter */
+	hevcasm_pred_uni_generic(intermediate[1], 2, 64, intermediate[3] + 64, 2, 64, 2 * nPbW, nPbH, 64, 4, yFrac1, 6, 0);
+
+	/* Combine two references for bi pred */
+	hevcasm_pred_bi_mean_16and16to8_c_ref(dst, stride_dst, intermediate[0], intermediate[1], 64, 2 * nPbW, nPbH);
+}
+
+
+#define MAKE_hevcasm_pred_bi_nv12_8to8(width, width2, isa) \
+ \
+static void hevcasm_pred_bi_nv12_8to8_ ## width ## xh_ ## isa(uint8_t *dst, ptrdiff_t stride_dst, const uint8_t *ref0, const uint8_t *ref1, ptrdiff_t stride_ref, int w, int h, int xFrac0, int yFrac0, int xFrac1, int yFrac1) \
+{ \
+	HEVCASM_ALIGN(32, int16_t, intermediate[2][(32 + 3) * 64]); \
+	 \
+	/* Horizontal filter */ \
+	hevcasm_pred_uni_nv12_8to16_h_ ## width ## xh_sse4(intermediate[0], 64, ref0 - stride_ref, stride_ref, w, h + 3, xFrac0, 0); \
+	 \
+	/* Horizontal filter */ \
+	hevcasm_pred_uni_nv12_8to16_h_ ## width ## xh_sse4(intermediate[1], 64, ref1 - stride_ref, stride_ref, w, h + 3, xFrac1, 0); \
+	 \
+	/* Two vertical filters and combine their output for bi pred */ \
+	hevcasm_pred_bi_v_4tap_16to16_ ## width2 ## xh_ ## isa(dst, stride_dst, intermediate[0], intermediate[1], 64, 2 * w, h, yFrac0, yFrac1); \
+} \
+
+MAKE_hevcasm_pred_bi_nv12_8to8(4, 8, sse4)
+MAKE_hevcasm_pred_bi_nv12_8to8(8, 16, sse4)
+MAKE_hevcasm_pred_bi_nv12_8to8(12, 24, sse4)
+MAKE_hevcasm_pred_bi_nv12_8to8(16, 32, sse4)
+MAKE_hevcasm_pred_bi_nv12_8to8(24, 48, sse4)
+MAKE_hevcasm_pred_bi_nv12_8to8(32, 64, sse4)
+
+#ifdef HEVCASM_X64
+MAKE_hevcasm_pred_bi_nv12_8to8(16, 32, avx2)
+MAKE_hevcasm_pred_bi_nv12_8to8(24, 48, avx2)
+MAKE_hevcasm_pred_bi_nv12_8to8(32, 64, avx2)
+#endif
+
+
+static hevcasm_pred_bi_8to8* get_pred_bi_nv12(int w, int h, int xFracA, int yFracA, int xFracB, int yFracB, hevcasm_instruction_set mask)
+{
+	hevcasm_pred_bi_8to8 *f = 0;
+
+	const int frac = xFracA || yFracA || xFracB || yFracB;
+
+	if (mask & (HEVCASM_C_REF | HEVCASM_C_OPT))
+	{
+		f = hevcasm_pred_bi_nv12_8to8_c_ref;
+	}
+
+	if (mask & HEVCASM_SSE2)
+	{
+		if (!frac)
+		{
+			if (w <= 32) f = hevcasm_pred_bi_8to8_copy_64xh_sse2;
+			if (w <= 24) f = hevcasm_pred_bi_8to8_copy_48xh_sse2;
+			if (w <= 16) f = hevcasm_pred_bi_8to8_copy_32xh_sse2;
+			if (w <= 8) f = hevcasm_pred_bi_8to8_copy_16xh_sse2;
+		}
+	}
+
+	if (mask & HEVCASM_SSE41)
+	{
+		if (frac)
+		{
+			if (w <= 32) f = hevcasm_pred_bi_nv12_8to8_32xh_sse4;
+			if (w <= 24) f = hevcasm_pred_bi_nv12_8to8_24xh_sse4;
+			if (w <= 16) f = hevcasm_pred_bi_nv12_8to8_16xh_sse4;
+			if (w <= 12) f = hevcasm_pred_bi_nv12_8to8_12xh_sse4;
+			if (w <= 8) f = hevcasm_pred_bi_nv12_8to8_8xh_sse4;
+			if (w <= 4) f = hevcasm_pred_bi_nv12_8to8_4xh_sse4;
+		}
+	}
+
+#ifdef HEVCASM_X64
+	if (mask & HEVCASM_AVX2)
+	{
+		if (!frac && w > 8)
+		{
+			if (w <= 32) f = hevcasm_pred_bi_8to8_copy_64xh_avx2;
+			if (w <= 24) f = hevcasm_pred_bi_8to8_copy_48xh_avx2;
+			if (w <= 16) f = hevcasm_pred_bi_8to8_copy_32xh_avx2;
+		}
+		if (frac && w > 12)
+		{
+			if (w <= 32) f = hevcasm_pred_bi_nv12_8to8_32xh_avx2;
+			if (w <= 24) f = hevcasm_pred_bi_nv12_8to8_24xh_avx2;
+			if (w <= 16) f = hevcasm_pred_bi_nv12_8to8_16xh_avx2;
+		}
+	}
+#endif
+
+	return f;
+}
+
+
+void hevcasm_populate_pred_bi_nv12(hevcasm_table_pred_bi_nv12 *table, hevcasm_instruction_set mask)
+{
+	for (int w = 0; w <= 32; w += 4)
+	{
+		for (int frac = 0; frac < 2; ++frac)
+		{
+			*hevcasm_get_pred_bi_nv12(table, w, 0, frac, frac, frac, frac)
+				= get_pred_bi_nv12(w, 0, frac, frac, frac, frac, mask);
+		}
+	}
+}
+
+
+static int init_pred_bi_nv12(void *p, hevcasm_instruction_set mask)
+{
+	bound_pred_bi *s = p;
+
+	hevcasm_table_pred_bi_nv12 table;
+
+	hevcasm_populate_pred_bi_nv12(&table, mask);
+
+	hevcasm_pred_bi_8to8 **entry = hevcasm_get_pred_bi_nv12(&table, s->w, s->h, s->xFracA, s->yFracA, s->xFracB, s->yFracB);
+	hevcasm_test_report_kernel(&table, sizeof(table), entry);
+	s->f = *entry;
+
+	assert(s->f == get_pred_bi_nv12(s->w, s->h, s->xFracA, s->yFracA, s->xFracB, s->yFracB, mask));
+
+	if (s->f && mask == HEVCASM_C_REF)
+	{
+		hevcasm_test_printf("\t%dx%d CbCr %s%s %s%s : ", s->w, s->h, s->xFracA ? "H" : "", s->yFracA ? "V" : "", s->xFracB ? "H" : "", s->yFracB ? "V" : "");
+	}
+
+	memset(s->dst, 0, 64 * s->stride_dst);
+
+	return !!s->f;
+}
+
+
+static int mismatch_pred_bi_nv12(void *boundRef, void *boundTest)
+{
+	bound_pred_bi *ref = boundRef;
+	bound_pred_bi *test = boundTest;
+
+	for (int y = 0; y < ref->h; ++y)
+	{
+		if (memcmp(&ref->dst[y*ref->stride_dst], &test->dst[y*test->stride_dst], 2 * ref->w)) return 1;
+	}
+
+	return 0;
+}
+
+
+void HEVCASM_API hevcasm_test_pred_bi_nv12(int *error_count, hevcasm_instruction_set mask)
+{
+	hevcasm_test_printf("\nhevcasm_pred_bi_nv12 - Bireference Inter Prediction of interleaved 4:2:0 chroma\n");
+
+	bound_pred_bi b[2];
+
+#define STRIDE_DST 192
+#define STRIDE_REF 192
+	HEVCASM_ALIGN(32, uint8_t, ref[2][80 * STRIDE_REF]);
+	b[0].stride_dst = STRIDE_DST;
+	b[0].stride_ref = STRIDE_REF;
+#undef STRIDE_DST
+#undef STRIDE_REF
+
+	for (int x = 0; x < 80 * b[0].stride_ref; x++)
+	{
+		ref[0][x] = hevcasm_test_rand() & 0xff;
+		ref[1][x] = hevcasm_test_rand() & 0xff;
+	}
+
+	b[0].refA = ref[0] + 8 * b[0].stride_ref + 16;
+	b[0].refB = ref[1] + 8 * b[0].stride_ref + 16;
+	b[0].taps = 4;
+
+	for (int frac = 0; frac < 2; ++frac)
+	{
+		/* arbitrary eighth-sample positions */
+		b[0].xFracA = frac ? 3 : 0;
+		b[0].yFracA = frac ? 5 : 0;
+		b[0].xFracB = frac ? 7 : 0;
+		b[0].yFracB = frac ? 1 : 0;
+
+		for (int k = 0; k < 24; ++k)
+		{
+			b[0].w = nv12_partitions[k][0];
+			b[0].h = nv12_partitions[k][1];
+
+			b[1] = b[0];
+
+			*error_count += hevcasm_test(&b[0], &b[1], init_pred_bi_nv12, invoke_pred_bi_8to8, mismatch_pred_bi_nv12, mask, 1000);
+		}
+	}
+}
+
+
+static const int weighted_partitions[24][2] =
+{
+	{ 8, 4 }, { 8, 8 }, { 4, 8 },
+	{ 16, 4 }, { 16, 8 }, { 16, 12 }, { 16, 16 }, { 12, 16 }, { 8, 16 }, { 4, 16 },
+	{ 32, 8 }, { 32, 16 }, { 32, 24 }, { 32, 32 }, { 24, 32 }, { 16, 32 }, { 8, 32 },
+	{ 64, 16 }, { 64, 32 }, { 64, 48 }, { 64, 64 }, { 48, 64 }, { 32, 64 }, { 16, 64 },
+};
+
+
+/* predSamplesLX before weighting: scaled integer samples, or the output of one or both filter stages with shift1 = 0 and shift2 = 6 */
+static void pred_uni_8to16_c_ref(int16_t *dst, ptrdiff_t stride_dst, const uint8_t *ref, ptrdiff_t stride_ref, int w, int h, int taps, int xFrac, int yFrac)
+{
+	if (!yFrac)
+	{
+		/* at position 0 the filter has a single coefficient, 64, so integer samples are scaled by it */
+		hevcasm_pred_uni_generic(dst, 2, stride_dst, ref, 1, stride_ref, w, h, 1, taps, xFrac, 0, 0);
+	}
+	else if (!xFrac)
+	{
+		hevcasm_pred_uni_generic(dst, 2, stride_dst, ref, 1, stride_ref, w, h, stride_ref, taps, yFrac, 0, 0);
+	}
+	else
+	{
+		int16_t intermediate[(64 + 7) * 64];
+
+		/* Horizontal filter */
+		hevcasm_pred_uni_generic(intermediate, 2, 64, ref - (taps / 2 - 1) * stride_ref, 1, stride_ref, w, h + taps - 1, 1, taps, xFrac, 0, 0);
+
+		/* Vertical filter */
+		hevcasm_pred_uni_generic(dst, 2, stride_dst, intermediate + (taps / 2 - 1) * 64, 2, 64, w, h, 64, taps, yFrac, 6, 0);
+	}
+}
+
+
+static void hevcasm_pred_uni_8tap_8to16_c_ref(int16_t *dst, ptrdiff_t stride_dst, const uint8_t *ref, ptrdiff_t stride_ref, int nPbW, int nPbH, int xFrac, int yFrac)
+{
+	pred_uni_8to16_c_ref(dst, stride_dst, ref, stride_ref, nPbW, nPbH, 8, xFrac, yFrac);
+}
+
+
+static void hevcasm_pred_uni_4tap_8to16_c_ref(int16_t *dst, ptrdiff_t stride_dst, const uint8_t *ref, ptrdiff_t stride_ref, int nPbW, int nPbH, int xFrac, int yFrac)
+{
+	pred_uni_8to16_c_ref(dst, stride_dst, ref, stride_ref, nPbW, nPbH, 4, xFrac, yFrac);
+}
+
+
+static hevcasm_pred_uni_8to16* get_pred_uni_8to16(int taps, int w, int h, int xFrac, int yFrac, hevcasm_instruction_set mask)
+{
+	hevcasm_pred_uni_8to16 *f = 0;
+
+	if (mask & (HEVCASM_C_REF | HEVCASM_C_OPT))
+	{
+		f = taps == 8 ? hevcasm_pred_uni_8tap_8to16_c_ref : hevcasm_pred_uni_4tap_8to16_c_ref;
+	}
+
+	/* the first stage kernels of the hv wrappers: with xFrac 0 they scale integer samples */
+	if (mask & HEVCASM_SSE41)
+	{
+		if (taps == 8 && !yFrac)
+		{
+			if (w <= 64) f = hevcasm_pred_uni_8tap_8to16_h_64xh_sse4;
+			if (w <= 48) f = hevcasm_pred_uni_8tap_8to16_h_48xh_sse4;
+			if (w <= 32) f = hevcasm_pred_uni_8tap_8to16_h_32xh_sse4;
+			if (w <= 24) f = hevcasm_pred_uni_8tap_8to16_h_24xh_sse4;
+			if (w <= 16) f = hevcasm_pred_uni_8tap_8to16_h_16xh_sse4;
+			if (w <= 8) f = hevcasm_pred_uni_8tap_8to16_h_8xh_sse4;
+			if (w <= 4) f = hevcasm_pred_uni_8tap_8to16_h_4xh_sse4;
+		}
+		if (taps == 4 && !yFrac)
+		{
+			if (w <= 32) f = hevcasm_pred_uni_4tap_8to16_h_32xh_sse4;
+			if (w <= 24) f = hevcasm_pred_uni_4tap_8to16_h_24xh_sse4;
+			if (w <= 16) f = hevcasm_pred_uni_4tap_8to16_h_16xh_sse4;
+			if (w <= 8) f = hevcasm_pred_uni_4tap_8to16_h_8xh_sse4;
+			if (w <= 4) f = hevcasm_pred_uni_4tap_8to16_h_4xh_sse4;
+		}
+	}
+
+#ifdef HEVCASM_X64
+	if (mask & HEVCASM_AVX2)
+	{
+		if (taps == 8 && !yFrac && w > 8)
+		{
+			if (w <= 64) f = hevcasm_pred_uni_8tap_8to16_h_64xh_avx2;
+			if (w <= 48) f = hevcasm_pred_uni_8tap_8to16_h_48xh_avx2;
+			if (w <= 32) f = hevcasm_pred_uni_8tap_8to16_h_32xh_avx2;
+			if (w <= 16) f = hevcasm_pred_uni_8tap_8to16_h_16xh_avx2;
+		}
+		if (taps == 4 && !yFrac && w > 8)
+		{
+			if (w <= 32) f = hevcasm_pred_uni_4tap_8to16_h_32xh_avx2;
+			if (w <= 16) f = hevcasm_pred_uni_4tap_8to16_h_16xh_avx2;
+		}
+	}
+#endif
+
+	return f;
+}
+
+
+void hevcasm_populate_pred_uni_8to16(hevcasm_table_pred_uni_8to16 *table, hevcasm_instruction_set mask)
+{
+	for (int taps = 4; taps <= 8; taps += 4)
+	{
+		for (int w = 0; w <= 8 * taps; w += 4)
+		{
+			for (int xFrac = 0; xFrac < 2; ++xFrac)
+			{
+				for (int yFrac = 0; yFrac < 2; ++yFrac)
+				{
+					*hevcasm_get_pred_uni_8to16(table, taps, w, 0, xFrac, yFrac)
+						= get_pred_uni_8to16(taps, w, 0, xFrac, yFrac, mask);
+				}
+			}
+		}
+	}
+}
+
+
+typedef struct
+{
+	HEVCASM_ALIGN(32, int16_t, dst[64 * 64]);
+	hevcasm_pred_uni_8to16 *f;
+	const uint8_t *ref;
+	ptrdiff_t stride_ref;
+	int w;
+	int h;
+	int xFrac;
+	int yFrac;
+	int taps;
+}
+bound_pred_uni_8to16;
+
+
+static int init_pred_uni_8to16(void *p, hevcasm_instruction_set mask)
+{
+	bound_pred_uni_8to16 *s = p;
+
+	hevcasm_table_pred_uni_8to16 table;
+
+	hevcasm_populate_pred_uni_8to16(&table, mask);
+
+	hevcasm_pred_uni_8to16 **entry = hevcasm_get_pred_uni_8to16(&table, s->taps, s->w, s->h, s->xFrac, s->yFrac);
+	hevcasm_test_report_kernel(&table, sizeof(table), entry);
+	s->f = *entry;
+
+	if (s->f && mask == HEVCASM_C_REF)
+	{
+		hevcasm_test_printf("\t%dx%d %d-tap %s%s : ", s->w, s->h, s->taps, s->xFrac ? "H" : "", s->yFrac ? "V" : "");
+	}
+
+	memset(s->dst, 0, sizeof(s->dst));
+
+	return !!s->f;
+}
+
+
+static void invoke_pred_uni_8to16(void *p, int n)
+{
+	bound_pred_uni_8to16 *s = p;
+	while (n--)
+	{
+		s->f(s->dst, 64, s->ref, s->stride_ref, s->w, s->h, s->xFrac, s->yFrac);
+	}
+}
+
+
+static int mismatch_pred_uni_8to16(void *boundRef, void *boundTest)
+{
+	bound_pred_uni_8to16 *ref = boundRef;
+	bound_pred_uni_8to16 *test = boundTest;
+
+	for (int y = 0; y < ref->h; ++y)
+	{
+		if (memcmp(&ref->dst[64 * y], &test->dst[64 * y], ref->w * sizeof(int16_t))) return 1;
+	}
+
+	return 0;
+}
+
+
+void HEVCASM_API hevcasm_test_pred_uni_8to16(int *error_count, hevcasm_instruction_set mask)
+{
+	hevcasm_test_printf("\nhevcasm_pred_uni_8to16 - Unireference Inter Prediction to 14-bit samples for weighting\n");
+
+	bound_pred_uni_8to16 b[2];
+
+#define STRIDE_REF 192
+	HEVCASM_ALIGN(32, uint8_t, ref[80 * STRIDE_REF]);
+	b[0].stride_ref = STRIDE_REF;
+	b[0].ref = ref + 8 * b[0].stride_ref + 8;
+#undef STRIDE_REF
+
+	for (int x = 0; x < 80 * b[0].stride_ref; x++) ref[x] = hevcasm_test_rand() & 0xff;
+
+	for (b[0].taps = 8; b[0].taps >= 4; b[0].taps -= 4)
+	{
+		for (int yFrac = 0; yFrac < 2; ++yFrac)
+		{
+			for (int xFrac = 0; xFrac < 2; ++xFrac)
+			{
+				/* half-sample for luma, an odd eighth for chroma */
+				b[0].xFrac = xFrac ? (b[0].taps == 8 ? 2 : 5) : 0;
+				b[0].yFrac = yFrac ? (b[0].taps == 8 ? 2 : 5) : 0;
+
+				for (int k = 0; k < 24; ++k)
+				{
+					b[0].w = weighted_partitions[k][0] * b[0].taps / 8;
+					b[0].h = weighted_partitions[k][1] * b[0].taps / 8;
+
+					b[1] = b[0];
+
+					*error_count += hevcasm_test(&b[0], &b[1], init_pred_uni_8to16, invoke_pred_uni_8to16, mismatch_pred_uni_8to16, mask, 1000);
+				}
+			}
+		}
+	}
+}
+
+
+static void hevcasm_pred_uni_weighted_16to8_c_ref(uint8_t *dst, ptrdiff_t stride_dst, const int16_t *src, ptrdiff_t stride_src, int nPbW, int nPbH, int w0, int o0, int log2Wd)
+{
+	for (int y = 0; y < nPbH; ++y)
+	{
+		for (int x = 0; x < nPbW; ++x)
+		{
+			if (log2Wd >= 1)
+			{
+				dst[x] = (uint8_t)Clip3(0, 255, ((src[x] * w0 + (1 << (log2Wd - 1))) >> log2Wd) + o0);
+			}
+			else
+			{
+				dst[x] = (uint8_t)Clip3(0, 255, src[x] * w0 + o0);
+			}
+		}
+		src += stride_src;
+		dst += stride_dst;
+	}
+}
+
+
+static hevcasm_pred_uni_weighted_16to8* get_pred_uni_weighted_16to8(int w, int h, hevcasm_instruction_set mask)
+{
+	hevcasm_pred_uni_weighted_16to8 *f = 0;
+
+	if (mask & (HEVCASM_C_REF | HEVCASM_C_OPT)) f = hevcasm_pred_uni_weighted_16to8_c_ref;
+
+#ifdef HEVCASM_X64
+	if (mask & HEVCASM_SSE2) f = hevcasm_pred_uni_weighted_16to8_8nxh_sse2;
+
+	if (mask & HEVCASM_AVX2)
+	{
+		if (w > 8) f = hevcasm_pred_uni_weighted_16to8_16nxh_avx2;
+	}
+#endif
+
+	return f;
+}
+
+
+void hevcasm_populate_pred_uni_weighted_16to8(hevcasm_table_pred_uni_weighted_16to8 *table, hevcasm_instruction_set mask)
+{
+	for (int w = 0; w <= 64; w += 4)
+	{
+		*hevcasm_get_pred_uni_weighted_16to8(table, w, 0) = get_pred_uni_weighted_16to8(w, 0, mask);
+	}
+}
+
+
+static void hevcasm_pred_bi_weighted_16to8_c_ref(uint8_t *dst, ptrdiff_t stride_dst, const int16_t *src0, const int16_t *src1, ptrdiff_t stride_src, int nPbW, int nPbH, int w0, int w1, int o0, int o1, int log2Wd)
+{
+	for (int y = 0; y < nPbH; ++y)
+	{
+		for (int x = 0; x < nPbW; ++x)
+		{
+			dst[x] = (uint8_t)Clip3(0, 255, (src0[x] * w0 + src1[x] * w1 + ((o0 + o1 + 1) * (1 << log2Wd))) >> (log2Wd + 1));
+		}
+		src0 += stride_src;
+		src1 += stride_src;
+		dst += stride_dst;
+	}
+}
+
+
+static hevcasm_pred_bi_weighted_16to8* get_pred_bi_weighted_16to8(int w, int h, hevcasm_instruction_set mask)
+{
+	hevcasm_pred_bi_weighted_16to8 *f = 0;
+
+	if (mask & (HEVCASM_C_REF | HEVCASM_C_OPT)) f = hevcasm_pred_bi_weighted_16to8_c_ref;
+
+#ifdef HEVCASM_X64
+	if (mask & HEVCASM_SSE2) f = hevcasm_pred_bi_weighted_16to8_8nxh_sse2;
+
+	if (mask & HEVCASM_AVX2)
+	{
+		if (w > 8) f = hevcasm_pred_bi_weighted_16to8_16nxh_avx2;
+	}
+#endif
+
+	return f;
+}
+
+
+void hevcasm_populate_pred_bi_weighted_16to8(hevcasm_table_pred_bi_weighted_16to8 *table, hevcasm_instruction_set mask)
+{
+	for (int w = 0; w <= 64; w += 4)
+	{
+		*hevcasm_get_pred_bi_weighted_16to8(table, w, 0) = get_pred_bi_weighted_16to8(w, 0, mask);
+	}
+}
+
+
+typedef struct
+{
+	HEVCASM_ALIGN(32, uint8_t, dst[64 * 64]);
+	const int16_t *src[2];
+	hevcasm_pred_uni_weighted_16to8 *f_uni;
+	hevcasm_pred_bi_weighted_16to8 *f_bi;
+	int w;
+	int h;
+	int w0;
+	int w1;
+	int o0;
+	int o1;
+	int log2Wd;
+}
+bound_pred_weighted;
+
+
+static int init_pred_uni_weighted(void *p, hevcasm_instruction_set mask)
+{
+	bound_pred_weighted *s = p;
+
+	hevcasm_table_pred_uni_weighted_16to8 table;
+
+	hevcasm_populate_pred_uni_weighted_16to8(&table, mask);
+
+	hevcasm_pred_uni_weighted_16to8 **entry = hevcasm_get_pred_uni_weighted_16to8(&table, s->w, s->h);
+	hevcasm_test_report_kernel(&table, sizeof(table), entry);
+	s->f_uni = *entry;
+
+	assert(s->f_uni == get_pred_uni_weighted_16to8(s->w, s->h, mask));
+
+	if (s->f_uni && mask == HEVCASM_C_REF)
+	{
+		hevcasm_test_printf("\t%dx%d : ", s->w, s->h);
+	}
+
+	memset(s->dst, 0, sizeof(s->dst));
+
+	return !!s->f_uni;
+}
+
+
+static void invoke_pred_uni_weighted(void *p, int n)
+{
+	bound_pred_weighted *s = p;
+	while (n--)
+	{
+		s->f_uni(s->dst, 64, s->src[0], 64, s->w, s->h, s->w0, s->o0, s->log2Wd);
+	}
+}
+
+
+static int mismatch_pred_weighted(void *boundRef, void *boundTest)
+{
+	bound_pred_weighted *ref = boundRef;
+	bound_pred_weighted *test = boundTest;
+
+	for (int y = 0; y < ref->h; ++y)
+	{
+		if (memcmp(&ref->dst[64 * y], &test->dst[64 * y], ref->w)) return 1;
+	}
+
+	return 0;
+}
+
+
+static void init_pred_weighted_src(int16_t src[2][64 * 64])
+{
+	/* 14-bit prediction samples, including the overshoot of the interpolation filters */
+	for (int i = 0; i < 2; ++i)
+	{
+		for (int x = 0; x < 64 * 64; ++x)
+		{
+			src[i][x] = (int16_t)(hevcasm_test_rand() % 24576 - 6144);
+		}
+	}
+}
+
+
+void HEVCASM_API hevcasm_test_pred_uni_weighted(int *error_count, hevcasm_instruction_set mask)
+{
+	hevcasm_test_printf("\nhevcasm_pred_uni_weighted - Explicit Weighted Unireference Prediction\n");
+
+	HEVCASM_ALIGN(32, int16_t, src[2][64 * 64]);
+	init_pred_weighted_src(src);
+
+	bound_pred_weighted b[2];
+
+	b[0].src[0] = src[0];
+	b[0].src[1] = src[1];
+
+	for (int k = 0; k < 24; ++k)
+	{
+		b[0].w = weighted_partitions[k][0];
+		b[0].h = weighted_partitions[k][1];
+
+		/* weights sweep [-128, 255] and offsets [-128, 127], the full ranges allowed for 8-bit video */
+		b[0].log2Wd = 6 + k % 8;
+		b[0].w0 = -128 + k * 383 / 23;
+		b[0].o0 = 127 - k * 255 / 23;
+
+		b[1] = b[0];
+
+		*error_count += hevcasm_test(&b[0], &b[1], init_pred_uni_weighted, invoke_pred_uni_weighted, mismatch_pred_weighted, mask, 1000);
+	}
+}
+
+
+static int init_pred_bi_weighted(void *p, hevcasm_instruction_set mask)
+{
+	bound_pred_weighted *s = p;
+
+	hevcasm_table_pred_bi_weighted_16to8 table;
+
+	hevcasm_populate_pred_bi_weighted_16to8(&table, mask);
+
+	hevcasm_pred_bi_weighted_16to8 **entry = hevcasm_get_pred_bi_weighted_16to8(&table, s->w, s->h);
+	hevcasm_test_report_kernel(&table, sizeof(table), entry);
+	s->f_bi = *entry;
+
+	assert(s->f_bi == get_pred_bi_weighted_16to8(s->w, s->h, mask));
+
+	if (s->f_bi && mask == HEVCASM_C_REF)
+	{
+		hevcasm_test_printf("\t%dx%d : ", s->w, s->h);
+	}
+
+	memset(s->dst, 0, sizeof(s->dst));
+
+	return !!s->f_bi;
+}
+
+
+static void invoke_pred_bi_weighted(void *p, int n)
+{
+	bound_pred_weighted *s = p;
+	while (n--)
+	{
+		s->f_bi(s->dst, 64, s->src[0], s->src[1], 64, s->w, s->h, s->w0, s->w1, s->o0, s->o1, s->log2Wd);
+	}
+}
+
+
+void HEVCASM_API hevcasm_test_pred_bi_weighted(int *error_count, hevcasm_instruction_set mask)
+{
+	hevcasm_test_printf("\nhevcasm_pred_bi_weighted - Explicit Weighted Bireference Prediction\n");
+
+	HEVCASM_ALIGN(32, int16_t, src[2][64 * 64]);
+	init_pred_weighted_src(src);
+
+	bound_pred_weighted b[2];
+
+	b[0].src[0] = src[0];
+	b[0].src[1] = src[1];
+
+	for (int k = 0; k < 24; ++k)
+	{
+		b[0].w = weighted_partitions[k][0];
+		b[0].h = weighted_partitions[k][1];
+		/* weights sweep [-128, 255] and offsets [-128, 127] in different orders for each list */
+		b[0].log2Wd = 6 + k % 8;
+		b[0].w0 = -128 + k * 383 / 23;
+		b[0].w1 = 255 - (7 * k % 24) * 383 / 23;
+		b[0].o0 = 127 - k * 255 / 23;
+		b[0].o1 = -128 + (5 * k % 24) * 255 / 23;
+
+		b[1] = b[0];
+
+		*error_count += hevcasm_test(&b[0], &b[1], init_pred_bi_weighted, invoke_pred_bi_weighted, mismatch_pred_weighted, mask, 1000);
+	}
+}
+
+
+void hevcasm_populate_pred_batch(hevcasm_table_pred_batch *table, hevcasm_instruction_set mask)
+{
+	hevcasm_populate_pred_uni_8to8(&table->uni, mask);
+	hevcasm_populate_pred_bi_8to8(&table->bi, mask);
+}
+
+
+typedef struct
+{
+	hevcasm_pred_uni_8to8 *uni;
+	hevcasm_pred_bi_8to8 *bi;
+	ptrdiff_t kernel; /* offset of the kernel's entry in the table: equal for PUs that share a kernel */
+	uint8_t *dst;
+	const uint8_t *ref[2];
+	hevcasm_picture_progress *progress[2];
+	int rows[2]; /* reference rows that must be final before prediction */
+	int x;
+	int w;
+	int h;
+	int xFrac[2];
+	int yFrac[2];
+}
+pred_batch_job;
+
+
+static int pred_batch_job_before(const pred_batch_job *a, const pred_batch_job *b)
+{
+	if (a->x != b->x) return a->x < b->x;
+	return a->kernel < b->kernel;
+}
+
+
+static void prefetch_pred_ref(const uint8_t *ref, ptrdiff_t stride_ref, int w, int h, int taps)
+{
+	ref -= (taps / 2 - 1) * (stride_ref + 1);
+
+	const int span = w + taps - 1;
+
+	for (int y = 0; y < h + taps - 1; ++y)
+	{
+		/* every 64-byte cache line of the row: steps of 64 from an unaligned start can miss only the last */
+		for (int x = 0; x < span; x += 64) HEVCASM_PREFETCH(ref + x);
+		HEVCASM_PREFETCH(ref + span - 1);
+		ref += stride_ref;
+	}
+}
+
+
+void hevcasm_pred_batch(hevcasm_table_pred_batch *table, uint8_t *dst, ptrdiff_t stride_dst, ptrdiff_t stride_ref, int taps, const hevcasm_pred_pu *pu, int n, int yDst)
+{
+	pred_batch_job job[HEVCASM_PRED_BATCH_MAX];
+
+	assert(n <= HEVCASM_PRED_BATCH_MAX);
+
+	const int shift = taps == 8 ? 2 : 3;
+	const int fraction = (1 << shift) - 1;
+
+	/* Look up each PU's kernel and resolve its arguments */
+	for (int i = 0; i < n; ++i)
+	{
+		pred_batch_job *j = &job[i];
+		int k = 0;
+
+		assert(pu[i].predFlag >= 1 && pu[i].predFlag <= 3);
+
+		for (int list = 0; list < 2; ++list)
+		{
+			if (pu[i].predFlag & (1 << list))
+			{
+				const int xInt = pu[i].x + (pu[i].mv[list][0] >> shift);
+				const int yInt = pu[i].y + (pu[i].mv[list][1] >> shift);
+				j->ref[k] = pu[i].ref[list] + yInt * stride_ref + xInt;
+				j->xFrac[k] = pu[i].mv[list][0] & fraction;
+				j->yFrac[k] = pu[i].mv[list][1] & fraction;
+				j->progress[k] = pu[i].progress[list];
+				j->rows[k] = hevcasm_progress_rows_pred(yDst + pu[i].y, pu[i].nPbH, pu[i].mv[list][1], shift, taps);
+				++k;
+			}
+		}
+
+		j->dst = dst + pu[i].y * stride_dst + pu[i].x;
+		j->x = pu[i].x;
+		j->w = pu[i].nPbW;
+		j->h = pu[i].nPbH;
+
+		if (k == 2)
+		{
+			hevcasm_pred_bi_8to8 **slot = hevcasm_get_pred_bi_8to8(&table->bi, taps, j->w, j->h, j->xFrac[0], j->yFrac[0], j->xFrac[1], j->yFrac[1]);
+			j->uni = 0;
+			j->bi = *slot;
+			j->kernel = (const char *)slot - (const char *)table;
+		}
+		else
+		{
+			hevcasm_pred_uni_8to8 **slot = hevcasm_get_pred_uni_8to8(&table->uni, taps, j->w, j->h, j->xFrac[0], j->yFrac[0]);
+			j->uni = *slot;
+			j->bi = 0;
+			j->progress[1] = 0;
+			j->kernel = (const char *)slot - (const char *)table;
+		}
+	}
+
+	/* Group by kernel within each column of PUs (stable insertion sort: n is small) */
+	for (int i = 1; i < n; ++i)
+	{
+		const pred_batch_job t = job[i];
+		int k = i;
+		while (k > 0 && pred_batch_job_before(&t, &job[k - 1]))
+		{
+			job[k] = job[k - 1];
+			--k;
+		}
+		job[k] = t;
+	}
+
+	/* Predict, prefetching the reference rows needed by the next PU */
+	for (int i = 0; i < n; ++i)
+	{
+		const pred_batch_job *j = &job[i];
+
+		for (int k = 0; k < 2; ++k)
+		{
+			if (j->progress[k]) hevcasm_progress_wait(j->progress[k], j->rows[k]);
+		}
+
+		if (i + 1 < n)
+		{
+			const pred_batch_job *next = &job[i + 1];
+			prefetch_pred_ref(next->ref[0], stride_ref, next->w, next->h, taps);
+			if (next->bi) prefetch_pred_ref(next->ref[1], stride_ref, next->w, next->h, taps);
+		}
+
+		if (j->bi)
+		{
+			j->bi(j->dst, stride_dst, j->ref[0], j->ref[1], stride_ref, j->w, j->h, j->xFrac[0], j->yFrac[0], j->xFrac[1], j->yFrac[1]);
+		}
+		else
+		{
+			j->uni(j->dst, stride_dst, j->ref[0], stride_ref, j->w, j->h, j->xFrac[0], j->yFrac[0]);
+		}
+	}
+}
+
+
+#define STRIDE_PRED_BATCH 192
+
+typedef struct
+{
+	HEVCASM_ALIGN(32, uint8_t, dst[64 * STRIDE_PRED_BATCH]);
+	hevcasm_table_pred_batch table;
+	const hevcasm_pred_pu *pu;
+	int n;
+	int taps;
+}
+bound_pred_batch;
+
+
+static int init_pred_batch(void *p, hevcasm_instruction_set mask)
+{
+	bound_pred_batch *s = p;
+
+	if (!mask) return 0;
+
+	/* Batches mix kernels from several instruction sets: populate with every set up to and including this one
+	and report only those sets that change the table */
+	hevcasm_table_pred_batch lower;
+	hevcasm_populate_pred_batch(&lower, mask - 1);
+	hevcasm_populate_pred_batch(&s->table, mask | (mask - 1));
+
+	if (!memcmp(&lower, &s->table, sizeof(lower))) return 0;
+
+	if (mask == HEVCASM_C_REF)
+	{
+		hevcasm_test_printf("\t%d PUs %d-tap : ", s->n, s->taps);
+	}
+
+	memset(s->dst, 0, sizeof(s->dst));
+
+	return 1;
+}
+
+
+static void invoke_pred_batch(void *p, int n)
+{
+	bound_pred_batch *s = p;
+	while (n--)
+	{
+		hevcasm_pred_batch(&s->table, s->dst, STRIDE_PRED_BATCH, STRIDE_PRED_BATCH, s->taps, s->pu, s->n, 0);
+	}
+}
+
+
+static int mismatch_pred_batch(void *boundRef, void *boundTest)
+{
+	bound_pred_batch *ref = boundRef;
+	bound_pred_batch *test = boundTest;
+
+	const int size = 8 * ref->taps;
+
+	for (int y = 0; y < size; ++y)
+	{
+		if (memcmp(&ref->dst[y * STRIDE_PRED_BATCH], &test->dst[y * STRIDE_PRED_BATCH], size)) return 1;
+	}
+
+	return 0;
+}
+
+
+/* Random quadtree of prediction units covering the size x size luma block at (x, y) */
+static int make_pred_batch_partitions(hevcasm_pred_pu *pu, int x, int y, int size)
+{
+	if (size == 64 || (size > 8 && hevcasm_test_rand() % 8))
+	{
+		const int half = size / 2;
+		int n = 0;
+		n += make_pred_batch_partitions(pu + n, x, y, half);
+		n += make_pred_batch_partitions(pu + n, x + half, y, half);
+		n += make_pred_batch_partitions(pu + n, x, y + half, half);
+		n += make_pred_batch_partitions(pu + n, x + half, y + half, half);
+		return n;
+	}
+
+	/* PartMode 2Nx2N, 2NxN or Nx2N */
+	const int partMode = hevcasm_test_rand() % 3;
+	const int n = partMode ? 2 : 1;
+
+	for (int i = 0; i < n; ++i)
+	{
+		pu[i].nPbW = partMode == 2 ? size / 2 : size;
+		pu[i].nPbH = partMode == 1 ? size / 2 : size;
+		pu[i].x = x + (partMode == 2 ? i * size / 2 : 0);
+		pu[i].y = y + (partMode == 1 ? i * size / 2 : 0);
+
+		/* 8x4 and 4x8 PUs are restricted to uni prediction */
+		pu[i].predFlag = (pu[i].nPbW + pu[i].nPbH == 12) ? 1 + hevcasm_test_rand() % 2 : 1 + hevcasm_test_rand() % 3;
+
+		for (int list = 0; list < 2; ++list)
+		{
+			pu[i].mv[list][0] = (int16_t)(hevcasm_test_rand() % 129 - 64);
+			pu[i].mv[list][1] = (int16_t)(hevcasm_test_rand() % 129 - 64);
+		}
+	}
+
+	return n;
+}
+
+
+#define ROWS_PRED_BATCH 112
+#define TOP_PRED_BATCH 24
+
+/* Reference pictures whose rows are published by a producer thread as their progress is reported */
+typedef struct
+{
+	hevcasm_picture_progress progress;
+	const uint8_t *source[2];
+	uint8_t *ref[2];
+	int taps;
+	int height; /* luma rows */
+	hevcasm_picture_progress consumed; /* reported final (one row) once the consumer has finished */
+}
+pred_batch_producer;
+
+
+/* Buffer rows of each reference available once luma rows [0, rows) are reported final */
+static int pred_batch_published(const pred_batch_producer *s, int rows)
+{
+	if (rows == s->height) return ROWS_PRED_BATCH;
+	const int rows_plane = s->taps == 8 ? rows : rows / 2;
+	return rows_plane ? TOP_PRED_BATCH + rows_plane : 0;
+}
+
+
+static void pred_batch_publish(pred_batch_producer *s, int rows)
+{
+	const int from = pred_batch_published(s, hevcasm_progress_get(&s->progress));
+	const int to = pred_batch_published(s, rows);
+
+	for (int list = 0; list < 2; ++list)
+	{
+		memcpy(s->ref[list] + from * STRIDE_PRED_BATCH, s->source[list] + from * STRIDE_PRED_BATCH, (to - from) * STRIDE_PRED_BATCH);
+	}
+
+	hevcasm_progress_set(&s->progress, rows);
+}
+
+
+#ifdef WIN32
+static DWORD WINAPI pred_batch_producer_thread(LPVOID p)
+#else
+static void *pred_batch_producer_thread(void *p)
+#endif
+{
+	pred_batch_producer *s = p;
+
+	for (int rows = hevcasm_progress_get(&s->progress) + 1; rows <= s->height; ++rows)
+	{
+		/* publish one more row only while the consumer is blocked, so that rows it reads without waiting for them
+		are still stale */
+		while (!hevcasm_progress_waiting(&s->progress) && !hevcasm_progress_get(&s->consumed))
+		{
+#ifdef WIN32
+			SwitchToThread();
+#else
+			sched_yield();
+#endif
+		}
+
+		if (hevcasm_progress_get(&s->consumed)) break;
+
+		pred_batch_publish(s, rows);
+
+		/* give the consumer time to wake and stop waiting before the next row */
+#ifdef WIN32
+		Sleep(1);
+#else
+		usleep(1000);
+#endif
+	}
+
+	return 0;
+}
+
+
+/* Predicts a batch while its reference pictures are only partly reported final and compares the result with
+prediction from the complete pictures */
+static void test_pred_batch_progress(int *error_count, hevcasm_instruction_set mask, hevcasm_pred_pu *pu, int n, int taps, uint8_t *source[2])
+{
+	HEVCASM_ALIGN(32, uint8_t, expected[64 * STRIDE_PRED_BATCH]);
+	HEVCASM_ALIGN(32, uint8_t, dst[64 * STRIDE_PRED_BATCH]);
+	memset(expected, 0, sizeof(expected));
+	memset(dst, 0, sizeof(dst));
+
+	hevcasm_table_pred_batch table;
+	hevcasm_populate_pred_batch(&table, HEVCASM_C_REF);
+	hevcasm_pred_batch(&table, expected, STRIDE_PRED_BATCH, STRIDE_PRED_BATCH, taps, pu, n, 0);
+	hevcasm_populate_pred_batch(&table, mask);
+
+	pred_batch_producer *s = malloc(sizeof(pred_batch_producer));
+	if (s)
+	{
+		s->ref[0] = malloc(ROWS_PRED_BATCH * STRIDE_PRED_BATCH);
+		s->ref[1] = malloc(ROWS_PRED_BATCH * STRIDE_PRED_BATCH);
+	}
+	if (!s || !s->ref[0] || !s->ref[1])
+	{
+		hevcasm_test_printf("	%d PUs %d-tap, progress partly reported : out of memory-MISMATCH\n", n, taps);
+		if (s)
+		{
+			free(s->ref[0]);
+			free(s->ref[1]);
+		}
+		free(s);
+		++*error_count;
+		return;
+	}
+
+	s->taps = taps;
+	s->height = ROWS_PRED_BATCH - 2 * TOP_PRED_BATCH;
+
+	for (int list = 0; list < 2; ++list)
+	{
+		/* rows not yet published hold stale samples */
+		s->source[list] = source[list];
+		for (int x = 0; x < ROWS_PRED_BATCH * STRIDE_PRED_BATCH; ++x) s->ref[list][x] = (uint8_t)~source[list][x];
+	}
+
+	hevcasm_progress_init(&s->progress, s->height);
+	hevcasm_progress_init(&s->consumed, 1);
+	pred_batch_publish(s, s->height / 4);
+
+	for (int i = 0; i < n; ++i)
+	{
+		for (int list = 0; list < 2; ++list)
+		{
+			pu[i].ref[list] = s->ref[list] + TOP_PRED_BATCH * STRIDE_PRED_BATCH + 24;
+			pu[i].progress[list] = &s->progress;
+		}
+	}
+
+#ifdef WIN32
+	HANDLE producer = CreateThread(NULL, 0, pred_batch_producer_thread, s, 0, NULL);
+	const int started = producer != NULL;
+#else
+	pthread_t producer;
+	const int started = !pthread_create(&producer, NULL, pred_batch_producer_thread, s);
+#endif
+
+	/* without a producer, prediction must not block: the test then fails but completes */
+	if (!started) pred_batch_publish(s, s->height);
+
+	hevcasm_pred_batch(&table, dst, STRIDE_PRED_BATCH, STRIDE_PRED_BATCH, taps, pu, n, 0);
+
+	hevcasm_progress_set(&s->consumed, 1);
+
+	if (started)
+	{
+#ifdef WIN32
+		WaitForSingleObject(producer, INFINITE);
+		CloseHandle(producer);
+#else
+		pthread_join(producer, NULL);
+#endif
+	}
+
+	const int size = 8 * taps;
+	int errors = !started;
+	for (int y = 0; y < size; ++y)
+	{
+		if (memcmp(&expected[y * STRIDE_PRED_BATCH], &dst[y * STRIDE_PRED_BATCH], size)) errors = 1;
+	}
+
+	hevcasm_test_printf("\t%d PUs %d-tap, progress partly reported, producer thread : %s\n", n, taps, errors ? "MISMATCH" : "ok");
+
+	free(s->ref[0]);
+	free(s->ref[1]);
+	free(s);
+
+	*error_count += errors;
+}
+
+
+void HEVCASM_API hevcasm_test_pred_batch(int *error_count, hevcasm_instruction_set mask)
+{
+	hevcasm_test_printf("\nhevcasm_pred_batch - Batched Inter Prediction of a CTU\n");
+
+	HEVCASM_ALIGN(32, uint8_t, ref[2][ROWS_PRED_BATCH * STRIDE_PRED_BATCH]);
+
+	for (int x = 0; x < ROWS_PRED_BATCH * STRIDE_PRED_BATCH; ++x)
+	{
+		ref[0][x] = hevcasm_test_rand() & 0xff;
+		ref[1][x] = hevcasm_test_rand() & 0xff;
+	}
+
+	hevcasm_pred_pu pu[HEVCASM_PRED_BATCH_MAX];
+	const int n = make_pred_batch_partitions(pu, 0, 0, 64);
+
+	bound_pred_batch b[2];
+
+	b[0].pu = pu;
+	b[0].n = n;
+
+	for (b[0].taps = 8; b[0].taps >= 4; b[0].taps -= 4)
+	{
+		/* chroma (taps == 4) PUs are half size and take the luma motion vector in 1/8 sample units */
+		for (int i = 0; i < n; ++i)
+		{
+			const int scale = b[0].taps == 8 ? 1 : 2;
+			pu[i].x /= scale;
+			pu[i].y /= scale;
+			pu[i].nPbW /= scale;
+			pu[i].nPbH /= scale;
+			pu[i].ref[0] = ref[0] + TOP_PRED_BATCH * STRIDE_PRED_BATCH + 24;
+			pu[i].ref[1] = ref[1] + TOP_PRED_BATCH * STRIDE_PRED_BATCH + 24;
+			pu[i].progress[0] = 0;
+			pu[i].progress[1] = 0;
+		}
+
+		b[1] = b[0];
+
+		*error_count += hevcasm_test(&b[0], &b[1], init_pred_batch, invoke_pred_batch, mismatch_pred_batch, mask, 100);
+
+		uint8_t *source[2] = { ref[0], ref[1] };
+		test_pred_batch_progress(error_count, mask, pu, n, b[0].taps, source);
+	}
+}
+
+#undef ROWS_PRED_BATCH
+#undef TOP_PRED_BATCH
+#undef STRIDE_PRED_BATCH
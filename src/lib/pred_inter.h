@@ -43,6 +43,7 @@ THE POSSIBILITY OF SUCH DAMAGE.
 
 
 #include "hevcasm.h"
+#include "progress.h"
 
 
 #ifdef __cplusplus
@@ -57,13 +58,13 @@ typedef void HEVCASM_API hevcasm_pred_uni_8to8(uint8_t *dst, ptrdiff_t stride_ds
 
 typedef struct
 {
-	hevcasm_pred_uni_8to8 * p[2][9][2][2];
+	hevcasm_pred_uni_8to8 * p[2][17][2][2];
 }
 hevcasm_table_pred_uni_8to8;
 
 static hevcasm_pred_uni_8to8** hevcasm_get_pred_uni_8to8(hevcasm_table_pred_uni_8to8 *table, int taps, int w, int h, int xFrac, int yFrac)
 {
-	return &table->p[taps / 4 - 1][(w + taps - 1) / taps][xFrac ? 1 : 0][yFrac ? 1 : 0];
+	return &table->p[taps / 4 - 1][(w + 3) / 4][xFrac ? 1 : 0][yFrac ? 1 : 0];
 }
 
 void HEVCASM_API hevcasm_populate_pred_uni_8to8(hevcasm_table_pred_uni_8to8 *table, hevcasm_instruction_set mask);
@@ -77,14 +78,14 @@ typedef void hevcasm_pred_bi_8to8(uint8_t *dst0, ptrdiff_t stride_dst, const uin
 
 typedef struct
 {
-	hevcasm_pred_bi_8to8 * p[2][5][2];
+	hevcasm_pred_bi_8to8 * p[2][17][2];
 }
 hevcasm_table_pred_bi_8to8;
 
 static hevcasm_pred_bi_8to8** hevcasm_get_pred_bi_8to8(hevcasm_table_pred_bi_8to8 *table, int taps, int w, int h, int xFracA, int yFracA, int xFracB, int yFracB)
 {
 	const int frac = xFracA || yFracA || xFracB || yFracB;
-	return &table->p[taps / 4 - 1][(w + 2 * taps - 1) / (2 * taps)][frac];
+	return &table->p[taps / 4 - 1][(w + 3) / 4][frac];
 }
 
 void HEVCASM_API hevcasm_populate_pred_bi_8to8(hevcasm_table_pred_bi_8to8 *table, hevcasm_instruction_set mask);
@@ -92,6 +93,148 @@ void HEVCASM_API hevcasm_populate_pred_bi_8to8(hevcasm_table_pred_bi_8to8 *table
 hevcasm_test_function hevcasm_test_pred_bi;
 
 
+// HEVC 4:2:0 chroma prediction on interleaved (semi-planar, e.g. NV12) Cb and Cr samples
+
+// nPbW is the chroma block width in samples of each component: a row of the block occupies 2 * nPbW bytes.
+// xFrac and yFrac are eighth-sample positions (0..7) shared by both components.
+// Planar chroma is predicted by the functions above with taps = 4.
+
+typedef struct
+{
+	hevcasm_pred_uni_8to8 * p[9][2][2];
+}
+hevcasm_table_pred_uni_nv12;
+
+static hevcasm_pred_uni_8to8** hevcasm_get_pred_uni_nv12(hevcasm_table_pred_uni_nv12 *table, int w, int h, int xFrac, int yFrac)
+{
+	return &table->p[(w + 3) / 4][xFrac ? 1 : 0][yFrac ? 1 : 0];
+}
+
+void HEVCASM_API hevcasm_populate_pred_uni_nv12(hevcasm_table_pred_uni_nv12 *table, hevcasm_instruction_set mask);
+
+hevcasm_test_function hevcasm_test_pred_uni_nv12;
+
+
+typedef struct
+{
+	hevcasm_pred_bi_8to8 * p[9][2];
+}
+hevcasm_table_pred_bi_nv12;
+
+static hevcasm_pred_bi_8to8** hevcasm_get_pred_bi_nv12(hevcasm_table_pred_bi_nv12 *table, int w, int h, int xFracA, int yFracA, int xFracB, int yFracB)
+{
+	const int frac = xFracA || yFracA || xFracB || yFracB;
+	return &table->p[(w + 3) / 4][frac];
+}
+
+void HEVCASM_API hevcasm_populate_pred_bi_nv12(hevcasm_table_pred_bi_nv12 *table, hevcasm_instruction_set mask);
+
+hevcasm_test_function hevcasm_test_pred_bi_nv12;
+
+
+// HEVC uni prediction to 14-bit samples (predSamplesLX in 8.5.3.3.3), the input of explicit weighted prediction
+
+// Integer positions give the reference samples scaled by 64. stride_dst is in int16_t units. Assembly kernels cover
+// integer and horizontal-only positions; vertical and two-dimensional positions use the C implementation.
+
+typedef void hevcasm_pred_uni_8to16(int16_t *dst, ptrdiff_t stride_dst, const uint8_t *ref, ptrdiff_t stride_ref, int nPbW, int nPbH, int xFrac, int yFrac);
+
+typedef struct
+{
+	hevcasm_pred_uni_8to16 * p[2][17][2][2];
+}
+hevcasm_table_pred_uni_8to16;
+
+static hevcasm_pred_uni_8to16** hevcasm_get_pred_uni_8to16(hevcasm_table_pred_uni_8to16 *table, int taps, int w, int h, int xFrac, int yFrac)
+{
+	return &table->p[taps / 4 - 1][(w + 3) / 4][xFrac ? 1 : 0][yFrac ? 1 : 0];
+}
+
+void HEVCASM_API hevcasm_populate_pred_uni_8to16(hevcasm_table_pred_uni_8to16 *table, hevcasm_instruction_set mask);
+
+hevcasm_test_function hevcasm_test_pred_uni_8to16;
+
+
+// HEVC explicit weighted sample prediction (8.5.3.3.4.3)
+
+// src, src0 and src1 are 14-bit prediction samples (predSamples in the standard), for example the output of
+// hevcasm_pred_uni_8to16. Strides are in int16_t units.
+// log2Wd is luma_log2_weight_denom (or ChromaLog2WeightDenom) + 6 so, at 8-bit depth, is never less than 6.
+
+typedef void hevcasm_pred_uni_weighted_16to8(uint8_t *dst, ptrdiff_t stride_dst, const int16_t *src, ptrdiff_t stride_src, int nPbW, int nPbH, int w0, int o0, int log2Wd);
+
+typedef struct
+{
+	hevcasm_pred_uni_weighted_16to8 * p[17];
+}
+hevcasm_table_pred_uni_weighted_16to8;
+
+static hevcasm_pred_uni_weighted_16to8** hevcasm_get_pred_uni_weighted_16to8(hevcasm_table_pred_uni_weighted_16to8 *table, int w, int h)
+{
+	return &table->p[(w + 3) / 4];
+}
+
+void HEVCASM_API hevcasm_populate_pred_uni_weighted_16to8(hevcasm_table_pred_uni_weighted_16to8 *table, hevcasm_instruction_set mask);
+
+hevcasm_test_function hevcasm_test_pred_uni_weighted;
+
+
+typedef void hevcasm_pred_bi_weighted_16to8(uint8_t *dst, ptrdiff_t stride_dst, const int16_t *src0, const int16_t *src1, ptrdiff_t stride_src, int nPbW, int nPbH, int w0, int w1, int o0, int o1, int log2Wd);
+
+typedef struct
+{
+	hevcasm_pred_bi_weighted_16to8 * p[17];
+}
+hevcasm_table_pred_bi_weighted_16to8;
+
+static hevcasm_pred_bi_weighted_16to8** hevcasm_get_pred_bi_weighted_16to8(hevcasm_table_pred_bi_weighted_16to8 *table, int w, int h)
+{
+	return &table->p[(w + 3) / 4];
+}
+
+void HEVCASM_API hevcasm_populate_pred_bi_weighted_16to8(hevcasm_table_pred_bi_weighted_16to8 *table, hevcasm_instruction_set mask);
+
+hevcasm_test_function hevcasm_test_pred_bi_weighted;
+
+
+// Batched inter prediction of a set of non-overlapping PUs, for example all the PUs of a CTU in one component
+
+// Each PU's kernel is looked up once; PUs are then grouped by kernel within each column of PUs and predicted
+// back to back, while the reference rows of the next PU are prefetched. Columns run from left to right so that
+// kernels writing beyond the right edge of their block never overwrite a PU that has already been predicted.
+
+#define HEVCASM_PRED_BATCH_MAX 256
+
+typedef struct
+{
+	int x; /* position of the block relative to dst, in samples */
+	int y;
+	int nPbW;
+	int nPbH;
+	int predFlag; /* bit 0: predFlagL0, bit 1: predFlagL1 */
+	const uint8_t *ref[2]; /* sample of each reference picture co-located with dst[0] */
+	int16_t mv[2][2]; /* [list][x, y] in units of 1/4 sample when taps is 8, 1/8 sample when taps is 4 */
+	hevcasm_picture_progress *progress[2]; /* reconstruction progress of each reference picture, or 0 if it is complete */
+}
+hevcasm_pred_pu;
+
+typedef struct
+{
+	hevcasm_table_pred_uni_8to8 uni;
+	hevcasm_table_pred_bi_8to8 bi;
+}
+hevcasm_table_pred_batch;
+
+void HEVCASM_API hevcasm_populate_pred_batch(hevcasm_table_pred_batch *table, hevcasm_instruction_set mask);
+
+// Predicts n PUs (n <= HEVCASM_PRED_BATCH_MAX). Both reference pictures share stride_ref. yDst is the row of dst[0]
+// within its plane (a chroma row when taps is 4): before predicting each PU, waits for the reference rows it reads
+// to be reported final, converting 4:2:0 chroma rows to the luma rows counted by hevcasm_picture_progress.
+void HEVCASM_API hevcasm_pred_batch(hevcasm_table_pred_batch *table, uint8_t *dst, ptrdiff_t stride_dst, ptrdiff_t stride_ref, int taps, const hevcasm_pred_pu *pu, int n, int yDst);
+
+hevcasm_test_function hevcasm_test_pred_batch;
+
+
 #ifdef __cplusplus
 }
 #endif
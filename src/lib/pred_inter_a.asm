@@ -35,6 +35,8 @@
 %define private_prefix hevcasm
 %include "x86inc.asm"
 
+%define ORDER(a, b, c, d) ((a << 6) | (b << 4) | (c << 2) | d)
+
 
 SECTION_RODATA 32
 
@@ -43,11 +45,33 @@ SECTION_RODATA 32
 		times %1 %2 %3
 %endmacro
 
+CONSTANT 16, dw, 1
+CONSTANT 16, dw, 0x20
+CONSTANT 16, dw, 0x40
+CONSTANT 8, dd, 0x800
 CONSTANT 8, dw, 0x20
 CONSTANT 8, dw, 0x40
 CONSTANT 4, dd, 0x800
 
 
+; pshufb patterns gathering the byte pairs (x+2k+i, x+2k+i+1) that pmaddubsw multiplies by taps (2k, 2k+1)
+pred_inter_shuffle_8x1:
+	db 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8
+	db 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10
+	db 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12
+	db 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13, 14
+
+; as above for two rows of four samples, one row in each 64-bit half
+pred_inter_shuffle_4x2:
+	db 0, 1, 1, 2, 2, 3, 3, 4, 8, 9, 9, 10, 10, 11, 11, 12
+	db 2, 3, 3, 4, 4, 5, 5, 6, 10, 11, 11, 12, 12, 13, 13, 14
+
+; as above for interleaved Cb/Cr samples, where taps are two bytes apart
+pred_inter_shuffle_nv12:
+	db 0, 2, 1, 3, 2, 4, 3, 5, 4, 6, 5, 7, 6, 8, 7, 9
+	db 4, 6, 5, 7, 6, 8, 7, 9, 8, 10, 9, 11, 10, 12, 11, 13
+
+
 %macro PRED_INTER_8TAP_COEFFICIENT_PAIRS 2
 	pred_inter_8tap_coefficient_pairs_%1_%2:
 		; Frac = 0/4
@@ -72,6 +96,8 @@ CONSTANT 4, dd, 0x800
 		times %1 %2 4, -1
 %endmacro
 
+PRED_INTER_8TAP_COEFFICIENT_PAIRS 16, db
+PRED_INTER_8TAP_COEFFICIENT_PAIRS 8, dw
 PRED_INTER_8TAP_COEFFICIENT_PAIRS 8, db
 PRED_INTER_8TAP_COEFFICIENT_PAIRS 4, dw
 
@@ -104,6 +130,8 @@ PRED_INTER_8TAP_COEFFICIENT_PAIRS 4, dw
 		times %1 %2 58, -2
 %endmacro
 
+PRED_INTER_4TAP_COEFFICIENT_PAIRS 16, db
+PRED_INTER_4TAP_COEFFICIENT_PAIRS 8, dw
 PRED_INTER_4TAP_COEFFICIENT_PAIRS 8, db
 PRED_INTER_4TAP_COEFFICIENT_PAIRS 4, dw
 
@@ -315,6 +343,250 @@ PRED_UNI_H_16NxH 4, 16, 32
 
 
 
+%macro PRED_UNI_H_8x1 3
+	; %1 is number of filter taps (4 or 8)
+	; %2 is size of output type (8 for uint8_t rounded, 16 for int16_t right shifted 6)
+	; %3 is dx (horizontal offset as integer number of samples)
+
+	movu m3, [r2 + 1 - (%1/2) + %3]
+	; m3 = reference samples from leftmost tap onwards
+
+	pshufb m0, m3, [pred_inter_shuffle_8x1 + 0 * 16]
+	pmaddubsw m0, m4
+	; m0 = 76543210 (first two taps)
+
+	pshufb m1, m3, [pred_inter_shuffle_8x1 + 1 * 16]
+	pmaddubsw m1, m5
+	paddw m0, m1
+	; m0 = 76543210 (four taps)
+
+	%if %1 == 8
+		pshufb m1, m3, [pred_inter_shuffle_8x1 + 2 * 16]
+		pmaddubsw m1, m6
+		paddw m0, m1
+
+		pshufb m1, m3, [pred_inter_shuffle_8x1 + 3 * 16]
+		pmaddubsw m1, m7
+		paddw m0, m1
+		; m0 = 76543210 (eight taps)
+	%endif
+
+	%if %2 == 16
+		movu [r0 + 2 * %3], m0
+	%else
+		paddw m0, [constant_times_8_dw_0x20]
+		psraw m0, 6
+		packuswb m0, m0
+		movq [r0 + %3], m0
+	%endif
+
+%endmacro
+
+
+%macro PRED_UNI_H_4x2 2
+	; %1 is number of filter taps (4 or 8)
+	; %2 is size of output type (8 for uint8_t rounded, 16 for int16_t right shifted 6)
+
+	movq m3, [r2 + 1 - (%1/2)]
+	movhps m3, [r2 + r3 + 1 - (%1/2)]
+	; m3 = 8 reference samples of first row (low half) and second row (high half)
+
+	pshufb m0, m3, [pred_inter_shuffle_4x2 + 0 * 16]
+	pmaddubsw m0, m4
+
+	pshufb m1, m3, [pred_inter_shuffle_4x2 + 1 * 16]
+	pmaddubsw m1, m5
+	paddw m0, m1
+
+	%if %1 == 8
+		; need four more taps...
+
+		movq m3, [r2 + 5 - (%1/2)]
+		movhps m3, [r2 + r3 + 5 - (%1/2)]
+
+		pshufb m1, m3, [pred_inter_shuffle_4x2 + 0 * 16]
+		pmaddubsw m1, m6
+		paddw m0, m1
+
+		pshufb m1, m3, [pred_inter_shuffle_4x2 + 1 * 16]
+		pmaddubsw m1, m7
+		paddw m0, m1
+	%endif
+
+	; m0 = 3210 (first row), 3210 (second row)
+
+	%if %2 == 16
+		movhps [r0 + r1], m0
+		movq [r0], m0
+	%else
+		paddw m0, [constant_times_8_dw_0x20]
+		psraw m0, 6
+		packuswb m0, m0
+		pextrd [r0 + r1], m0, 1
+		movd [r0], m0
+	%endif
+
+%endmacro
+
+
+%macro PRED_UNI_H_NARROW 3
+	; %1 is number of filter taps (4 or 8)
+	; %2 is size of output type (8 for uint8_t rounded, 16 for int16_t right shifted 6)
+	; %3 is block width (4, 8 or 24)
+
+	; void hevcasm_pred_uni_%1tap_8to%2_h_%3xh_sse4(D *dst, ptrdiff_t stride_dst, const uint8_t *ref, ptrdiff_t stride_ref, int nPbW, int nPbH, int xFrac, int yFrac);
+	INIT_XMM sse4
+	cglobal pred_uni_%1tap_8to%2_h_%3xh, 8, 8, (6+%1/4)
+
+		%if %1 == 8
+			shl r6d, 6  ; frac *= 4 * 16
+			lea r4, [pred_inter_8tap_coefficient_pairs_8_db ]
+		%else
+			shl r6d, 5  ; frac *= 2 * 16
+			lea r4, [pred_inter_4tap_coefficient_pairs_8_db ]
+		%endif
+
+		mova m4, [r4 + r6+ 0 * 16]
+		mova m5, [r4 + r6+ 1 * 16]
+		%if %1 == 8
+			mova m6, [r4 + r6+ 2 * 16]
+			mova m7, [r4 + r6+ 3 * 16]
+		%endif
+
+		%if %2 == 16
+			; dst is int16_t * so need double the stride
+			shl r1, 1
+		%endif
+
+		%if %3 == 4
+			; two rows per iteration
+			.loop
+				cmp r5d, 1
+				jne .pair
+				; final row of odd-height block: filter it into both halves
+				xor r1, r1
+				xor r3, r3
+			.pair
+				PRED_UNI_H_4x2 %1, %2
+
+				lea r0, [r0 + 2 * r1]
+				lea r2, [r2 + 2 * r3]
+				sub r5d, 2
+				jg .loop
+		%else
+			.loop
+				%if %3 == 24
+					PRED_UNI_H_16x1 %1, %2, 0
+				%endif
+				PRED_UNI_H_8x1 %1, %2, %3 - 8
+
+				add r0, r1
+				add r2, r3
+				dec r5d
+				jg .loop
+		%endif
+
+		RET
+
+%endmacro
+
+PRED_UNI_H_NARROW 8, 8, 4
+PRED_UNI_H_NARROW 8, 8, 8
+PRED_UNI_H_NARROW 8, 8, 24
+
+PRED_UNI_H_NARROW 8, 16, 4
+PRED_UNI_H_NARROW 8, 16, 8
+PRED_UNI_H_NARROW 8, 16, 24
+
+PRED_UNI_H_NARROW 4, 8, 4
+PRED_UNI_H_NARROW 4, 8, 8
+PRED_UNI_H_NARROW 4, 8, 24
+
+PRED_UNI_H_NARROW 4, 16, 4
+PRED_UNI_H_NARROW 4, 16, 8
+PRED_UNI_H_NARROW 4, 16, 24
+
+
+
+%macro PRED_NV12_H_8x1 2
+	; %1 is size of output type (8 for uint8_t rounded, 16 for int16_t right shifted 6)
+	; %2 is dx (horizontal offset in bytes)
+
+	movu m3, [r2 - 2 + %2]
+	; m3 = interleaved reference samples from leftmost tap onwards
+
+	pshufb m0, m3, [pred_inter_shuffle_nv12 + 0 * 16]
+	pmaddubsw m0, m4
+	; m0 = 76543210 (first two taps)
+
+	pshufb m1, m3, [pred_inter_shuffle_nv12 + 1 * 16]
+	pmaddubsw m1, m5
+	paddw m0, m1
+	; m0 = 76543210 (Cr3 Cb3 Cr2 Cb2 Cr1 Cb1 Cr0 Cb0)
+
+	%if %1 == 16
+		movu [r0 + 2 * %2], m0
+	%else
+		paddw m0, [constant_times_8_dw_0x20]
+		psraw m0, 6
+		packuswb m0, m0
+		movq [r0 + %2], m0
+	%endif
+
+%endmacro
+
+
+%macro PRED_NV12_H 2
+	; %1 is size of output type (8 for uint8_t rounded, 16 for int16_t right shifted 6)
+	; %2 is block width (chroma samples of each component, multiple of 4)
+
+	; void hevcasm_pred_uni_nv12_8to%1_h_%2xh_sse4(D *dst, ptrdiff_t stride_dst, const uint8_t *ref, ptrdiff_t stride_ref, int nPbW, int nPbH, int xFrac, int yFrac);
+	INIT_XMM sse4
+	cglobal pred_uni_nv12_8to%1_h_%2xh, 8, 8, 6
+
+		shl r6d, 5  ; frac *= 2 * 16
+		lea r4, [pred_inter_4tap_coefficient_pairs_8_db]
+
+		mova m4, [r4 + r6 + 0 * 16]
+		mova m5, [r4 + r6 + 1 * 16]
+
+		%if %1 == 16
+			; dst is int16_t * so need double the stride
+			shl r1, 1
+		%endif
+
+		.loop
+			%assign dx 0
+			%rep %2/4
+				PRED_NV12_H_8x1 %1, dx
+				%assign dx dx+8
+			%endrep
+
+			add r0, r1
+			add r2, r3
+			dec r5d
+			jg .loop
+
+		RET
+
+%endmacro
+
+PRED_NV12_H 8, 4
+PRED_NV12_H 8, 8
+PRED_NV12_H 8, 12
+PRED_NV12_H 8, 16
+PRED_NV12_H 8, 24
+PRED_NV12_H 8, 32
+
+PRED_NV12_H 16, 4
+PRED_NV12_H 16, 8
+PRED_NV12_H 16, 12
+PRED_NV12_H 16, 16
+PRED_NV12_H 16, 24
+PRED_NV12_H 16, 32
+
+
+
 %macro PRED_UNI_V_8NxH 3
 	; %1 is number of filter taps (4 or 8);
 	; %2 is size of input type (8 for uint8_t, 16 for int16_t right shifted 6)
@@ -436,11 +708,119 @@ PRED_UNI_V_8NxH 4, 8, 8
 PRED_UNI_V_8NxH 4, 8, 16
 PRED_UNI_V_8NxH 4, 8, 24
 PRED_UNI_V_8NxH 4, 8, 32 
+PRED_UNI_V_8NxH 4, 8, 48
+PRED_UNI_V_8NxH 4, 8, 64
 
 PRED_UNI_V_8NxH 4, 16, 8
 PRED_UNI_V_8NxH 4, 16, 16
 PRED_UNI_V_8NxH 4, 16, 24
 PRED_UNI_V_8NxH 4, 16, 32
+PRED_UNI_V_8NxH 4, 16, 48
+PRED_UNI_V_8NxH 4, 16, 64
+
+
+
+%macro PRED_UNI_V_4xH 2
+	; %1 is number of filter taps (4 or 8);
+	; %2 is size of input type (8 for uint8_t, 16 for int16_t right shifted 6)
+
+	; void hevcasm_pred_uni_%1tap_%2to8_v_4xh_sse4(uint8_t *dst, ptrdiff_t stride_dst, const uint8_t *ref, ptrdiff_t stride_ref, int nPbW, int nPbH, int xFrac, int yFrac);
+	INIT_XMM sse4
+	cglobal pred_uni_%1tap_%2to8_v_4xh, 8, 8, 6
+
+		%if %2 == 16
+			shl r3, 1
+		%endif
+
+		; adjust input pointer (subtract (taps/2-1) * stride)
+		%rep %1/2-1
+			sub r2, r3
+		%endrep
+
+		%if %2 == 16
+			lea r4, [pred_inter_%1tap_coefficient_pairs_4_dw]
+		%else
+			lea r4, [pred_inter_%1tap_coefficient_pairs_8_db]
+		%endif
+
+		shl r7d, 4+%1/4
+		add r4, r7
+
+		; two rows per iteration
+		.loop
+			cmp r5d, 1
+			jne .pair
+			; final row of odd-height block: both halves store to the same row
+			xor r1, r1
+		.pair
+			%if %2 == 16
+				mova m3, [constant_times_4_dd_0x800]
+				mova m5, m3
+			%else
+				mova m3, [constant_times_8_dw_0x20]
+			%endif
+
+			%assign k 0
+			%rep %1/2
+				; each iteration of this loop performs two filter taps
+
+				%if %2 == 16
+					movq m0, [r2 + 0 * r3]
+					movq m1, [r2 + 1 * r3]
+					movq m2, [r2 + 2 * r3]
+					punpcklwd m0, m1
+					punpcklwd m1, m2
+					pmaddwd m0, [r4 + 16 * k]
+					pmaddwd m1, [r4 + 16 * k]
+					paddd m3, m0
+					paddd m5, m1
+					; m3 = 3210 (first row), m5 = 3210 (second row)
+				%else
+					movd m0, [r2 + 0 * r3]
+					movd m1, [r2 + 1 * r3]
+					movd m2, [r2 + 2 * r3]
+					punpcklbw m0, m1
+					punpcklbw m1, m2
+					punpcklqdq m0, m1
+					pmaddubsw m0, [r4 + 16 * k]
+					paddw m3, m0
+					; m3 = 3210 (first row), 3210 (second row)
+				%endif
+
+				lea r2, [r2 + 2 * r3]
+				%assign k k+1
+			%endrep
+
+			neg r3
+			lea r2, [r2 + %1 * r3]
+			neg r3
+
+			%if %2 == 16
+				psrad m3, 12
+				psrad m5, 12
+				packssdw m3, m5
+			%else
+				psraw m3, 6
+			%endif
+
+			packuswb m3, m3
+
+			pextrd [r0 + r1], m3, 1
+			movd [r0], m3
+
+			lea r0, [r0 + 2 * r1]
+			lea r2, [r2 + 2 * r3]
+			sub r5d, 2
+			jg .loop
+
+		RET
+
+%endmacro
+
+PRED_UNI_V_4xH 8, 8
+PRED_UNI_V_4xH 8, 16
+PRED_UNI_V_4xH 4, 8
+PRED_UNI_V_4xH 4, 16
 
 
 
@@ -567,13 +947,115 @@ PRED_UNI_V_8NxH 4, 16, 32
 
 %endmacro	
 
+PRED_BI_V_8NxH 8, 16, 8
 PRED_BI_V_8NxH 8, 16, 16
+PRED_BI_V_8NxH 8, 16, 24
 PRED_BI_V_8NxH 8, 16, 32
 PRED_BI_V_8NxH 8, 16, 48
 PRED_BI_V_8NxH 8, 16, 64
 
+PRED_BI_V_8NxH 4, 16, 8
 PRED_BI_V_8NxH 4, 16, 16
+PRED_BI_V_8NxH 4, 16, 24
 PRED_BI_V_8NxH 4, 16, 32
+PRED_BI_V_8NxH 4, 16, 48
+PRED_BI_V_8NxH 4, 16, 64
+
+
+
+%macro PRED_BI_V_4xH 1
+	; %1 is number of filter taps (4 or 8);
+
+	; void hevcasm_pred_bi_v_%1tap_16to16_4xh_sse4(uint8_t *dst, ptrdiff_t stride_dst, const int16_t *refAtop, const int16_t *refBtop, ptrdiff_t stride_ref, int nPbW, int nPbH, int yFracA, int yFracB);
+	INIT_XMM sse4
+	cglobal pred_bi_v_%1tap_16to16_4xh, 9, 9, 8
+
+		shl r4, 1
+
+		shl r7d, 4+%1/4
+		shl r8d, 4+%1/4
+		lea r5, [pred_inter_%1tap_coefficient_pairs_4_dw]
+		lea r7, [r5 + r7]
+		lea r8, [r5 + r8]
+
+		; two rows per iteration
+		.loop
+			cmp r6d, 1
+			jne .pair
+			; final row of odd-height block: both halves store to the same row
+			xor r1, r1
+		.pair
+			pxor m3, m3
+			pxor m5, m5
+			pxor m6, m6
+			pxor m7, m7
+
+			%assign k 0
+			%rep %1/2
+				; each iteration of this loop performs two filter taps
+
+				; reference picture A
+				movq m0, [r2 + 0 * r4]
+				movq m1, [r2 + 1 * r4]
+				movq m2, [r2 + 2 * r4]
+				punpcklwd m0, m1
+				punpcklwd m1, m2
+				pmaddwd m0, [r7 + 16 * k]
+				pmaddwd m1, [r7 + 16 * k]
+				paddd m3, m0
+				paddd m5, m1
+				lea r2, [r2 + 2 * r4]
+
+				; reference picture B
+				movq m0, [r3 + 0 * r4]
+				movq m1, [r3 + 1 * r4]
+				movq m2, [r3 + 2 * r4]
+				punpcklwd m0, m1
+				punpcklwd m1, m2
+				pmaddwd m0, [r8 + 16 * k]
+				pmaddwd m1, [r8 + 16 * k]
+				paddd m6, m0
+				paddd m7, m1
+				lea r3, [r3 + 2 * r4]
+
+				%assign k k+1
+			%endrep
+
+			neg r4
+			lea r2, [r2 + %1 * r4]
+			lea r3, [r3 + %1 * r4]
+			neg r4
+
+			psrad m3, 6
+			psrad m5, 6
+			psrad m6, 6
+			psrad m7, 6
+
+			packssdw m3, m5
+			packssdw m6, m7
+			; m3 = 3210 (first row), 3210 (second row) of reference picture A, m6 likewise for B
+
+			paddsw m3, m6
+			paddsw m3, [constant_times_8_dw_0x40]
+			psraw m3, 7
+
+			packuswb m3, m3
+
+			pextrd [r0 + r1], m3, 1
+			movd [r0], m3
+
+			lea r0, [r0 + 2 * r1]
+			lea r2, [r2 + 2 * r4]
+			lea r3, [r3 + 2 * r4]
+			sub r6d, 2
+			jg .loop
+
+		RET
+
+%endmacro
+
+PRED_BI_V_4xH 8
+PRED_BI_V_4xH 4
 
 
 
@@ -606,3 +1088,709 @@ PRED_BI_COPY 16
 PRED_BI_COPY 32
 PRED_BI_COPY 48
 PRED_BI_COPY 64
+
+
+
+%if ARCH_X86_64 == 1
+
+; AVX2 kernels below process two rows per iteration: each 128-bit lane of a ymm register holds
+; 16 samples of one row. When the block height is odd, the final iteration computes a row into
+; both lanes and stores both lanes to the same destination row (high lane first).
+
+
+%macro PRED_UNI_COPY_AVX2 1
+	; %1 is block width (32, 48 or 64)
+
+	; void hevcasm_pred_uni_copy_8to8_%1xh_avx2(uint8_t *dst, ptrdiff_t stride_dst, const uint8_t *ref, ptrdiff_t stride_ref, int nPbW, int nPbH, int xFrac, int yFrac);
+	INIT_YMM avx2
+	cglobal pred_uni_copy_8to8_%1xh, 8, 8, 2
+		.loop
+			movu m0, [r2]
+			%if %1 == 48
+				movu xm1, [r2 + 32]
+			%elif %1 == 64
+				movu m1, [r2 + 32]
+			%endif
+			movu [r0], m0
+			%if %1 == 48
+				movu [r0 + 32], xm1
+			%elif %1 == 64
+				movu [r0 + 32], m1
+			%endif
+			lea r2, [r2 + r3]
+			lea r0, [r0 + r1]
+			dec r5d
+			jg .loop
+		RET
+
+%endmacro
+
+PRED_UNI_COPY_AVX2 32
+PRED_UNI_COPY_AVX2 48
+PRED_UNI_COPY_AVX2 64
+
+
+
+%macro PRED_UNI_H_AVX2_LOAD 2
+	; %1 is destination register number
+	; %2 is byte offset from r2
+
+	movu xm%1, [r2 + %2]
+	vinserti128 m%1, m%1, [r2 + r3 + %2], 1
+	; m%1 = 16 bytes of first row (low lane), 16 bytes of second row (high lane)
+
+%endmacro
+
+
+%macro PRED_UNI_H_16x2 3
+	; %1 is number of filter taps (4 or 8)
+	; %2 is size of output type (8 for uint8_t rounded, 16 for int16_t right shifted 6)
+	; %3 is dx (horizontal offset as integer number of samples)
+
+	PRED_UNI_H_AVX2_LOAD 2, 1 - (%1/2) + %3
+	pmaddubsw m2, m4
+	; m2 = eca86420 (even positions, first two taps) for each row
+
+	PRED_UNI_H_AVX2_LOAD 1, 2 - (%1/2) + %3
+	pmaddubsw m1, m4
+	; m1 = fdb97531 (odd positions, first two taps) for each row
+
+	PRED_UNI_H_AVX2_LOAD 0, 3 - (%1/2) + %3
+	pmaddubsw m0, m5
+	paddw m2, m0
+	; m2 = eca86420 (even positions, four taps)
+
+	PRED_UNI_H_AVX2_LOAD 0, 4 - (%1/2) + %3
+	pmaddubsw m0, m5
+	paddw m1, m0
+	; m1 = fdb97531 (odd positions, four taps)
+
+	%if %1 == 8
+		PRED_UNI_H_AVX2_LOAD 0, 5 - (%1/2) + %3
+		pmaddubsw m0, m6
+		paddw m2, m0
+
+		PRED_UNI_H_AVX2_LOAD 0, 6 - (%1/2) + %3
+		pmaddubsw m0, m6
+		paddw m1, m0
+
+		PRED_UNI_H_AVX2_LOAD 0, 7 - (%1/2) + %3
+		pmaddubsw m0, m7
+		paddw m2, m0
+		; m2 = eca86420 (even positions)
+
+		PRED_UNI_H_AVX2_LOAD 0, 8 - (%1/2) + %3
+		pmaddubsw m0, m7
+		paddw m1, m0
+		; m1 = fdb97531 (odd positions)
+	%endif
+
+	punpcklwd m0, m2, m1
+	; m0 = 76543210 for each row
+
+	punpckhwd m2, m1
+	; m2 = fedcba98 for each row
+
+	%if %2 == 16
+		vperm2i128 m1, m0, m2, 0x31
+		; m1 = fedcba9876543210 (second row)
+
+		vperm2i128 m0, m0, m2, 0x20
+		; m0 = fedcba9876543210 (first row)
+
+		movu [r0 + r1 + 2 * %3], m1
+		movu [r0 + 2 * %3], m0
+	%else
+		paddw m0, [constant_times_16_dw_0x20]
+		paddw m2, [constant_times_16_dw_0x20]
+		psraw m0, 6
+		psraw m2, 6
+		packuswb m0, m2
+		; m0 = fedcba9876543210 for each row
+
+		vextracti128 [r0 + r1 + %3], m0, 1
+		movu [r0 + %3], xm0
+	%endif
+
+%endmacro
+
+
+%macro PRED_UNI_H_AVX2 3
+	; %1 is number of filter taps (4 or 8)
+	; %2 is size of output type (8 for uint8_t rounded, 16 for int16_t right shifted 6)
+	; %3 is block width (number of samples, multiple of 16)
+
+	; void hevcasm_pred_uni_%1tap_8to%2_h_%3xh_avx2(D *dst, ptrdiff_t stride_dst, const uint8_t *ref, ptrdiff_t stride_ref, int nPbW, int nPbH, int xFrac, int yFrac);
+	INIT_YMM avx2
+	cglobal pred_uni_%1tap_8to%2_h_%3xh, 8, 8, (6+%1/4)
+
+		%if %1 == 8
+			shl r6d, 7  ; frac *= 4 * 32
+			lea r4, [pred_inter_8tap_coefficient_pairs_16_db]
+		%else
+			shl r6d, 6  ; frac *= 2 * 32
+			lea r4, [pred_inter_4tap_coefficient_pairs_16_db]
+		%endif
+
+		movu m4, [r4 + r6 + 0 * 32]
+		movu m5, [r4 + r6 + 1 * 32]
+		%if %1 == 8
+			movu m6, [r4 + r6 + 2 * 32]
+			movu m7, [r4 + r6 + 3 * 32]
+		%endif
+
+		%if %2 == 16
+			; dst is int16_t * so need double the stride
+			shl r1, 1
+		%endif
+
+		.loop
+			cmp r5d, 1
+			jne .pair
+			; final row of odd-height block: filter it into both lanes
+			xor r1, r1
+			xor r3, r3
+		.pair
+			%assign dx 0
+			%rep %3/16
+				PRED_UNI_H_16x2 %1, %2, dx
+				%assign dx dx+16
+			%endrep
+
+			lea r0, [r0 + 2 * r1]
+			lea r2, [r2 + 2 * r3]
+			sub r5d, 2
+			jg .loop
+
+		RET
+
+%endmacro
+
+PRED_UNI_H_AVX2 8, 8, 16
+PRED_UNI_H_AVX2 8, 8, 32
+PRED_UNI_H_AVX2 8, 8, 48
+PRED_UNI_H_AVX2 8, 8, 64
+
+PRED_UNI_H_AVX2 8, 16, 16
+PRED_UNI_H_AVX2 8, 16, 32
+PRED_UNI_H_AVX2 8, 16, 48
+PRED_UNI_H_AVX2 8, 16, 64
+
+PRED_UNI_H_AVX2 4, 8, 16
+PRED_UNI_H_AVX2 4, 8, 32
+
+PRED_UNI_H_AVX2 4, 16, 16
+PRED_UNI_H_AVX2 4, 16, 32
+
+
+
+%macro PRED_UNI_V_8to8_16x2 2
+	; %1 is number of filter taps (4 or 8)
+	; %2 is dx (horizontal offset as integer number of samples)
+
+	mova m3, [constant_times_16_dw_0x20]
+	mova m5, m3
+
+	%assign k 0
+	%rep %1/2
+		; each iteration of this loop performs two filter taps
+
+		movu xm0, [r2 + %2]
+		vinserti128 m0, m0, [r2 + r6 + %2], 1
+		; m0 = row k (low lane), row k+1 (high lane, or row k on the final row of an odd-height block)
+
+		movu xm1, [r2 + r3 + %2]
+		vinserti128 m1, m1, [r2 + r7 + %2], 1
+		; m1 = row k+1 (low lane), row k+2 (high lane)
+
+		punpckhbw m2, m0, m1
+		punpcklbw m0, m1
+		pmaddubsw m0, [r4 + 32 * k]
+		pmaddubsw m2, [r4 + 32 * k]
+
+		paddw m3, m0
+		paddw m5, m2
+		; m3 = 76543210, m5 = fedcba98 (partial sums for each row)
+
+		lea r2, [r2 + 2 * r3]
+		%assign k k+1
+	%endrep
+
+	neg r3
+	lea r2, [r2 + %1 * r3]
+	neg r3
+
+	psraw m3, 6
+	psraw m5, 6
+	packuswb m3, m5
+	; m3 = fedcba9876543210 for each row
+
+	vextracti128 [r0 + r1 + %2], m3, 1
+	movu [r0 + %2], xm3
+
+%endmacro
+
+
+%macro PRED_UNI_V_16to8_16x2 2
+	; %1 is number of filter taps (4 or 8)
+	; %2 is dx (horizontal offset as integer number of samples)
+
+	mova m3, [constant_times_8_dd_0x800]
+	mova m4, m3
+	mova m5, m3
+	mova m6, m3
+
+	%assign k 0
+	%rep %1/2
+		; each iteration of this loop performs two filter taps
+
+		movu xm0, [r2 + 2 * %2]
+		vinserti128 m0, m0, [r2 + r6 + 2 * %2], 1
+		movu xm1, [r2 + r3 + 2 * %2]
+		vinserti128 m1, m1, [r2 + r7 + 2 * %2], 1
+		punpckhwd m2, m0, m1
+		punpcklwd m0, m1
+		pmaddwd m0, [r4 + 32 * k]
+		pmaddwd m2, [r4 + 32 * k]
+		paddd m3, m0
+		paddd m4, m2
+		; m3 = 3210, m4 = 7654 (partial sums for each row)
+
+		movu xm0, [r2 + 2 * %2 + 16]
+		vinserti128 m0, m0, [r2 + r6 + 2 * %2 + 16], 1
+		movu xm1, [r2 + r3 + 2 * %2 + 16]
+		vinserti128 m1, m1, [r2 + r7 + 2 * %2 + 16], 1
+		punpckhwd m2, m0, m1
+		punpcklwd m0, m1
+		pmaddwd m0, [r4 + 32 * k]
+		pmaddwd m2, [r4 + 32 * k]
+		paddd m5, m0
+		paddd m6, m2
+		; m5 = ba98, m6 = fedc (partial sums for each row)
+
+		lea r2, [r2 + 2 * r3]
+		%assign k k+1
+	%endrep
+
+	neg r3
+	lea r2, [r2 + %1 * r3]
+	neg r3
+
+	psrad m3, 12
+	psrad m4, 12
+	psrad m5, 12
+	psrad m6, 12
+	packssdw m3, m4
+	packssdw m5, m6
+	packuswb m3, m5
+	; m3 = fedcba9876543210 for each row
+
+	vextracti128 [r0 + r1 + %2], m3, 1
+	movu [r0 + %2], xm3
+
+%endmacro
+
+
+%macro PRED_UNI_V_AVX2 3
+	; %1 is number of filter taps (4 or 8);
+	; %2 is size of input type (8 for uint8_t, 16 for int16_t right shifted 6)
+	; %3 is block width (number of samples, multiple of 16)
+
+	; void hevcasm_pred_uni_%1tap_%2to8_v_%3xh_avx2(uint8_t *dst, ptrdiff_t stride_dst, const uint8_t *ref, ptrdiff_t stride_ref, int nPbW, int nPbH, int xFrac, int yFrac);
+	INIT_YMM avx2
+	cglobal pred_uni_%1tap_%2to8_v_%3xh, 8, 8, 7
+
+		%if %2 == 16
+			shl r3, 1
+		%endif
+
+		; adjust input pointer (subtract (taps/2-1) * stride)
+		%rep %1/2-1
+			sub r2, r3
+		%endrep
+
+		%if %2 == 16
+			lea r4, [pred_inter_%1tap_coefficient_pairs_8_dw]
+		%else
+			lea r4, [pred_inter_%1tap_coefficient_pairs_16_db]
+		%endif
+
+		shl r7d, 5+%1/4
+		add r4, r7
+
+		; high lane loads are offset by one row, r6 and r7 hold that row's offsets for the two loads of each tap pair
+		mov r6, r3
+		lea r7, [r3 + r3]
+
+		.loop
+			cmp r5d, 1
+			jne .pair
+			; final row of odd-height block: both lanes load and store the same row so that no row below it is read
+			xor r1, r1
+			xor r6, r6
+			mov r7, r3
+		.pair
+			%assign dx 0
+			%rep %3/16
+				%if %2 == 16
+					PRED_UNI_V_16to8_16x2 %1, dx
+				%else
+					PRED_UNI_V_8to8_16x2 %1, dx
+				%endif
+				%assign dx dx+16
+			%endrep
+
+			lea r0, [r0 + 2 * r1]
+			lea r2, [r2 + 2 * r3]
+			sub r5d, 2
+			jg .loop
+
+		RET
+
+%endmacro
+
+PRED_UNI_V_AVX2 8, 8, 16
+PRED_UNI_V_AVX2 8, 8, 32
+PRED_UNI_V_AVX2 8, 8, 48
+PRED_UNI_V_AVX2 8, 8, 64
+
+PRED_UNI_V_AVX2 8, 16, 16
+PRED_UNI_V_AVX2 8, 16, 32
+PRED_UNI_V_AVX2 8, 16, 48
+PRED_UNI_V_AVX2 8, 16, 64
+
+PRED_UNI_V_AVX2 4, 8, 16
+PRED_UNI_V_AVX2 4, 8, 32
+PRED_UNI_V_AVX2 4, 8, 48
+PRED_UNI_V_AVX2 4, 8, 64
+
+PRED_UNI_V_AVX2 4, 16, 16
+PRED_UNI_V_AVX2 4, 16, 32
+PRED_UNI_V_AVX2 4, 16, 48
+PRED_UNI_V_AVX2 4, 16, 64
+
+
+
+%macro PRED_BI_V_16x2 2
+	; %1 is number of filter taps (4 or 8)
+	; %2 is dx (horizontal offset as integer number of samples)
+
+	%assign half 0
+	%rep 2
+		; each iteration of this loop operates on 8 samples of each of two rows
+
+		pxor m3, m3
+		pxor m4, m4
+		pxor m5, m5
+		pxor m6, m6
+
+		%assign k 0
+		%rep %1/2
+			; each iteration of this loop performs two filter taps
+
+			; reference picture A
+			movu xm0, [r2 + 2 * %2 + 16 * half]
+			vinserti128 m0, m0, [r2 + r9 + 2 * %2 + 16 * half], 1
+			movu xm1, [r2 + r4 + 2 * %2 + 16 * half]
+			vinserti128 m1, m1, [r2 + r10 + 2 * %2 + 16 * half], 1
+			punpckhwd m2, m0, m1
+			punpcklwd m0, m1
+			pmaddwd m0, [r7 + 32 * k]
+			pmaddwd m2, [r7 + 32 * k]
+			paddd m3, m0
+			paddd m4, m2
+			lea r2, [r2 + 2 * r4]
+
+			; reference picture B
+			movu xm0, [r3 + 2 * %2 + 16 * half]
+			vinserti128 m0, m0, [r3 + r9 + 2 * %2 + 16 * half], 1
+			movu xm1, [r3 + r4 + 2 * %2 + 16 * half]
+			vinserti128 m1, m1, [r3 + r10 + 2 * %2 + 16 * half], 1
+			punpckhwd m2, m0, m1
+			punpcklwd m0, m1
+			pmaddwd m0, [r8 + 32 * k]
+			pmaddwd m2, [r8 + 32 * k]
+			paddd m5, m0
+			paddd m6, m2
+			lea r3, [r3 + 2 * r4]
+
+			%assign k k+1
+		%endrep
+
+		neg r4
+		lea r2, [r2 + %1 * r4]
+		lea r3, [r3 + %1 * r4]
+		neg r4
+
+		psrad m3, 6
+		psrad m4, 6
+		psrad m5, 6
+		psrad m6, 6
+
+		packssdw m3, m4
+		packssdw m5, m6
+
+		paddsw m3, m5
+		paddsw m3, [constant_times_16_dw_0x40]
+		psraw m3, 7
+
+		%if half == 0
+			mova m7, m3
+			; m7 = 76543210 for each row
+		%endif
+
+		%assign half half+1
+	%endrep
+
+	packuswb m7, m3
+	; m7 = fedcba9876543210 for each row
+
+	vextracti128 [r0 + r1 + %2], m7, 1
+	movu [r0 + %2], xm7
+
+%endmacro
+
+
+%macro PRED_BI_V_AVX2 3
+	; %1 is number of filter taps (4 or 8);
+	; %2 is size of input type (16 for int16_t right shifted 6)
+	; %3 is block width (number of samples, multiple of 16)
+
+	; void hevcasm_pred_bi_v_%1tap_16to16_%3xh_avx2(uint8_t *dst, ptrdiff_t stride_dst, const int16_t *refAtop, const int16_t *refBtop, ptrdiff_t stride_ref, int nPbW, int nPbH, int yFracA, int yFracB);
+	INIT_YMM avx2
+	cglobal pred_bi_v_%1tap_16to16_%3xh, 9, 11, 8
+
+		shl r4, 1
+
+		; high lane loads are offset by one row, r9 and r10 hold that row's offsets for the two loads of each tap pair
+		mov r9, r4
+		lea r10, [r4 + r4]
+
+		shl r7d, 5+%1/4
+		shl r8d, 5+%1/4
+		lea r5, [pred_inter_%1tap_coefficient_pairs_8_dw]
+		lea r7, [r5 + r7]
+		lea r8, [r5 + r8]
+
+		.loop
+			cmp r6d, 1
+			jne .pair
+			; final row of odd-height block: both lanes load and store the same row so that no row below it is read
+			xor r1, r1
+			xor r9, r9
+			mov r10, r4
+		.pair
+			%assign dx 0
+			%rep %3/16
+				PRED_BI_V_16x2 %1, dx
+				%assign dx dx+16
+			%endrep
+
+			lea r0, [r0 + 2 * r1]
+			lea r2, [r2 + 2 * r4]
+			lea r3, [r3 + 2 * r4]
+			sub r6d, 2
+			jg .loop
+
+		RET
+
+%endmacro
+
+PRED_BI_V_AVX2 8, 16, 16
+PRED_BI_V_AVX2 8, 16, 32
+PRED_BI_V_AVX2 8, 16, 48
+PRED_BI_V_AVX2 8, 16, 64
+
+PRED_BI_V_AVX2 4, 16, 16
+PRED_BI_V_AVX2 4, 16, 32
+PRED_BI_V_AVX2 4, 16, 48
+PRED_BI_V_AVX2 4, 16, 64
+
+
+
+%macro PRED_BI_COPY_AVX2 1
+	; %1 width (in bytes: 32, 48 or 64)
+
+	; void hevcasm_pred_bi_8to8_copy_%1xh_avx2(uint8_t *dst, ptrdiff_t stride_dst, const uint8_t *ref0, const uint8_t *ref1, ptrdiff_t stride_ref, int nPbW, int nPbH, int xFrac0, int yFrac0, int xFrac1, int yFrac1);
+	INIT_YMM avx2
+	cglobal pred_bi_8to8_copy_%1xh, 11, 11, 2
+		.loop
+			movu m0, [r2]
+			pavgb m0, [r3]
+			movu [r0], m0
+			%if %1 == 48
+				movu xm1, [r2 + 32]
+				pavgb xm1, [r3 + 32]
+				movu [r0 + 32], xm1
+			%elif %1 == 64
+				movu m1, [r2 + 32]
+				pavgb m1, [r3 + 32]
+				movu [r0 + 32], m1
+			%endif
+			lea r2, [r2 + r4]
+			lea r3, [r3 + r4]
+			lea r0, [r0 + r1]
+			dec r6d
+			jg .loop
+		RET
+
+%endmacro
+
+PRED_BI_COPY_AVX2 32
+PRED_BI_COPY_AVX2 48
+PRED_BI_COPY_AVX2 64
+
+
+
+; Explicit weighted prediction: nPbW is rounded up to a multiple of mmsize / 2 samples
+
+%macro PRED_WEIGHTED_STORE 0
+	packuswb m0, m0
+	%if mmsize == 32
+		vpermq m0, m0, ORDER(3, 1, 2, 0)
+		movu [r0 + r9], xm0
+	%else
+		movq [r0 + r9], m0
+	%endif
+%endmacro
+
+
+%macro PRED_UNI_WEIGHTED 1
+	; %1 samples per iteration (mmsize / 2)
+
+	; void hevcasm_pred_uni_weighted_16to8_%1nxh_isa(uint8_t *dst, ptrdiff_t stride_dst, const int16_t *src, ptrdiff_t stride_src, int nPbW, int nPbH, int w0, int o0, int log2Wd);
+	cglobal pred_uni_weighted_16to8_%1nxh, 9, 10, 8
+		shl r3, 1
+		; r3 = stride_src in bytes
+
+		movd xm6, r8d
+		; xm6 = log2Wd
+
+		movd xm4, r6d
+		pslld xm4, 16
+		psrld xm4, 16
+		mov r9d, 1
+		movd xm5, r9d
+		pslld xm5, xm6
+		psrld xm5, 1
+		pslld xm5, 16
+		por xm4, xm5
+		; xm4 = 1 << (log2Wd - 1) : w0 (words)
+
+		movd xm7, r7d
+		%if mmsize == 32
+			vpbroadcastd m4, xm4
+			vpbroadcastw m7, xm7
+		%else
+			pshufd m4, m4, 0
+			pshuflw m7, m7, 0
+			punpcklqdq m7, m7
+		%endif
+		; m7 = o0 (words)
+
+		mova m3, [constant_times_16_dw_1]
+
+		.row
+			xor r9, r9
+			.column
+				movu m0, [r2 + 2 * r9]
+				punpckhwd m1, m0, m3
+				punpcklwd m0, m3
+				; m0, m1 = 1 : predSamples (words)
+
+				pmaddwd m0, m4
+				pmaddwd m1, m4
+				psrad m0, xm6
+				psrad m1, xm6
+				; m0, m1 = (predSamples * w0 + (1 << (log2Wd - 1))) >> log2Wd
+
+				packssdw m0, m1
+				paddsw m0, m7
+				PRED_WEIGHTED_STORE
+
+				add r9, %1
+				cmp r9d, r4d
+				jl .column
+			add r0, r1
+			add r2, r3
+			dec r5d
+			jg .row
+		RET
+%endmacro
+
+
+%macro PRED_BI_WEIGHTED 1
+	; %1 samples per iteration (mmsize / 2)
+
+	; void hevcasm_pred_bi_weighted_16to8_%1nxh_isa(uint8_t *dst, ptrdiff_t stride_dst, const int16_t *src0, const int16_t *src1, ptrdiff_t stride_src, int nPbW, int nPbH, int w0, int w1, int o0, int o1, int log2Wd);
+	cglobal pred_bi_weighted_16to8_%1nxh, 12, 12, 6
+		shl r4, 1
+		; r4 = stride_src in bytes
+
+		movd xm4, r7d
+		pslld xm4, 16
+		psrld xm4, 16
+		movd xm5, r8d
+		pslld xm5, 16
+		por xm4, xm5
+		; xm4 = w1 : w0 (words)
+
+		lea r9d, [r9 + r10 + 1]
+		movd xm5, r9d
+		movd xm3, r11d
+		pslld xm5, xm3
+		; xm5 = (o0 + o1 + 1) << log2Wd
+
+		inc r11d
+		movd xm3, r11d
+		; xm3 = log2Wd + 1
+
+		%if mmsize == 32
+			vpbroadcastd m4, xm4
+			vpbroadcastd m5, xm5
+		%else
+			pshufd m4, m4, 0
+			pshufd m5, m5, 0
+		%endif
+
+		.row
+			xor r9, r9
+			.column
+				movu m0, [r2 + 2 * r9]
+				movu m1, [r3 + 2 * r9]
+				punpckhwd m2, m0, m1
+				punpcklwd m0, m1
+				; m0, m2 = predSamplesL1 : predSamplesL0 (words)
+
+				pmaddwd m0, m4
+				pmaddwd m2, m4
+				paddd m0, m5
+				paddd m2, m5
+				psrad m0, xm3
+				psrad m2, xm3
+				; m0, m2 = (predSamplesL0 * w0 + predSamplesL1 * w1 + ((o0 + o1 + 1) << log2Wd)) >> (log2Wd + 1)
+
+				packssdw m0, m2
+				PRED_WEIGHTED_STORE
+
+				add r9, %1
+				cmp r9d, r5d
+				jl .column
+			add r0, r1
+			add r2, r4
+			add r3, r4
+			dec r6d
+			jg .row
+		RET
+%endmacro
+
+
+INIT_XMM sse2
+PRED_UNI_WEIGHTED 8
+PRED_BI_WEIGHTED 8
+
+INIT_YMM avx2
+PRED_UNI_WEIGHTED 16
+PRED_BI_WEIGHTED 16
+
+%endif
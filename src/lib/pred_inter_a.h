@@ -43,7 +43,6 @@ THE POSSIBILITY OF SUCH DAMAGE.
 #include <stdlib.h>
 #include <stdint.h>
 
-typedef void hevcasm_pred_uni_8to16(int16_t *dst, ptrdiff_t stride_dst, const uint8_t *ref, ptrdiff_t stride_ref, int nPbW, int nPbH, int xFrac, int yFrac);
 typedef void hevcasm_pred_uni_16to8(uint8_t *dst, ptrdiff_t stride_dst, const int16_t *ref, ptrdiff_t stride_ref, int nPbW, int nPbH, int xFrac, int yFrac);
 typedef void hevcasm_pred_uni_16to16(int16_t *dst, ptrdiff_t stride_dst, const int16_t *ref, ptrdiff_t stride_ref, int nPbW, int nPbH, int xFrac, int yFrac);
 typedef void hevcasm_pred_bi_v_16to16(uint8_t *dst, ptrdiff_t stride_dst, const int16_t *refAtop, const int16_t *refBtop, ptrdiff_t stride_ref, int nPbW, int nPbH, int yFracA, int yFracB);
@@ -54,20 +53,33 @@ hevcasm_pred_uni_8to8 hevcasm_pred_uni_copy_8to8_32xh_sse2;
 hevcasm_pred_uni_8to8 hevcasm_pred_uni_copy_8to8_48xh_sse2;
 hevcasm_pred_uni_8to8 hevcasm_pred_uni_copy_8to8_64xh_sse2;
 
+hevcasm_pred_uni_8to8 hevcasm_pred_uni_8tap_8to8_h_4xh_sse4;
+hevcasm_pred_uni_8to8 hevcasm_pred_uni_8tap_8to8_h_8xh_sse4;
 hevcasm_pred_uni_8to8 hevcasm_pred_uni_8tap_8to8_h_16xh_sse4;
+hevcasm_pred_uni_8to8 hevcasm_pred_uni_8tap_8to8_h_24xh_sse4;
 hevcasm_pred_uni_8to8 hevcasm_pred_uni_8tap_8to8_h_32xh_sse4;
 hevcasm_pred_uni_8to8 hevcasm_pred_uni_8tap_8to8_h_48xh_sse4;
 hevcasm_pred_uni_8to8 hevcasm_pred_uni_8tap_8to8_h_64xh_sse4;
+hevcasm_pred_uni_8to8 hevcasm_pred_uni_4tap_8to8_h_4xh_sse4;
+hevcasm_pred_uni_8to8 hevcasm_pred_uni_4tap_8to8_h_8xh_sse4;
 hevcasm_pred_uni_8to8 hevcasm_pred_uni_4tap_8to8_h_16xh_sse4;
+hevcasm_pred_uni_8to8 hevcasm_pred_uni_4tap_8to8_h_24xh_sse4;
 hevcasm_pred_uni_8to8 hevcasm_pred_uni_4tap_8to8_h_32xh_sse4;
 
+hevcasm_pred_uni_8to16 hevcasm_pred_uni_8tap_8to16_h_4xh_sse4;
+hevcasm_pred_uni_8to16 hevcasm_pred_uni_8tap_8to16_h_8xh_sse4;
 hevcasm_pred_uni_8to16 hevcasm_pred_uni_8tap_8to16_h_16xh_sse4;
+hevcasm_pred_uni_8to16 hevcasm_pred_uni_8tap_8to16_h_24xh_sse4;
 hevcasm_pred_uni_8to16 hevcasm_pred_uni_8tap_8to16_h_32xh_sse4;
 hevcasm_pred_uni_8to16 hevcasm_pred_uni_8tap_8to16_h_48xh_sse4;
 hevcasm_pred_uni_8to16 hevcasm_pred_uni_8tap_8to16_h_64xh_sse4;
+hevcasm_pred_uni_8to16 hevcasm_pred_uni_4tap_8to16_h_4xh_sse4;
+hevcasm_pred_uni_8to16 hevcasm_pred_uni_4tap_8to16_h_8xh_sse4;
 hevcasm_pred_uni_8to16 hevcasm_pred_uni_4tap_8to16_h_16xh_sse4;
+hevcasm_pred_uni_8to16 hevcasm_pred_uni_4tap_8to16_h_24xh_sse4;
 hevcasm_pred_uni_8to16 hevcasm_pred_uni_4tap_8to16_h_32xh_sse4;
 
+hevcasm_pred_uni_8to8 hevcasm_pred_uni_8tap_8to8_v_4xh_sse4;
 hevcasm_pred_uni_8to8 hevcasm_pred_uni_8tap_8to8_v_8xh_sse4;
 hevcasm_pred_uni_8to8 hevcasm_pred_uni_8tap_8to8_v_16xh_sse4;
 hevcasm_pred_uni_8to8 hevcasm_pred_uni_8tap_8to8_v_24xh_sse4;
@@ -75,31 +87,121 @@ hevcasm_pred_uni_8to8 hevcasm_pred_uni_8tap_8to8_v_32xh_sse4;
 hevcasm_pred_uni_8to8 hevcasm_pred_uni_8tap_8to8_v_48xh_sse4;
 hevcasm_pred_uni_8to8 hevcasm_pred_uni_8tap_8to8_v_64xh_sse4;
 
+hevcasm_pred_uni_16to8 hevcasm_pred_uni_8tap_16to8_v_4xh_sse4;
+hevcasm_pred_uni_16to8 hevcasm_pred_uni_8tap_16to8_v_8xh_sse4;
 hevcasm_pred_uni_16to8 hevcasm_pred_uni_8tap_16to8_v_16xh_sse4;
+hevcasm_pred_uni_16to8 hevcasm_pred_uni_8tap_16to8_v_24xh_sse4;
 hevcasm_pred_uni_16to8 hevcasm_pred_uni_8tap_16to8_v_32xh_sse4;
 hevcasm_pred_uni_16to8 hevcasm_pred_uni_8tap_16to8_v_48xh_sse4;
 hevcasm_pred_uni_16to8 hevcasm_pred_uni_8tap_16to8_v_64xh_sse4;
 
+hevcasm_pred_bi_v_16to16 hevcasm_pred_bi_v_8tap_16to16_4xh_sse4;
+hevcasm_pred_bi_v_16to16 hevcasm_pred_bi_v_8tap_16to16_8xh_sse4;
 hevcasm_pred_bi_v_16to16 hevcasm_pred_bi_v_8tap_16to16_16xh_sse4;
+hevcasm_pred_bi_v_16to16 hevcasm_pred_bi_v_8tap_16to16_24xh_sse4;
 hevcasm_pred_bi_v_16to16 hevcasm_pred_bi_v_8tap_16to16_32xh_sse4;
 hevcasm_pred_bi_v_16to16 hevcasm_pred_bi_v_8tap_16to16_48xh_sse4;
 hevcasm_pred_bi_v_16to16 hevcasm_pred_bi_v_8tap_16to16_64xh_sse4;
 
+hevcasm_pred_uni_8to8 hevcasm_pred_uni_4tap_8to8_v_4xh_sse4;
 hevcasm_pred_uni_8to8 hevcasm_pred_uni_4tap_8to8_v_8xh_sse4;
 hevcasm_pred_uni_8to8 hevcasm_pred_uni_4tap_8to8_v_16xh_sse4;
 hevcasm_pred_uni_8to8 hevcasm_pred_uni_4tap_8to8_v_24xh_sse4;
 hevcasm_pred_uni_8to8 hevcasm_pred_uni_4tap_8to8_v_32xh_sse4;
+hevcasm_pred_uni_8to8 hevcasm_pred_uni_4tap_8to8_v_48xh_sse4;
+hevcasm_pred_uni_8to8 hevcasm_pred_uni_4tap_8to8_v_64xh_sse4;
 
+hevcasm_pred_uni_16to8 hevcasm_pred_uni_4tap_16to8_v_4xh_sse4;
+hevcasm_pred_uni_16to8 hevcasm_pred_uni_4tap_16to8_v_8xh_sse4;
 hevcasm_pred_uni_16to8 hevcasm_pred_uni_4tap_16to8_v_16xh_sse4;
+hevcasm_pred_uni_16to8 hevcasm_pred_uni_4tap_16to8_v_24xh_sse4;
 hevcasm_pred_uni_16to8 hevcasm_pred_uni_4tap_16to8_v_32xh_sse4;
+hevcasm_pred_uni_16to8 hevcasm_pred_uni_4tap_16to8_v_48xh_sse4;
+hevcasm_pred_uni_16to8 hevcasm_pred_uni_4tap_16to8_v_64xh_sse4;
 
+hevcasm_pred_bi_v_16to16 hevcasm_pred_bi_v_4tap_16to16_4xh_sse4;
 hevcasm_pred_bi_v_16to16 hevcasm_pred_bi_v_4tap_16to16_8xh_sse4;
 hevcasm_pred_bi_v_16to16 hevcasm_pred_bi_v_4tap_16to16_16xh_sse4;
+hevcasm_pred_bi_v_16to16 hevcasm_pred_bi_v_4tap_16to16_24xh_sse4;
 hevcasm_pred_bi_v_16to16 hevcasm_pred_bi_v_4tap_16to16_32xh_sse4;
+hevcasm_pred_bi_v_16to16 hevcasm_pred_bi_v_4tap_16to16_48xh_sse4;
+hevcasm_pred_bi_v_16to16 hevcasm_pred_bi_v_4tap_16to16_64xh_sse4;
+
+hevcasm_pred_uni_8to8 hevcasm_pred_uni_nv12_8to8_h_4xh_sse4;
+hevcasm_pred_uni_8to8 hevcasm_pred_uni_nv12_8to8_h_8xh_sse4;
+hevcasm_pred_uni_8to8 hevcasm_pred_uni_nv12_8to8_h_12xh_sse4;
+hevcasm_pred_uni_8to8 hevcasm_pred_uni_nv12_8to8_h_16xh_sse4;
+hevcasm_pred_uni_8to8 hevcasm_pred_uni_nv12_8to8_h_24xh_sse4;
+hevcasm_pred_uni_8to8 hevcasm_pred_uni_nv12_8to8_h_32xh_sse4;
+
+hevcasm_pred_uni_8to16 hevcasm_pred_uni_nv12_8to16_h_4xh_sse4;
+hevcasm_pred_uni_8to16 hevcasm_pred_uni_nv12_8to16_h_8xh_sse4;
+hevcasm_pred_uni_8to16 hevcasm_pred_uni_nv12_8to16_h_12xh_sse4;
+hevcasm_pred_uni_8to16 hevcasm_pred_uni_nv12_8to16_h_16xh_sse4;
+hevcasm_pred_uni_8to16 hevcasm_pred_uni_nv12_8to16_h_24xh_sse4;
+hevcasm_pred_uni_8to16 hevcasm_pred_uni_nv12_8to16_h_32xh_sse4;
 
 hevcasm_pred_bi_8to8_copy hevcasm_pred_bi_8to8_copy_16xh_sse2;
 hevcasm_pred_bi_8to8_copy hevcasm_pred_bi_8to8_copy_32xh_sse2;
 hevcasm_pred_bi_8to8_copy hevcasm_pred_bi_8to8_copy_48xh_sse2;
 hevcasm_pred_bi_8to8_copy hevcasm_pred_bi_8to8_copy_64xh_sse2;
 
+#ifdef HEVCASM_X64
+
+hevcasm_pred_uni_8to8 hevcasm_pred_uni_copy_8to8_32xh_avx2;
+hevcasm_pred_uni_8to8 hevcasm_pred_uni_copy_8to8_48xh_avx2;
+hevcasm_pred_uni_8to8 hevcasm_pred_uni_copy_8to8_64xh_avx2;
+
+hevcasm_pred_uni_8to8 hevcasm_pred_uni_8tap_8to8_h_16xh_avx2;
+hevcasm_pred_uni_8to8 hevcasm_pred_uni_8tap_8to8_h_32xh_avx2;
+hevcasm_pred_uni_8to8 hevcasm_pred_uni_8tap_8to8_h_48xh_avx2;
+hevcasm_pred_uni_8to8 hevcasm_pred_uni_8tap_8to8_h_64xh_avx2;
+hevcasm_pred_uni_8to8 hevcasm_pred_uni_4tap_8to8_h_16xh_avx2;
+hevcasm_pred_uni_8to8 hevcasm_pred_uni_4tap_8to8_h_32xh_avx2;
+
+hevcasm_pred_uni_8to16 hevcasm_pred_uni_8tap_8to16_h_16xh_avx2;
+hevcasm_pred_uni_8to16 hevcasm_pred_uni_8tap_8to16_h_32xh_avx2;
+hevcasm_pred_uni_8to16 hevcasm_pred_uni_8tap_8to16_h_48xh_avx2;
+hevcasm_pred_uni_8to16 hevcasm_pred_uni_8tap_8to16_h_64xh_avx2;
+hevcasm_pred_uni_8to16 hevcasm_pred_uni_4tap_8to16_h_16xh_avx2;
+hevcasm_pred_uni_8to16 hevcasm_pred_uni_4tap_8to16_h_32xh_avx2;
+
+hevcasm_pred_uni_8to8 hevcasm_pred_uni_8tap_8to8_v_16xh_avx2;
+hevcasm_pred_uni_8to8 hevcasm_pred_uni_8tap_8to8_v_32xh_avx2;
+hevcasm_pred_uni_8to8 hevcasm_pred_uni_8tap_8to8_v_48xh_avx2;
+hevcasm_pred_uni_8to8 hevcasm_pred_uni_8tap_8to8_v_64xh_avx2;
+hevcasm_pred_uni_8to8 hevcasm_pred_uni_4tap_8to8_v_16xh_avx2;
+hevcasm_pred_uni_8to8 hevcasm_pred_uni_4tap_8to8_v_32xh_avx2;
+hevcasm_pred_uni_8to8 hevcasm_pred_uni_4tap_8to8_v_48xh_avx2;
+hevcasm_pred_uni_8to8 hevcasm_pred_uni_4tap_8to8_v_64xh_avx2;
+
+hevcasm_pred_uni_16to8 hevcasm_pred_uni_8tap_16to8_v_16xh_avx2;
+hevcasm_pred_uni_16to8 hevcasm_pred_uni_8tap_16to8_v_32xh_avx2;
+hevcasm_pred_uni_16to8 hevcasm_pred_uni_8tap_16to8_v_48xh_avx2;
+hevcasm_pred_uni_16to8 hevcasm_pred_uni_8tap_16to8_v_64xh_avx2;
+hevcasm_pred_uni_16to8 hevcasm_pred_uni_4tap_16to8_v_16xh_avx2;
+hevcasm_pred_uni_16to8 hevcasm_pred_uni_4tap_16to8_v_32xh_avx2;
+hevcasm_pred_uni_16to8 hevcasm_pred_uni_4tap_16to8_v_48xh_avx2;
+hevcasm_pred_uni_16to8 hevcasm_pred_uni_4tap_16to8_v_64xh_avx2;
+
+hevcasm_pred_bi_v_16to16 hevcasm_pred_bi_v_8tap_16to16_16xh_avx2;
+hevcasm_pred_bi_v_16to16 hevcasm_pred_bi_v_8tap_16to16_32xh_avx2;
+hevcasm_pred_bi_v_16to16 hevcasm_pred_bi_v_8tap_16to16_48xh_avx2;
+hevcasm_pred_bi_v_16to16 hevcasm_pred_bi_v_8tap_16to16_64xh_avx2;
+hevcasm_pred_bi_v_16to16 hevcasm_pred_bi_v_4tap_16to16_16xh_avx2;
+hevcasm_pred_bi_v_16to16 hevcasm_pred_bi_v_4tap_16to16_32xh_avx2;
+hevcasm_pred_bi_v_16to16 hevcasm_pred_bi_v_4tap_16to16_48xh_avx2;
+hevcasm_pred_bi_v_16to16 hevcasm_pred_bi_v_4tap_16to16_64xh_avx2;
+
+hevcasm_pred_bi_8to8_copy hevcasm_pred_bi_8to8_copy_32xh_avx2;
+hevcasm_pred_bi_8to8_copy hevcasm_pred_bi_8to8_copy_48xh_avx2;
+hevcasm_pred_bi_8to8_copy hevcasm_pred_bi_8to8_copy_64xh_avx2;
+
+hevcasm_pred_uni_weighted_16to8 hevcasm_pred_uni_weighted_16to8_8nxh_sse2;
+hevcasm_pred_uni_weighted_16to8 hevcasm_pred_uni_weighted_16to8_16nxh_avx2;
+hevcasm_pred_bi_weighted_16to8 hevcasm_pred_bi_weighted_16to8_8nxh_sse2;
+hevcasm_pred_bi_weighted_16to8 hevcasm_pred_bi_weighted_16to8_16nxh_avx2;
+
+#endif
+
 #endif
\ No newline at end of file
@@ -163,16 +163,18 @@ static int get_pred_intra(void *p, hevcasm_instruction_set mask)
 
 	hevcasm_populate_pred_intra(&table, mask);
 
-	s->f = *hevcasm_get_pred_intra(&table, s->intraPredMode, s->packed);
+	hevcasm_pred_intra **entry = hevcasm_get_pred_intra(&table, s->intraPredMode, s->packed);
+	hevcasm_test_report_kernel(&table, sizeof(table), entry);
+	s->f = *entry;
 
 	if (s->f && mask == HEVCASM_C_REF)
 	{
 		const int k = (s->packed >> 1) & 0x7f;
 		const int nTbS = 1 << k;
-		printf("\t%dx%d %s", nTbS, nTbS, name);
+		hevcasm_test_printf("\t%dx%d %s", nTbS, nTbS, name);
 		if (s->packed & 1)
 		{
-			printf(" edge");
+			hevcasm_test_printf(" edge");
 		}
 	}
 
@@ -206,14 +208,14 @@ int mismatch_pred_intra(void *boundRef, void *boundTest)
 
 void HEVCASM_API hevcasm_test_pred_intra(int *error_count, hevcasm_instruction_set mask)
 {
-	printf("\nhevcasm_pred_intra - Intra Prediction\n");
+	hevcasm_test_printf("\nhevcasm_pred_intra - Intra Prediction\n");
 
 	bound_pred_intra b[2];
 
 	HEVCASM_ALIGN(32, uint8_t, neighbours[256]);
 	b[0].neighbours = neighbours + 128;
 
-	for (int x = 0; x < 256; x++) neighbours[x] = rand() & 0xff;
+	for (int x = 0; x < 256; x++) neighbours[x] = hevcasm_test_rand() & 0xff;
 
 	for (int k = 2; k <= 5; ++k)
 	{
@@ -0,0 +1,265 @@
+/*
+The copyright in this software is being made available under the BSD
+License, included below. This software may be subject to other third party
+and contributor rights, including patent rights, and no such rights are
+granted under this license.
+
+
+Copyright(c) 2011 - 2015, Parabola Research Limited
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met :
+
+* Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+this list of conditions and the following disclaimer in the documentation
+and / or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its contributors may
+be used to endorse or promote products derived from this software without
+specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "progress.h"
+#include "hevcasm_test.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <assert.h>
+
+#ifdef WIN32
+#include <Windows.h>
+#pragma comment(lib, "Synchronization.lib")
+#else
+#include <pthread.h>
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#else
+#include <sched.h>
+#endif
+#endif
+
+
+static int32_t progress_load(volatile int32_t *p)
+{
+#ifdef WIN32
+	return InterlockedCompareExchange((volatile LONG *)p, 0, 0);
+#else
+	return __atomic_load_n(p, __ATOMIC_SEQ_CST);
+#endif
+}
+
+
+static void progress_store(volatile int32_t *p, int32_t value)
+{
+#ifdef WIN32
+	InterlockedExchange((volatile LONG *)p, value);
+#else
+	__atomic_store_n(p, value, __ATOMIC_SEQ_CST);
+#endif
+}
+
+
+static void progress_add(volatile int32_t *p, int32_t value)
+{
+#ifdef WIN32
+	InterlockedExchangeAdd((volatile LONG *)p, value);
+#else
+	__atomic_fetch_add(p, value, __ATOMIC_SEQ_CST);
+#endif
+}
+
+
+/* Sleeps while *p == value. May return early. */
+static void progress_sleep(volatile int32_t *p, int32_t value)
+{
+#if defined(WIN32)
+	WaitOnAddress((volatile VOID *)p, &value, sizeof(value), INFINITE);
+#elif defined(__linux__)
+	syscall(SYS_futex, p, FUTEX_WAIT_PRIVATE, value, NULL, NULL, 0);
+#else
+	(void)p;
+	(void)value;
+	sched_yield();
+#endif
+}
+
+
+static void progress_wake(volatile int32_t *p)
+{
+#if defined(WIN32)
+	WakeByAddressAll((PVOID)p);
+#elif defined(__linux__)
+	syscall(SYS_futex, p, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+#else
+	(void)p;
+#endif
+}
+
+
+void HEVCASM_API hevcasm_progress_init(hevcasm_picture_progress *progress, int height)
+{
+	progress->height = height;
+	progress_store(&progress->waiters, 0);
+	progress_store(&progress->rows, 0);
+}
+
+
+void HEVCASM_API hevcasm_progress_set(hevcasm_picture_progress *progress, int rows)
+{
+	assert(rows <= progress->height);
+
+	/* Sequentially consistent store then load: either a waiter sees the new rows or we see the waiter */
+	progress_store(&progress->rows, rows);
+
+	if (progress_load(&progress->waiters)) progress_wake(&progress->rows);
+}
+
+
+int HEVCASM_API hevcasm_progress_get(hevcasm_picture_progress *progress)
+{
+	return progress_load(&progress->rows);
+}
+
+
+void HEVCASM_API hevcasm_progress_wait(hevcasm_picture_progress *progress, int rows)
+{
+	if (rows > progress->height) rows = progress->height;
+
+	if (progress_load(&progress->rows) >= rows) return;
+
+	progress_add(&progress->waiters, 1);
+
+	for (;;)
+	{
+		const int32_t available = progress_load(&progress->rows);
+		if (available >= rows) break;
+		progress_sleep(&progress->rows, available);
+	}
+
+	progress_add(&progress->waiters, -1);
+}
+
+
+int HEVCASM_API hevcasm_progress_waiting(hevcasm_picture_progress *progress)
+{
+	return progress_load(&progress->waiters);
+}
+
+
+#define PROGRESS_TEST_HEIGHT 1080
+#define PROGRESS_TEST_WIDTH 64
+
+typedef struct
+{
+	hevcasm_picture_progress progress;
+	uint8_t picture[PROGRESS_TEST_HEIGHT][PROGRESS_TEST_WIDTH];
+}
+progress_test;
+
+
+#ifdef WIN32
+static DWORD WINAPI progress_test_producer(LPVOID p)
+#else
+static void *progress_test_producer(void *p)
+#endif
+{
+	progress_test *s = p;
+
+	for (int y = 0; y < PROGRESS_TEST_HEIGHT; ++y)
+	{
+		/* stands in for reconstruction of a row */
+		for (int i = 0; i < 1000 * (y % 3); ++i)
+		{
+			s->picture[y][i % PROGRESS_TEST_WIDTH] = (uint8_t)i;
+		}
+		memset(s->picture[y], y & 0xff, PROGRESS_TEST_WIDTH);
+
+		hevcasm_progress_set(&s->progress, y + 1);
+	}
+
+	return 0;
+}
+
+
+void HEVCASM_API hevcasm_test_progress(int *error_count, hevcasm_instruction_set mask)
+{
+	hevcasm_test_printf("\nhevcasm_progress - Picture Reconstruction Progress\n");
+
+	progress_test *s = malloc(sizeof(progress_test));
+	if (!s)
+	{
+		hevcasm_test_printf("\tout of memory-MISMATCH\n");
+		++*error_count;
+		return;
+	}
+
+	hevcasm_progress_init(&s->progress, PROGRESS_TEST_HEIGHT);
+
+#ifdef WIN32
+	HANDLE producer = CreateThread(NULL, 0, progress_test_producer, s, 0, NULL);
+	const int started = producer != NULL;
+#else
+	pthread_t producer;
+	const int started = !pthread_create(&producer, NULL, progress_test_producer, s);
+#endif
+
+	/* without a producer thread, reconstruct the whole picture first so that the consumer cannot block */
+	if (!started) progress_test_producer(s);
+	int errors = !started;
+
+	/* consumer: predict 16-row luma PUs with assorted motion vectors in picture row order */
+	for (int yPb = 0; yPb < PROGRESS_TEST_HEIGHT; yPb += 16)
+	{
+		const int mvy = (hevcasm_test_rand() % 257) - 128;
+		const int rows = hevcasm_progress_rows_pred(yPb, 16, mvy, 2, 8);
+
+		hevcasm_progress_wait(&s->progress, rows);
+
+		const int available = rows < PROGRESS_TEST_HEIGHT ? rows : PROGRESS_TEST_HEIGHT;
+		if (hevcasm_progress_get(&s->progress) < available) ++errors;
+
+		for (int y = 0; y < available; y += 7)
+		{
+			if (s->picture[y][PROGRESS_TEST_WIDTH - 1] != (y & 0xff)) ++errors;
+		}
+	}
+
+	hevcasm_progress_wait(&s->progress, INT_MAX);
+	if (hevcasm_progress_get(&s->progress) != PROGRESS_TEST_HEIGHT) ++errors;
+
+	if (started)
+	{
+#ifdef WIN32
+		WaitForSingleObject(producer, INFINITE);
+		CloseHandle(producer);
+#else
+		pthread_join(producer, NULL);
+#endif
+	}
+
+	free(s);
+
+	hevcasm_test_printf("\t%d rows, producer thread : %s\n", PROGRESS_TEST_HEIGHT, errors ? "MISMATCH" : "ok");
+
+	*error_count += errors;
+}
+
+#undef PROGRESS_TEST_HEIGHT
+#undef PROGRESS_TEST_WIDTH
@@ -0,0 +1,100 @@
+/*
+The copyright in this software is being made available under the BSD
+License, included below. This software may be subject to other third party
+and contributor rights, including patent rights, and no such rights are
+granted under this license.
+
+
+Copyright(c) 2011 - 2015, Parabola Research Limited
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met :
+
+* Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+this list of conditions and the following disclaimer in the documentation
+and / or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its contributors may
+be used to endorse or promote products derived from this software without
+specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/* Reconstruction progress of a picture, for frame-parallel access to reference pictures */
+
+
+#ifndef INCLUDED_progress_h
+#define INCLUDED_progress_h
+
+#include "hevcasm.h"
+
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+// A producer (the thread reconstructing a picture) reports the number of rows of the picture that are final,
+// including in-loop filtering and border padding. Rows are always counted in luma rows: reporting luma rows [0, rows)
+// final also declares the co-located chroma rows final ([0, rows / 2) in 4:2:0), so one progress object serves all
+// planes of the picture. Consumers (threads predicting from the picture as a reference)
+// block until the rows they need are available. Waiting is lock-free when the rows are already available and
+// otherwise sleeps on the row counter (futex on Linux, WaitOnAddress on Windows).
+
+typedef struct
+{
+	volatile int32_t rows; /* rows [0, rows) are final */
+	volatile int32_t waiters;
+	int32_t height;
+}
+hevcasm_picture_progress;
+
+// Resets progress for a picture of the given height in rows.
+void HEVCASM_API hevcasm_progress_init(hevcasm_picture_progress *progress, int height);
+
+// Reports that rows [0, rows) are final and wakes any waiting consumers. Report height only once the bottom border
+// has been padded.
+void HEVCASM_API hevcasm_progress_set(hevcasm_picture_progress *progress, int rows);
+
+// Returns the number of rows currently reported final.
+int HEVCASM_API hevcasm_progress_get(hevcasm_picture_progress *progress);
+
+// Blocks until rows [0, rows) are final. Requests beyond the bottom of the picture wait for the whole picture.
+void HEVCASM_API hevcasm_progress_wait(hevcasm_picture_progress *progress, int rows);
+
+// Returns the number of consumers currently blocked in hevcasm_progress_wait().
+int HEVCASM_API hevcasm_progress_waiting(hevcasm_picture_progress *progress);
+
+
+// Luma rows of a reference picture to wait for before predicting a PU of height nPbH at row yPb of its plane, with
+// vertical motion vector component mvy in units of 1 / (1 << shift) sample (shift 2 for luma, 3 for 4:2:0 chroma).
+// yPb and nPbH are in rows of the predicted plane: chroma rows are converted to luma rows.
+static int hevcasm_progress_rows_pred(int yPb, int nPbH, int mvy, int shift, int taps)
+{
+	const int rows = yPb + nPbH + (mvy >> shift) + taps / 2;
+	return shift == 3 ? 2 * rows : rows;
+}
+
+
+hevcasm_test_function hevcasm_test_progress;
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -100,14 +100,16 @@ int init_quantize_inverse(void *p, hevcasm_instruction_set mask)
 
 	hevcasm_populate_quantize_inverse(&table, mask);
 
-	s->f = *hevcasm_get_quantize_inverse(&table);
+	hevcasm_quantize_inverse **entry = hevcasm_get_quantize_inverse(&table);
+	hevcasm_test_report_kernel(&table, sizeof(table), entry);
+	s->f = *entry;
 	
 	assert(s->f == get_quantize_inverse(mask));
 
 	if (s->f && mask == HEVCASM_C_REF)
 	{
 		const int nCbS = 1 << s->log2TrafoSize;
-		printf("\t%dx%d : ", nCbS, nCbS);
+		hevcasm_test_printf("\t%dx%d : ", nCbS, nCbS);
 	}
 
 	return !!s->f;
@@ -138,11 +140,11 @@ int mismatch_quantize_inverse(void *boundRef, void *boundTest)
 
 void HEVCASM_API hevcasm_test_quantize_inverse(int *error_count, hevcasm_instruction_set mask)
 {
-	printf("\nhevcasm_quantize_inverse - Inverse Quantization (\"scaling\")\n");
+	hevcasm_test_printf("\nhevcasm_quantize_inverse - Inverse Quantization (\"scaling\")\n");
 
 	HEVCASM_ALIGN(32, int16_t, src[32 * 32]);
 
-	for (int x = 0; x < 32 * 32; ++x) src[x] = (rand() & 0xff) - 0x100;
+	for (int x = 0; x < 32 * 32; ++x) src[x] = (hevcasm_test_rand() & 0xff) - 0x100;
 
 	hevcasm_bound_quantize_inverse b[2];
 	b[0].src = src;
@@ -225,12 +227,14 @@ int init_quantize(void *p, hevcasm_instruction_set mask)
 	hevcasm_bound_quantize *s = p;
 	hevcasm_table_quantize table;
 	hevcasm_populate_quantize(&table, mask);
-	s->f = *hevcasm_get_quantize(&table);
+	hevcasm_quantize **entry = hevcasm_get_quantize(&table);
+	hevcasm_test_report_kernel(&table, sizeof(table), entry);
+	s->f = *entry;
 	assert(s->f == get_quantize(mask));
 	if (mask == HEVCASM_C_REF)
 	{
 		const int nCbS = 1 << s->log2TrafoSize;
-		printf("\t%dx%d : ", nCbS, nCbS);
+		hevcasm_test_printf("\t%dx%d : ", nCbS, nCbS);
 	}
 	return !!s->f;
 }
@@ -262,13 +266,13 @@ int mismatch_quantize(void *boundRef, void *boundTest)
 
 void HEVCASM_API hevcasm_test_quantize(int *error_count, hevcasm_instruction_set mask)
 {
-	printf("\nhevcasm_quantize - Quantization\n");
+	hevcasm_test_printf("\nhevcasm_quantize - Quantization\n");
 
 	HEVCASM_ALIGN(32, int16_t, src[32 * 32]);
 
 	for (int x = 0; x < 32 * 32; ++x)
 	{
-		src[x] = rand() - rand();
+		src[x] = hevcasm_test_rand() - hevcasm_test_rand();
 	}
 
 	hevcasm_bound_quantize b[2];
@@ -351,14 +355,16 @@ int init_quantize_reconstruct(void *p, hevcasm_instruction_set mask)
 
 	hevcasm_populate_quantize_reconstruct(&table, mask);
 
-	s->f = *hevcasm_get_quantize_reconstruct(&table, s->log2TrafoSize);
+	hevcasm_quantize_reconstruct **entry = hevcasm_get_quantize_reconstruct(&table, s->log2TrafoSize);
+	hevcasm_test_report_kernel(&table, sizeof(table), entry);
+	s->f = *entry;
 
 	assert(s->f == get_quantize_reconstruct(s->log2TrafoSize, mask));
 
 	if (mask == HEVCASM_C_REF)
 	{
 		const int nCbS = 1 << s->log2TrafoSize;
-		printf("\t%dx%d : ", nCbS, nCbS);
+		hevcasm_test_printf("\t%dx%d : ", nCbS, nCbS);
 	}
 
 	return !!s->f;
@@ -398,15 +404,15 @@ int mismatch_quantize_reconstruct(void *boundRef, void *boundTest)
 
 void HEVCASM_API hevcasm_test_quantize_reconstruct(int *error_count, hevcasm_instruction_set mask)
 {
-	printf("\nhevcasm_quantize_reconstruct - Reconstruction\n");
+	hevcasm_test_printf("\nhevcasm_quantize_reconstruct - Reconstruction\n");
 
 	HEVCASM_ALIGN(32, uint8_t, pred[32 * 32]);
 	HEVCASM_ALIGN(32, int16_t, res[32 * 32]);
 
 	for (int x = 0; x < 32 * 32; ++x)
 	{
-		pred[x] = rand() & 0xff;
-		res[x] = (rand() & 0x1ff) - 0x100;
+		pred[x] = hevcasm_test_rand() & 0xff;
+		res[x] = (hevcasm_test_rand() & 0x1ff) - 0x100;
 	}
 
 	bound_quantize_reconstruct b[2];
@@ -422,3 +428,159 @@ void HEVCASM_API hevcasm_test_quantize_reconstruct(int *error_count, hevcasm_ins
 		*error_count += hevcasm_test(&b[0], &b[1], init_quantize_reconstruct, invoke_quantize_reconstruct, mismatch_quantize_reconstruct, mask, 100000);
 	}
 }
+
+
+static int64_t transform_domain_ssd(const int16_t *coeffs, const int16_t *dequant, int log2TrafoSize)
+{
+	const int n = 1 << (2 * log2TrafoSize);
+
+	/* the forward transform has gain 1 << (15 - bitDepth - log2TrafoSize) */
+	const int shift = 2 * (15 - 8 - log2TrafoSize);
+
+	int64_t sum = 0;
+	for (int i = 0; i < n; ++i)
+	{
+		const int diff = coeffs[i] - dequant[i];
+		assert(diff >= -32768 && diff <= 32767);
+		sum += diff * diff;
+	}
+
+	return (sum + ((int64_t)1 << (shift - 1))) >> shift;
+}
+
+
+#define MAKE_hevcasm_transform_domain_ssd_c_ref(nCbS, log2TrafoSize) \
+	\
+static int64_t hevcasm_transform_domain_ssd_ ## nCbS ## x ## nCbS ## _c_ref(const int16_t *coeffs, const int16_t *dequant) \
+{ \
+	return transform_domain_ssd(coeffs, dequant, log2TrafoSize); \
+} \
+
+MAKE_hevcasm_transform_domain_ssd_c_ref(4, 2)
+MAKE_hevcasm_transform_domain_ssd_c_ref(8, 3)
+MAKE_hevcasm_transform_domain_ssd_c_ref(16, 4)
+MAKE_hevcasm_transform_domain_ssd_c_ref(32, 5)
+
+
+static hevcasm_transform_domain_ssd * get_transform_domain_ssd(int log2TrafoSize, hevcasm_instruction_set mask)
+{
+	const int nCbS = 1 << log2TrafoSize;
+
+	hevcasm_transform_domain_ssd *f = 0;
+
+	if (mask & (HEVCASM_C_REF | HEVCASM_C_OPT))
+	{
+		if (nCbS == 4) f = hevcasm_transform_domain_ssd_4x4_c_ref;
+		if (nCbS == 8) f = hevcasm_transform_domain_ssd_8x8_c_ref;
+		if (nCbS == 16) f = hevcasm_transform_domain_ssd_16x16_c_ref;
+		if (nCbS == 32) f = hevcasm_transform_domain_ssd_32x32_c_ref;
+	}
+
+#ifdef HEVCASM_X64
+	if (mask & HEVCASM_SSE2)
+	{
+		if (nCbS == 4) f = hevcasm_transform_domain_ssd_4x4_sse2;
+		if (nCbS == 8) f = hevcasm_transform_domain_ssd_8x8_sse2;
+		if (nCbS == 16) f = hevcasm_transform_domain_ssd_16x16_sse2;
+		if (nCbS == 32) f = hevcasm_transform_domain_ssd_32x32_sse2;
+	}
+
+	if (mask & HEVCASM_AVX2)
+	{
+		if (nCbS == 8) f = hevcasm_transform_domain_ssd_8x8_avx2;
+		if (nCbS == 16) f = hevcasm_transform_domain_ssd_16x16_avx2;
+		if (nCbS == 32) f = hevcasm_transform_domain_ssd_32x32_avx2;
+	}
+#endif
+
+	return f;
+}
+
+
+void HEVCASM_API hevcasm_populate_transform_domain_ssd(hevcasm_table_transform_domain_ssd *table, hevcasm_instruction_set mask)
+{
+	for (int log2TrafoSize = 2; log2TrafoSize < 6; ++log2TrafoSize)
+	{
+		*hevcasm_get_transform_domain_ssd(table, log2TrafoSize) = get_transform_domain_ssd(log2TrafoSize, mask);
+	}
+}
+
+
+typedef struct
+{
+	const int16_t *coeffs;
+	const int16_t *dequant;
+	int log2TrafoSize;
+	int64_t ssd;
+	hevcasm_transform_domain_ssd *f;
+}
+bound_transform_domain_ssd;
+
+
+int init_transform_domain_ssd(void *p, hevcasm_instruction_set mask)
+{
+	bound_transform_domain_ssd *s = p;
+
+	hevcasm_table_transform_domain_ssd table;
+
+	hevcasm_populate_transform_domain_ssd(&table, mask);
+
+	hevcasm_transform_domain_ssd **entry = hevcasm_get_transform_domain_ssd(&table, s->log2TrafoSize);
+	hevcasm_test_report_kernel(&table, sizeof(table), entry);
+	s->f = *entry;
+
+	assert(s->f == get_transform_domain_ssd(s->log2TrafoSize, mask));
+
+	if (s->f && mask == HEVCASM_C_REF)
+	{
+		const int nCbS = 1 << s->log2TrafoSize;
+		hevcasm_test_printf("\t%dx%d : ", nCbS, nCbS);
+	}
+
+	return !!s->f;
+}
+
+
+void invoke_transform_domain_ssd(void *p, int n)
+{
+	bound_transform_domain_ssd *s = p;
+	while (n--)
+	{
+		s->ssd = s->f(s->coeffs, s->dequant);
+	}
+}
+
+
+int mismatch_transform_domain_ssd(void *boundRef, void *boundTest)
+{
+	bound_transform_domain_ssd *ref = boundRef;
+	bound_transform_domain_ssd *test = boundTest;
+
+	return ref->ssd != test->ssd;
+}
+
+
+void HEVCASM_API hevcasm_test_transform_domain_ssd(int *error_count, hevcasm_instruction_set mask)
+{
+	hevcasm_test_printf("\nhevcasm_transform_domain_ssd - Transform-Domain Distortion\n");
+
+	HEVCASM_ALIGN(32, int16_t, coeffs[32 * 32]);
+	HEVCASM_ALIGN(32, int16_t, dequant[32 * 32]);
+
+	for (int x = 0; x < 32 * 32; ++x)
+	{
+		coeffs[x] = (hevcasm_test_rand() & 0x3fff) - 0x2000;
+		dequant[x] = coeffs[x] + (hevcasm_test_rand() & 0xfff) - 0x800;
+	}
+
+	bound_transform_domain_ssd b[2];
+
+	b[0].coeffs = coeffs;
+	b[0].dequant = dequant;
+
+	for (b[0].log2TrafoSize = 2; b[0].log2TrafoSize <= 5; ++b[0].log2TrafoSize)
+	{
+		b[1] = b[0];
+		*error_count += hevcasm_test(&b[0], &b[1], init_transform_domain_ssd, invoke_transform_domain_ssd, mismatch_transform_domain_ssd, mask, 100000);
+	}
+}
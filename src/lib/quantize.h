@@ -52,6 +52,22 @@ extern "C"
 #endif
 
 
+// Quantizer scale and shift for a given QP and transform size (8-bit video, flat scaling list)
+
+static int hevcasm_quantize_scale(int qp)
+{
+	static const int quantScales[6] = { 26214, 23302, 20560, 18396, 16384, 14564 };
+	return quantScales[qp % 6];
+}
+
+static int hevcasm_quantize_shift(int qp, int log2TrafoSize)
+{
+	const int transformShift = 15 - 8 - log2TrafoSize;
+	return 14 + qp / 6 + transformShift;
+}
+
+
+
 // HEVC inverse quantization ("scaling")
 
 typedef void hevcasm_quantize_inverse(int16_t *dst, const int16_t *src, int scale, int shift, int n);
@@ -114,6 +130,29 @@ void HEVCASM_API hevcasm_populate_quantize_reconstruct(hevcasm_table_quantize_re
 void HEVCASM_API hevcasm_test_quantize_reconstruct(int *error_count, hevcasm_instruction_set mask);
 
 
+
+// Transform-domain distortion: sum of (coeffs[i] - dequant[i])^2 scaled to approximate the sample-domain SSD.
+// Valid when each difference lies within the int16 range, as it does for dequantized levels of the same coefficients.
+// coeffs and dequant are contiguous nCbS x nCbS blocks and must be 32-byte aligned (e.g. HEVCASM_ALIGN(32, ...)).
+
+typedef int64_t hevcasm_transform_domain_ssd(const int16_t *coeffs, const int16_t *dequant);
+
+typedef struct
+{
+	hevcasm_transform_domain_ssd *p[4];
+}
+hevcasm_table_transform_domain_ssd;
+
+static hevcasm_transform_domain_ssd** hevcasm_get_transform_domain_ssd(hevcasm_table_transform_domain_ssd *table, int log2TrafoSize)
+{
+	return &table->p[log2TrafoSize - 2];
+}
+
+void HEVCASM_API hevcasm_populate_transform_domain_ssd(hevcasm_table_transform_domain_ssd *table, hevcasm_instruction_set mask);
+
+void HEVCASM_API hevcasm_test_transform_domain_ssd(int *error_count, hevcasm_instruction_set mask);
+
+
 #ifdef __cplusplus
 }
 #endif
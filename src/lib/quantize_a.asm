@@ -327,4 +327,78 @@ cglobal quantize_reconstruct_32x32, 5, 6, 3
 		dec r5d
 		jg .loop
 
-	RET		
\ No newline at end of file
+	RET
+
+
+
+%if ARCH_X86_64 == 1
+
+; int64_t hevcasm_transform_domain_ssd_NxN(const int16_t *coeffs, const int16_t *dequant);
+; %1 = nCbS, %2 = log2TrafoSize
+%macro TRANSFORM_DOMAIN_SSD 2
+cglobal transform_domain_ssd_%1x%1, 2, 3, 5
+
+	pxor m0, m0
+	; m0 = 64-bit sums
+
+	pxor m4, m4
+	; m4 = 0
+
+	mov r2d, (%1 * %1) / mmsize
+	; r2 = loop count: each iteration handles mmsize / 2 coefficients from each of two registers
+
+	.loop
+
+		mova m1, [r0]
+		psubw m1, [r1]
+		pmaddwd m1, m1
+		; m1 = sums of pairs of (coeffs[i] - dequant[i])^2
+
+		mova m2, [r0 + mmsize]
+		psubw m2, [r1 + mmsize]
+		pmaddwd m2, m2
+		; m2 = sums of pairs of (coeffs[i] - dequant[i])^2
+
+		punpckhdq m3, m1, m4
+		punpckldq m1, m4
+		paddq m0, m3
+		paddq m0, m1
+
+		punpckhdq m3, m2, m4
+		punpckldq m2, m4
+		paddq m0, m3
+		paddq m0, m2
+
+		add r0, 2 * mmsize
+		add r1, 2 * mmsize
+		dec r2d
+		jg .loop
+
+%if mmsize == 32
+	vextracti128 xm1, m0, 1
+	paddq xm0, xm1
+%endif
+	pshufd xm1, xm0, ORDER(1, 0, 3, 2)
+	paddq xm0, xm1
+	movq rax, xm0
+	; rax = sum of squared differences in the transform domain
+
+	add rax, 1 << (2 * (7 - %2) - 1)
+	sar rax, 2 * (7 - %2)
+	; rax = estimated sum of squared differences in the sample domain
+
+	RET
+%endmacro
+
+INIT_XMM sse2
+TRANSFORM_DOMAIN_SSD 4, 2
+TRANSFORM_DOMAIN_SSD 8, 3
+TRANSFORM_DOMAIN_SSD 16, 4
+TRANSFORM_DOMAIN_SSD 32, 5
+
+INIT_YMM avx2
+TRANSFORM_DOMAIN_SSD 8, 3
+TRANSFORM_DOMAIN_SSD 16, 4
+TRANSFORM_DOMAIN_SSD 32, 5
+
+%endif
@@ -52,5 +52,15 @@ hevcasm_quantize_reconstruct hevcasm_quantize_reconstruct_8x8_sse4;
 hevcasm_quantize_reconstruct hevcasm_quantize_reconstruct_16x16_sse4;
 hevcasm_quantize_reconstruct hevcasm_quantize_reconstruct_32x32_sse4;
 
+#ifdef HEVCASM_X64
+hevcasm_transform_domain_ssd hevcasm_transform_domain_ssd_4x4_sse2;
+hevcasm_transform_domain_ssd hevcasm_transform_domain_ssd_8x8_sse2;
+hevcasm_transform_domain_ssd hevcasm_transform_domain_ssd_16x16_sse2;
+hevcasm_transform_domain_ssd hevcasm_transform_domain_ssd_32x32_sse2;
+hevcasm_transform_domain_ssd hevcasm_transform_domain_ssd_8x8_avx2;
+hevcasm_transform_domain_ssd hevcasm_transform_domain_ssd_16x16_avx2;
+hevcasm_transform_domain_ssd hevcasm_transform_domain_ssd_32x32_avx2;
+#endif
+
 
 #endif
\ No newline at end of file
@@ -0,0 +1,803 @@
+/*
+The copyright in this software is being made available under the BSD
+License, included below. This software may be subject to other third party
+and contributor rights, including patent rights, and no such rights are
+granted under this license.
+
+
+Copyright(c) 2011 - 2015, Parabola Research Limited
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met :
+
+* Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+this list of conditions and the following disclaimer in the documentation
+and / or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its contributors may
+be used to endorse or promote products derived from this software without
+specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "rdoq.h"
+#include "quantize.h"
+#include "hevcasm_test.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+
+#ifdef HEVCASM_X64
+hevcasm_rdoq_candidates hevcasm_rdoq_candidates_sse4;
+hevcasm_rdoq_candidates hevcasm_rdoq_candidates_avx2;
+#endif
+
+
+static void hevcasm_rdoq_candidates_c_ref(int16_t *level, float *err, const int16_t *src, int n, int scale, int shift, const float *errScale)
+{
+	assert(scale < 0x8000);
+	assert(shift >= 16);
+	assert(shift <= 27);
+
+	for (int i = 0; i < n; ++i)
+	{
+		const int a = abs(src[i]) * scale;
+		const int L = (a + (1 << (shift - 1))) >> shift;
+
+		level[i] = (int16_t)L;
+
+		const float e0 = (float)a;
+		const float e1 = (float)(a - (L << shift));
+		const float e2 = (float)(a - (L << shift) + (1 << shift));
+
+		err[i] = e0 * e0 * *errScale;
+		err[n + i] = e1 * e1 * *errScale;
+		err[2 * n + i] = e2 * e2 * *errScale;
+	}
+}
+
+
+static hevcasm_rdoq_candidates * get_rdoq_candidates(hevcasm_instruction_set mask)
+{
+	hevcasm_rdoq_candidates *f = 0;
+
+	if (mask & (HEVCASM_C_REF | HEVCASM_C_OPT)) f = hevcasm_rdoq_candidates_c_ref;
+
+#ifdef HEVCASM_X64
+	if (mask & HEVCASM_SSE41) f = hevcasm_rdoq_candidates_sse4;
+
+	if (mask & HEVCASM_AVX2) f = hevcasm_rdoq_candidates_avx2;
+#endif
+
+	return f;
+}
+
+
+void HEVCASM_API hevcasm_populate_rdoq_candidates(hevcasm_table_rdoq_candidates *table, hevcasm_instruction_set mask)
+{
+	table->p = get_rdoq_candidates(mask);
+}
+
+
+typedef struct
+{
+	int16_t *src;
+	HEVCASM_ALIGN(32, int16_t, level[32 * 32]);
+	HEVCASM_ALIGN(32, float, err[3 * 32 * 32]);
+	hevcasm_rdoq_candidates *f;
+	int scale;
+	int shift;
+	float errScale;
+	int log2TrafoSize;
+}
+bound_rdoq_candidates;
+
+
+int init_rdoq_candidates(void *p, hevcasm_instruction_set mask)
+{
+	bound_rdoq_candidates *s = p;
+	hevcasm_table_rdoq_candidates table;
+	hevcasm_populate_rdoq_candidates(&table, mask);
+	hevcasm_rdoq_candidates **entry = hevcasm_get_rdoq_candidates(&table);
+	hevcasm_test_report_kernel(&table, sizeof(table), entry);
+	s->f = *entry;
+	assert(s->f == get_rdoq_candidates(mask));
+	if (s->f && mask == HEVCASM_C_REF)
+	{
+		const int nCbS = 1 << s->log2TrafoSize;
+		hevcasm_test_printf("\t%dx%d : ", nCbS, nCbS);
+	}
+	return !!s->f;
+}
+
+
+void invoke_rdoq_candidates(void *p, int iterations)
+{
+	bound_rdoq_candidates *s = p;
+	while (iterations--)
+	{
+		const int n = 1 << (2 * s->log2TrafoSize);
+		s->f(s->level, s->err, s->src, n, s->scale, s->shift, &s->errScale);
+	}
+}
+
+
+int mismatch_rdoq_candidates(void *boundRef, void *boundTest)
+{
+	bound_rdoq_candidates *ref = boundRef;
+	bound_rdoq_candidates *test = boundTest;
+
+	const int n = 1 << (2 * ref->log2TrafoSize);
+
+	return 
+		memcmp(ref->level, test->level, n * sizeof(int16_t)) ||
+		memcmp(ref->err, test->err, 3 * n * sizeof(float));
+}
+
+
+void HEVCASM_API hevcasm_test_rdoq_candidates(int *error_count, hevcasm_instruction_set mask)
+{
+	hevcasm_test_printf("\nhevcasm_rdoq_candidates - RDOQ Candidate Levels\n");
+
+	HEVCASM_ALIGN(32, int16_t, src[32 * 32]);
+
+	for (int x = 0; x < 32 * 32; ++x)
+	{
+		src[x] = hevcasm_test_rand() - hevcasm_test_rand();
+	}
+
+	bound_rdoq_candidates b[2];
+
+	b[0].src = src;
+
+	for (b[0].log2TrafoSize = 2; b[0].log2TrafoSize <= 5; ++b[0].log2TrafoSize)
+	{
+		const int qp = 32;
+		b[0].scale = hevcasm_quantize_scale(qp);
+		b[0].shift = hevcasm_quantize_shift(qp, b[0].log2TrafoSize);
+		b[0].errScale = 1.0f / 65536;
+		b[1] = b[0];
+		*error_count += hevcasm_test(&b[0], &b[1], init_rdoq_candidates, invoke_rdoq_candidates, mismatch_rdoq_candidates, mask, 100000);
+	}
+}
+
+
+
+/* Estimated cost, in 1/32768 bit units, of coding a bin of each value: indexed by ((pStateIdx << 1) | valMps) ^ binVal */
+static const int32_t entropyBits[128] =
+{
+	0x07af1, 0x08534, 0x073f8, 0x08cdf, 0x06dcc, 0x09432, 0x066d9, 0x09d20,
+	0x05fc6, 0x0a710, 0x059b2, 0x0b063, 0x053bb, 0x0ba58, 0x04e8b, 0x0c3bf,
+	0x049cf, 0x0cd06, 0x04531, 0x0d6cb, 0x040b0, 0x0e11b, 0x03cfc, 0x0ea40,
+	0x0395a, 0x0f3de, 0x035eb, 0x0fda3, 0x032de, 0x106f1, 0x02fe7, 0x1109d,
+	0x02cf3, 0x11af4, 0x02a81, 0x1241c, 0x0281d, 0x12da5, 0x025bb, 0x137ce,
+	0x023d9, 0x14059, 0x021ad, 0x14ad6, 0x01ff7, 0x153a1, 0x01e15, 0x15ded,
+	0x01c63, 0x167cf, 0x01ae1, 0x1712b, 0x01978, 0x17a70, 0x01817, 0x18408,
+	0x016b9, 0x18e27, 0x015ac, 0x19665, 0x01452, 0x1a19b, 0x01364, 0x1a9d1,
+	0x0122e, 0x1b520, 0x01142, 0x1be46, 0x0104f, 0x1c83f, 0x00f66, 0x1d26c,
+	0x00ec0, 0x1da03, 0x00dfd, 0x1e371, 0x00d35, 0x1edac, 0x00c73, 0x1f831,
+	0x00beb, 0x20000, 0x00b49, 0x209c5, 0x00aa3, 0x2145a, 0x00a02, 0x21f4b,
+	0x0097c, 0x228ff, 0x00921, 0x22fe2, 0x0089b, 0x23a85, 0x00815, 0x245d0,
+	0x007bb, 0x24de3, 0x00759, 0x25713, 0x006ff, 0x25ff5, 0x00698, 0x26ab1,
+	0x00661, 0x270b2, 0x005dd, 0x28000, 0x005a6, 0x286c0, 0x00559, 0x290b0,
+	0x00500, 0x29cef, 0x004bd, 0x2a6cb, 0x004a0, 0x2ab3a, 0x00464, 0x2b4a8,
+	0x0041d, 0x2c094, 0x003e2, 0x2cb33, 0x003ab, 0x2d570, 0x00100, 0x3c432,
+};
+
+
+static int32_t rate_bin(uint8_t state, int binVal)
+{
+	return entropyBits[state ^ binVal];
+}
+
+
+/* Writes raster positions, (y << log2BlockSize) + x, of an up-right diagonal (0), horizontal (1) or vertical (2) scan */
+static void build_scan(uint16_t *scan, int log2BlockSize, int scanIdx)
+{
+	const int blkSize = 1 << log2BlockSize;
+
+	if (scanIdx == 0)
+	{
+		int i = 0;
+		int x = 0;
+		int y = 0;
+		while (i < blkSize * blkSize)
+		{
+			while (y >= 0)
+			{
+				if (x < blkSize && y < blkSize)
+				{
+					scan[i++] = (uint16_t)((y << log2BlockSize) + x);
+				}
+				--y;
+				++x;
+			}
+			y = x;
+			x = 0;
+		}
+	}
+	else
+	{
+		for (int i = 0; i < blkSize * blkSize; ++i)
+		{
+			const int a = i & (blkSize - 1);
+			const int b = i >> log2BlockSize;
+			scan[i] = (uint16_t)(scanIdx == 1 ? (b << log2BlockSize) + a : (a << log2BlockSize) + b);
+		}
+	}
+}
+
+
+/* ctxInc of sig_coeff_flag (9.3.4.2.5) */
+static int sig_coeff_flag_ctx_inc(int xC, int yC, int log2TrafoSize, int cIdx, int scanIdx, int prevCsbf)
+{
+	static const uint8_t ctxIdxMap[16] = { 0, 1, 4, 5, 2, 3, 4, 5, 6, 6, 8, 8, 7, 7, 8, 8 };
+
+	int sigCtx;
+
+	if (log2TrafoSize == 2)
+	{
+		sigCtx = ctxIdxMap[(yC << 2) + xC];
+	}
+	else if (xC + yC == 0)
+	{
+		sigCtx = 0;
+	}
+	else
+	{
+		const int xP = xC & 3;
+		const int yP = yC & 3;
+
+		if (prevCsbf == 0) sigCtx = (xP + yP == 0) ? 2 : (xP + yP < 3) ? 1 : 0;
+		else if (prevCsbf == 1) sigCtx = (yP == 0) ? 2 : (yP == 1) ? 1 : 0;
+		else if (prevCsbf == 2) sigCtx = (xP == 0) ? 2 : (xP == 1) ? 1 : 0;
+		else sigCtx = 2;
+
+		if (cIdx == 0)
+		{
+			if ((xC >> 2) + (yC >> 2) > 0) sigCtx += 3;
+			sigCtx += (log2TrafoSize == 3) ? (scanIdx == 0 ? 9 : 15) : 21;
+		}
+		else
+		{
+			sigCtx += (log2TrafoSize == 3) ? 9 : 12;
+		}
+	}
+
+	return cIdx ? 27 + sigCtx : sigCtx;
+}
+
+
+/* Rate of last_sig_coeff_x_prefix/suffix or last_sig_coeff_y_prefix/suffix */
+static int32_t rate_last_sig_coeff(const uint8_t *ctx, int position, int log2TrafoSize, int cIdx)
+{
+	static const uint8_t groupIdx[32] = { 0, 1, 2, 3, 4, 4, 5, 5, 6, 6, 6, 6, 7, 7, 7, 7, 8, 8, 8, 8, 8, 8, 8, 8, 9, 9, 9, 9, 9, 9, 9, 9 };
+
+	const int ctxOffset = cIdx ? 15 : 3 * (log2TrafoSize - 2) + ((log2TrafoSize - 1) >> 2);
+	const int ctxShift = cIdx ? log2TrafoSize - 2 : (log2TrafoSize + 1) >> 2;
+	const int cMax = (log2TrafoSize << 1) - 1;
+	const int prefix = groupIdx[position];
+
+	int32_t rate = 0;
+	for (int i = 0; i < prefix; ++i)
+	{
+		rate += rate_bin(ctx[ctxOffset + (i >> ctxShift)], 1);
+	}
+	if (prefix < cMax)
+	{
+		rate += rate_bin(ctx[ctxOffset + (prefix >> ctxShift)], 0);
+	}
+	if (prefix > 3)
+	{
+		rate += ((prefix >> 1) - 1) << 15;
+	}
+	return rate;
+}
+
+
+/* Rate of coeff_abs_level_remaining */
+static int32_t rate_remaining(int symbol, int cRiceParam)
+{
+	int length;
+	if (symbol < (3 << cRiceParam))
+	{
+		length = (symbol >> cRiceParam) + 1 + cRiceParam;
+	}
+	else
+	{
+		int k = cRiceParam;
+		symbol -= 3 << cRiceParam;
+		while (symbol >= (1 << k))
+		{
+			symbol -= 1 << k;
+			++k;
+		}
+		length = 3 + k + 1 - cRiceParam + k;
+	}
+	return length << 15;
+}
+
+
+/* Rate of an absolute level excluding sig_coeff_flag but including its sign */
+static int32_t rate_level(int absLevel, int c1Idx, int c2Idx, uint8_t ctxGreater1, uint8_t ctxGreater2, int cRiceParam)
+{
+	int32_t rate = 1 << 15;
+	const int baseLevel = (c1Idx < 8) ? (2 + (c2Idx < 1)) : 1;
+
+	if (absLevel >= baseLevel)
+	{
+		rate += rate_remaining(absLevel - baseLevel, cRiceParam);
+		if (c1Idx < 8)
+		{
+			rate += rate_bin(ctxGreater1, 1);
+			if (c2Idx < 1) rate += rate_bin(ctxGreater2, 1);
+		}
+	}
+	else if (absLevel == 1)
+	{
+		rate += rate_bin(ctxGreater1, 0);
+	}
+	else if (absLevel == 2)
+	{
+		rate += rate_bin(ctxGreater1, 1) + rate_bin(ctxGreater2, 0);
+	}
+
+	return rate;
+}
+
+
+/* 
+The RDOQ decision process, similar to that in HM: per-coefficient level decisions in reverse scan order, 
+then a coded_sub_block_flag decision for each sub-block, then a search for the best last position.
+Distortions come from the (vectorised) candidates function, so only the scalar decisions remain here.
+*/
+static int rdoq(int16_t *dst, const int16_t *src, int log2TrafoSize, int scale, int shift, double lambda, const hevcasm_residual_contexts *contexts, int cIdx, int scanIdx, hevcasm_rdoq_candidates *candidates)
+{
+	const int nCbS = 1 << log2TrafoSize;
+	const int n = nCbS * nCbS;
+	const int log2SbSize = log2TrafoSize - 2;
+	const int transformShift = 15 - 8 - log2TrafoSize;
+
+	/* weights squared coefficient-domain error down to the sample domain */
+	const float errScale = (float)(1.0 / ((double)scale * scale * (1 << (2 * transformShift))));
+
+	/* rates are in 1/32768 bit units */
+	const double lambdaBit = lambda / 32768;
+
+	HEVCASM_ALIGN(32, int16_t, level[32 * 32]);
+	HEVCASM_ALIGN(32, float, err[3 * 32 * 32]);
+
+	candidates(level, err, src, n, scale, shift, &errScale);
+
+	uint16_t scanSb[64];
+	uint16_t scanPos[16];
+	uint16_t scan[32 * 32];
+
+	build_scan(scanSb, log2SbSize, scanIdx);
+	build_scan(scanPos, 2, scanIdx);
+
+	for (int i = 0; i < n; ++i)
+	{
+		const int xS = scanSb[i >> 4] & ((1 << log2SbSize) - 1);
+		const int yS = scanSb[i >> 4] >> log2SbSize;
+		const int xP = scanPos[i & 15] & 3;
+		const int yP = scanPos[i & 15] >> 2;
+		scan[i] = (uint16_t)((((yS << 2) + yP) << log2TrafoSize) + (xS << 2) + xP);
+	}
+
+	memset(dst, 0, n * sizeof(int16_t));
+
+	int lastScanPos = n - 1;
+	while (lastScanPos >= 0 && !level[scan[lastScanPos]]) --lastScanPos;
+
+	if (lastScanPos < 0) return -1;
+
+	const uint8_t *ctxGreater1 = &contexts->coeff_abs_level_greater1_flag[cIdx ? 16 : 0];
+	const uint8_t *ctxGreater2 = &contexts->coeff_abs_level_greater2_flag[cIdx ? 4 : 0];
+	const uint8_t *ctxCsbf = &contexts->coded_sub_block_flag[cIdx ? 2 : 0];
+
+	double costCoeff[32 * 32];
+	double costSig[32 * 32];
+	double costCsbf[64];
+	uint8_t csbf[64];
+	int16_t absLevel[32 * 32];
+
+	memset(csbf, 0, sizeof(csbf));
+	memset(absLevel, 0, n * sizeof(int16_t));
+
+	double uncodedCost = 0.0;
+	for (int i = 0; i < n; ++i) uncodedCost += err[i];
+
+	/* cost of the whole block with the decisions made so far */
+	double totalCost = uncodedCost;
+
+	const int lastSubBlock = lastScanPos >> 4;
+	int c1 = 1;
+
+	for (int i = lastSubBlock; i >= 0; --i)
+	{
+		const int sbPos = scanSb[i];
+		const int xS = sbPos & ((1 << log2SbSize) - 1);
+		const int yS = sbPos >> log2SbSize;
+
+		int prevCsbf = 0;
+		if (xS < (1 << log2SbSize) - 1) prevCsbf |= csbf[sbPos + 1];
+		if (yS < (1 << log2SbSize) - 1) prevCsbf |= csbf[sbPos + (1 << log2SbSize)] << 1;
+
+		int ctxSet = (i == 0 || cIdx > 0) ? 0 : 2;
+		if (c1 == 0) ++ctxSet;
+		c1 = 1;
+
+		int c1Idx = 0;
+		int c2Idx = 0;
+		int cRiceParam = 0;
+
+		double sbCodedCost = 0.0;
+		double sbSigCost = 0.0;
+		double sbUncodedCost = 0.0;
+		int sbNonZero = 0;
+
+		for (int j = 15; j >= 0; --j)
+		{
+			const int k = (i << 4) + j;
+			if (k > lastScanPos) continue;
+
+			const int blkPos = scan[k];
+			const int L = level[blkPos];
+			const double e0 = err[blkPos];
+			const double e1 = err[n + blkPos];
+			const double e2 = err[2 * n + blkPos];
+			const uint8_t g1 = ctxGreater1[4 * ctxSet + c1];
+			const uint8_t g2 = ctxGreater2[ctxSet];
+
+			int best;
+			double bestCost;
+			double sigCost;
+
+			if (k == lastScanPos)
+			{
+				/* last position: significance is implied so zero is not a candidate */
+				best = L;
+				bestCost = e1 + lambdaBit * rate_level(L, c1Idx, c2Idx, g1, g2, cRiceParam);
+				sigCost = 0.0;
+
+				if (L > 1)
+				{
+					const double cost = e2 + lambdaBit * rate_level(L - 1, c1Idx, c2Idx, g1, g2, cRiceParam);
+					if (cost < bestCost)
+					{
+						best = L - 1;
+						bestCost = cost;
+					}
+				}
+			}
+			else
+			{
+				const int xC = blkPos & (nCbS - 1);
+				const int yC = blkPos >> log2TrafoSize;
+				const uint8_t ctxSig = contexts->sig_coeff_flag[sig_coeff_flag_ctx_inc(xC, yC, log2TrafoSize, cIdx, scanIdx, prevCsbf)];
+
+				best = 0;
+				sigCost = lambdaBit * rate_bin(ctxSig, 0);
+				bestCost = e0 + sigCost;
+
+				if (L > 0)
+				{
+					const double sig1Cost = lambdaBit * rate_bin(ctxSig, 1);
+
+					double cost = e1 + sig1Cost + lambdaBit * rate_level(L, c1Idx, c2Idx, g1, g2, cRiceParam);
+					if (cost < bestCost)
+					{
+						best = L;
+						bestCost = cost;
+						sigCost = sig1Cost;
+					}
+
+					if (L > 1)
+					{
+						cost = e2 + sig1Cost + lambdaBit * rate_level(L - 1, c1Idx, c2Idx, g1, g2, cRiceParam);
+						if (cost < bestCost)
+						{
+							best = L - 1;
+							bestCost = cost;
+							sigCost = sig1Cost;
+						}
+					}
+				}
+			}
+
+			absLevel[blkPos] = (int16_t)best;
+			costSig[k] = sigCost;
+			costCoeff[k] = bestCost - sigCost;
+
+			sbCodedCost += costCoeff[k];
+			sbSigCost += sigCost;
+			sbUncodedCost += e0;
+
+			if (best)
+			{
+				const int baseLevel = (c1Idx < 8) ? (2 + (c2Idx < 1)) : 1;
+				if (best >= baseLevel && best > 3 * (1 << cRiceParam))
+				{
+					cRiceParam = cRiceParam < 4 ? cRiceParam + 1 : 4;
+				}
+
+				++c1Idx;
+
+				if (best > 1)
+				{
+					c1 = 0;
+					++c2Idx;
+				}
+				else if (c1 > 0 && c1 < 3)
+				{
+					++c1;
+				}
+
+				sbNonZero = 1;
+			}
+		}
+
+		totalCost += sbCodedCost + sbSigCost - sbUncodedCost;
+
+		costCsbf[i] = 0.0;
+
+		if (i == lastSubBlock || i == 0)
+		{
+			/* coded_sub_block_flag is inferred */
+			csbf[sbPos] = 1;
+		}
+		else
+		{
+			const uint8_t ctx = ctxCsbf[prevCsbf ? 1 : 0];
+			const double csbf0Cost = lambdaBit * rate_bin(ctx, 0);
+			const double csbf1Cost = lambdaBit * rate_bin(ctx, 1);
+
+			const double zeroCost = totalCost - sbCodedCost - sbSigCost + sbUncodedCost + csbf0Cost;
+
+			if (!sbNonZero || zeroCost < totalCost + csbf1Cost)
+			{
+				/* sub-block not coded */
+				for (int j = 0; j < 16; ++j)
+				{
+					const int k = (i << 4) + j;
+					if (k > lastScanPos) continue;
+					absLevel[scan[k]] = 0;
+					costCoeff[k] = err[scan[k]];
+					costSig[k] = 0.0;
+				}
+				csbf[sbPos] = 0;
+				costCsbf[i] = csbf0Cost;
+				totalCost = zeroCost;
+			}
+			else
+			{
+				csbf[sbPos] = 1;
+				costCsbf[i] = csbf1Cost;
+				totalCost += csbf1Cost;
+			}
+		}
+	}
+
+	/* search for the best last significant position */
+	double bestCost = uncodedCost;
+	int bestLastScanPos = -1;
+
+	for (int i = lastSubBlock; i >= 0; --i)
+	{
+		totalCost -= costCsbf[i];
+
+		if (!csbf[scanSb[i]]) continue;
+
+		for (int j = 15; j >= 0; --j)
+		{
+			const int k = (i << 4) + j;
+			if (k > lastScanPos) continue;
+
+			const int blkPos = scan[k];
+
+			if (absLevel[blkPos])
+			{
+				int xC = blkPos & (nCbS - 1);
+				int yC = blkPos >> log2TrafoSize;
+				if (scanIdx == 2)
+				{
+					const int t = xC;
+					xC = yC;
+					yC = t;
+				}
+
+				const int32_t rateLast =
+					rate_last_sig_coeff(contexts->last_sig_coeff_x_prefix, xC, log2TrafoSize, cIdx) +
+					rate_last_sig_coeff(contexts->last_sig_coeff_y_prefix, yC, log2TrafoSize, cIdx);
+
+				const double cost = totalCost - costSig[k] + lambdaBit * rateLast;
+				if (cost < bestCost)
+				{
+					bestCost = cost;
+					bestLastScanPos = k;
+				}
+
+				if (absLevel[blkPos] > 1) goto found;
+
+				totalCost += err[blkPos] - costCoeff[k] - costSig[k];
+			}
+			else
+			{
+				totalCost -= costSig[k];
+			}
+		}
+	}
+
+found:
+	for (int k = 0; k <= bestLastScanPos; ++k)
+	{
+		const int blkPos = scan[k];
+		dst[blkPos] = src[blkPos] < 0 ? -absLevel[blkPos] : absLevel[blkPos];
+	}
+
+	return bestLastScanPos;
+}
+
+
+#define MAKE_hevcasm_rdoq(suffix) \
+	\
+static int hevcasm_rdoq ## suffix(int16_t *dst, const int16_t *src, int log2TrafoSize, int scale, int shift, double lambda, const hevcasm_residual_contexts *contexts, int cIdx, int scanIdx) \
+{ \
+	return rdoq(dst, src, log2TrafoSize, scale, shift, lambda, contexts, cIdx, scanIdx, hevcasm_rdoq_candidates ## suffix); \
+} \
+
+MAKE_hevcasm_rdoq(_c_ref)
+#ifdef HEVCASM_X64
+MAKE_hevcasm_rdoq(_sse4)
+MAKE_hevcasm_rdoq(_avx2)
+#endif
+
+
+static hevcasm_rdoq * get_rdoq(int log2TrafoSize, hevcasm_instruction_set mask)
+{
+	hevcasm_rdoq *f = 0;
+
+	if (mask & (HEVCASM_C_REF | HEVCASM_C_OPT)) f = hevcasm_rdoq_c_ref;
+
+#ifdef HEVCASM_X64
+	if (mask & HEVCASM_SSE41) f = hevcasm_rdoq_sse4;
+
+	if (mask & HEVCASM_AVX2) f = hevcasm_rdoq_avx2;
+#endif
+
+	return f;
+}
+
+
+void HEVCASM_API hevcasm_populate_rdoq(hevcasm_table_rdoq *table, hevcasm_instruction_set mask)
+{
+	for (int log2TrafoSize = 2; log2TrafoSize < 6; ++log2TrafoSize)
+	{
+		*hevcasm_get_rdoq(table, log2TrafoSize) = get_rdoq(log2TrafoSize, mask);
+	}
+}
+
+
+typedef struct
+{
+	int16_t *src;
+	HEVCASM_ALIGN(32, int16_t, dst[32 * 32]);
+	hevcasm_rdoq *f;
+	int scale;
+	int shift;
+	double lambda;
+	const hevcasm_residual_contexts *contexts;
+	int log2TrafoSize;
+	int cIdx;
+	int scanIdx;
+	int lastScanPos;
+}
+bound_rdoq;
+
+
+int init_rdoq(void *p, hevcasm_instruction_set mask)
+{
+	bound_rdoq *s = p;
+	hevcasm_table_rdoq table;
+	hevcasm_populate_rdoq(&table, mask);
+	hevcasm_rdoq **entry = hevcasm_get_rdoq(&table, s->log2TrafoSize);
+	hevcasm_test_report_kernel(&table, sizeof(table), entry);
+	s->f = *entry;
+	assert(s->f == get_rdoq(s->log2TrafoSize, mask));
+	if (s->f && mask == HEVCASM_C_REF)
+	{
+		const int nCbS = 1 << s->log2TrafoSize;
+		hevcasm_test_printf("\t%dx%d %s scanIdx=%d : ", nCbS, nCbS, s->cIdx ? "chroma" : "luma", s->scanIdx);
+	}
+	return !!s->f;
+}
+
+
+void invoke_rdoq(void *p, int iterations)
+{
+	bound_rdoq *s = p;
+	while (iterations--)
+	{
+		s->lastScanPos = s->f(s->dst, s->src, s->log2TrafoSize, s->scale, s->shift, s->lambda, s->contexts, s->cIdx, s->scanIdx);
+	}
+}
+
+
+int mismatch_rdoq(void *boundRef, void *boundTest)
+{
+	bound_rdoq *ref = boundRef;
+	bound_rdoq *test = boundTest;
+
+	const int n = 1 << (2 * ref->log2TrafoSize);
+
+	if (ref->lastScanPos != test->lastScanPos) return 1;
+
+	return memcmp(ref->dst, test->dst, n * sizeof(int16_t));
+}
+
+
+void HEVCASM_API hevcasm_test_rdoq(int *error_count, hevcasm_instruction_set mask)
+{
+	hevcasm_test_printf("\nhevcasm_rdoq - Rate-Distortion Optimised Quantization\n");
+
+	HEVCASM_ALIGN(32, int16_t, src[32 * 32]);
+
+	for (int x = 0; x < 32 * 32; ++x)
+	{
+		/* mostly small coefficients with occasional large ones */
+		src[x] = (hevcasm_test_rand() & 0x3ff) - 0x200;
+		if (!(hevcasm_test_rand() & 0xf)) src[x] *= 16;
+	}
+
+	hevcasm_residual_contexts contexts;
+	uint8_t *state = (uint8_t *)&contexts;
+	for (int i = 0; i < (int)sizeof(contexts); ++i)
+	{
+		state[i] = (uint8_t)(((hevcasm_test_rand() % 63) << 1) | (hevcasm_test_rand() & 1));
+	}
+
+	const int qp = 32;
+
+	bound_rdoq b[2];
+
+	b[0].src = src;
+	b[0].contexts = &contexts;
+	/* HM-style lambda for QP 32: 0.57 * 2^((32 - 12) / 3) */
+	b[0].lambda = 0.57 * 101.59;
+
+	for (b[0].log2TrafoSize = 2; b[0].log2TrafoSize <= 5; ++b[0].log2TrafoSize)
+	{
+		b[0].scale = hevcasm_quantize_scale(qp);
+		b[0].shift = hevcasm_quantize_shift(qp, b[0].log2TrafoSize);
+
+		for (b[0].cIdx = 0; b[0].cIdx < 2; ++b[0].cIdx)
+		{
+			if (b[0].cIdx && b[0].log2TrafoSize == 5) continue;
+
+			for (b[0].scanIdx = 0; b[0].scanIdx < 3; ++b[0].scanIdx)
+			{
+				if (b[0].scanIdx && b[0].log2TrafoSize > 3) continue;
+				if (b[0].scanIdx && b[0].cIdx && b[0].log2TrafoSize > 2) continue;
+
+				b[1] = b[0];
+				*error_count += hevcasm_test(&b[0], &b[1], init_rdoq, invoke_rdoq, mismatch_rdoq, mask, 1000);
+			}
+		}
+	}
+}
@@ -0,0 +1,120 @@
+/*
+The copyright in this software is being made available under the BSD
+License, included below. This software may be subject to other third party
+and contributor rights, including patent rights, and no such rights are
+granted under this license.
+
+
+Copyright(c) 2011 - 2015, Parabola Research Limited
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met :
+
+* Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+this list of conditions and the following disclaimer in the documentation
+and / or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its contributors may
+be used to endorse or promote products derived from this software without
+specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+/* Rate-distortion optimised quantization (RDOQ) */
+
+
+#ifndef INCLUDED_rdoq_h
+#define INCLUDED_rdoq_h
+
+#include "hevcasm.h"
+
+#include <stdint.h>
+#include <stddef.h>
+
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+/* 
+Snapshot of the CABAC context variables used by residual_coding().
+Each entry is packed as (pStateIdx << 1) | valMps. Chroma contexts follow luma contexts in each array.
+*/
+typedef struct
+{
+	uint8_t sig_coeff_flag[42];
+	uint8_t coded_sub_block_flag[4];
+	uint8_t last_sig_coeff_x_prefix[18];
+	uint8_t last_sig_coeff_y_prefix[18];
+	uint8_t coeff_abs_level_greater1_flag[24];
+	uint8_t coeff_abs_level_greater2_flag[6];
+}
+hevcasm_residual_contexts;
+
+
+
+// RDOQ candidate levels: for each coefficient, finds the rounded quantized level, L, and the
+// weighted squared error of reconstructing zero, L and L-1. Error planes are written to err[0..n), err[n..2n) and err[2n..3n).
+
+typedef void hevcasm_rdoq_candidates(int16_t *level, float *err, const int16_t *src, int n, int scale, int shift, const float *errScale);
+
+typedef struct
+{
+	hevcasm_rdoq_candidates *p;
+}
+hevcasm_table_rdoq_candidates;
+
+static hevcasm_rdoq_candidates** hevcasm_get_rdoq_candidates(hevcasm_table_rdoq_candidates *table)
+{
+	return &table->p;
+}
+
+void HEVCASM_API hevcasm_populate_rdoq_candidates(hevcasm_table_rdoq_candidates *table, hevcasm_instruction_set mask);
+
+void HEVCASM_API hevcasm_test_rdoq_candidates(int *error_count, hevcasm_instruction_set mask);
+
+
+
+// RDOQ: chooses coefficient levels and last significant position to minimise D + lambda * R.
+// scale and shift are as for hevcasm_quantize. Writes signed levels to dst in raster order and
+// returns the scan position of the last significant coefficient, or -1 if all levels are zero.
+
+typedef int hevcasm_rdoq(int16_t *dst, const int16_t *src, int log2TrafoSize, int scale, int shift, double lambda, const hevcasm_residual_contexts *contexts, int cIdx, int scanIdx);
+
+typedef struct
+{
+	hevcasm_rdoq *p[4];
+}
+hevcasm_table_rdoq;
+
+static hevcasm_rdoq** hevcasm_get_rdoq(hevcasm_table_rdoq *table, int log2TrafoSize)
+{
+	return &table->p[log2TrafoSize - 2];
+}
+
+void HEVCASM_API hevcasm_populate_rdoq(hevcasm_table_rdoq *table, hevcasm_instruction_set mask);
+
+void HEVCASM_API hevcasm_test_rdoq(int *error_count, hevcasm_instruction_set mask);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,224 @@
+; The copyright in this software is being made available under the BSD
+; License, included below. This software may be subject to other third party
+; and contributor rights, including patent rights, and no such rights are
+; granted under this license.
+; 
+; 
+; Copyright(c) 2011 - 2015, Parabola Research Limited
+; All rights reserved.
+; 
+; Redistribution and use in source and binary forms, with or without
+; modification, are permitted provided that the following conditions are met :
+; 
+; * Redistributions of source code must retain the above copyright notice,
+; this list of conditions and the following disclaimer.
+; * Redistributions in binary form must reproduce the above copyright notice,
+; this list of conditions and the following disclaimer in the documentation
+; and / or other materials provided with the distribution.
+; * Neither the name of the copyright holder nor the names of its contributors may
+; be used to endorse or promote products derived from this software without
+; specific prior written permission.
+; 
+; THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+; AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+; IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+; ARE DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+; BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+; CONSEQUENTIAL DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+; SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+; INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+; CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE)
+; ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+; THE POSSIBILITY OF SUCH DAMAGE.
+
+
+%define private_prefix hevcasm
+%include "x86inc.asm"
+
+
+
+SECTION .text
+
+
+%if ARCH_X86_64 == 1
+
+; candidates for four coefficients: %1 is the index of the first
+%macro RDOQ_CANDIDATES_4 1
+
+	movq m0, [r2 + 2 * %1]
+	; m0 = src[3], src[2], src[1], src[0] (words)
+
+	pabsw m0, m0
+	pmovzxwd m0, m0
+	pmulld m0, m7
+	; m0 = a = abs(src[]) * scale
+
+	paddd m1, m0, m4
+	psrad m1, m6
+	; m1 = L = (a + (1 << (shift - 1))) >> shift
+
+	packssdw m2, m1, m1
+	movq [r0 + 2 * %1], m2
+	; level[] = L
+
+	pslld m1, m6
+	psubd m2, m0, m1
+	; m2 = a - (L << shift)
+
+	cvtdq2ps m1, m2
+	mulps m1, m1
+	mulps m1, m3
+	movu [r1 + r3 + 4 * %1], m1
+	; err[n + i] = (a - (L << shift))^2 * errScale
+
+	paddd m2, m5
+	cvtdq2ps m1, m2
+	mulps m1, m1
+	mulps m1, m3
+	movu [r1 + 2 * r3 + 4 * %1], m1
+	; err[2n + i] = (a - ((L - 1) << shift))^2 * errScale
+
+	cvtdq2ps m0, m0
+	mulps m0, m0
+	mulps m0, m3
+	movu [r1 + 4 * %1], m0
+	; err[i] = a^2 * errScale
+
+%endmacro
+
+
+; void hevcasm_rdoq_candidates_sse4(int16_t *level, float *err, const int16_t *src, int n, int scale, int shift, const float *errScale);
+INIT_XMM sse4
+cglobal rdoq_candidates, 7, 8, 8
+
+	movd m7, r4d
+	pshufd m7, m7, 0
+	; m7 = scale, scale, scale, scale
+
+	movd m6, r5d
+	; m6 = shift
+
+	xor r4d, r4d
+	bts r4d, r5d
+	movd m5, r4d
+	pshufd m5, m5, 0
+	; m5 = 1 << shift (x4)
+
+	psrld m4, m5, 1
+	; m4 = 1 << (shift - 1) (x4)
+
+	movss m3, [r6]
+	shufps m3, m3, 0
+	; m3 = errScale (x4)
+
+	mov r7d, r3d
+	shr r7d, 3
+	; r7 = n / 8
+
+	shl r3d, 2
+	; r3 = n * sizeof(float), the distance between err planes
+
+	.loop
+
+		RDOQ_CANDIDATES_4 0
+		RDOQ_CANDIDATES_4 4
+
+		add r0, 16
+		add r1, 32
+		add r2, 16
+		dec r7d
+		jg .loop
+
+	RET
+
+
+; candidates for eight coefficients: %1 is the index of the first
+%macro RDOQ_CANDIDATES_8 1
+
+	movu xm0, [r2 + 2 * %1]
+	; xm0 = src[7], src[6], ..., src[0] (words)
+
+	pabsw xm0, xm0
+	pmovzxwd m0, xm0
+	pmulld m0, m7
+	; m0 = a = abs(src[]) * scale
+
+	paddd m1, m0, m4
+	psrad m1, xm6
+	; m1 = L = (a + (1 << (shift - 1))) >> shift
+
+	vextracti128 xm2, m1, 1
+	packssdw xm2, xm1, xm2
+	movu [r0 + 2 * %1], xm2
+	; level[] = L
+
+	pslld m1, xm6
+	psubd m2, m0, m1
+	; m2 = a - (L << shift)
+
+	cvtdq2ps m1, m2
+	mulps m1, m1
+	mulps m1, m3
+	movu [r1 + r3 + 4 * %1], m1
+	; err[n + i] = (a - (L << shift))^2 * errScale
+
+	paddd m2, m5
+	cvtdq2ps m1, m2
+	mulps m1, m1
+	mulps m1, m3
+	movu [r1 + 2 * r3 + 4 * %1], m1
+	; err[2n + i] = (a - ((L - 1) << shift))^2 * errScale
+
+	cvtdq2ps m0, m0
+	mulps m0, m0
+	mulps m0, m3
+	movu [r1 + 4 * %1], m0
+	; err[i] = a^2 * errScale
+
+%endmacro
+
+
+; void hevcasm_rdoq_candidates_avx2(int16_t *level, float *err, const int16_t *src, int n, int scale, int shift, const float *errScale);
+INIT_YMM avx2
+cglobal rdoq_candidates, 7, 8, 8
+
+	movd xm7, r4d
+	vpbroadcastd m7, xm7
+	; m7 = scale (x8)
+
+	movd xm6, r5d
+	; xm6 = shift
+
+	xor r4d, r4d
+	bts r4d, r5d
+	movd xm5, r4d
+	vpbroadcastd m5, xm5
+	; m5 = 1 << shift (x8)
+
+	psrld m4, m5, 1
+	; m4 = 1 << (shift - 1) (x8)
+
+	vbroadcastss m3, [r6]
+	; m3 = errScale (x8)
+
+	mov r7d, r3d
+	shr r7d, 4
+	; r7 = n / 16
+
+	shl r3d, 2
+	; r3 = n * sizeof(float), the distance between err planes
+
+	.loop
+
+		RDOQ_CANDIDATES_8 0
+		RDOQ_CANDIDATES_8 8
+
+		add r0, 32
+		add r1, 64
+		add r2, 32
+		dec r7d
+		jg .loop
+
+	RET
+
+%endif
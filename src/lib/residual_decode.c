@@ -517,6 +517,7 @@ typedef struct
 	hevcasm_inverse_transform_add *f;
 	int log2TrafoSize;
 	int trType;
+	int rotate;
 	uint8_t dst[32 * 32];
 } 
 bind_inverse_transform_add;
@@ -530,12 +531,14 @@ int init_inverse_transform_add(void *p, hevcasm_instruction_set mask)
 
 	hevcasm_populate_inverse_transform_add(&table, mask, 1);
 
-	s->f = *hevcasm_get_inverse_transform_add(&table, s->trType, s->log2TrafoSize);
+	hevcasm_inverse_transform_add **entry = hevcasm_get_inverse_transform_add(&table, s->trType, s->log2TrafoSize);
+	hevcasm_test_report_kernel(&table, sizeof(table), entry);
+	s->f = *entry;
 
 	if (s->f && mask == HEVCASM_C_REF)
 	{
 		const int nCbS = 1 << s->log2TrafoSize;
-		printf("\t%s %dx%d : ", s->trType ? "sine" : "cosine", nCbS, nCbS);
+		hevcasm_test_printf("\t%s %dx%d : ", s->trType ? "sine" : "cosine", nCbS, nCbS);
 	}
 
 	return !!s->f;
@@ -566,13 +569,13 @@ int mismatch_transform_add(void *boundRef, void *boundTest)
 
 void hevcasm_test_inverse_transform_add(int *error_count, hevcasm_instruction_set mask)
 {
-	printf("\ninverse_transform_add - Inverse Transform, then add to predicted\n");
+	hevcasm_test_printf("\ninverse_transform_add - Inverse Transform, then add to predicted\n");
 
 	HEVCASM_ALIGN(32, int16_t, coefficients[32 * 32]);
 	HEVCASM_ALIGN(32, uint8_t, predicted[32 * 32]);
 
-	for (int x = 0; x < 32 * 32; x++) coefficients[x] = ((rand() << 1) ^ rand()) & 0xffff;
-	for (int x = 0; x < 32 * 32; x++) predicted[x] = rand() & 0xff;
+	for (int x = 0; x < 32 * 32; x++) coefficients[x] = ((hevcasm_test_rand() << 1) ^ hevcasm_test_rand()) & 0xffff;
+	for (int x = 0; x < 32 * 32; x++) predicted[x] = hevcasm_test_rand() & 0xff;
 
 	bind_inverse_transform_add b[2];
 	b[0].coefficients = coefficients;
@@ -957,13 +960,15 @@ int init_transform(void *p, hevcasm_instruction_set mask)
 	hevcasm_table_transform table;
 	hevcasm_populate_transform(&table, mask);
 
-	s->f = *hevcasm_get_transform(&table, s->trType, s->log2TrafoSize);
+	hevcasm_transform **entry = hevcasm_get_transform(&table, s->trType, s->log2TrafoSize);
+	hevcasm_test_report_kernel(&table, sizeof(table), entry);
+	s->f = *entry;
 	assert(s->f == get_transform(s->trType, s->log2TrafoSize, mask));
 
 	if (s->f && mask == HEVCASM_C_REF)
 	{
 		const int nCbS = 1 << s->log2TrafoSize;
-		printf("\t%s %dx%d : ", s->trType ? "sine" : "cosine", nCbS, nCbS);
+		hevcasm_test_printf("\t%s %dx%d : ", s->trType ? "sine" : "cosine", nCbS, nCbS);
 	}
 
 	return !!s->f;
@@ -994,10 +999,10 @@ int mismatch_transform(void *boundRef, void *boundTest)
 
 void hevcasm_test_transform(int *error_count, hevcasm_instruction_set mask)
 {
-	printf("\nhevcasm_transform - Forward Transform\n");
+	hevcasm_test_printf("\nhevcasm_transform - Forward Transform\n");
 
 	HEVCASM_ALIGN(32, int16_t, src[32 * 32]);
-	for (int x = 0; x < 32 * 32; x++) src[x] = (rand() & 0x1ff) - 0x100;
+	for (int x = 0; x < 32 * 32; x++) src[x] = (hevcasm_test_rand() & 0x1ff) - 0x100;
 
 	bound_transform b[2];
 	b[0].src = src;
@@ -1013,3 +1018,378 @@ void hevcasm_test_transform(int *error_count, hevcasm_instruction_set mask)
 		*error_count += hevcasm_test(&b[0], &b[1], init_transform, invoke_transform, mismatch_transform, mask, 100000);
 	}
 }
+
+
+static void transform_skip(int16_t *coeffs, const int16_t *src, ptrdiff_t src_stride, int log2TrafoSize, int rotate)
+{
+	const int nCbS = 1 << log2TrafoSize;
+	const int shift = 15 - 8 - log2TrafoSize;
+
+	for (int y = 0; y < nCbS; ++y)
+	{
+		for (int x = 0; x < nCbS; ++x)
+		{
+			const int residual = rotate ? src[(nCbS - 1 - y) * src_stride + nCbS - 1 - x] : src[y * src_stride + x];
+			coeffs[y * nCbS + x] = (int16_t)(residual * (1 << shift));
+		}
+	}
+}
+
+
+#define MAKE_hevcasm_transform_skip_c_ref(name, log2TrafoSize, rotate) \
+	\
+static void hevcasm_transform_ ## name ## _c_ref(int16_t *coeffs, const int16_t *src, ptrdiff_t src_stride) \
+{ \
+	transform_skip(coeffs, src, src_stride, log2TrafoSize, rotate); \
+} \
+
+MAKE_hevcasm_transform_skip_c_ref(skip_rotate_4x4, 2, 1)
+MAKE_hevcasm_transform_skip_c_ref(skip_4x4, 2, 0)
+MAKE_hevcasm_transform_skip_c_ref(skip_8x8, 3, 0)
+MAKE_hevcasm_transform_skip_c_ref(skip_16x16, 4, 0)
+MAKE_hevcasm_transform_skip_c_ref(skip_32x32, 5, 0)
+
+
+static hevcasm_transform* get_transform_skip(int rotate, int log2TrafoSize, hevcasm_instruction_set mask)
+{
+	const int nCbS = 1 << log2TrafoSize;
+
+	hevcasm_transform *f = 0;
+
+	if (mask & (HEVCASM_C_REF | HEVCASM_C_OPT))
+	{
+		if (nCbS == 4) f = rotate ? hevcasm_transform_skip_rotate_4x4_c_ref : hevcasm_transform_skip_4x4_c_ref;
+		if (nCbS == 8) f = hevcasm_transform_skip_8x8_c_ref;
+		if (nCbS == 16) f = hevcasm_transform_skip_16x16_c_ref;
+		if (nCbS == 32) f = hevcasm_transform_skip_32x32_c_ref;
+	}
+
+	if (mask & HEVCASM_SSE2)
+	{
+		if (nCbS == 4) f = rotate ? hevcasm_transform_skip_rotate_4x4_sse2 : hevcasm_transform_skip_4x4_sse2;
+		if (nCbS == 8) f = hevcasm_transform_skip_8x8_sse2;
+		if (nCbS == 16) f = hevcasm_transform_skip_16x16_sse2;
+		if (nCbS == 32) f = hevcasm_transform_skip_32x32_sse2;
+	}
+
+	return f;
+}
+
+
+void HEVCASM_API hevcasm_populate_transform_skip(hevcasm_table_transform_skip *table, hevcasm_instruction_set mask)
+{
+	*hevcasm_get_transform_skip(table, 1, 2) = get_transform_skip(1, 2, mask);
+	for (int log2TrafoSize = 2; log2TrafoSize <= 5; ++log2TrafoSize)
+	{
+		*hevcasm_get_transform_skip(table, 0, log2TrafoSize) = get_transform_skip(0, log2TrafoSize, mask);
+	}
+}
+
+
+typedef struct
+{
+	hevcasm_transform *f;
+	HEVCASM_ALIGN(32, int16_t, dst[32 * 32]);
+	int16_t *src;
+	ptrdiff_t src_stride;
+	int rotate;
+	int log2TrafoSize;
+}
+bound_transform_skip;
+
+
+int init_transform_skip(void *p, hevcasm_instruction_set mask)
+{
+	bound_transform_skip *s = p;
+
+	hevcasm_table_transform_skip table;
+	hevcasm_populate_transform_skip(&table, mask);
+
+	hevcasm_transform **entry = hevcasm_get_transform_skip(&table, s->rotate, s->log2TrafoSize);
+	hevcasm_test_report_kernel(&table, sizeof(table), entry);
+	s->f = *entry;
+	assert(s->f == get_transform_skip(s->rotate, s->log2TrafoSize, mask));
+
+	if (s->f && mask == HEVCASM_C_REF)
+	{
+		const int nCbS = 1 << s->log2TrafoSize;
+		hevcasm_test_printf("\t%s%dx%d : ", s->rotate ? "rotate " : "", nCbS, nCbS);
+	}
+
+	return !!s->f;
+}
+
+
+void invoke_transform_skip(void *p, int n)
+{
+	bound_transform_skip *s = p;
+
+	while (n--)
+	{
+		s->f(s->dst, s->src, s->src_stride);
+	}
+}
+
+
+int mismatch_transform_skip(void *boundRef, void *boundTest)
+{
+	bound_transform_skip *ref = boundRef;
+	bound_transform_skip *test = boundTest;
+
+	const int nCbS = 1 << ref->log2TrafoSize;
+
+	return memcmp(ref->dst, test->dst, nCbS * nCbS * sizeof(int16_t));
+}
+
+
+void HEVCASM_API hevcasm_test_transform_skip(int *error_count, hevcasm_instruction_set mask)
+{
+	hevcasm_test_printf("\nhevcasm_transform_skip - Forward Transform Skip\n");
+
+	HEVCASM_ALIGN(32, int16_t, src[32 * 32]);
+	for (int x = 0; x < 32 * 32; x++) src[x] = (hevcasm_test_rand() & 0x1ff) - 0x100;
+
+	bound_transform_skip b[2];
+	b[0].src = src;
+	b[0].src_stride = 32;
+
+	for (int j = 1; j < 6; ++j)
+	{
+		b[0].rotate = (j == 1) ? 1 : 0;
+		b[0].log2TrafoSize = (j == 1) ? 2 : j;
+
+		b[1] = b[0];
+
+		*error_count += hevcasm_test(&b[0], &b[1], init_transform_skip, invoke_transform_skip, mismatch_transform_skip, mask, 100000);
+	}
+}
+
+
+static void inverse_transform_skip_add(uint8_t *dst, ptrdiff_t stride_dst, const uint8_t *pred, ptrdiff_t stride_pred, const int16_t *coeffs, int log2TrafoSize, int rotate)
+{
+	const int nCbS = 1 << log2TrafoSize;
+	const int tsShift = 5 + log2TrafoSize;
+	const int bdShift = 20 - 8;
+
+	for (int y = 0; y < nCbS; ++y)
+	{
+		for (int x = 0; x < nCbS; ++x)
+		{
+			const int d = rotate ? coeffs[(nCbS - 1 - y) * nCbS + nCbS - 1 - x] : coeffs[y * nCbS + x];
+			const int r = (d * (1 << tsShift) + (1 << (bdShift - 1))) >> bdShift;
+			dst[y * stride_dst + x] = (uint8_t)Clip3(0, 255, pred[y * stride_pred + x] + r);
+		}
+	}
+}
+
+
+#define MAKE_hevcasm_inverse_transform_skip_add_c_ref(name, log2TrafoSize, rotate) \
+	\
+static void hevcasm_inverse_transform_ ## name ## _c_ref(uint8_t *dst, ptrdiff_t stride_dst, const uint8_t *pred, ptrdiff_t stride_pred, const int16_t *coeffs) \
+{ \
+	inverse_transform_skip_add(dst, stride_dst, pred, stride_pred, coeffs, log2TrafoSize, rotate); \
+} \
+
+MAKE_hevcasm_inverse_transform_skip_add_c_ref(skip_add_rotate_4x4, 2, 1)
+MAKE_hevcasm_inverse_transform_skip_add_c_ref(skip_add_4x4, 2, 0)
+MAKE_hevcasm_inverse_transform_skip_add_c_ref(skip_add_8x8, 3, 0)
+MAKE_hevcasm_inverse_transform_skip_add_c_ref(skip_add_16x16, 4, 0)
+MAKE_hevcasm_inverse_transform_skip_add_c_ref(skip_add_32x32, 5, 0)
+
+
+static hevcasm_inverse_transform_add* get_inverse_transform_skip_add(int rotate, int log2TrafoSize, hevcasm_instruction_set mask)
+{
+	const int nCbS = 1 << log2TrafoSize;
+
+	hevcasm_inverse_transform_add *f = 0;
+
+	if (mask & (HEVCASM_C_REF | HEVCASM_C_OPT))
+	{
+		if (nCbS == 4) f = rotate ? hevcasm_inverse_transform_skip_add_rotate_4x4_c_ref : hevcasm_inverse_transform_skip_add_4x4_c_ref;
+		if (nCbS == 8) f = hevcasm_inverse_transform_skip_add_8x8_c_ref;
+		if (nCbS == 16) f = hevcasm_inverse_transform_skip_add_16x16_c_ref;
+		if (nCbS == 32) f = hevcasm_inverse_transform_skip_add_32x32_c_ref;
+	}
+
+	if (mask & HEVCASM_SSSE3)
+	{
+		if (nCbS == 4) f = rotate ? hevcasm_inverse_transform_skip_add_rotate_4x4_ssse3 : hevcasm_inverse_transform_skip_add_4x4_ssse3;
+		if (nCbS == 8) f = hevcasm_inverse_transform_skip_add_8x8_ssse3;
+		if (nCbS == 16) f = hevcasm_inverse_transform_skip_add_16x16_ssse3;
+		if (nCbS == 32) f = hevcasm_inverse_transform_skip_add_32x32_ssse3;
+	}
+
+	return f;
+}
+
+
+void HEVCASM_API hevcasm_populate_inverse_transform_skip_add(hevcasm_table_inverse_transform_skip_add *table, hevcasm_instruction_set mask)
+{
+	*hevcasm_get_inverse_transform_skip_add(table, 1, 2) = get_inverse_transform_skip_add(1, 2, mask);
+	for (int log2TrafoSize = 2; log2TrafoSize <= 5; ++log2TrafoSize)
+	{
+		*hevcasm_get_inverse_transform_skip_add(table, 0, log2TrafoSize) = get_inverse_transform_skip_add(0, log2TrafoSize, mask);
+	}
+}
+
+
+int init_inverse_transform_skip_add(void *p, hevcasm_instruction_set mask)
+{
+	bind_inverse_transform_add *s = p;
+
+	hevcasm_table_inverse_transform_skip_add table;
+
+	hevcasm_populate_inverse_transform_skip_add(&table, mask);
+
+	hevcasm_inverse_transform_add **entry = hevcasm_get_inverse_transform_skip_add(&table, s->rotate, s->log2TrafoSize);
+	hevcasm_test_report_kernel(&table, sizeof(table), entry);
+	s->f = *entry;
+	assert(s->f == get_inverse_transform_skip_add(s->rotate, s->log2TrafoSize, mask));
+
+	if (s->f && mask == HEVCASM_C_REF)
+	{
+		const int nCbS = 1 << s->log2TrafoSize;
+		hevcasm_test_printf("\t%s%dx%d : ", s->rotate ? "rotate " : "", nCbS, nCbS);
+	}
+
+	return !!s->f;
+}
+
+
+void HEVCASM_API hevcasm_test_inverse_transform_skip_add(int *error_count, hevcasm_instruction_set mask)
+{
+	hevcasm_test_printf("\nhevcasm_inverse_transform_skip_add - Inverse Transform Skip, then add to predicted\n");
+
+	HEVCASM_ALIGN(32, int16_t, coefficients[32 * 32]);
+	HEVCASM_ALIGN(32, uint8_t, predicted[32 * 32]);
+
+	for (int x = 0; x < 32 * 32; x++) coefficients[x] = ((hevcasm_test_rand() << 1) ^ hevcasm_test_rand()) & 0xffff;
+	for (int x = 0; x < 32 * 32; x++) predicted[x] = hevcasm_test_rand() & 0xff;
+
+	bind_inverse_transform_add b[2];
+	b[0].coefficients = coefficients;
+	b[0].predicted = predicted;
+
+	for (int j = 1; j < 6; ++j)
+	{
+		b[0].rotate = (j == 1) ? 1 : 0;
+		b[0].log2TrafoSize = (j == 1) ? 2 : j;
+		b[1] = b[0];
+
+		*error_count += hevcasm_test(&b[0], &b[1], init_inverse_transform_skip_add, invoke_inverse_transform_add, mismatch_transform_add, mask, 100000);
+	}
+}
+
+
+static void transquant_bypass_add(uint8_t *dst, ptrdiff_t stride_dst, const uint8_t *pred, ptrdiff_t stride_pred, const int16_t *residual, int log2TrafoSize, int rotate)
+{
+	const int nCbS = 1 << log2TrafoSize;
+
+	for (int y = 0; y < nCbS; ++y)
+	{
+		for (int x = 0; x < nCbS; ++x)
+		{
+			const int r = rotate ? residual[(nCbS - 1 - y) * nCbS + nCbS - 1 - x] : residual[y * nCbS + x];
+			dst[y * stride_dst + x] = (uint8_t)Clip3(0, 255, pred[y * stride_pred + x] + r);
+		}
+	}
+}
+
+
+#define MAKE_hevcasm_transquant_bypass_add_c_ref(name, log2TrafoSize, rotate) \
+	\
+static void hevcasm_transquant_ ## name ## _c_ref(uint8_t *dst, ptrdiff_t stride_dst, const uint8_t *pred, ptrdiff_t stride_pred, const int16_t *residual) \
+{ \
+	transquant_bypass_add(dst, stride_dst, pred, stride_pred, residual, log2TrafoSize, rotate); \
+} \
+
+MAKE_hevcasm_transquant_bypass_add_c_ref(bypass_add_rotate_4x4, 2, 1)
+MAKE_hevcasm_transquant_bypass_add_c_ref(bypass_add_4x4, 2, 0)
+MAKE_hevcasm_transquant_bypass_add_c_ref(bypass_add_8x8, 3, 0)
+MAKE_hevcasm_transquant_bypass_add_c_ref(bypass_add_16x16, 4, 0)
+MAKE_hevcasm_transquant_bypass_add_c_ref(bypass_add_32x32, 5, 0)
+
+
+static hevcasm_inverse_transform_add* get_transquant_bypass_add(int rotate, int log2TrafoSize, hevcasm_instruction_set mask)
+{
+	const int nCbS = 1 << log2TrafoSize;
+
+	hevcasm_inverse_transform_add *f = 0;
+
+	if (mask & (HEVCASM_C_REF | HEVCASM_C_OPT))
+	{
+		if (nCbS == 4) f = rotate ? hevcasm_transquant_bypass_add_rotate_4x4_c_ref : hevcasm_transquant_bypass_add_4x4_c_ref;
+		if (nCbS == 8) f = hevcasm_transquant_bypass_add_8x8_c_ref;
+		if (nCbS == 16) f = hevcasm_transquant_bypass_add_16x16_c_ref;
+		if (nCbS == 32) f = hevcasm_transquant_bypass_add_32x32_c_ref;
+	}
+
+	if (mask & HEVCASM_SSE2)
+	{
+		if (nCbS == 4) f = rotate ? hevcasm_transquant_bypass_add_rotate_4x4_sse2 : hevcasm_transquant_bypass_add_4x4_sse2;
+		if (nCbS == 8) f = hevcasm_transquant_bypass_add_8x8_sse2;
+		if (nCbS == 16) f = hevcasm_transquant_bypass_add_16x16_sse2;
+		if (nCbS == 32) f = hevcasm_transquant_bypass_add_32x32_sse2;
+	}
+
+	return f;
+}
+
+
+void HEVCASM_API hevcasm_populate_transquant_bypass_add(hevcasm_table_transquant_bypass_add *table, hevcasm_instruction_set mask)
+{
+	*hevcasm_get_transquant_bypass_add(table, 1, 2) = get_transquant_bypass_add(1, 2, mask);
+	for (int log2TrafoSize = 2; log2TrafoSize <= 5; ++log2TrafoSize)
+	{
+		*hevcasm_get_transquant_bypass_add(table, 0, log2TrafoSize) = get_transquant_bypass_add(0, log2TrafoSize, mask);
+	}
+}
+
+
+int init_transquant_bypass_add(void *p, hevcasm_instruction_set mask)
+{
+	bind_inverse_transform_add *s = p;
+
+	hevcasm_table_transquant_bypass_add table;
+
+	hevcasm_populate_transquant_bypass_add(&table, mask);
+
+	hevcasm_inverse_transform_add **entry = hevcasm_get_transquant_bypass_add(&table, s->rotate, s->log2TrafoSize);
+	hevcasm_test_report_kernel(&table, sizeof(table), entry);
+	s->f = *entry;
+	assert(s->f == get_transquant_bypass_add(s->rotate, s->log2TrafoSize, mask));
+
+	if (s->f && mask == HEVCASM_C_REF)
+	{
+		const int nCbS = 1 << s->log2TrafoSize;
+		hevcasm_test_printf("\t%s%dx%d : ", s->rotate ? "rotate " : "", nCbS, nCbS);
+	}
+
+	return !!s->f;
+}
+
+
+void HEVCASM_API hevcasm_test_transquant_bypass_add(int *error_count, hevcasm_instruction_set mask)
+{
+	hevcasm_test_printf("\nhevcasm_transquant_bypass_add - Lossless residual, add to predicted\n");
+
+	HEVCASM_ALIGN(32, int16_t, residual[32 * 32]);
+	HEVCASM_ALIGN(32, uint8_t, predicted[32 * 32]);
+
+	/* full int16 range exercises saturation as well as the -255..255 residuals of 8-bit lossless */
+	for (int x = 0; x < 32 * 32; x++) residual[x] = (x & 1) ? ((hevcasm_test_rand() << 1) ^ hevcasm_test_rand()) & 0xffff : (hevcasm_test_rand() & 0x1ff) - 0xff;
+	for (int x = 0; x < 32 * 32; x++) predicted[x] = hevcasm_test_rand() & 0xff;
+
+	bind_inverse_transform_add b[2];
+	b[0].coefficients = residual;
+	b[0].predicted = predicted;
+
+	for (int j = 1; j < 6; ++j)
+	{
+		b[0].rotate = (j == 1) ? 1 : 0;
+		b[0].log2TrafoSize = (j == 1) ? 2 : j;
+		b[1] = b[0];
+
+		*error_count += hevcasm_test(&b[0], &b[1], init_transquant_bypass_add, invoke_inverse_transform_add, mismatch_transform_add, mask, 100000);
+	}
+}
@@ -77,6 +77,16 @@ void HEVCASM_API hevcasm_populate_inverse_transform_add(hevcasm_table_inverse_tr
 
 void HEVCASM_API hevcasm_test_inverse_transform_add(int *error_count, hevcasm_instruction_set mask);
 
+#ifdef HEVCASM_X64
+hevcasm_inverse_transform_add hevcasm_idct_8x8_ssse3;
+hevcasm_inverse_transform_add hevcasm_idct_16x16_ssse3;
+hevcasm_inverse_transform_add hevcasm_idst_4x4_avx2;
+hevcasm_inverse_transform_add hevcasm_idct_4x4_avx2;
+hevcasm_inverse_transform_add hevcasm_idct_8x8_avx2;
+hevcasm_inverse_transform_add hevcasm_idct_16x16_avx2;
+hevcasm_inverse_transform_add hevcasm_idct_32x32_avx2;
+#endif
+
 
 // Review: this is an encode function in a file called "residual_decode.h"
 typedef void hevcasm_transform(int16_t *coeffs, const int16_t *src, ptrdiff_t src_stride);
@@ -105,6 +115,95 @@ void HEVCASM_API hevcasm_populate_transform(hevcasm_table_transform *table, hevc
 
 void HEVCASM_API hevcasm_test_transform(int *error_count, hevcasm_instruction_set mask);
 
+#ifdef HEVCASM_X64
+hevcasm_transform hevcasm_dct_16x16_ssse3;
+#endif
+
+
+
+// Transform skip, forward: coefficients are the residual scaled by 1 << (15 - bitDepth - log2TrafoSize).
+// The rotate variant applies the range extensions 180 degree rotation (4x4 only).
+
+typedef struct
+{
+	hevcasm_transform *rotate;
+	hevcasm_transform *skip[4];
+}
+hevcasm_table_transform_skip;
+
+static hevcasm_transform** hevcasm_get_transform_skip(hevcasm_table_transform_skip *table, int rotate, int log2TrafoSize)
+{
+	if (rotate)
+	{
+		assert(log2TrafoSize == 2);
+		return &table->rotate;
+	}
+	else
+	{
+		return &table->skip[log2TrafoSize - 2];
+	}
+}
+
+void HEVCASM_API hevcasm_populate_transform_skip(hevcasm_table_transform_skip *table, hevcasm_instruction_set mask);
+
+void HEVCASM_API hevcasm_test_transform_skip(int *error_count, hevcasm_instruction_set mask);
+
+
+
+// Transform skip, inverse: residual is ((coeff << (5 + log2TrafoSize)) + (1 << 11)) >> 12, then add to predictor
+
+typedef struct
+{
+	hevcasm_inverse_transform_add *rotate;
+	hevcasm_inverse_transform_add *skip[4];
+}
+hevcasm_table_inverse_transform_skip_add;
+
+static hevcasm_inverse_transform_add** hevcasm_get_inverse_transform_skip_add(hevcasm_table_inverse_transform_skip_add *table, int rotate, int log2TrafoSize)
+{
+	if (rotate)
+	{
+		assert(log2TrafoSize == 2);
+		return &table->rotate;
+	}
+	else
+	{
+		return &table->skip[log2TrafoSize - 2];
+	}
+}
+
+void HEVCASM_API hevcasm_populate_inverse_transform_skip_add(hevcasm_table_inverse_transform_skip_add *table, hevcasm_instruction_set mask);
+
+void HEVCASM_API hevcasm_test_inverse_transform_skip_add(int *error_count, hevcasm_instruction_set mask);
+
+
+
+// Transquant bypass (lossless): residual is added directly to predictor
+
+typedef struct
+{
+	hevcasm_inverse_transform_add *rotate;
+	hevcasm_inverse_transform_add *bypass[4];
+}
+hevcasm_table_transquant_bypass_add;
+
+static hevcasm_inverse_transform_add** hevcasm_get_transquant_bypass_add(hevcasm_table_transquant_bypass_add *table, int rotate, int log2TrafoSize)
+{
+	if (rotate)
+	{
+		assert(log2TrafoSize == 2);
+		return &table->rotate;
+	}
+	else
+	{
+		return &table->bypass[log2TrafoSize - 2];
+	}
+}
+
+void HEVCASM_API hevcasm_populate_transquant_bypass_add(hevcasm_table_transquant_bypass_add *table, hevcasm_instruction_set mask);
+
+void HEVCASM_API hevcasm_test_transquant_bypass_add(int *error_count, hevcasm_instruction_set mask);
+
 
 
 #ifdef __cplusplus
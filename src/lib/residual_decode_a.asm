@@ -36,11 +36,12 @@
 %include "x86inc.asm"
 
 
-%if ARCH_X86_64 == 1
-
 %define ORDER(a, b, c, d) ((a << 6) | (b << 4) | (c << 2) | d)
 
 
+%if ARCH_X86_64 == 1
+
+
 SECTION_RODATA 32
 
 cosine_inverse_4:
@@ -1102,4 +1103,257 @@ cglobal partial_butterfly_inverse_16h, 3, 5, 16
 	RET
 
 
-%endif
\ No newline at end of file
+%endif
+
+
+
+; Transform skip and transquant bypass - these do not need the extra registers of x64
+
+
+SECTION_RODATA 16
+
+; pmulhrsw multipliers equivalent to ((d << (5 + log2TrafoSize)) + (1 << 11)) >> 12
+transform_skip_scale_4:
+	times 8 dw 1 << 10
+transform_skip_scale_8:
+	times 8 dw 1 << 11
+transform_skip_scale_16:
+	times 8 dw 1 << 12
+transform_skip_scale_32:
+	times 8 dw 1 << 13
+
+
+SECTION .text
+
+
+; reverses the order of the eight words in %1
+%macro REVERSE_W 1
+	pshuflw %1, %1, ORDER(0, 1, 2, 3)
+	pshufhw %1, %1, ORDER(0, 1, 2, 3)
+	pshufd %1, %1, ORDER(1, 0, 3, 2)
+%endmacro
+
+
+; void hevcasm_transform_skip_4x4_sse2(int16_t *coeffs, const int16_t *src, ptrdiff_t src_stride);
+; %1 is nonzero for the rotated (180 degree) variant
+%macro TRANSFORM_SKIP_4x4 1
+	add r2, r2
+	; r2 = src_stride in bytes
+
+	movq m0, [r1]
+	movhps m0, [r1 + r2]
+	lea r1, [r1 + 2 * r2]
+	; m0 = src row 1, src row 0
+
+	movq m1, [r1]
+	movhps m1, [r1 + r2]
+	; m1 = src row 3, src row 2
+
+	psllw m0, 5
+	psllw m1, 5
+
+%if %1
+	REVERSE_W m0
+	REVERSE_W m1
+	mova [r0], m1
+	mova [r0 + 16], m0
+%else
+	mova [r0], m0
+	mova [r0 + 16], m1
+%endif
+	RET
+%endmacro
+
+
+INIT_XMM sse2
+cglobal transform_skip_4x4, 3, 3, 2
+	TRANSFORM_SKIP_4x4 0
+
+INIT_XMM sse2
+cglobal transform_skip_rotate_4x4, 3, 3, 2
+	TRANSFORM_SKIP_4x4 1
+
+
+; void hevcasm_transform_skip_NxN_sse2(int16_t *coeffs, const int16_t *src, ptrdiff_t src_stride);
+; %1 is nCbS, %2 is log2TrafoSize
+%macro TRANSFORM_SKIP 2
+INIT_XMM sse2
+cglobal transform_skip_%1x%1, 3, 4, 1
+	add r2, r2
+	; r2 = src_stride in bytes
+
+	mov r3d, %1
+
+	.loop
+
+%assign i 0
+%rep %1 / 8
+		movu m0, [r1 + 16 * i]
+		psllw m0, 7 - %2
+		mova [r0 + 16 * i], m0
+%assign i i+1
+%endrep
+
+		add r0, 2 * %1
+		add r1, r2
+		dec r3d
+		jg .loop
+
+	RET
+%endmacro
+
+TRANSFORM_SKIP 8, 3
+TRANSFORM_SKIP 16, 4
+TRANSFORM_SKIP 32, 5
+
+
+; adds residual words in m0 (rows 1, 0) and m1 (rows 3, 2) to a 4x4 predictor and writes dst
+; r0 = dst, r1 = stride_dst, r2 = pred, r3 = stride_pred, m4 = 0
+%macro ADD_PRED_4x4 1 ; %1 is the word add instruction
+	movd m2, [r2]
+	movd m3, [r2 + r3]
+	punpckldq m2, m3
+	punpcklbw m2, m4
+	%1 m0, m2
+	; m0 = pred + res, rows 1, 0
+
+	lea r2, [r2 + 2 * r3]
+	movd m2, [r2]
+	movd m3, [r2 + r3]
+	punpckldq m2, m3
+	punpcklbw m2, m4
+	%1 m1, m2
+	; m1 = pred + res, rows 3, 2
+
+	packuswb m0, m1
+	; m0 = dst rows 3, 2, 1, 0
+
+	movd [r0], m0
+	psrldq m0, 4
+	movd [r0 + r1], m0
+	lea r0, [r0 + 2 * r1]
+	psrldq m0, 4
+	movd [r0], m0
+	psrldq m0, 4
+	movd [r0 + r1], m0
+%endmacro
+
+
+; void hevcasm_inverse_transform_skip_add_4x4_ssse3(uint8_t *dst, ptrdiff_t stride_dst, const uint8_t *pred, ptrdiff_t stride_pred, const int16_t *coeffs);
+; %1 is nonzero for the rotated (180 degree) variant
+%macro INVERSE_TRANSFORM_SKIP_ADD_4x4 1
+	pxor m4, m4
+	mova m5, [transform_skip_scale_4]
+
+%if %1
+	mova m0, [r4 + 16]
+	mova m1, [r4]
+	REVERSE_W m0
+	REVERSE_W m1
+%else
+	mova m0, [r4]
+	mova m1, [r4 + 16]
+%endif
+	; m0 = coeffs rows 1, 0; m1 = coeffs rows 3, 2
+
+	pmulhrsw m0, m5
+	pmulhrsw m1, m5
+	; m0, m1 = residual
+
+	ADD_PRED_4x4 paddw
+	RET
+%endmacro
+
+INIT_XMM ssse3
+cglobal inverse_transform_skip_add_4x4, 5, 5, 6
+	INVERSE_TRANSFORM_SKIP_ADD_4x4 0
+
+INIT_XMM ssse3
+cglobal inverse_transform_skip_add_rotate_4x4, 5, 5, 6
+	INVERSE_TRANSFORM_SKIP_ADD_4x4 1
+
+
+; void hevcasm_transquant_bypass_add_4x4_sse2(uint8_t *dst, ptrdiff_t stride_dst, const uint8_t *pred, ptrdiff_t stride_pred, const int16_t *residual);
+; %1 is nonzero for the rotated (180 degree) variant
+%macro TRANSQUANT_BYPASS_ADD_4x4 1
+	pxor m4, m4
+
+%if %1
+	mova m0, [r4 + 16]
+	mova m1, [r4]
+	REVERSE_W m0
+	REVERSE_W m1
+%else
+	mova m0, [r4]
+	mova m1, [r4 + 16]
+%endif
+	; m0 = residual rows 1, 0; m1 = residual rows 3, 2
+
+	ADD_PRED_4x4 paddsw
+	RET
+%endmacro
+
+INIT_XMM sse2
+cglobal transquant_bypass_add_4x4, 5, 5, 5
+	TRANSQUANT_BYPASS_ADD_4x4 0
+
+INIT_XMM sse2
+cglobal transquant_bypass_add_rotate_4x4, 5, 5, 5
+	TRANSQUANT_BYPASS_ADD_4x4 1
+
+
+; void hevcasm_inverse_transform_skip_add_NxN_ssse3(uint8_t *dst, ptrdiff_t stride_dst, const uint8_t *pred, ptrdiff_t stride_pred, const int16_t *coeffs);
+; void hevcasm_transquant_bypass_add_NxN_sse2(uint8_t *dst, ptrdiff_t stride_dst, const uint8_t *pred, ptrdiff_t stride_pred, const int16_t *residual);
+; %1 is nCbS, %2 is nonzero for transform skip (otherwise bypass)
+%macro RESIDUAL_ADD 2
+	pxor m4, m4
+%if %2
+	mova m5, [transform_skip_scale_%1]
+%endif
+
+	mov r5d, %1
+
+	.loop
+
+%assign i 0
+%rep %1 / 8
+		movq m0, [r2 + 8 * i]
+		punpcklbw m0, m4
+		; m0 = pred[7..0]
+
+		mova m1, [r4 + 16 * i]
+%if %2
+		pmulhrsw m1, m5
+		paddw m0, m1
+%else
+		paddsw m0, m1
+%endif
+		; m0 = pred + res
+
+		packuswb m0, m0
+		movq [r0 + 8 * i], m0
+%assign i i+1
+%endrep
+
+		add r0, r1
+		add r2, r3
+		add r4, 2 * %1
+		dec r5d
+		jg .loop
+
+	RET
+%endmacro
+
+%macro RESIDUAL_ADD_NxN 1
+INIT_XMM ssse3
+cglobal inverse_transform_skip_add_%1x%1, 5, 6, 6
+	RESIDUAL_ADD %1, 1
+
+INIT_XMM sse2
+cglobal transquant_bypass_add_%1x%1, 5, 6, 5
+	RESIDUAL_ADD %1, 0
+%endmacro
+
+RESIDUAL_ADD_NxN 8
+RESIDUAL_ADD_NxN 16
+RESIDUAL_ADD_NxN 32
@@ -38,6 +38,8 @@ THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef INCLUDED_hevcasm_residual_decode_a_h
 #define INCLUDED_hevcasm_residual_decode_a_h
 
+#include "residual_decode.h"
+
 #include <stdint.h>
 #include <stddef.h>
 
@@ -52,5 +54,23 @@ void hevcasm_partial_butterfly_inverse_16h_ssse3(int16_t *dst, const int16_t *sr
 void hevcasm_partial_butterfly_16v_ssse3(int16_t *dst, const int16_t *src, int shift);
 void hevcasm_partial_butterfly_16h_ssse3(int16_t *dst, const int16_t *src, ptrdiff_t src_stride, int shift);
 
+hevcasm_transform hevcasm_transform_skip_4x4_sse2;
+hevcasm_transform hevcasm_transform_skip_rotate_4x4_sse2;
+hevcasm_transform hevcasm_transform_skip_8x8_sse2;
+hevcasm_transform hevcasm_transform_skip_16x16_sse2;
+hevcasm_transform hevcasm_transform_skip_32x32_sse2;
+
+hevcasm_inverse_transform_add hevcasm_inverse_transform_skip_add_4x4_ssse3;
+hevcasm_inverse_transform_add hevcasm_inverse_transform_skip_add_rotate_4x4_ssse3;
+hevcasm_inverse_transform_add hevcasm_inverse_transform_skip_add_8x8_ssse3;
+hevcasm_inverse_transform_add hevcasm_inverse_transform_skip_add_16x16_ssse3;
+hevcasm_inverse_transform_add hevcasm_inverse_transform_skip_add_32x32_ssse3;
+
+hevcasm_inverse_transform_add hevcasm_transquant_bypass_add_4x4_sse2;
+hevcasm_inverse_transform_add hevcasm_transquant_bypass_add_rotate_4x4_sse2;
+hevcasm_inverse_transform_add hevcasm_transquant_bypass_add_8x8_sse2;
+hevcasm_inverse_transform_add hevcasm_transquant_bypass_add_16x16_sse2;
+hevcasm_inverse_transform_add hevcasm_transquant_bypass_add_32x32_sse2;
+
 
 #endif
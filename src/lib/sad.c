@@ -200,9 +200,11 @@ int init_sad(void *p, hevcasm_instruction_set mask)
 	hevcasm_table_sad table;
 	hevcasm_populate_sad(&table, mask);
 
-	s->f = *hevcasm_get_sad(&table, s->width, s->height);
+	hevcasm_sad **entry = hevcasm_get_sad(&table, s->width, s->height);
+	hevcasm_test_report_kernel(&table, sizeof(table), entry);
+	s->f = *entry;
 
-	if (mask == HEVCASM_C_REF) printf("\t%dx%d:", s->width, s->height);
+	if (mask == HEVCASM_C_REF) hevcasm_test_printf("\t%dx%d:", s->width, s->height);
 
 	return !!s->f;
 }
@@ -242,12 +244,12 @@ static const int partitions[][2] = {
 
 void HEVCASM_API hevcasm_test_sad(int *error_count, hevcasm_instruction_set mask)
 {
-	printf("\nhevcasm_sad - Sum of Absolute Differences\n");
+	hevcasm_test_printf("\nhevcasm_sad - Sum of Absolute Differences\n");
 
 	bound_sad b[2];
 
-	for (int x = 0; x < 128 * 128; x++) b[0].src[x] = rand();
-	for (int x = 0; x < 128 * 128; x++) b[0].ref[x] = rand();
+	for (int x = 0; x < 128 * 128; x++) b[0].src[x] = hevcasm_test_rand();
+	for (int x = 0; x < 128 * 128; x++) b[0].ref[x] = hevcasm_test_rand();
 
 	for (int i = 0; partitions[i][0]; ++i)
 	{
@@ -279,11 +281,13 @@ int init_sad_multiref(void *p, hevcasm_instruction_set mask)
 
 	hevcasm_table_sad_multiref table;
 	hevcasm_populate_sad_multiref(&table, mask);
-	s->f = *hevcasm_get_sad_multiref(&table, s->ways, s->width, s->height);
+	hevcasm_sad_multiref **entry = hevcasm_get_sad_multiref(&table, s->ways, s->width, s->height);
+	hevcasm_test_report_kernel(&table, sizeof(table), entry);
+	s->f = *entry;
 
 	if (s->f && mask == HEVCASM_C_REF)
 	{
-		printf("\t%d-way %dx%d : ", s->ways, s->width, s->height);
+		hevcasm_test_printf("\t%d-way %dx%d : ", s->ways, s->width, s->height);
 	}
 
 	return !!s->f;
@@ -320,10 +324,10 @@ void HEVCASM_API hevcasm_test_sad_multiref(int *error_count, hevcasm_instruction
 
 	b[0].ways = 4;
 
-	printf("\nhevcasm_sad_multiref - Sum Of Absolute Differences with multiple references (%d candidate references)\n", b[0].ways);
+	hevcasm_test_printf("\nhevcasm_sad_multiref - Sum Of Absolute Differences with multiple references (%d candidate references)\n", b[0].ways);
 
-	for (int x = 0; x < 128 * 128; x++) b[0].src[x] = rand();
-	for (int x = 0; x < 128 * 128; x++) b[0].ref[x] = rand();
+	for (int x = 0; x < 128 * 128; x++) b[0].src[x] = hevcasm_test_rand();
+	for (int x = 0; x < 128 * 128; x++) b[0].ref[x] = hevcasm_test_rand();
 
 	b[0].ref_array[0] = &b[0].ref[1 + 2 * 128];
 	b[0].ref_array[1] = &b[0].ref[2 + 1 * 128];
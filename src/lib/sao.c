@@ -0,0 +1,677 @@
+/*
+The copyright in this software is being made available under the BSD
+License, included below. This software may be subject to other third party
+and contributor rights, including patent rights, and no such rights are
+granted under this license.
+
+
+Copyright(c) 2011 - 2015, Parabola Research Limited
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met :
+
+* Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+this list of conditions and the following disclaimer in the documentation
+and / or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its contributors may
+be used to endorse or promote products derived from this software without
+specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "sao.h"
+#include "hevcasm_test.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+
+static uint8_t clip1(int x)
+{
+	return (uint8_t)(x < 0 ? 0 : x > 255 ? 255 : x);
+}
+
+
+static int sign(int x)
+{
+	return (x > 0) - (x < 0);
+}
+
+
+static void hevcasm_sao_band_c_ref(uint8_t *dst, ptrdiff_t stride_dst, const uint8_t *src, ptrdiff_t stride_src, int w, int h, int band_position, const int offset[4])
+{
+	int table[32] = { 0 };
+	for (int k = 0; k < 4; ++k)
+	{
+		table[(k + band_position) & 31] = offset[k];
+	}
+
+	for (int y = 0; y < h; ++y)
+	{
+		for (int x = 0; x < w; ++x)
+		{
+			dst[x + y * stride_dst] = clip1(src[x + y * stride_src] + table[src[x + y * stride_src] >> 3]);
+		}
+	}
+}
+
+
+/* positions of the two neighbours of each edge offset class as (hPos, vPos) */
+static const int sao_edge_position[4][2][2] =
+{
+	{ { -1, 0 }, { 1, 0 } },
+	{ { 0, -1 }, { 0, 1 } },
+	{ { -1, -1 }, { 1, 1 } },
+	{ { 1, -1 }, { -1, 1 } },
+};
+
+
+static int sao_edge_offset(const uint8_t *src, ptrdiff_t stride_src, int eo_class, const int offset[4])
+{
+	const int(*pos)[2] = sao_edge_position[eo_class];
+	int edgeIdx = 2
+		+ sign(src[0] - src[pos[0][0] + pos[0][1] * stride_src])
+		+ sign(src[0] - src[pos[1][0] + pos[1][1] * stride_src]);
+
+	if (edgeIdx <= 2) edgeIdx = edgeIdx == 2 ? 0 : edgeIdx + 1;
+
+	return edgeIdx ? offset[edgeIdx - 1] : 0;
+}
+
+
+/* whether both edge offset neighbours of sample (x, y) of a w x h CTB lie in the CTB or in an available neighbour */
+static int sao_edge_usable(int x, int y, int w, int h, int eo_class, int available)
+{
+	static const int neighbour[3][3] =
+	{
+		{ HEVCASM_SAO_ABOVE_LEFT, HEVCASM_SAO_ABOVE, HEVCASM_SAO_ABOVE_RIGHT },
+		{ HEVCASM_SAO_LEFT, -1, HEVCASM_SAO_RIGHT },
+		{ HEVCASM_SAO_BELOW_LEFT, HEVCASM_SAO_BELOW, HEVCASM_SAO_BELOW_RIGHT },
+	};
+
+	for (int i = 0; i < 2; ++i)
+	{
+		const int xn = x + sao_edge_position[eo_class][i][0];
+		const int yn = y + sao_edge_position[eo_class][i][1];
+		const int n = neighbour[(yn >= 0) + (yn >= h)][(xn >= 0) + (xn >= w)];
+		if (n >= 0 && !(available & n)) return 0;
+	}
+	return 1;
+}
+
+
+static void sao_edge_c(uint8_t *dst, ptrdiff_t stride_dst, const uint8_t *src, ptrdiff_t stride_src, int w, int h, int eo_class, const int offset[4])
+{
+	for (int y = 0; y < h; ++y)
+	{
+		for (int x = 0; x < w; ++x)
+		{
+			const uint8_t *s = &src[x + y * stride_src];
+			dst[x + y * stride_dst] = clip1(s[0] + sao_edge_offset(s, stride_src, eo_class, offset));
+		}
+	}
+}
+
+
+#define MAKE_hevcasm_sao_edge_c_ref(eo_class) \
+static void hevcasm_sao_edge_ ## eo_class ## _c_ref(uint8_t *dst, ptrdiff_t stride_dst, const uint8_t *src, ptrdiff_t stride_src, int w, int h, const int offset[4]) \
+{ \
+	sao_edge_c(dst, stride_dst, src, stride_src, w, h, eo_class, offset); \
+}
+
+MAKE_hevcasm_sao_edge_c_ref(0)
+MAKE_hevcasm_sao_edge_c_ref(1)
+MAKE_hevcasm_sao_edge_c_ref(2)
+MAKE_hevcasm_sao_edge_c_ref(3)
+
+
+#ifdef HEVCASM_X64
+
+hevcasm_sao_band hevcasm_sao_band_16n_ssse3;
+hevcasm_sao_band hevcasm_sao_band_32n_avx2;
+
+static void hevcasm_sao_band_ssse3(uint8_t *dst, ptrdiff_t stride_dst, const uint8_t *src, ptrdiff_t stride_src, int w, int h, int band_position, const int offset[4])
+{
+	const int w16 = w & ~15;
+	if (w16) hevcasm_sao_band_16n_ssse3(dst, stride_dst, src, stride_src, w16, h, band_position, offset);
+	if (w16 < w) hevcasm_sao_band_c_ref(dst + w16, stride_dst, src + w16, stride_src, w - w16, h, band_position, offset);
+}
+
+static void hevcasm_sao_band_avx2(uint8_t *dst, ptrdiff_t stride_dst, const uint8_t *src, ptrdiff_t stride_src, int w, int h, int band_position, const int offset[4])
+{
+	const int w32 = w & ~31;
+	if (w32) hevcasm_sao_band_32n_avx2(dst, stride_dst, src, stride_src, w32, h, band_position, offset);
+	if (w32 < w) hevcasm_sao_band_ssse3(dst + w32, stride_dst, src + w32, stride_src, w - w32, h, band_position, offset);
+}
+
+
+#define MAKE_hevcasm_sao_edge(eo_class) \
+hevcasm_sao_edge hevcasm_sao_edge_ ## eo_class ## _16n_ssse3; \
+hevcasm_sao_edge hevcasm_sao_edge_ ## eo_class ## _32n_avx2; \
+ \
+static void hevcasm_sao_edge_ ## eo_class ## _ssse3(uint8_t *dst, ptrdiff_t stride_dst, const uint8_t *src, ptrdiff_t stride_src, int w, int h, const int offset[4]) \
+{ \
+	const int w16 = w & ~15; \
+	if (w16) hevcasm_sao_edge_ ## eo_class ## _16n_ssse3(dst, stride_dst, src, stride_src, w16, h, offset); \
+	if (w16 < w) sao_edge_c(dst + w16, stride_dst, src + w16, stride_src, w - w16, h, eo_class, offset); \
+} \
+ \
+static void hevcasm_sao_edge_ ## eo_class ## _avx2(uint8_t *dst, ptrdiff_t stride_dst, const uint8_t *src, ptrdiff_t stride_src, int w, int h, const int offset[4]) \
+{ \
+	const int w32 = w & ~31; \
+	if (w32) hevcasm_sao_edge_ ## eo_class ## _32n_avx2(dst, stride_dst, src, stride_src, w32, h, offset); \
+	if (w32 < w) hevcasm_sao_edge_ ## eo_class ## _ssse3(dst + w32, stride_dst, src + w32, stride_src, w - w32, h, offset); \
+}
+
+MAKE_hevcasm_sao_edge(0)
+MAKE_hevcasm_sao_edge(1)
+MAKE_hevcasm_sao_edge(2)
+MAKE_hevcasm_sao_edge(3)
+
+#endif
+
+
+void HEVCASM_API hevcasm_populate_sao(hevcasm_table_sao *table, hevcasm_instruction_set mask)
+{
+	*hevcasm_get_sao_band(table) = 0;
+	for (int eo_class = 0; eo_class < 4; ++eo_class)
+	{
+		*hevcasm_get_sao_edge(table, eo_class) = 0;
+	}
+
+	if (mask & (HEVCASM_C_REF | HEVCASM_C_OPT))
+	{
+		*hevcasm_get_sao_band(table) = hevcasm_sao_band_c_ref;
+		*hevcasm_get_sao_edge(table, 0) = hevcasm_sao_edge_0_c_ref;
+		*hevcasm_get_sao_edge(table, 1) = hevcasm_sao_edge_1_c_ref;
+		*hevcasm_get_sao_edge(table, 2) = hevcasm_sao_edge_2_c_ref;
+		*hevcasm_get_sao_edge(table, 3) = hevcasm_sao_edge_3_c_ref;
+	}
+
+#ifdef HEVCASM_X64
+	if (mask & HEVCASM_SSSE3)
+	{
+		*hevcasm_get_sao_band(table) = hevcasm_sao_band_ssse3;
+		*hevcasm_get_sao_edge(table, 0) = hevcasm_sao_edge_0_ssse3;
+		*hevcasm_get_sao_edge(table, 1) = hevcasm_sao_edge_1_ssse3;
+		*hevcasm_get_sao_edge(table, 2) = hevcasm_sao_edge_2_ssse3;
+		*hevcasm_get_sao_edge(table, 3) = hevcasm_sao_edge_3_ssse3;
+	}
+
+	if (mask & HEVCASM_AVX2)
+	{
+		*hevcasm_get_sao_band(table) = hevcasm_sao_band_avx2;
+		*hevcasm_get_sao_edge(table, 0) = hevcasm_sao_edge_0_avx2;
+		*hevcasm_get_sao_edge(table, 1) = hevcasm_sao_edge_1_avx2;
+		*hevcasm_get_sao_edge(table, 2) = hevcasm_sao_edge_2_avx2;
+		*hevcasm_get_sao_edge(table, 3) = hevcasm_sao_edge_3_avx2;
+	}
+#endif
+}
+
+
+static void sao_copy(uint8_t *dst, ptrdiff_t stride_dst, const uint8_t *src, ptrdiff_t stride_src, int w, int h)
+{
+	for (int y = 0; y < h; ++y)
+	{
+		memcpy(&dst[y * stride_dst], &src[y * stride_src], w);
+	}
+}
+
+
+void HEVCASM_API hevcasm_sao_ctb(hevcasm_table_sao *table, uint8_t *dst, ptrdiff_t stride_dst, const uint8_t *src, ptrdiff_t stride_src, int w, int h, const hevcasm_sao_parameters *parameters, int available)
+{
+	if (parameters->type == HEVCASM_SAO_BAND)
+	{
+		(*hevcasm_get_sao_band(table))(dst, stride_dst, src, stride_src, w, h, parameters->band_position, parameters->offset);
+		return;
+	}
+
+	if (parameters->type != HEVCASM_SAO_EDGE)
+	{
+		sao_copy(dst, stride_dst, src, stride_src, w, h);
+		return;
+	}
+
+	/* rows and columns whose neighbours are unavailable are copied, the kernel filters the rest */
+	const int eo_class = parameters->eo_class;
+	const int horizontal = eo_class != 1;
+	const int vertical = eo_class != 0;
+	const int x0 = horizontal && !(available & HEVCASM_SAO_LEFT);
+	const int x1 = w - (horizontal && !(available & HEVCASM_SAO_RIGHT));
+	const int y0 = vertical && !(available & HEVCASM_SAO_ABOVE);
+	const int y1 = h - (vertical && !(available & HEVCASM_SAO_BELOW));
+
+	if (y0) sao_copy(dst, stride_dst, src, stride_src, w, 1);
+	if (y1 < h) sao_copy(&dst[y1 * stride_dst], stride_dst, &src[y1 * stride_src], stride_src, w, 1);
+	if (x0) sao_copy(&dst[y0 * stride_dst], stride_dst, &src[y0 * stride_src], stride_src, 1, y1 - y0);
+	if (x1 < w) sao_copy(&dst[x1 + y0 * stride_dst], stride_dst, &src[x1 + y0 * stride_src], stride_src, 1, y1 - y0);
+
+	if (x1 > x0 && y1 > y0)
+	{
+		(*hevcasm_get_sao_edge(table, eo_class))(&dst[x0 + y0 * stride_dst], stride_dst, &src[x0 + y0 * stride_src], stride_src, x1 - x0, y1 - y0, parameters->offset);
+	}
+
+	/* for diagonal classes, a corner sample depends only on its diagonal neighbour outside the CTB */
+	if (eo_class >= 2)
+	{
+		const int corner[2][3] =
+		{
+			{ eo_class == 2 ? 0 : w - 1, 0, eo_class == 2 ? HEVCASM_SAO_ABOVE_LEFT : HEVCASM_SAO_ABOVE_RIGHT },
+			{ eo_class == 2 ? w - 1 : 0, h - 1, eo_class == 2 ? HEVCASM_SAO_BELOW_RIGHT : HEVCASM_SAO_BELOW_LEFT },
+		};
+
+		for (int i = 0; i < 2; ++i)
+		{
+			uint8_t *d = &dst[corner[i][0] + corner[i][1] * stride_dst];
+			const uint8_t *s = &src[corner[i][0] + corner[i][1] * stride_src];
+			if (available & corner[i][2]) sao_edge_c(d, stride_dst, s, stride_src, 1, 1, eo_class, parameters->offset);
+			else *d = *s;
+		}
+	}
+}
+
+
+/* 96x96 test picture with the CTB at (16, 16) */
+#define SAO_TEST_STRIDE 96
+#define SAO_TEST_CASES 8
+
+/* CTB sizes of the test cases, including partial CTBs at picture edges */
+static const int sao_test_sizes[SAO_TEST_CASES][2] = { { 64, 64 }, { 32, 32 }, { 16, 16 }, { 8, 8 }, { 40, 24 }, { 64, 20 }, { 20, 64 }, { 56, 8 } };
+
+
+/* smooth gradients with noise and occasional steps, reaching the clipping limits */
+static uint8_t *sao_test_picture(void)
+{
+	uint8_t *src = malloc(SAO_TEST_STRIDE * SAO_TEST_STRIDE);
+	for (int y = 0; y < SAO_TEST_STRIDE; ++y)
+	{
+		for (int x = 0; x < SAO_TEST_STRIDE; ++x)
+		{
+			const int step = ((x / 12 + y / 20) & 1) ? 40 : 0;
+			src[x + y * SAO_TEST_STRIDE] = clip1(3 * x - y + step - 20 + hevcasm_test_rand() % 5);
+		}
+	}
+	return src;
+}
+
+
+/* per-sample SAO of one CTB written directly from the specification (8.7.3) */
+static void sao_ctb_reference(hevcasm_table_sao *table, uint8_t *dst, ptrdiff_t stride_dst, const uint8_t *src, ptrdiff_t stride_src, int w, int h, const hevcasm_sao_parameters *parameters, int available)
+{
+	for (int y = 0; y < h; ++y)
+	{
+		for (int x = 0; x < w; ++x)
+		{
+			const uint8_t *s = &src[x + y * stride_src];
+			int offset = 0;
+
+			if (parameters->type == HEVCASM_SAO_BAND)
+			{
+				const int k = ((s[0] >> 3) - parameters->band_position) & 31;
+				if (k < 4) offset = parameters->offset[k];
+			}
+			else if (parameters->type == HEVCASM_SAO_EDGE)
+			{
+				if (sao_edge_usable(x, y, w, h, parameters->eo_class, available)) offset = sao_edge_offset(s, stride_src, parameters->eo_class, parameters->offset);
+			}
+
+			dst[x + y * stride_dst] = clip1(s[0] + offset);
+		}
+	}
+}
+
+
+typedef void sao_ctb_function(hevcasm_table_sao *table, uint8_t *dst, ptrdiff_t stride_dst, const uint8_t *src, ptrdiff_t stride_src, int w, int h, const hevcasm_sao_parameters *parameters, int available);
+
+typedef struct
+{
+	const uint8_t *src;
+	hevcasm_sao_parameters parameters[SAO_TEST_CASES];
+	int available[SAO_TEST_CASES];
+	int w[SAO_TEST_CASES];
+	int h[SAO_TEST_CASES];
+	hevcasm_table_sao table;
+	sao_ctb_function *f;
+	HEVCASM_ALIGN(32, uint8_t, dst[SAO_TEST_CASES][64 * 64]);
+}
+bound_sao;
+
+
+int init_sao(void *p, hevcasm_instruction_set mask)
+{
+	bound_sao *s = p;
+
+	hevcasm_populate_sao(&s->table, mask);
+
+	/* the specification-style reference also checks hevcasm_sao_ctb() itself */
+	s->f = mask == HEVCASM_C_REF ? sao_ctb_reference : hevcasm_sao_ctb;
+
+	/* all cases share one type and class and so exercise one kernel of the table */
+	if (s->parameters[0].type == HEVCASM_SAO_BAND) hevcasm_test_report_kernel(&s->table, sizeof(s->table), hevcasm_get_sao_band(&s->table));
+	else hevcasm_test_report_kernel(&s->table, sizeof(s->table), hevcasm_get_sao_edge(&s->table, s->parameters[0].eo_class));
+
+	if (mask == HEVCASM_C_REF)
+	{
+		if (s->parameters[0].type == HEVCASM_SAO_BAND) hevcasm_test_printf("\tband offset : ");
+		else hevcasm_test_printf("\tedge offset class %d : ", s->parameters[0].eo_class);
+	}
+
+	return !!*hevcasm_get_sao_band(&s->table);
+}
+
+
+void invoke_sao(void *p, int n)
+{
+	bound_sao *s = p;
+	while (n--)
+	{
+		for (int i = 0; i < SAO_TEST_CASES; ++i)
+		{
+			s->f(&s->table, s->dst[i], 64, &s->src[16 + 16 * SAO_TEST_STRIDE], SAO_TEST_STRIDE, s->w[i], s->h[i], &s->parameters[i], s->available[i]);
+		}
+	}
+}
+
+
+int mismatch_sao(void *boundRef, void *boundTest)
+{
+	bound_sao *ref = boundRef;
+	bound_sao *test = boundTest;
+
+	for (int i = 0; i < SAO_TEST_CASES; ++i)
+	{
+		for (int y = 0; y < ref->h[i]; ++y)
+		{
+			if (memcmp(&ref->dst[i][64 * y], &test->dst[i][64 * y], ref->w[i])) return 1;
+		}
+	}
+	return 0;
+}
+
+
+void HEVCASM_API hevcasm_test_sao(int *error_count, hevcasm_instruction_set mask)
+{
+	hevcasm_test_printf("\nhevcasm_sao - Sample adaptive offset of a CTB\n");
+
+	uint8_t *src = sao_test_picture();
+
+	bound_sao b[2];
+	b[0].src = src;
+
+	for (int type = 0; type < 5; ++type)
+	{
+		for (int i = 0; i < SAO_TEST_CASES; ++i)
+		{
+			hevcasm_sao_parameters *parameters = &b[0].parameters[i];
+			parameters->type = type ? HEVCASM_SAO_EDGE : HEVCASM_SAO_BAND;
+			parameters->eo_class = type - 1;
+			/* the first two cases cover the darkest bands and wrap around to the brightest */
+			parameters->band_position = i == 0 ? 0 : i == 1 ? 30 : hevcasm_test_rand() % 32;
+			for (int k = 0; k < 4; ++k)
+			{
+				/* edge offsets are positive for categories 1 and 2, negative for 3 and 4 */
+				parameters->offset[k] = type ? (k < 2 ? 1 : -1) * (hevcasm_test_rand() % 8) : hevcasm_test_rand() % 15 - 7;
+			}
+			b[0].available[i] = i ? hevcasm_test_rand() & 0xff : 0xff;
+			b[0].w[i] = sao_test_sizes[i][0];
+			b[0].h[i] = sao_test_sizes[i][1];
+		}
+
+		b[1] = b[0];
+		*error_count += hevcasm_test(&b[0], &b[1], init_sao, invoke_sao, mismatch_sao, mask, 1000);
+	}
+
+	free(src);
+}
+
+/* edgeIdx - 1 for Sign(cur - a) + Sign(cur - b) + 2, or -1 for none */
+static const int sao_edge_category[5] = { 0, 1, -1, 2, 3 };
+
+
+static void sao_collect_sample(hevcasm_sao_statistics *stats, const uint8_t *orig, const uint8_t *rec, ptrdiff_t stride_rec, int edge_classes)
+{
+	const int diff = orig[0] - rec[0];
+
+	stats->band_diff[rec[0] >> 3] += diff;
+	++stats->band_count[rec[0] >> 3];
+
+	for (int eo_class = 0; eo_class < 4; ++eo_class)
+	{
+		if (!(edge_classes & (1 << eo_class))) continue;
+
+		const int(*pos)[2] = sao_edge_position[eo_class];
+		const int k = sao_edge_category[2
+			+ sign(rec[0] - rec[pos[0][0] + pos[0][1] * stride_rec])
+			+ sign(rec[0] - rec[pos[1][0] + pos[1][1] * stride_rec])];
+
+		if (k >= 0)
+		{
+			stats->edge_diff[eo_class][k] += diff;
+			++stats->edge_count[eo_class][k];
+		}
+	}
+}
+
+
+static void hevcasm_sao_collect_c_ref(hevcasm_sao_statistics *stats, const uint8_t *orig, ptrdiff_t stride_orig, const uint8_t *rec, ptrdiff_t stride_rec, int w, int h)
+{
+	for (int y = 0; y < h; ++y)
+	{
+		for (int x = 0; x < w; ++x)
+		{
+			sao_collect_sample(stats, &orig[x + y * stride_orig], &rec[x + y * stride_rec], stride_rec, 0xf);
+		}
+	}
+}
+
+
+#ifdef HEVCASM_X64
+
+hevcasm_sao_collect hevcasm_sao_collect_16n_sse2;
+hevcasm_sao_collect hevcasm_sao_collect_32n_avx2;
+
+static void hevcasm_sao_collect_sse2(hevcasm_sao_statistics *stats, const uint8_t *orig, ptrdiff_t stride_orig, const uint8_t *rec, ptrdiff_t stride_rec, int w, int h)
+{
+	const int w16 = w & ~15;
+	if (w16) hevcasm_sao_collect_16n_sse2(stats, orig, stride_orig, rec, stride_rec, w16, h);
+	if (w16 < w) hevcasm_sao_collect_c_ref(stats, orig + w16, stride_orig, rec + w16, stride_rec, w - w16, h);
+}
+
+static void hevcasm_sao_collect_avx2(hevcasm_sao_statistics *stats, const uint8_t *orig, ptrdiff_t stride_orig, const uint8_t *rec, ptrdiff_t stride_rec, int w, int h)
+{
+	const int w32 = w & ~31;
+	if (w32) hevcasm_sao_collect_32n_avx2(stats, orig, stride_orig, rec, stride_rec, w32, h);
+	if (w32 < w) hevcasm_sao_collect_sse2(stats, orig + w32, stride_orig, rec + w32, stride_rec, w - w32, h);
+}
+
+#endif
+
+
+void HEVCASM_API hevcasm_populate_sao_collect(hevcasm_table_sao_collect *table, hevcasm_instruction_set mask)
+{
+	*hevcasm_get_sao_collect(table) = 0;
+
+	if (mask & (HEVCASM_C_REF | HEVCASM_C_OPT))
+	{
+		*hevcasm_get_sao_collect(table) = hevcasm_sao_collect_c_ref;
+	}
+
+#ifdef HEVCASM_X64
+	if (mask & HEVCASM_SSE2)
+	{
+		*hevcasm_get_sao_collect(table) = hevcasm_sao_collect_sse2;
+	}
+
+	if (mask & HEVCASM_AVX2)
+	{
+		*hevcasm_get_sao_collect(table) = hevcasm_sao_collect_avx2;
+	}
+#endif
+}
+
+
+/* statistics of sample (x, y) of the CTB for those classes whose neighbours are available */
+static void sao_collect_boundary_sample(hevcasm_sao_statistics *stats, const uint8_t *orig, ptrdiff_t stride_orig, const uint8_t *rec, ptrdiff_t stride_rec, int x, int y, int w, int h, int available)
+{
+	int edge_classes = 0;
+	for (int eo_class = 0; eo_class < 4; ++eo_class)
+	{
+		if (sao_edge_usable(x, y, w, h, eo_class, available)) edge_classes |= 1 << eo_class;
+	}
+
+	sao_collect_sample(stats, &orig[x + y * stride_orig], &rec[x + y * stride_rec], stride_rec, edge_classes);
+}
+
+
+void HEVCASM_API hevcasm_sao_collect_ctb(hevcasm_table_sao_collect *table, hevcasm_sao_statistics *stats, const uint8_t *orig, ptrdiff_t stride_orig, const uint8_t *rec, ptrdiff_t stride_rec, int w, int h, int available)
+{
+	memset(stats, 0, sizeof(*stats));
+
+	if ((available & 0xff) == 0xff)
+	{
+		(*hevcasm_get_sao_collect(table))(stats, orig, stride_orig, rec, stride_rec, w, h);
+		return;
+	}
+
+	/* the kernel takes samples whose neighbours all lie within the CTB, the outermost ring is done per sample */
+	if (w > 2 && h > 2)
+	{
+		(*hevcasm_get_sao_collect(table))(stats, &orig[1 + stride_orig], stride_orig, &rec[1 + stride_rec], stride_rec, w - 2, h - 2);
+	}
+
+	for (int y = 0; y < h; ++y)
+	{
+		const int step = (y == 0 || y == h - 1 || w == 1) ? 1 : w - 1;
+		for (int x = 0; x < w; x += step)
+		{
+			sao_collect_boundary_sample(stats, orig, stride_orig, rec, stride_rec, x, y, w, h, available);
+		}
+	}
+}
+
+
+/* per-sample statistics of one CTB */
+static void sao_collect_ctb_reference(hevcasm_table_sao_collect *table, hevcasm_sao_statistics *stats, const uint8_t *orig, ptrdiff_t stride_orig, const uint8_t *rec, ptrdiff_t stride_rec, int w, int h, int available)
+{
+	memset(stats, 0, sizeof(*stats));
+
+	for (int y = 0; y < h; ++y)
+	{
+		for (int x = 0; x < w; ++x)
+		{
+			sao_collect_boundary_sample(stats, orig, stride_orig, rec, stride_rec, x, y, w, h, available);
+		}
+	}
+}
+
+
+typedef void sao_collect_ctb_function(hevcasm_table_sao_collect *table, hevcasm_sao_statistics *stats, const uint8_t *orig, ptrdiff_t stride_orig, const uint8_t *rec, ptrdiff_t stride_rec, int w, int h, int available);
+
+typedef struct
+{
+	const uint8_t *orig;
+	const uint8_t *rec;
+	int available[SAO_TEST_CASES];
+	int w[SAO_TEST_CASES];
+	int h[SAO_TEST_CASES];
+	hevcasm_table_sao_collect table;
+	sao_collect_ctb_function *f;
+	hevcasm_sao_statistics stats[SAO_TEST_CASES];
+}
+bound_sao_collect;
+
+
+int init_sao_collect(void *p, hevcasm_instruction_set mask)
+{
+	bound_sao_collect *s = p;
+
+	hevcasm_populate_sao_collect(&s->table, mask);
+
+	s->f = mask == HEVCASM_C_REF ? sao_collect_ctb_reference : hevcasm_sao_collect_ctb;
+
+	hevcasm_test_report_kernel(&s->table, sizeof(s->table), hevcasm_get_sao_collect(&s->table));
+
+	if (mask == HEVCASM_C_REF)
+	{
+		hevcasm_test_printf("\tall classes and bands : ");
+	}
+
+	return !!*hevcasm_get_sao_collect(&s->table);
+}
+
+
+void invoke_sao_collect(void *p, int n)
+{
+	bound_sao_collect *s = p;
+	while (n--)
+	{
+		for (int i = 0; i < SAO_TEST_CASES; ++i)
+		{
+			const ptrdiff_t offset = 16 + 16 * SAO_TEST_STRIDE;
+			s->f(&s->table, &s->stats[i], &s->orig[offset], SAO_TEST_STRIDE, &s->rec[offset], SAO_TEST_STRIDE, s->w[i], s->h[i], s->available[i]);
+		}
+	}
+}
+
+
+int mismatch_sao_collect(void *boundRef, void *boundTest)
+{
+	bound_sao_collect *ref = boundRef;
+	bound_sao_collect *test = boundTest;
+
+	return memcmp(ref->stats, test->stats, sizeof(ref->stats));
+}
+
+
+void HEVCASM_API hevcasm_test_sao_collect(int *error_count, hevcasm_instruction_set mask)
+{
+	hevcasm_test_printf("\nhevcasm_sao_collect - SAO encoder statistics of a CTB\n");
+
+	/* reconstructed picture as for hevcasm_test_sao(), original picture differs by mostly small errors */
+	uint8_t *rec = sao_test_picture();
+	uint8_t *orig = malloc(SAO_TEST_STRIDE * SAO_TEST_STRIDE);
+	for (int x = 0; x < SAO_TEST_STRIDE * SAO_TEST_STRIDE; ++x)
+	{
+		const int error = hevcasm_test_rand() % 16 ? hevcasm_test_rand() % 9 - 4 : hevcasm_test_rand() % 511 - 255;
+		orig[x] = clip1(rec[x] + error);
+	}
+
+	bound_sao_collect b[2];
+	b[0].orig = orig;
+	b[0].rec = rec;
+
+	for (int i = 0; i < SAO_TEST_CASES; ++i)
+	{
+		/* alternate cases have all neighbours available and so exercise the kernel over the whole CTB */
+		b[0].available[i] = (i & 1) ? 0xff : hevcasm_test_rand() & 0xff;
+		b[0].w[i] = sao_test_sizes[i][0];
+		b[0].h[i] = sao_test_sizes[i][1];
+	}
+
+	b[1] = b[0];
+	*error_count += hevcasm_test(&b[0], &b[1], init_sao_collect, invoke_sao_collect, mismatch_sao_collect, mask, 1000);
+
+	free(orig);
+	free(rec);
+}
+
+
+#undef SAO_TEST_STRIDE
+#undef SAO_TEST_CASES
@@ -0,0 +1,155 @@
+/*
+The copyright in this software is being made available under the BSD
+License, included below. This software may be subject to other third party
+and contributor rights, including patent rights, and no such rights are
+granted under this license.
+
+
+Copyright(c) 2011 - 2015, Parabola Research Limited
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met :
+
+* Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+this list of conditions and the following disclaimer in the documentation
+and / or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its contributors may
+be used to endorse or promote products derived from this software without
+specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/* HEVC sample adaptive offset (8-bit) */
+
+
+#ifndef INCLUDED_sao_h
+#define INCLUDED_sao_h
+
+#include "hevcasm.h"
+
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+// Kernels read deblocked samples from src and write to dst, which must not overlap src. offset[] is SaoOffsetVal[1..4].
+// Edge offset kernels read one sample beyond each side of the w x h block.
+
+typedef void hevcasm_sao_band(uint8_t *dst, ptrdiff_t stride_dst, const uint8_t *src, ptrdiff_t stride_src, int w, int h, int band_position, const int offset[4]);
+
+typedef void hevcasm_sao_edge(uint8_t *dst, ptrdiff_t stride_dst, const uint8_t *src, ptrdiff_t stride_src, int w, int h, const int offset[4]);
+
+typedef struct
+{
+	hevcasm_sao_band *band;
+	hevcasm_sao_edge *edge[4];
+}
+hevcasm_table_sao;
+
+static hevcasm_sao_band** hevcasm_get_sao_band(hevcasm_table_sao *table)
+{
+	return &table->band;
+}
+
+// eo_class: 0 horizontal, 1 vertical, 2 135 degree, 3 45 degree
+static hevcasm_sao_edge** hevcasm_get_sao_edge(hevcasm_table_sao *table, int eo_class)
+{
+	return &table->edge[eo_class];
+}
+
+void HEVCASM_API hevcasm_populate_sao(hevcasm_table_sao *table, hevcasm_instruction_set mask);
+
+
+#define HEVCASM_SAO_NONE 0
+#define HEVCASM_SAO_BAND 1
+#define HEVCASM_SAO_EDGE 2
+
+typedef struct
+{
+	int type; /* SaoTypeIdx */
+	int band_position; /* sao_band_position */
+	int eo_class; /* SaoEoClass */
+	int offset[4]; /* SaoOffsetVal[1..4] */
+}
+hevcasm_sao_parameters;
+
+// Neighbouring CTBs whose samples may be used by edge offset (in the picture, and in the same slice and tile or
+// with loop filtering across those boundaries enabled)
+#define HEVCASM_SAO_LEFT 0x1
+#define HEVCASM_SAO_RIGHT 0x2
+#define HEVCASM_SAO_ABOVE 0x4
+#define HEVCASM_SAO_BELOW 0x8
+#define HEVCASM_SAO_ABOVE_LEFT 0x10
+#define HEVCASM_SAO_ABOVE_RIGHT 0x20
+#define HEVCASM_SAO_BELOW_LEFT 0x40
+#define HEVCASM_SAO_BELOW_RIGHT 0x80
+
+// Applies SAO to one w x h CTB of a luma or chroma plane. src is the deblocked picture (or a copy of the CTB with
+// a one-sample border of deblocked neighbouring samples) and dst receives every sample of the CTB. Samples whose
+// edge offset neighbours lie in an unavailable CTB are copied unmodified. Samples of PCM or transquant-bypass
+// blocks that must not be modified are the responsibility of the caller.
+void HEVCASM_API hevcasm_sao_ctb(hevcasm_table_sao *table, uint8_t *dst, ptrdiff_t stride_dst, const uint8_t *src, ptrdiff_t stride_src, int w, int h, const hevcasm_sao_parameters *parameters, int available);
+
+void HEVCASM_API hevcasm_test_sao(int *error_count, hevcasm_instruction_set mask);
+
+
+/* Encoder statistics */
+
+// Sums of (original - reconstructed) and sample counts for every edge offset category of every class and for every
+// band, from which an encoder derives candidate offsets (diff / count) and their distortion change
+// (count * offset * offset - 2 * offset * diff).
+typedef struct
+{
+	int32_t edge_diff[4][4]; /* [SaoEoClass][edgeIdx - 1] */
+	int32_t edge_count[4][4];
+	int32_t band_diff[32]; /* [sample >> 3] */
+	int32_t band_count[32];
+}
+hevcasm_sao_statistics;
+
+// Adds statistics of all edge offset classes and all bands of a w x h block to stats in a single pass. rec is the
+// deblocked picture and is read one sample beyond each side of the block; all neighbouring samples are used.
+typedef void hevcasm_sao_collect(hevcasm_sao_statistics *stats, const uint8_t *orig, ptrdiff_t stride_orig, const uint8_t *rec, ptrdiff_t stride_rec, int w, int h);
+
+typedef struct
+{
+	hevcasm_sao_collect *p;
+}
+hevcasm_table_sao_collect;
+
+static hevcasm_sao_collect** hevcasm_get_sao_collect(hevcasm_table_sao_collect *table)
+{
+	return &table->p;
+}
+
+void HEVCASM_API hevcasm_populate_sao_collect(hevcasm_table_sao_collect *table, hevcasm_instruction_set mask);
+
+// Statistics of one w x h CTB, overwriting stats. available is as for hevcasm_sao_ctb(): edge offset statistics
+// exclude samples whose neighbour lies in an unavailable CTB. Encoders that collect statistics before the CTBs to
+// the right and below are deblocked should clear the corresponding bits.
+void HEVCASM_API hevcasm_sao_collect_ctb(hevcasm_table_sao_collect *table, hevcasm_sao_statistics *stats, const uint8_t *orig, ptrdiff_t stride_orig, const uint8_t *rec, ptrdiff_t stride_rec, int w, int h, int available);
+
+void HEVCASM_API hevcasm_test_sao_collect(int *error_count, hevcasm_instruction_set mask);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
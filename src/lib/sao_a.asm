@@ -0,0 +1,365 @@
+; The copyright in this software is being made available under the BSD
+; License, included below. This software may be subject to other third party
+; and contributor rights, including patent rights, and no such rights are
+; granted under this license.
+; 
+; 
+; Copyright(c) 2011 - 2015, Parabola Research Limited
+; All rights reserved.
+; 
+; Redistribution and use in source and binary forms, with or without
+; modification, are permitted provided that the following conditions are met :
+; 
+; * Redistributions of source code must retain the above copyright notice,
+; this list of conditions and the following disclaimer.
+; * Redistributions in binary form must reproduce the above copyright notice,
+; this list of conditions and the following disclaimer in the documentation
+; and / or other materials provided with the distribution.
+; * Neither the name of the copyright holder nor the names of its contributors may
+; be used to endorse or promote products derived from this software without
+; specific prior written permission.
+; 
+; THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+; AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+; IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+; ARE DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+; BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+; CONSEQUENTIAL DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+; SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+; INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+; CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE)
+; ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+; THE POSSIBILITY OF SUCH DAMAGE.
+
+
+%define private_prefix hevcasm
+%include "x86inc.asm"
+
+
+%if ARCH_X86_64 == 1
+
+SECTION_RODATA 32
+
+%macro CONSTANT 3
+	constant_times_%1_%2_%3:
+		times %1 %2 %3
+%endmacro
+
+CONSTANT 32, db, 0x80
+CONSTANT 32, db, 2
+CONSTANT 32, db, 0x1f
+CONSTANT 32, db, 4
+CONSTANT 32, db, 1
+CONSTANT 32, db, 3
+
+; SaoOffsetVal[1..4] bytes to offsets indexed by 2 + Sign(a) + Sign(b)
+constant_sao_edge_shuffle:
+	db 0, 1, 0x80, 2, 3
+	times 11 db 0x80
+
+; SaoOffsetVal[1..4] bytes to offsets indexed by band relative to sao_band_position, clamped to 4
+constant_sao_band_shuffle:
+	db 0, 1, 2, 3
+	times 12 db 0x80
+
+
+SECTION .text
+
+
+; m7 = table of signed byte offsets from the four dwords at [%1] using shuffle %2
+%macro SAO_OFFSETS 2
+	movu xm7, [%1]
+	packssdw xm7, xm7
+	packsswb xm7, xm7
+	pshufb xm7, [%2]
+%if mmsize == 32
+	vpbroadcastq m7, xm7
+%endif
+%endmacro
+
+
+; void hevcasm_sao_edge_%1_%2_xxx(uint8_t *dst, ptrdiff_t stride_dst, const uint8_t *src, ptrdiff_t stride_src, int w, int h, const int offset[4]);
+; w is a multiple of mmsize
+%macro SAO_EDGE 2
+cglobal sao_edge_%1_%2, 7, 11, 8
+	SAO_OFFSETS r6, constant_sao_edge_shuffle
+	mova m6, [constant_times_32_db_0x80]
+
+	; r7 = offset of neighbour a, neighbour b is at -r7
+%if %1 == 0
+	mov r7, -1
+%elif %1 == 1
+	mov r7, r3
+	neg r7
+%elif %1 == 2
+	lea r7, [r3 + 1]
+	neg r7
+%else
+	lea r7, [r3 - 1]
+	neg r7
+%endif
+	lea r8, [r2 + r7]
+	mov r9, r2
+	sub r9, r7
+.row:
+	xor r10d, r10d
+.column:
+		movu m0, [r2 + r10]
+		movu m1, [r8 + r10]
+		movu m2, [r9 + r10]
+		pxor m0, m6
+		pxor m1, m6
+		pxor m2, m6
+
+		; Sign(cur - a) + Sign(cur - b) with signed compares of biased samples
+		mova m3, m1
+		pcmpgtb m3, m0
+		mova m4, m0
+		pcmpgtb m4, m1
+		psubb m3, m4
+		mova m4, m2
+		pcmpgtb m4, m0
+		mova m5, m0
+		pcmpgtb m5, m2
+		psubb m4, m5
+		paddb m3, m4
+		paddb m3, [constant_times_32_db_2]
+
+		mova m4, m7
+		pshufb m4, m3
+		paddsb m0, m4
+		pxor m0, m6
+		movu [r0 + r10], m0
+
+		add r10, mmsize
+		cmp r10d, r4d
+		jl .column
+	add r0, r1
+	add r2, r3
+	add r8, r3
+	add r9, r3
+	dec r5d
+	jg .row
+	RET
+%endmacro
+
+
+; void hevcasm_sao_band_%1_xxx(uint8_t *dst, ptrdiff_t stride_dst, const uint8_t *src, ptrdiff_t stride_src, int w, int h, int band_position, const int offset[4]);
+; w is a multiple of mmsize
+%macro SAO_BAND 1
+cglobal sao_band_%1, 8, 9, 8
+	SAO_OFFSETS r7, constant_sao_band_shuffle
+	mova m6, [constant_times_32_db_0x80]
+	movd xm5, r6d
+	pxor m4, m4
+	pshufb xm5, xm4
+%if mmsize == 32
+	vpbroadcastq m5, xm5
+%endif
+.row:
+	xor r8d, r8d
+.column:
+		movu m0, [r2 + r8]
+
+		; (band - sao_band_position) & 31, clamped to 4 so that bands without an offset index zero
+		mova m1, m0
+		psrlw m1, 3
+		psubb m1, m5
+		pand m1, [constant_times_32_db_0x1f]
+		pminub m1, [constant_times_32_db_4]
+
+		mova m2, m7
+		pshufb m2, m1
+		pxor m0, m6
+		paddsb m0, m2
+		pxor m0, m6
+		movu [r0 + r8], m0
+
+		add r8, mmsize
+		cmp r8d, r4d
+		jl .column
+	add r0, r1
+	add r2, r3
+	dec r5d
+	jg .row
+	RET
+%endmacro
+
+
+; Statistics accumulators on the stack: per class and category one vector of dword sums of (orig - rec) followed by
+; one vector of qword counts, then four interleaved band histograms of 32 dword sums and 32 dword counts each
+%define SAO_EDGE_SUM(class, category) rsp + ((class) * 4 + (category)) * mmsize
+%define SAO_EDGE_COUNT(class, category) rsp + (16 + (class) * 4 + (category)) * mmsize
+%define SAO_BAND_HISTOGRAM(i) rsp + 32 * mmsize + (i) * 256
+
+
+; accumulate samples of class %1 whose edgeIdx - 1 is %2, m3 holds 2 + Sign(cur - a) + Sign(cur - b) and %3 the
+; value it must equal; m1 and m2 are (rec - orig) of the low and high samples of each lane
+%macro SAO_COLLECT_CATEGORY 3
+	pcmpeqb m4, m3, %3
+	pand m5, m4, m9
+	psadbw m5, m10
+	paddq m5, [SAO_EDGE_COUNT(%1, %2)]
+	mova [SAO_EDGE_COUNT(%1, %2)], m5
+	punpcklbw m5, m4, m4
+	pmaddwd m5, m1
+	punpckhbw m4, m4
+	pmaddwd m4, m2
+	paddd m4, m5
+	paddd m4, [SAO_EDGE_SUM(%1, %2)]
+	mova [SAO_EDGE_SUM(%1, %2)], m4
+%endmacro
+
+
+; edge offset class %1 with neighbours a at %2 and b at %3
+%macro SAO_COLLECT_CLASS 3
+	movu m4, %2
+	movu m5, %3
+	pxor m4, m8
+	pxor m5, m8
+	pcmpgtb m6, m0, m4
+	pcmpgtb m4, m0
+	psubb m4, m6
+	pcmpgtb m7, m0, m5
+	pcmpgtb m5, m0
+	psubb m5, m7
+	paddb m3, m4, m5
+	paddb m3, [constant_times_32_db_2]
+	SAO_COLLECT_CATEGORY %1, 0, m10
+	SAO_COLLECT_CATEGORY %1, 1, m9
+	SAO_COLLECT_CATEGORY %1, 2, m11
+	SAO_COLLECT_CATEGORY %1, 3, m12
+%endmacro
+
+
+; band statistics of sample %1 of the four at r9 into histogram %1
+%macro SAO_COLLECT_BAND 1
+	movzx r10d, byte [r3 + r9 + %1]
+	movzx r11d, byte [r1 + r9 + %1]
+	sub r11d, r10d
+	shr r10d, 3
+	add [SAO_BAND_HISTOGRAM(%1) + r10 * 4], r11d
+	add dword [SAO_BAND_HISTOGRAM(%1) + 128 + r10 * 4], 1
+%endmacro
+
+
+; void hevcasm_sao_collect_%1_xxx(hevcasm_sao_statistics *stats, const uint8_t *orig, ptrdiff_t stride_orig, const uint8_t *rec, ptrdiff_t stride_rec, int w, int h);
+; w is a multiple of mmsize
+; (one more GPR than used is declared: x86inc keeps the unaligned stack pointer in it for 32-byte alignment)
+%macro SAO_COLLECT 1
+cglobal sao_collect_%1, 7, 13, 13, 32 * mmsize + 4 * 256
+	pxor m10, m10
+	xor r9d, r9d
+.zero:
+		mova [rsp + r9], m10
+		add r9, mmsize
+		cmp r9d, 32 * mmsize + 4 * 256
+		jl .zero
+
+	mova m8, [constant_times_32_db_0x80]
+	mova m9, [constant_times_32_db_1]
+	mova m11, [constant_times_32_db_3]
+	mova m12, [constant_times_32_db_4]
+.row:
+	mov r7, r3
+	sub r7, r4
+	lea r8, [r3 + r4]
+	xor r9d, r9d
+.column:
+		movu m0, [r3 + r9]
+		movu m4, [r1 + r9]
+		punpcklbw m1, m0, m10
+		punpcklbw m5, m4, m10
+		psubw m1, m5
+		punpckhbw m2, m0, m10
+		punpckhbw m4, m10
+		psubw m2, m4
+		pxor m0, m8
+
+		; the category masks are -1, so the products accumulate (orig - rec)
+		SAO_COLLECT_CLASS 0, [r3 + r9 - 1], [r3 + r9 + 1]
+		SAO_COLLECT_CLASS 1, [r7 + r9], [r8 + r9]
+		SAO_COLLECT_CLASS 2, [r7 + r9 - 1], [r8 + r9 + 1]
+		SAO_COLLECT_CLASS 3, [r7 + r9 + 1], [r8 + r9 - 1]
+
+		add r9, mmsize
+		cmp r9d, r5d
+		jl .column
+
+	xor r9d, r9d
+.band:
+		SAO_COLLECT_BAND 0
+		SAO_COLLECT_BAND 1
+		SAO_COLLECT_BAND 2
+		SAO_COLLECT_BAND 3
+		add r9, 4
+		cmp r9d, r5d
+		jl .band
+
+	add r1, r2
+	add r3, r4
+	dec r6d
+	jg .row
+
+	; horizontal sums of the edge accumulators
+	xor r9d, r9d
+	xor r7d, r7d
+.edge:
+		mova m0, [rsp + r9]
+		mova m1, [rsp + r9 + 16 * mmsize]
+%if mmsize == 32
+		vextracti128 xm2, m0, 1
+		paddd xm0, xm2
+		vextracti128 xm2, m1, 1
+		paddq xm1, xm2
+%endif
+		pshufd xm2, xm0, 0x4e
+		paddd xm0, xm2
+		pshufd xm2, xm0, 0xb1
+		paddd xm0, xm2
+		pshufd xm2, xm1, 0x4e
+		paddq xm1, xm2
+		movd r10d, xm0
+		add [r0 + r7 * 4], r10d
+		movd r10d, xm1
+		add [r0 + 64 + r7 * 4], r10d
+		add r9, mmsize
+		inc r7d
+		cmp r7d, 16
+		jl .edge
+
+	; sum of the band histograms
+	xor r9d, r9d
+.histogram:
+		movu m0, [r0 + 128 + r9]
+		paddd m0, [SAO_BAND_HISTOGRAM(0) + r9]
+		paddd m0, [SAO_BAND_HISTOGRAM(1) + r9]
+		paddd m0, [SAO_BAND_HISTOGRAM(2) + r9]
+		paddd m0, [SAO_BAND_HISTOGRAM(3) + r9]
+		movu [r0 + 128 + r9], m0
+		add r9, mmsize
+		cmp r9d, 256
+		jl .histogram
+	RET
+%endmacro
+
+
+INIT_XMM ssse3
+SAO_EDGE 0, 16n
+SAO_EDGE 1, 16n
+SAO_EDGE 2, 16n
+SAO_EDGE 3, 16n
+SAO_BAND 16n
+
+INIT_XMM sse2
+SAO_COLLECT 16n
+
+INIT_YMM avx2
+SAO_EDGE 0, 32n
+SAO_EDGE 1, 32n
+SAO_EDGE 2, 32n
+SAO_EDGE 3, 32n
+SAO_BAND 32n
+SAO_COLLECT 32n
+
+%endif
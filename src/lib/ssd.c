@@ -58,38 +58,71 @@ static int hevcasm_ssd_c_ref(const uint8_t *pA, ptrdiff_t strideA, const uint8_t
 hevcasm_ssd hevcasm_ssd_16x16_avx;
 hevcasm_ssd hevcasm_ssd_32x32_avx;
 hevcasm_ssd hevcasm_ssd_64x64_avx;
+hevcasm_ssd hevcasm_ssd_4xh_sse2;
+hevcasm_ssd hevcasm_ssd_8nxh_sse2;
+hevcasm_ssd hevcasm_ssd_16nxh_avx2;
 
 
-void HEVCASM_API hevcasm_populate_ssd(hevcasm_table_ssd *table, hevcasm_instruction_set mask)
+static int hevcasm_ssd_12xh_sse2(const uint8_t *pA, ptrdiff_t strideA, const uint8_t *pB, ptrdiff_t strideB, int w, int h)
 {
-	*hevcasm_get_ssd(table, 2) = 0;
-	*hevcasm_get_ssd(table, 3) = 0;
-	*hevcasm_get_ssd(table, 4) = 0;
-	*hevcasm_get_ssd(table, 5) = 0;
-	*hevcasm_get_ssd(table, 6) = 0;
+	return hevcasm_ssd_8nxh_sse2(pA, strideA, pB, strideB, 8, h)
+		+ hevcasm_ssd_4xh_sse2(pA + 8, strideA, pB + 8, strideB, 4, h);
+}
+
+
+static hevcasm_ssd *get_ssd(int width, int height, hevcasm_instruction_set mask)
+{
+	hevcasm_ssd *f = 0;
 
 	if (mask & (HEVCASM_C_REF | HEVCASM_C_OPT))
 	{
-		*hevcasm_get_ssd(table, 2) = hevcasm_ssd_c_ref;
-		*hevcasm_get_ssd(table, 3) = hevcasm_ssd_c_ref;
-		*hevcasm_get_ssd(table, 4) = hevcasm_ssd_c_ref;
-		*hevcasm_get_ssd(table, 5) = hevcasm_ssd_c_ref;
-		*hevcasm_get_ssd(table, 6) = hevcasm_ssd_c_ref;
+		f = hevcasm_ssd_c_ref;
+	}
+
+	if (mask & HEVCASM_SSE2)
+	{
+		if (width == 4) f = hevcasm_ssd_4xh_sse2;
+		if (width == 12) f = hevcasm_ssd_12xh_sse2;
+		if (width % 8 == 0) f = hevcasm_ssd_8nxh_sse2;
 	}
 
 	if (mask & HEVCASM_AVX)
 	{
-		*hevcasm_get_ssd(table, 4) = hevcasm_ssd_16x16_avx;
-		*hevcasm_get_ssd(table, 5) = hevcasm_ssd_32x32_avx;
-		*hevcasm_get_ssd(table, 6) = hevcasm_ssd_64x64_avx;
+		if (width == height)
+		{
+			if (width == 16) f = hevcasm_ssd_16x16_avx;
+			if (width == 32) f = hevcasm_ssd_32x32_avx;
+			if (width == 64) f = hevcasm_ssd_64x64_avx;
+		}
+	}
+
+	if (mask & HEVCASM_AVX2)
+	{
+		if (width % 16 == 0) f = hevcasm_ssd_16nxh_avx2;
+	}
+
+	return f;
+}
+
+
+void HEVCASM_API hevcasm_populate_ssd(hevcasm_table_ssd *table, hevcasm_instruction_set mask)
+{
+	for (int height = 4; height <= 64; height += 4)
+	{
+		for (int width = 4; width <= 64; width += 4)
+		{
+			*hevcasm_get_ssd_rect(table, width, height) = get_ssd(width, height, mask);
+		}
 	}
 }
 
 
 typedef struct
 {
-	uint8_t *srcA, *srcB;
-	int log2TrafoSize;
+	HEVCASM_ALIGN(32, uint8_t, srcA[128 * 64]);
+	HEVCASM_ALIGN(32, uint8_t, srcB[128 * 64]);
+	int width;
+	int height;
 	int ssd;
 	hevcasm_ssd *f;
 }
@@ -104,12 +137,13 @@ int init_ssd(void *p, hevcasm_instruction_set mask)
 
 	hevcasm_populate_ssd(&table, mask);
 
-	s->f = *hevcasm_get_ssd(&table, s->log2TrafoSize);
+	hevcasm_ssd **entry = hevcasm_get_ssd_rect(&table, s->width, s->height);
+	hevcasm_test_report_kernel(&table, sizeof(table), entry);
+	s->f = *entry;
 
 	if (mask == HEVCASM_C_REF)
 	{
-		const int nCbS = 1 << s->log2TrafoSize;
-		printf("\t%dx%d : ", nCbS, nCbS);
+		hevcasm_test_printf("\t%dx%d : ", s->width, s->height);
 	}
 
 	return !!s->f;
@@ -119,10 +153,9 @@ int init_ssd(void *p, hevcasm_instruction_set mask)
 void invoke_ssd(void *p, int n)
 {
 	bound_ssd *s = p;
-	const int nCbS = 1 << s->log2TrafoSize;
 	while (n--)
 	{
-		s->ssd = s->f(s->srcA, 2*nCbS, s->srcB, 2*nCbS, nCbS, nCbS);
+		s->ssd = s->f(s->srcA, 128, s->srcB, 128, s->width, s->height);
 	}
 }
 
@@ -136,27 +169,170 @@ int mismatch_ssd(void *boundRef, void *boundTest)
 }
 
 
+static const int partitions[][2] = {
+	{ 64, 64 },{ 64, 48 },{ 64, 32 },{ 64, 16 },
+	{ 48, 64 },
+	{ 32, 64 },{ 32, 32 },{ 32, 24 },{ 32, 16 },{ 32, 8 },
+	{ 24, 32 },
+	{ 16, 64 },{ 16, 32 },{ 16, 16 },{ 16, 12 },{ 16, 8 },{ 16, 4 },
+	{ 12, 16 },
+	{ 8, 32 },{ 8, 16 },{ 8, 8 },{ 8, 4 },
+	{ 4, 16 },{ 4, 8 },{ 4, 4 },
+	{ 0, 0 } };
+
+
 void HEVCASM_API hevcasm_test_ssd(int *error_count, hevcasm_instruction_set mask)
 {
-	printf("\nhevcasm_ssd - Sum of Square Differences\n");
+	hevcasm_test_printf("\nhevcasm_ssd - Sum of Square Differences\n");
 
-	uint8_t  srcA[64 * 96];
-	uint8_t  srcB[64 * 96];
+	bound_ssd b[2];
 
-	for (int i = 0; i < 64 * 96; ++i)
+	for (int i = 0; i < 128 * 64; ++i)
 	{
-		srcA[i] = rand() & 0xff;
-		srcB[i] = rand() & 0xff;
+		b[0].srcA[i] = hevcasm_test_rand() & 0xff;
+		b[0].srcB[i] = hevcasm_test_rand() & 0xff;
 	}
 
-	bound_ssd b[2];
+	for (int i = 0; partitions[i][0]; ++i)
+	{
+		b[0].width = partitions[i][0];
+		b[0].height = partitions[i][1];
+		b[1] = b[0];
+		*error_count += hevcasm_test(&b[0], &b[1], init_ssd, invoke_ssd, mismatch_ssd, mask, 10000);
+	}
+}
+
+
+static int hevcasm_ssd_residual_c_ref(const int16_t *src, ptrdiff_t stride_src, int w, int h)
+{
+	int ssd = 0;
+	for (int y = 0; y < h; ++y)
+	{
+		for (int x = 0; x < w; ++x)
+		{
+			ssd += src[x + y * stride_src] * src[x + y * stride_src];
+		}
+	}
+	return ssd;
+}
+
+
+hevcasm_ssd_residual hevcasm_ssd_residual_4xh_sse2;
+hevcasm_ssd_residual hevcasm_ssd_residual_8nxh_sse2;
+hevcasm_ssd_residual hevcasm_ssd_residual_16nxh_avx2;
+
+
+static int hevcasm_ssd_residual_12xh_sse2(const int16_t *src, ptrdiff_t stride_src, int w, int h)
+{
+	return hevcasm_ssd_residual_8nxh_sse2(src, stride_src, 8, h)
+		+ hevcasm_ssd_residual_4xh_sse2(src + 8, stride_src, 4, h);
+}
+
+
+static hevcasm_ssd_residual *get_ssd_residual(int width, int height, hevcasm_instruction_set mask)
+{
+	hevcasm_ssd_residual *f = 0;
+
+	if (mask & (HEVCASM_C_REF | HEVCASM_C_OPT))
+	{
+		f = hevcasm_ssd_residual_c_ref;
+	}
+
+	if (mask & HEVCASM_SSE2)
+	{
+		if (width == 4) f = hevcasm_ssd_residual_4xh_sse2;
+		if (width == 12) f = hevcasm_ssd_residual_12xh_sse2;
+		if (width % 8 == 0) f = hevcasm_ssd_residual_8nxh_sse2;
+	}
+
+	if (mask & HEVCASM_AVX2)
+	{
+		if (width % 16 == 0) f = hevcasm_ssd_residual_16nxh_avx2;
+	}
+
+	return f;
+}
+
+
+void HEVCASM_API hevcasm_populate_ssd_residual(hevcasm_table_ssd_residual *table, hevcasm_instruction_set mask)
+{
+	for (int height = 4; height <= 64; height += 4)
+	{
+		for (int width = 4; width <= 64; width += 4)
+		{
+			*hevcasm_get_ssd_residual(table, width, height) = get_ssd_residual(width, height, mask);
+		}
+	}
+}
+
+
+typedef struct
+{
+	HEVCASM_ALIGN(32, int16_t, src[80 * 64]);
+	int width;
+	int height;
+	int ssd;
+	hevcasm_ssd_residual *f;
+}
+bound_ssd_residual;
+
+
+int init_ssd_residual(void *p, hevcasm_instruction_set mask)
+{
+	bound_ssd_residual *s = p;
+
+	hevcasm_table_ssd_residual table;
+
+	hevcasm_populate_ssd_residual(&table, mask);
 
-	b[0].srcA = srcA;
-	b[0].srcB = srcB;
+	hevcasm_ssd_residual **entry = hevcasm_get_ssd_residual(&table, s->width, s->height);
+	hevcasm_test_report_kernel(&table, sizeof(table), entry);
+	s->f = *entry;
+
+	if (mask == HEVCASM_C_REF)
+	{
+		hevcasm_test_printf("\t%dx%d : ", s->width, s->height);
+	}
+
+	return !!s->f;
+}
+
+
+void invoke_ssd_residual(void *p, int n)
+{
+	bound_ssd_residual *s = p;
+	while (n--)
+	{
+		s->ssd = s->f(s->src, 80, s->width, s->height);
+	}
+}
+
+
+int mismatch_ssd_residual(void *boundRef, void *boundTest)
+{
+	bound_ssd_residual *ref = boundRef;
+	bound_ssd_residual *test = boundTest;
+
+	return ref->ssd != test->ssd;
+}
+
+
+void HEVCASM_API hevcasm_test_ssd_residual(int *error_count, hevcasm_instruction_set mask)
+{
+	hevcasm_test_printf("\nhevcasm_ssd_residual - Sum of Squares of residual\n");
+
+	bound_ssd_residual b[2];
+
+	for (int i = 0; i < 80 * 64; ++i)
+	{
+		b[0].src[i] = (hevcasm_test_rand() & 0x1ff) - 0xff;
+	}
 
-	for (b[0].log2TrafoSize = 2; b[0].log2TrafoSize <= 6; ++b[0].log2TrafoSize)
+	for (int i = 0; partitions[i][0]; ++i)
 	{
+		b[0].width = partitions[i][0];
+		b[0].height = partitions[i][1];
 		b[1] = b[0];
-		*error_count += hevcasm_test(&b[0], &b[1], init_ssd, invoke_ssd, mismatch_ssd, mask, 100000);
+		*error_count += hevcasm_test(&b[0], &b[1], init_ssd_residual, invoke_ssd_residual, mismatch_ssd_residual, mask, 10000);
 	}
 }
@@ -54,13 +54,18 @@ typedef int hevcasm_ssd(const uint8_t *srcA, ptrdiff_t stride_srcA, const uint8_
 
 typedef struct
 {
-	hevcasm_ssd *satd[5];
+	hevcasm_ssd *lookup[16][16];
 }
 hevcasm_table_ssd;
 
+static hevcasm_ssd** hevcasm_get_ssd_rect(hevcasm_table_ssd *table, int width, int height)
+{
+	return &table->lookup[(width >> 2) - 1][(height >> 2) - 1];
+}
+
 static hevcasm_ssd** hevcasm_get_ssd(hevcasm_table_ssd *table, int log2TrafoSize)
 {
-	return &table->satd[log2TrafoSize - 2];
+	return hevcasm_get_ssd_rect(table, 1 << log2TrafoSize, 1 << log2TrafoSize);
 }
 
 void HEVCASM_API hevcasm_populate_ssd(hevcasm_table_ssd *table, hevcasm_instruction_set mask);
@@ -68,6 +73,26 @@ void HEVCASM_API hevcasm_populate_ssd(hevcasm_table_ssd *table, hevcasm_instruct
 void HEVCASM_API hevcasm_test_ssd(int *error_count, hevcasm_instruction_set mask);
 
 
+/* Sum of squares of an int16 residual block (SSD against zero), e.g. for RDO on an already computed residual.
+stride_src is in samples. Valid while the result fits in an int, as it does for 8-bit residuals of any block up to 64x64. */
+typedef int hevcasm_ssd_residual(const int16_t *src, ptrdiff_t stride_src, int w, int h);
+
+typedef struct
+{
+	hevcasm_ssd_residual *lookup[16][16];
+}
+hevcasm_table_ssd_residual;
+
+static hevcasm_ssd_residual** hevcasm_get_ssd_residual(hevcasm_table_ssd_residual *table, int width, int height)
+{
+	return &table->lookup[(width >> 2) - 1][(height >> 2) - 1];
+}
+
+void HEVCASM_API hevcasm_populate_ssd_residual(hevcasm_table_ssd_residual *table, hevcasm_instruction_set mask);
+
+void HEVCASM_API hevcasm_test_ssd_residual(int *error_count, hevcasm_instruction_set mask);
+
+
 #ifdef __cplusplus
 }
 #endif
@@ -183,3 +183,134 @@ cglobal ssd_64x64, 6, 6, 6
 	paddd m0, m1
     movd   eax, m0
 	RET
+
+
+; horizontal sum of the dwords in m0, result in eax
+%macro SSD_REDUCE 0
+%if mmsize == 32
+	vextracti128 xm1, m0, 1
+	paddd xm0, xm1
+%endif
+	pshufd xm1, xm0, ORDER(3, 2, 3, 2)
+	paddd xm0, xm1
+	pshufd xm1, xm0, ORDER(3, 2, 0, 1)
+	paddd xm0, xm1
+	movd eax, xm0
+%endmacro
+
+
+; Sum of square differences, two rows per iteration, h must be even
+; extern "C" int ssd_4xh_sse2(const uint8_t *srcA, ptrdiff_t stride_srcA, const uint8_t *srcB, ptrdiff_t stride_srcB, int w, int h)
+
+INIT_XMM sse2
+cglobal ssd_4xh, 6, 6, 5
+	pxor m0, m0
+	pxor m3, m3
+.loop:
+		movd m1, [r0]
+		movd m4, [r0 + r1]
+		punpckldq m1, m4
+		movd m2, [r2]
+		movd m4, [r2 + r3]
+		punpckldq m2, m4
+		punpcklbw m1, m3
+		punpcklbw m2, m3
+		psubw m1, m2
+		pmaddwd m1, m1
+		paddd m0, m1
+		lea r0, [r0 + 2 * r1]
+		lea r2, [r2 + 2 * r3]
+		sub r5d, 2
+		jg .loop
+	SSD_REDUCE
+	RET
+
+
+; Sum of square differences, w a multiple of mmsize / 2: 8 samples per step (SSE2) or 16 samples per step (AVX2)
+; extern "C" int ssd_8nxh_sse2(const uint8_t *srcA, ptrdiff_t stride_srcA, const uint8_t *srcB, ptrdiff_t stride_srcB, int w, int h)
+; extern "C" int ssd_16nxh_avx2(const uint8_t *srcA, ptrdiff_t stride_srcA, const uint8_t *srcB, ptrdiff_t stride_srcB, int w, int h)
+
+%macro SSD_NXH 1
+cglobal ssd_%1nxh, 6, 7, 4
+	pxor m0, m0
+	pxor m3, m3
+.row:
+		xor r6d, r6d
+.column:
+%if mmsize == 32
+			pmovzxbw m1, [r0 + r6]
+			pmovzxbw m2, [r2 + r6]
+%else
+			movq m1, [r0 + r6]
+			movq m2, [r2 + r6]
+			punpcklbw m1, m3
+			punpcklbw m2, m3
+%endif
+			psubw m1, m2
+			pmaddwd m1, m1
+			paddd m0, m1
+			add r6d, mmsize / 2
+			cmp r6d, r4d
+			jl .column
+		add r0, r1
+		add r2, r3
+		dec r5d
+		jg .row
+	SSD_REDUCE
+	RET
+%endmacro
+
+INIT_XMM sse2
+SSD_NXH 8
+INIT_YMM avx2
+SSD_NXH 16
+
+
+; Sum of squares of int16 residual, two rows per iteration, h must be even
+; extern "C" int ssd_residual_4xh_sse2(const int16_t *src, ptrdiff_t stride_src, int w, int h)
+
+INIT_XMM sse2
+cglobal ssd_residual_4xh, 4, 4, 3
+	add r1, r1
+	pxor m0, m0
+.loop:
+		movq m1, [r0]
+		movhps m1, [r0 + r1]
+		pmaddwd m1, m1
+		paddd m0, m1
+		lea r0, [r0 + 2 * r1]
+		sub r3d, 2
+		jg .loop
+	SSD_REDUCE
+	RET
+
+
+; Sum of squares of int16 residual, w a multiple of mmsize / 2
+; extern "C" int ssd_residual_8nxh_sse2(const int16_t *src, ptrdiff_t stride_src, int w, int h)
+; extern "C" int ssd_residual_16nxh_avx2(const int16_t *src, ptrdiff_t stride_src, int w, int h)
+
+%macro SSD_RESIDUAL_NXH 1
+cglobal ssd_residual_%1nxh, 4, 5, 3
+	add r1, r1
+	add r2d, r2d
+	pxor m0, m0
+.row:
+		xor r4d, r4d
+.column:
+			movu m1, [r0 + r4]
+			pmaddwd m1, m1
+			paddd m0, m1
+			add r4d, mmsize
+			cmp r4d, r2d
+			jl .column
+		add r0, r1
+		dec r3d
+		jg .row
+	SSD_REDUCE
+	RET
+%endmacro
+
+INIT_XMM sse2
+SSD_RESIDUAL_NXH 8
+INIT_YMM avx2
+SSD_RESIDUAL_NXH 16
@@ -0,0 +1,141 @@
+/*
+The copyright in this software is being made available under the BSD
+License, included below. This software may be subject to other third party
+and contributor rights, including patent rights, and no such rights are
+granted under this license.
+
+
+Copyright(c) 2011 - 2015, Parabola Research Limited
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met :
+
+* Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+this list of conditions and the following disclaimer in the documentation
+and / or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its contributors may
+be used to endorse or promote products derived from this software without
+specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "static_dispatch.h"
+#include "context.h"
+#include "hevcasm_test.h"
+
+#include <stdlib.h>
+
+
+/* Counts a selection that differs from the runtime table and, at the level targeted by the build, one made without reading the table */
+#define STATIC_DISPATCH_CHECK(name, ...) \
+	{ \
+		if (*hevcasm_static_select_ ## name(level, __VA_ARGS__) != *hevcasm_get_ ## name(__VA_ARGS__)) ++errors; \
+		if (level == HEVCASM_STATIC_LEVEL) \
+		{ \
+			if ((const void *)hevcasm_static_get_ ## name(__VA_ARGS__) != (const void *)hevcasm_get_ ## name(__VA_ARGS__)) ++direct; \
+			++selections; \
+		} \
+	}
+
+
+void HEVCASM_API hevcasm_test_static_dispatch(int *error_count, hevcasm_instruction_set mask)
+{
+	hevcasm_test_printf("\nhevcasm_static_dispatch - compile-time kernel selection\n");
+
+	int selections = 0;
+	int direct = 0;
+
+	hevcasm_context *context = malloc(sizeof(hevcasm_context));
+
+	/* at every level, the selectors must agree with tables populated for that instruction set and those below it */
+	for (int level = 1; level < HEVCASM_INSTRUCTION_SET_COUNT; ++level)
+	{
+		int errors = 0;
+
+		hevcasm_populate_context(context, (hevcasm_instruction_set)((2 << level) - 1));
+
+		for (int height = 4; height <= 64; height += 4)
+		{
+			for (int width = 4; width <= 64; width += 4)
+			{
+				STATIC_DISPATCH_CHECK(sad, &context->sad, width, height)
+				STATIC_DISPATCH_CHECK(sad_multiref, &context->sad_multiref, 4, width, height)
+				STATIC_DISPATCH_CHECK(ssd_rect, &context->ssd, width, height)
+				STATIC_DISPATCH_CHECK(ssd_residual, &context->ssd_residual, width, height)
+			}
+		}
+
+		for (int log2TrafoSize = 1; log2TrafoSize <= 3; ++log2TrafoSize)
+		{
+			STATIC_DISPATCH_CHECK(hadamard_satd, &context->hadamard_satd, log2TrafoSize)
+		}
+
+		STATIC_DISPATCH_CHECK(quantize_inverse, &context->quantize_inverse)
+		STATIC_DISPATCH_CHECK(quantize, &context->quantize)
+
+		for (int log2TrafoSize = 2; log2TrafoSize <= 5; ++log2TrafoSize)
+		{
+			STATIC_DISPATCH_CHECK(ssd, &context->ssd, log2TrafoSize)
+			STATIC_DISPATCH_CHECK(quantize_reconstruct, &context->quantize_reconstruct, log2TrafoSize)
+			STATIC_DISPATCH_CHECK(transform_domain_ssd, &context->transform_domain_ssd, log2TrafoSize)
+			STATIC_DISPATCH_CHECK(inverse_transform_add, &context->inverse_transform_add, 0, log2TrafoSize)
+			STATIC_DISPATCH_CHECK(inverse_transform_add, &context->inverse_transform_add_encoder, 0, log2TrafoSize)
+			STATIC_DISPATCH_CHECK(transform, &context->transform, 0, log2TrafoSize)
+			STATIC_DISPATCH_CHECK(transform_skip, &context->transform_skip, 0, log2TrafoSize)
+			STATIC_DISPATCH_CHECK(inverse_transform_skip_add, &context->inverse_transform_skip_add, 0, log2TrafoSize)
+			STATIC_DISPATCH_CHECK(transquant_bypass_add, &context->transquant_bypass_add, 0, log2TrafoSize)
+		}
+
+		STATIC_DISPATCH_CHECK(inverse_transform_add, &context->inverse_transform_add, 1, 2)
+		STATIC_DISPATCH_CHECK(inverse_transform_add, &context->inverse_transform_add_encoder, 1, 2)
+		STATIC_DISPATCH_CHECK(transform, &context->transform, 1, 2)
+		STATIC_DISPATCH_CHECK(transform_skip, &context->transform_skip, 1, 2)
+		STATIC_DISPATCH_CHECK(inverse_transform_skip_add, &context->inverse_transform_skip_add, 1, 2)
+		STATIC_DISPATCH_CHECK(transquant_bypass_add, &context->transquant_bypass_add, 1, 2)
+
+		STATIC_DISPATCH_CHECK(residual_scan, &context->residual_scan)
+		STATIC_DISPATCH_CHECK(residual_unscan, &context->residual_unscan)
+		STATIC_DISPATCH_CHECK(residual_rate_sub_blocks, &context->residual_rate_sub_blocks)
+		STATIC_DISPATCH_CHECK(deblock_bs, &context->deblock_bs, 0)
+		STATIC_DISPATCH_CHECK(deblock_bs, &context->deblock_bs, 1)
+
+		hevcasm_test_printf("\t%s precedence%s\n", hevcasm_instruction_set_as_text(1 << level), errors ? "-MISMATCH" : " : ok");
+
+		*error_count += errors;
+	}
+
+	free(context);
+
+#ifdef HEVCASM_STATIC_DISPATCH
+	/* statically selected kernels are called without checking the processor */
+	const int unsupported = (mask & HEVCASM_STATIC_MASK) != HEVCASM_STATIC_MASK;
+
+	hevcasm_test_printf("\ttarget %s: %d of %d selections direct%s\n", hevcasm_instruction_set_as_text(1 << HEVCASM_STATIC_DISPATCH), direct, selections, unsupported ? "-MISMATCH" : "");
+
+	*error_count += unsupported;
+#else
+	hevcasm_test_printf("\truntime dispatch build: %d of %d selections direct\n", direct, selections);
+#endif
+}
+
+
+#undef STATIC_DISPATCH_CHECK
@@ -0,0 +1,499 @@
+/*
+The copyright in this software is being made available under the BSD
+License, included below. This software may be subject to other third party
+and contributor rights, including patent rights, and no such rights are
+granted under this license.
+
+
+Copyright(c) 2011 - 2015, Parabola Research Limited
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met :
+
+* Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+this list of conditions and the following disclaimer in the documentation
+and / or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its contributors may
+be used to endorse or promote products derived from this software without
+specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/* Static (compile-time) dispatch: direct-call kernel selection for builds targeting a known instruction set */
+
+
+#ifndef INCLUDED_static_dispatch_h
+#define INCLUDED_static_dispatch_h
+
+#include "hevcasm.h"
+#include "cabac.h"
+#include "deblock.h"
+#include "hadamard.h"
+#include "quantize.h"
+#include "residual_decode.h"
+#include "sad.h"
+#include "ssd.h"
+#include "quantize_a.h"
+#include "residual_decode_a.h"
+#include "sad_a.h"
+
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+// HEVCASM_STATIC_DISPATCH, if defined, is the HEVCASM_INSTRUCTION_SET_XMACRO value of the instruction set targeted by
+// the build, e.g. 8 for AVX2. configure --with-static-dispatch=<set> defines it in config.h, which the library's own
+// sources include before this header; this header does not include config.h, so other users define it on the compiler
+// command line. The processor must support it and every set below it.
+//
+// hevcasm_static_get_<name>() take the same arguments as hevcasm_get_<name>() and are meant for call sites: the entry
+// they return must not be written. Where precedence over the target and lower sets selects an assembly kernel, it is
+// a constant, so that calls through it are direct and, with link-time optimisation, may be inlined. Otherwise they
+// read table, which must be populated as usual (e.g. hevcasm_get_context()). Without HEVCASM_STATIC_DISPATCH every
+// selection reads table.
+//
+// Selectors cover SAD, SSD, SATD, quantization, transforms, transform skip, transquant bypass, residual coding and
+// deblocking boundary strength. Intra and inter prediction have none: their tables are indexed by many parameters
+// and many entries are C wrappers combining several kernels, so call sites use hevcasm_get_*() as before.
+//
+// hevcasm_static_select_<name>() make the same selection for a given level; hevcasm_test_static_dispatch checks them
+// against hevcasm_populate_*() at every level, whichever level the build targets.
+#ifdef HEVCASM_STATIC_DISPATCH
+#define HEVCASM_STATIC_LEVEL HEVCASM_STATIC_DISPATCH
+#else
+#define HEVCASM_STATIC_LEVEL 1
+#endif
+
+// Instruction sets that the selectors may assume, as passed to hevcasm_populate_*()
+#define HEVCASM_STATIC_MASK ((hevcasm_instruction_set)((2 << HEVCASM_STATIC_LEVEL) - 1))
+
+#define HEVCASM_STATIC_KERNEL(type, f) \
+	{ static type *const kernel = (type *)&f; return &kernel; }
+
+
+typedef unsigned int hevcasm_static_vp9_sad(const uint8_t *src_ptr, int source_stride, const uint8_t *ref_ptr, int ref_stride);
+typedef void hevcasm_static_vp9_sad_x4d(const uint8_t *src_ptr, int src_stride, const uint8_t* const ref_ptr[], int ref_stride, unsigned int *sad_array);
+
+hevcasm_static_vp9_sad vp9_sad64x64_sse2, vp9_sad64x32_sse2, vp9_sad32x64_sse2, vp9_sad32x32_sse2, vp9_sad32x16_sse2,
+	vp9_sad16x32_sse2, vp9_sad16x16_sse2, vp9_sad16x8_sse2, vp9_sad8x16_sse2, vp9_sad8x8_sse2, vp9_sad8x4_sse2;
+
+hevcasm_static_vp9_sad_x4d vp9_sad64x64x4d_sse2, vp9_sad64x32x4d_sse2, vp9_sad32x64x4d_sse2, vp9_sad32x32x4d_sse2,
+	vp9_sad32x16x4d_sse2, vp9_sad16x32x4d_sse2, vp9_sad16x16x4d_sse2, vp9_sad16x8x4d_sse2, vp9_sad8x16x4d_sse2,
+	vp9_sad8x8x4d_sse2, vp9_sad8x4x4d_sse2;
+
+hevcasm_ssd hevcasm_ssd_16x16_avx;
+hevcasm_ssd hevcasm_ssd_32x32_avx;
+hevcasm_ssd hevcasm_ssd_64x64_avx;
+hevcasm_ssd hevcasm_ssd_4xh_sse2;
+hevcasm_ssd hevcasm_ssd_8nxh_sse2;
+hevcasm_ssd hevcasm_ssd_16nxh_avx2;
+
+hevcasm_ssd_residual hevcasm_ssd_residual_4xh_sse2;
+hevcasm_ssd_residual hevcasm_ssd_residual_8nxh_sse2;
+hevcasm_ssd_residual hevcasm_ssd_residual_16nxh_avx2;
+
+hevcasm_hadamard_satd hevcasm_hadamard_satd_4x4_sse2;
+hevcasm_hadamard_satd hevcasm_hadamard_satd_8x8_avx2;
+
+
+static hevcasm_sad *const *hevcasm_static_select_sad(int level, hevcasm_table_sad *table, int width, int height)
+{
+	if (level >= 2 /* SSE2 */) switch (HEVCASM_RECT(width, height))
+	{
+	case HEVCASM_RECT(64, 64): HEVCASM_STATIC_KERNEL(hevcasm_sad, vp9_sad64x64_sse2)
+	case HEVCASM_RECT(64, 32): HEVCASM_STATIC_KERNEL(hevcasm_sad, vp9_sad64x32_sse2)
+	case HEVCASM_RECT(32, 64): HEVCASM_STATIC_KERNEL(hevcasm_sad, vp9_sad32x64_sse2)
+	case HEVCASM_RECT(32, 32): HEVCASM_STATIC_KERNEL(hevcasm_sad, vp9_sad32x32_sse2)
+	case HEVCASM_RECT(32, 16): HEVCASM_STATIC_KERNEL(hevcasm_sad, vp9_sad32x16_sse2)
+	case HEVCASM_RECT(16, 32): HEVCASM_STATIC_KERNEL(hevcasm_sad, vp9_sad16x32_sse2)
+	case HEVCASM_RECT(16, 16): HEVCASM_STATIC_KERNEL(hevcasm_sad, vp9_sad16x16_sse2)
+	case HEVCASM_RECT(16, 8): HEVCASM_STATIC_KERNEL(hevcasm_sad, vp9_sad16x8_sse2)
+	case HEVCASM_RECT(8, 16): HEVCASM_STATIC_KERNEL(hevcasm_sad, vp9_sad8x16_sse2)
+	case HEVCASM_RECT(8, 8): HEVCASM_STATIC_KERNEL(hevcasm_sad, vp9_sad8x8_sse2)
+	case HEVCASM_RECT(8, 4): HEVCASM_STATIC_KERNEL(hevcasm_sad, vp9_sad8x4_sse2)
+	default:;
+	}
+	return hevcasm_get_sad(table, width, height);
+}
+
+static hevcasm_sad *const *hevcasm_static_get_sad(hevcasm_table_sad *table, int width, int height)
+{
+	return hevcasm_static_select_sad(HEVCASM_STATIC_LEVEL, table, width, height);
+}
+
+
+static hevcasm_sad_multiref *const *hevcasm_static_select_sad_multiref(int level, hevcasm_table_sad_multiref *table, int ways, int width, int height)
+{
+	if (ways != 4) return 0;
+	if (level >= 8 /* AVX2 */) switch (width)
+	{
+	case 64: HEVCASM_STATIC_KERNEL(hevcasm_sad_multiref, hevcasm_sad_multiref_4_64xh_avx2)
+	case 48: HEVCASM_STATIC_KERNEL(hevcasm_sad_multiref, hevcasm_sad_multiref_4_48xh_avx2)
+	case 32: HEVCASM_STATIC_KERNEL(hevcasm_sad_multiref, hevcasm_sad_multiref_4_32xh_avx2)
+	case 24: HEVCASM_STATIC_KERNEL(hevcasm_sad_multiref, hevcasm_sad_multiref_4_24xh_avx2)
+	case 16: HEVCASM_STATIC_KERNEL(hevcasm_sad_multiref, hevcasm_sad_multiref_4_16xh_avx2)
+	case 12: HEVCASM_STATIC_KERNEL(hevcasm_sad_multiref, hevcasm_sad_multiref_4_12xh_avx2)
+	case 8: if (height != 4 && height != 8 && height != 16) HEVCASM_STATIC_KERNEL(hevcasm_sad_multiref, hevcasm_sad_multiref_4_8xh_avx2) break;
+	case 4: HEVCASM_STATIC_KERNEL(hevcasm_sad_multiref, hevcasm_sad_multiref_4_4xh_avx2)
+	default:;
+	}
+	if (level >= 2 /* SSE2 */) switch (HEVCASM_RECT(width, height))
+	{
+	case HEVCASM_RECT(64, 64): HEVCASM_STATIC_KERNEL(hevcasm_sad_multiref, vp9_sad64x64x4d_sse2)
+	case HEVCASM_RECT(64, 32): HEVCASM_STATIC_KERNEL(hevcasm_sad_multiref, vp9_sad64x32x4d_sse2)
+	case HEVCASM_RECT(32, 64): HEVCASM_STATIC_KERNEL(hevcasm_sad_multiref, vp9_sad32x64x4d_sse2)
+	case HEVCASM_RECT(32, 32): HEVCASM_STATIC_KERNEL(hevcasm_sad_multiref, vp9_sad32x32x4d_sse2)
+	case HEVCASM_RECT(32, 16): HEVCASM_STATIC_KERNEL(hevcasm_sad_multiref, vp9_sad32x16x4d_sse2)
+	case HEVCASM_RECT(16, 32): HEVCASM_STATIC_KERNEL(hevcasm_sad_multiref, vp9_sad16x32x4d_sse2)
+	case HEVCASM_RECT(16, 16): HEVCASM_STATIC_KERNEL(hevcasm_sad_multiref, vp9_sad16x16x4d_sse2)
+	case HEVCASM_RECT(16, 8): HEVCASM_STATIC_KERNEL(hevcasm_sad_multiref, vp9_sad16x8x4d_sse2)
+	case HEVCASM_RECT(8, 16): HEVCASM_STATIC_KERNEL(hevcasm_sad_multiref, vp9_sad8x16x4d_sse2)
+	case HEVCASM_RECT(8, 8): HEVCASM_STATIC_KERNEL(hevcasm_sad_multiref, vp9_sad8x8x4d_sse2)
+	case HEVCASM_RECT(8, 4): HEVCASM_STATIC_KERNEL(hevcasm_sad_multiref, vp9_sad8x4x4d_sse2)
+	default:;
+	}
+	return hevcasm_get_sad_multiref(table, ways, width, height);
+}
+
+static hevcasm_sad_multiref *const *hevcasm_static_get_sad_multiref(hevcasm_table_sad_multiref *table, int ways, int width, int height)
+{
+	return hevcasm_static_select_sad_multiref(HEVCASM_STATIC_LEVEL, table, ways, width, height);
+}
+
+
+static hevcasm_ssd *const *hevcasm_static_select_ssd_rect(int level, hevcasm_table_ssd *table, int width, int height)
+{
+	if (level >= 8 /* AVX2 */)
+	{
+		if (width % 16 == 0) HEVCASM_STATIC_KERNEL(hevcasm_ssd, hevcasm_ssd_16nxh_avx2)
+	}
+	if (level >= 7 /* AVX */ && width == height)
+	{
+		if (width == 16) HEVCASM_STATIC_KERNEL(hevcasm_ssd, hevcasm_ssd_16x16_avx)
+		if (width == 32) HEVCASM_STATIC_KERNEL(hevcasm_ssd, hevcasm_ssd_32x32_avx)
+		if (width == 64) HEVCASM_STATIC_KERNEL(hevcasm_ssd, hevcasm_ssd_64x64_avx)
+	}
+	if (level >= 2 /* SSE2 */)
+	{
+		if (width == 4) HEVCASM_STATIC_KERNEL(hevcasm_ssd, hevcasm_ssd_4xh_sse2)
+		if (width % 8 == 0) HEVCASM_STATIC_KERNEL(hevcasm_ssd, hevcasm_ssd_8nxh_sse2)
+	}
+	return hevcasm_get_ssd_rect(table, width, height);
+}
+
+static hevcasm_ssd *const *hevcasm_static_get_ssd_rect(hevcasm_table_ssd *table, int width, int height)
+{
+	return hevcasm_static_select_ssd_rect(HEVCASM_STATIC_LEVEL, table, width, height);
+}
+
+static hevcasm_ssd *const *hevcasm_static_select_ssd(int level, hevcasm_table_ssd *table, int log2TrafoSize)
+{
+	return hevcasm_static_select_ssd_rect(level, table, 1 << log2TrafoSize, 1 << log2TrafoSize);
+}
+
+static hevcasm_ssd *const *hevcasm_static_get_ssd(hevcasm_table_ssd *table, int log2TrafoSize)
+{
+	return hevcasm_static_select_ssd(HEVCASM_STATIC_LEVEL, table, log2TrafoSize);
+}
+
+
+static hevcasm_ssd_residual *const *hevcasm_static_select_ssd_residual(int level, hevcasm_table_ssd_residual *table, int width, int height)
+{
+	if (level >= 8 /* AVX2 */)
+	{
+		if (width % 16 == 0) HEVCASM_STATIC_KERNEL(hevcasm_ssd_residual, hevcasm_ssd_residual_16nxh_avx2)
+	}
+	if (level >= 2 /* SSE2 */)
+	{
+		if (width == 4) HEVCASM_STATIC_KERNEL(hevcasm_ssd_residual, hevcasm_ssd_residual_4xh_sse2)
+		if (width % 8 == 0) HEVCASM_STATIC_KERNEL(hevcasm_ssd_residual, hevcasm_ssd_residual_8nxh_sse2)
+	}
+	return hevcasm_get_ssd_residual(table, width, height);
+}
+
+static hevcasm_ssd_residual *const *hevcasm_static_get_ssd_residual(hevcasm_table_ssd_residual *table, int width, int height)
+{
+	return hevcasm_static_select_ssd_residual(HEVCASM_STATIC_LEVEL, table, width, height);
+}
+
+
+static hevcasm_hadamard_satd *const *hevcasm_static_select_hadamard_satd(int level, hevcasm_table_hadamard_satd *table, int log2TrafoSize)
+{
+#ifdef HEVCASM_X64
+	if (level >= 8 /* AVX2 */)
+	{
+		if (log2TrafoSize == 3) HEVCASM_STATIC_KERNEL(hevcasm_hadamard_satd, hevcasm_hadamard_satd_8x8_avx2)
+	}
+	if (level >= 2 /* SSE2 */)
+	{
+		if (log2TrafoSize == 2) HEVCASM_STATIC_KERNEL(hevcasm_hadamard_satd, hevcasm_hadamard_satd_4x4_sse2)
+	}
+#endif
+	return hevcasm_get_hadamard_satd(table, log2TrafoSize);
+}
+
+static hevcasm_hadamard_satd *const *hevcasm_static_get_hadamard_satd(hevcasm_table_hadamard_satd *table, int log2TrafoSize)
+{
+	return hevcasm_static_select_hadamard_satd(HEVCASM_STATIC_LEVEL, table, log2TrafoSize);
+}
+
+
+static hevcasm_quantize_inverse *const *hevcasm_static_select_quantize_inverse(int level, hevcasm_table_quantize_inverse *table)
+{
+	if (level >= 5 /* SSE41 */) HEVCASM_STATIC_KERNEL(hevcasm_quantize_inverse, hevcasm_quantize_inverse_sse4)
+	return hevcasm_get_quantize_inverse(table);
+}
+
+static hevcasm_quantize_inverse *const *hevcasm_static_get_quantize_inverse(hevcasm_table_quantize_inverse *table)
+{
+	return hevcasm_static_select_quantize_inverse(HEVCASM_STATIC_LEVEL, table);
+}
+
+
+static hevcasm_quantize *const *hevcasm_static_select_quantize(int level, hevcasm_table_quantize *table)
+{
+	if (level >= 5 /* SSE41 */) HEVCASM_STATIC_KERNEL(hevcasm_quantize, hevcasm_quantize_sse4)
+	return hevcasm_get_quantize(table);
+}
+
+static hevcasm_quantize *const *hevcasm_static_get_quantize(hevcasm_table_quantize *table)
+{
+	return hevcasm_static_select_quantize(HEVCASM_STATIC_LEVEL, table);
+}
+
+
+static hevcasm_quantize_reconstruct *const *hevcasm_static_select_quantize_reconstruct(int level, hevcasm_table_quantize_reconstruct *table, int log2TrafoSize)
+{
+	if (level >= 5 /* SSE41 */) switch (log2TrafoSize)
+	{
+	case 2: HEVCASM_STATIC_KERNEL(hevcasm_quantize_reconstruct, hevcasm_quantize_reconstruct_4x4_sse4)
+	case 3: HEVCASM_STATIC_KERNEL(hevcasm_quantize_reconstruct, hevcasm_quantize_reconstruct_8x8_sse4)
+	case 4: HEVCASM_STATIC_KERNEL(hevcasm_quantize_reconstruct, hevcasm_quantize_reconstruct_16x16_sse4)
+	case 5: HEVCASM_STATIC_KERNEL(hevcasm_quantize_reconstruct, hevcasm_quantize_reconstruct_32x32_sse4)
+	}
+	return hevcasm_get_quantize_reconstruct(table, log2TrafoSize);
+}
+
+static hevcasm_quantize_reconstruct *const *hevcasm_static_get_quantize_reconstruct(hevcasm_table_quantize_reconstruct *table, int log2TrafoSize)
+{
+	return hevcasm_static_select_quantize_reconstruct(HEVCASM_STATIC_LEVEL, table, log2TrafoSize);
+}
+
+
+static hevcasm_transform_domain_ssd *const *hevcasm_static_select_transform_domain_ssd(int level, hevcasm_table_transform_domain_ssd *table, int log2TrafoSize)
+{
+#ifdef HEVCASM_X64
+	if (level >= 8 /* AVX2 */) switch (log2TrafoSize)
+	{
+	case 3: HEVCASM_STATIC_KERNEL(hevcasm_transform_domain_ssd, hevcasm_transform_domain_ssd_8x8_avx2)
+	case 4: HEVCASM_STATIC_KERNEL(hevcasm_transform_domain_ssd, hevcasm_transform_domain_ssd_16x16_avx2)
+	case 5: HEVCASM_STATIC_KERNEL(hevcasm_transform_domain_ssd, hevcasm_transform_domain_ssd_32x32_avx2)
+	}
+	if (level >= 2 /* SSE2 */) switch (log2TrafoSize)
+	{
+	case 2: HEVCASM_STATIC_KERNEL(hevcasm_transform_domain_ssd, hevcasm_transform_domain_ssd_4x4_sse2)
+	case 3: HEVCASM_STATIC_KERNEL(hevcasm_transform_domain_ssd, hevcasm_transform_domain_ssd_8x8_sse2)
+	case 4: HEVCASM_STATIC_KERNEL(hevcasm_transform_domain_ssd, hevcasm_transform_domain_ssd_16x16_sse2)
+	case 5: HEVCASM_STATIC_KERNEL(hevcasm_transform_domain_ssd, hevcasm_transform_domain_ssd_32x32_sse2)
+	}
+#endif
+	return hevcasm_get_transform_domain_ssd(table, log2TrafoSize);
+}
+
+static hevcasm_transform_domain_ssd *const *hevcasm_static_get_transform_domain_ssd(hevcasm_table_transform_domain_ssd *table, int log2TrafoSize)
+{
+	return hevcasm_static_select_transform_domain_ssd(HEVCASM_STATIC_LEVEL, table, log2TrafoSize);
+}
+
+
+static hevcasm_inverse_transform_add *const *hevcasm_static_select_inverse_transform_add(int level, hevcasm_table_inverse_transform_add *table, int trType, int log2TrafoSize)
+{
+#ifdef HEVCASM_X64
+	/* the 32x32 entry depends on the encoder argument of hevcasm_populate_inverse_transform_add() so is always read */
+	if (level >= 8 /* AVX2 */) switch (log2TrafoSize)
+	{
+	case 2:
+		if (trType) HEVCASM_STATIC_KERNEL(hevcasm_inverse_transform_add, hevcasm_idst_4x4_avx2)
+		HEVCASM_STATIC_KERNEL(hevcasm_inverse_transform_add, hevcasm_idct_4x4_avx2)
+	case 3: HEVCASM_STATIC_KERNEL(hevcasm_inverse_transform_add, hevcasm_idct_8x8_avx2)
+	case 4: HEVCASM_STATIC_KERNEL(hevcasm_inverse_transform_add, hevcasm_idct_16x16_avx2)
+	}
+	if (level >= 4 /* SSSE3 */) switch (log2TrafoSize)
+	{
+	case 3: HEVCASM_STATIC_KERNEL(hevcasm_inverse_transform_add, hevcasm_idct_8x8_ssse3)
+	case 4: HEVCASM_STATIC_KERNEL(hevcasm_inverse_transform_add, hevcasm_idct_16x16_ssse3)
+	}
+#endif
+	return hevcasm_get_inverse_transform_add(table, trType, log2TrafoSize);
+}
+
+static hevcasm_inverse_transform_add *const *hevcasm_static_get_inverse_transform_add(hevcasm_table_inverse_transform_add *table, int trType, int log2TrafoSize)
+{
+	return hevcasm_static_select_inverse_transform_add(HEVCASM_STATIC_LEVEL, table, trType, log2TrafoSize);
+}
+
+
+static hevcasm_transform *const *hevcasm_static_select_transform(int level, hevcasm_table_transform *table, int trType, int log2TrafoSize)
+{
+#ifdef HEVCASM_X64
+	if (level >= 4 /* SSSE3 */ && log2TrafoSize == 4) HEVCASM_STATIC_KERNEL(hevcasm_transform, hevcasm_dct_16x16_ssse3)
+#endif
+	return hevcasm_get_transform(table, trType, log2TrafoSize);
+}
+
+static hevcasm_transform *const *hevcasm_static_get_transform(hevcasm_table_transform *table, int trType, int log2TrafoSize)
+{
+	return hevcasm_static_select_transform(HEVCASM_STATIC_LEVEL, table, trType, log2TrafoSize);
+}
+
+
+static hevcasm_transform *const *hevcasm_static_select_transform_skip(int level, hevcasm_table_transform_skip *table, int rotate, int log2TrafoSize)
+{
+	if (level >= 2 /* SSE2 */) switch (log2TrafoSize)
+	{
+	case 2:
+		if (rotate) HEVCASM_STATIC_KERNEL(hevcasm_transform, hevcasm_transform_skip_rotate_4x4_sse2)
+		HEVCASM_STATIC_KERNEL(hevcasm_transform, hevcasm_transform_skip_4x4_sse2)
+	case 3: HEVCASM_STATIC_KERNEL(hevcasm_transform, hevcasm_transform_skip_8x8_sse2)
+	case 4: HEVCASM_STATIC_KERNEL(hevcasm_transform, hevcasm_transform_skip_16x16_sse2)
+	case 5: HEVCASM_STATIC_KERNEL(hevcasm_transform, hevcasm_transform_skip_32x32_sse2)
+	}
+	return hevcasm_get_transform_skip(table, rotate, log2TrafoSize);
+}
+
+static hevcasm_transform *const *hevcasm_static_get_transform_skip(hevcasm_table_transform_skip *table, int rotate, int log2TrafoSize)
+{
+	return hevcasm_static_select_transform_skip(HEVCASM_STATIC_LEVEL, table, rotate, log2TrafoSize);
+}
+
+
+static hevcasm_inverse_transform_add *const *hevcasm_static_select_inverse_transform_skip_add(int level, hevcasm_table_inverse_transform_skip_add *table, int rotate, int log2TrafoSize)
+{
+	if (level >= 4 /* SSSE3 */) switch (log2TrafoSize)
+	{
+	case 2:
+		if (rotate) HEVCASM_STATIC_KERNEL(hevcasm_inverse_transform_add, hevcasm_inverse_transform_skip_add_rotate_4x4_ssse3)
+		HEVCASM_STATIC_KERNEL(hevcasm_inverse_transform_add, hevcasm_inverse_transform_skip_add_4x4_ssse3)
+	case 3: HEVCASM_STATIC_KERNEL(hevcasm_inverse_transform_add, hevcasm_inverse_transform_skip_add_8x8_ssse3)
+	case 4: HEVCASM_STATIC_KERNEL(hevcasm_inverse_transform_add, hevcasm_inverse_transform_skip_add_16x16_ssse3)
+	case 5: HEVCASM_STATIC_KERNEL(hevcasm_inverse_transform_add, hevcasm_inverse_transform_skip_add_32x32_ssse3)
+	}
+	return hevcasm_get_inverse_transform_skip_add(table, rotate, log2TrafoSize);
+}
+
+static hevcasm_inverse_transform_add *const *hevcasm_static_get_inverse_transform_skip_add(hevcasm_table_inverse_transform_skip_add *table, int rotate, int log2TrafoSize)
+{
+	return hevcasm_static_select_inverse_transform_skip_add(HEVCASM_STATIC_LEVEL, table, rotate, log2TrafoSize);
+}
+
+
+static hevcasm_inverse_transform_add *const *hevcasm_static_select_transquant_bypass_add(int level, hevcasm_table_transquant_bypass_add *table, int rotate, int log2TrafoSize)
+{
+	if (level >= 2 /* SSE2 */) switch (log2TrafoSize)
+	{
+	case 2:
+		if (rotate) HEVCASM_STATIC_KERNEL(hevcasm_inverse_transform_add, hevcasm_transquant_bypass_add_rotate_4x4_sse2)
+		HEVCASM_STATIC_KERNEL(hevcasm_inverse_transform_add, hevcasm_transquant_bypass_add_4x4_sse2)
+	case 3: HEVCASM_STATIC_KERNEL(hevcasm_inverse_transform_add, hevcasm_transquant_bypass_add_8x8_sse2)
+	case 4: HEVCASM_STATIC_KERNEL(hevcasm_inverse_transform_add, hevcasm_transquant_bypass_add_16x16_sse2)
+	case 5: HEVCASM_STATIC_KERNEL(hevcasm_inverse_transform_add, hevcasm_transquant_bypass_add_32x32_sse2)
+	}
+	return hevcasm_get_transquant_bypass_add(table, rotate, log2TrafoSize);
+}
+
+static hevcasm_inverse_transform_add *const *hevcasm_static_get_transquant_bypass_add(hevcasm_table_transquant_bypass_add *table, int rotate, int log2TrafoSize)
+{
+	return hevcasm_static_select_transquant_bypass_add(HEVCASM_STATIC_LEVEL, table, rotate, log2TrafoSize);
+}
+
+
+static hevcasm_residual_scan *const *hevcasm_static_select_residual_scan(int level, hevcasm_table_residual_scan *table)
+{
+#ifdef HEVCASM_X64
+	if (level >= 4 /* SSSE3 */) HEVCASM_STATIC_KERNEL(hevcasm_residual_scan, hevcasm_residual_scan_ssse3)
+#endif
+	return hevcasm_get_residual_scan(table);
+}
+
+static hevcasm_residual_scan *const *hevcasm_static_get_residual_scan(hevcasm_table_residual_scan *table)
+{
+	return hevcasm_static_select_residual_scan(HEVCASM_STATIC_LEVEL, table);
+}
+
+
+static hevcasm_residual_unscan *const *hevcasm_static_select_residual_unscan(int level, hevcasm_table_residual_unscan *table)
+{
+#ifdef HEVCASM_X64
+	if (level >= 4 /* SSSE3 */) HEVCASM_STATIC_KERNEL(hevcasm_residual_unscan, hevcasm_residual_unscan_ssse3)
+#endif
+	return hevcasm_get_residual_unscan(table);
+}
+
+static hevcasm_residual_unscan *const *hevcasm_static_get_residual_unscan(hevcasm_table_residual_unscan *table)
+{
+	return hevcasm_static_select_residual_unscan(HEVCASM_STATIC_LEVEL, table);
+}
+
+
+static hevcasm_residual_rate_sub_blocks *const *hevcasm_static_select_residual_rate_sub_blocks(int level, hevcasm_table_residual_rate_sub_blocks *table)
+{
+#ifdef HEVCASM_X64
+	if (level >= 4 /* SSSE3 */) HEVCASM_STATIC_KERNEL(hevcasm_residual_rate_sub_blocks, hevcasm_residual_rate_sub_blocks_ssse3)
+#endif
+	return hevcasm_get_residual_rate_sub_blocks(table);
+}
+
+static hevcasm_residual_rate_sub_blocks *const *hevcasm_static_get_residual_rate_sub_blocks(hevcasm_table_residual_rate_sub_blocks *table)
+{
+	return hevcasm_static_select_residual_rate_sub_blocks(HEVCASM_STATIC_LEVEL, table);
+}
+
+
+static hevcasm_deblock_bs *const *hevcasm_static_select_deblock_bs(int level, hevcasm_table_deblock_bs *table, int edge)
+{
+#ifdef HEVCASM_X64
+	if (level >= 8 /* AVX2 */)
+	{
+		if (edge) HEVCASM_STATIC_KERNEL(hevcasm_deblock_bs, hevcasm_deblock_bs_h_avx2)
+		HEVCASM_STATIC_KERNEL(hevcasm_deblock_bs, hevcasm_deblock_bs_v_avx2)
+	}
+	if (level >= 5 /* SSE41 */)
+	{
+		if (edge) HEVCASM_STATIC_KERNEL(hevcasm_deblock_bs, hevcasm_deblock_bs_h_4n_sse4)
+		HEVCASM_STATIC_KERNEL(hevcasm_deblock_bs, hevcasm_deblock_bs_v_4n_sse4)
+	}
+#endif
+	return hevcasm_get_deblock_bs(table, edge);
+}
+
+static hevcasm_deblock_bs *const *hevcasm_static_get_deblock_bs(hevcasm_table_deblock_bs *table, int edge)
+{
+	return hevcasm_static_select_deblock_bs(HEVCASM_STATIC_LEVEL, table, edge);
+}
+
+
+void HEVCASM_API hevcasm_test_static_dispatch(int *error_count, hevcasm_instruction_set mask);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,300 @@
+/*
+The copyright in this software is being made available under the BSD
+License, included below. This software may be subject to other third party
+and contributor rights, including patent rights, and no such rights are
+granted under this license.
+
+
+Copyright(c) 2011 - 2015, Parabola Research Limited
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met :
+
+* Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+this list of conditions and the following disclaimer in the documentation
+and / or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its contributors may
+be used to endorse or promote products derived from this software without
+specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "variance.h"
+#include "hevcasm_test.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+
+static uint64_t variance_c(const uint8_t *src, ptrdiff_t stride_src, int w, int h)
+{
+	uint32_t sum = 0;
+	uint32_t ssq = 0;
+	for (int y = 0; y < h; ++y)
+	{
+		for (int x = 0; x < w; ++x)
+		{
+			const uint32_t a = src[x + y * stride_src];
+			sum += a;
+			ssq += a * a;
+		}
+	}
+	return sum | ((uint64_t)ssq << 32);
+}
+
+
+#define MAKE_hevcasm_variance_c_ref(n) \
+static uint64_t hevcasm_variance_ ## n ## x ## n ## _c_ref(const uint8_t *src, ptrdiff_t stride_src) \
+{ \
+	return variance_c(src, stride_src, n, n); \
+}
+
+MAKE_hevcasm_variance_c_ref(8)
+MAKE_hevcasm_variance_c_ref(16)
+MAKE_hevcasm_variance_c_ref(32)
+MAKE_hevcasm_variance_c_ref(64)
+
+
+#ifdef HEVCASM_X64
+hevcasm_variance hevcasm_variance_8x8_sse2;
+hevcasm_variance hevcasm_variance_16x16_sse2;
+hevcasm_variance hevcasm_variance_32x32_sse2;
+hevcasm_variance hevcasm_variance_64x64_sse2;
+hevcasm_variance hevcasm_variance_16x16_avx2;
+hevcasm_variance hevcasm_variance_32x32_avx2;
+hevcasm_variance hevcasm_variance_64x64_avx2;
+#endif
+
+
+void HEVCASM_API hevcasm_populate_variance(hevcasm_table_variance *table, hevcasm_instruction_set mask)
+{
+	*hevcasm_get_variance(table, 3) = 0;
+	*hevcasm_get_variance(table, 4) = 0;
+	*hevcasm_get_variance(table, 5) = 0;
+	*hevcasm_get_variance(table, 6) = 0;
+
+	if (mask & (HEVCASM_C_REF | HEVCASM_C_OPT))
+	{
+		*hevcasm_get_variance(table, 3) = hevcasm_variance_8x8_c_ref;
+		*hevcasm_get_variance(table, 4) = hevcasm_variance_16x16_c_ref;
+		*hevcasm_get_variance(table, 5) = hevcasm_variance_32x32_c_ref;
+		*hevcasm_get_variance(table, 6) = hevcasm_variance_64x64_c_ref;
+	}
+
+#ifdef HEVCASM_X64
+	if (mask & HEVCASM_SSE2)
+	{
+		*hevcasm_get_variance(table, 3) = hevcasm_variance_8x8_sse2;
+		*hevcasm_get_variance(table, 4) = hevcasm_variance_16x16_sse2;
+		*hevcasm_get_variance(table, 5) = hevcasm_variance_32x32_sse2;
+		*hevcasm_get_variance(table, 6) = hevcasm_variance_64x64_sse2;
+	}
+
+	if (mask & HEVCASM_AVX2)
+	{
+		*hevcasm_get_variance(table, 4) = hevcasm_variance_16x16_avx2;
+		*hevcasm_get_variance(table, 5) = hevcasm_variance_32x32_avx2;
+		*hevcasm_get_variance(table, 6) = hevcasm_variance_64x64_avx2;
+	}
+#endif
+}
+
+
+void HEVCASM_API hevcasm_variance_plane(hevcasm_table_variance *table, uint64_t *map, ptrdiff_t stride_map, const uint8_t *src, ptrdiff_t stride_src, int width, int height, int log2Size, int y0, int y1)
+{
+	hevcasm_variance *f = *hevcasm_get_variance(table, log2Size);
+	const int size = 1 << log2Size;
+	const int columns = (width + size - 1) >> log2Size;
+	const int whole_columns = width >> log2Size;
+
+	for (int y = y0; y < y1; ++y)
+	{
+		const uint8_t *p = &src[(y << log2Size) * stride_src];
+		uint64_t *dst = &map[y * stride_map];
+		const int h = height - (y << log2Size);
+
+		if (h < size)
+		{
+			for (int x = 0; x < columns; ++x)
+			{
+				const int w = width - (x << log2Size);
+				dst[x] = variance_c(&p[x << log2Size], stride_src, w < size ? w : size, h);
+			}
+			continue;
+		}
+
+		for (int x = 0; x < whole_columns; ++x)
+		{
+			dst[x] = f(&p[x << log2Size], stride_src);
+		}
+
+		if (whole_columns < columns)
+		{
+			dst[whole_columns] = variance_c(&p[whole_columns << log2Size], stride_src, width - (whole_columns << log2Size), size);
+		}
+	}
+}
+
+
+typedef struct
+{
+	HEVCASM_ALIGN(32, uint8_t, src[128 * 64]);
+	int log2Size;
+	uint64_t sums;
+	hevcasm_variance *f;
+}
+bound_variance;
+
+
+int init_variance(void *p, hevcasm_instruction_set mask)
+{
+	bound_variance *s = p;
+
+	hevcasm_table_variance table;
+	hevcasm_populate_variance(&table, mask);
+	hevcasm_variance **entry = hevcasm_get_variance(&table, s->log2Size);
+	hevcasm_test_report_kernel(&table, sizeof(table), entry);
+	s->f = *entry;
+
+	if (mask == HEVCASM_C_REF) hevcasm_test_printf("\t%dx%d : ", 1 << s->log2Size, 1 << s->log2Size);
+
+	return !!s->f;
+}
+
+
+void invoke_variance(void *p, int n)
+{
+	bound_variance *s = p;
+	while (n--)
+	{
+		s->sums = s->f(s->src, 128);
+	}
+}
+
+
+int mismatch_variance(void *boundRef, void *boundTest)
+{
+	bound_variance *ref = boundRef;
+	bound_variance *test = boundTest;
+
+	return ref->sums != test->sums;
+}
+
+
+void HEVCASM_API hevcasm_test_variance(int *error_count, hevcasm_instruction_set mask)
+{
+	hevcasm_test_printf("\nhevcasm_variance - Block sum and sum of squares\n");
+
+	bound_variance b[2];
+
+	for (int i = 0; i < 128 * 64; ++i)
+	{
+		b[0].src[i] = hevcasm_test_rand();
+	}
+
+	for (b[0].log2Size = 3; b[0].log2Size <= 6; ++b[0].log2Size)
+	{
+		b[1] = b[0];
+		*error_count += hevcasm_test(&b[0], &b[1], init_variance, invoke_variance, mismatch_variance, mask, 10000);
+	}
+}
+
+
+#define VARIANCE_TEST_WIDTH 420
+#define VARIANCE_TEST_HEIGHT 240
+
+typedef struct
+{
+	const uint8_t *src;
+	int log2Size;
+	hevcasm_table_variance table;
+	uint64_t map[((VARIANCE_TEST_HEIGHT + 7) / 8) * ((VARIANCE_TEST_WIDTH + 7) / 8)];
+}
+bound_variance_plane;
+
+
+int init_variance_plane(void *p, hevcasm_instruction_set mask)
+{
+	bound_variance_plane *s = p;
+
+	if (!mask) return 0;
+
+	/* the plane pass uses kernels from this instruction set and all those before it */
+	hevcasm_table_variance previous;
+	hevcasm_populate_variance(&previous, (mask >> 1) | ((mask >> 1) - 1));
+	hevcasm_populate_variance(&s->table, mask | (mask - 1));
+
+	if (mask == HEVCASM_C_REF) hevcasm_test_printf("\t%dx%d %dx%d blocks : ", VARIANCE_TEST_WIDTH, VARIANCE_TEST_HEIGHT, 1 << s->log2Size, 1 << s->log2Size);
+
+	return mask <= HEVCASM_C_OPT || *hevcasm_get_variance(&s->table, s->log2Size) != *hevcasm_get_variance(&previous, s->log2Size);
+}
+
+
+void invoke_variance_plane(void *p, int n)
+{
+	bound_variance_plane *s = p;
+	const int size = 1 << s->log2Size;
+	const int columns = (VARIANCE_TEST_WIDTH + size - 1) >> s->log2Size;
+	const int rows = (VARIANCE_TEST_HEIGHT + size - 1) >> s->log2Size;
+	while (n--)
+	{
+		hevcasm_variance_plane(&s->table, s->map, columns, s->src, VARIANCE_TEST_WIDTH, VARIANCE_TEST_WIDTH, VARIANCE_TEST_HEIGHT, s->log2Size, 0, rows);
+	}
+}
+
+
+int mismatch_variance_plane(void *boundRef, void *boundTest)
+{
+	bound_variance_plane *ref = boundRef;
+	bound_variance_plane *test = boundTest;
+
+	const int size = 1 << ref->log2Size;
+	const int columns = (VARIANCE_TEST_WIDTH + size - 1) >> ref->log2Size;
+	const int rows = (VARIANCE_TEST_HEIGHT + size - 1) >> ref->log2Size;
+
+	return memcmp(ref->map, test->map, columns * rows * sizeof(ref->map[0]));
+}
+
+
+void HEVCASM_API hevcasm_test_variance_plane(int *error_count, hevcasm_instruction_set mask)
+{
+	hevcasm_test_printf("\nhevcasm_variance_plane - Activity map of a plane\n");
+
+	uint8_t *src = malloc(VARIANCE_TEST_WIDTH * VARIANCE_TEST_HEIGHT);
+
+	for (int i = 0; i < VARIANCE_TEST_WIDTH * VARIANCE_TEST_HEIGHT; ++i)
+	{
+		src[i] = hevcasm_test_rand();
+	}
+
+	bound_variance_plane b[2];
+
+	b[0].src = src;
+
+	for (b[0].log2Size = 3; b[0].log2Size <= 6; ++b[0].log2Size)
+	{
+		b[1] = b[0];
+		*error_count += hevcasm_test(&b[0], &b[1], init_variance_plane, invoke_variance_plane, mismatch_variance_plane, mask, 100);
+	}
+
+	free(src);
+}
+
+#undef VARIANCE_TEST_WIDTH
+#undef VARIANCE_TEST_HEIGHT
@@ -0,0 +1,91 @@
+/*
+The copyright in this software is being made available under the BSD
+License, included below. This software may be subject to other third party
+and contributor rights, including patent rights, and no such rights are
+granted under this license.
+
+
+Copyright(c) 2011 - 2015, Parabola Research Limited
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met :
+
+* Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+this list of conditions and the following disclaimer in the documentation
+and / or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its contributors may
+be used to endorse or promote products derived from this software without
+specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/* Block sum and sum of squares, for activity (adaptive quantization) and weighted prediction estimation */
+
+
+#ifndef INCLUDED_variance_h
+#define INCLUDED_variance_h
+
+#include "hevcasm.h"
+
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+/* Returns the sum of the samples of a square block in the low 32 bits and the sum of their squares in the high 32 bits */
+typedef uint64_t hevcasm_variance(const uint8_t *src, ptrdiff_t stride_src);
+
+typedef struct
+{
+	hevcasm_variance *p[4];
+}
+hevcasm_table_variance;
+
+static hevcasm_variance** hevcasm_get_variance(hevcasm_table_variance *table, int log2Size)
+{
+	return &table->p[log2Size - 3];
+}
+
+void HEVCASM_API hevcasm_populate_variance(hevcasm_table_variance *table, hevcasm_instruction_set mask);
+
+void HEVCASM_API hevcasm_test_variance(int *error_count, hevcasm_instruction_set mask);
+
+
+/* AC energy (sum of squares minus the DC contribution) of a block of n samples from its hevcasm_variance result */
+static uint32_t hevcasm_variance_ac_energy(uint64_t sums, int n)
+{
+	const uint32_t sum = (uint32_t)sums;
+	return (uint32_t)(sums >> 32) - (uint32_t)((uint64_t)sum * sum / n);
+}
+
+
+// Activity map: map[x + y * stride_map] receives the hevcasm_variance result of the block of size 1 << log2Size
+// at (x << log2Size, y << log2Size), for block rows [y0, y1). Blocks overlapping the right or bottom edge of the
+// plane include only samples inside the plane. Reads the plane once in raster order and keeps no state, so a
+// lookahead thread may call it for successive block rows as they become available.
+void HEVCASM_API hevcasm_variance_plane(hevcasm_table_variance *table, uint64_t *map, ptrdiff_t stride_map, const uint8_t *src, ptrdiff_t stride_src, int width, int height, int log2Size, int y0, int y1);
+
+void HEVCASM_API hevcasm_test_variance_plane(int *error_count, hevcasm_instruction_set mask);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
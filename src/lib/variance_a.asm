@@ -0,0 +1,123 @@
+; The copyright in this software is being made available under the BSD
+; License, included below. This software may be subject to other third party
+; and contributor rights, including patent rights, and no such rights are
+; granted under this license.
+; 
+; 
+; Copyright(c) 2011 - 2015, Parabola Research Limited
+; All rights reserved.
+; 
+; Redistribution and use in source and binary forms, with or without
+; modification, are permitted provided that the following conditions are met :
+; 
+; * Redistributions of source code must retain the above copyright notice,
+; this list of conditions and the following disclaimer.
+; * Redistributions in binary form must reproduce the above copyright notice,
+; this list of conditions and the following disclaimer in the documentation
+; and / or other materials provided with the distribution.
+; * Neither the name of the copyright holder nor the names of its contributors may
+; be used to endorse or promote products derived from this software without
+; specific prior written permission.
+; 
+; THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+; AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+; IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+; ARE DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+; BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+; CONSEQUENTIAL DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+; SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+; INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+; CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE)
+; ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+; THE POSSIBILITY OF SUCH DAMAGE.
+
+
+%define private_prefix hevcasm
+%include "x86inc.asm"
+
+
+SECTION .text
+
+
+%if ARCH_X86_64 == 1
+
+; adds sum (m0, q) and sum of squares (m1, d) of the bytes in m2; m7 is zero, uses m3
+%macro VARIANCE_ACCUMULATE 0
+	psadbw m3, m2, m7
+	paddq m0, m3
+	punpcklbw m3, m2, m7
+	punpckhbw m2, m7
+	pmaddwd m3, m3
+	pmaddwd m2, m2
+	paddd m1, m3
+	paddd m1, m2
+%endmacro
+
+
+; uint64_t hevcasm_variance_%1x%1_xxx(const uint8_t *src, ptrdiff_t stride_src);
+; returns sum in the low 32 bits and sum of squares in the high 32 bits
+%macro VARIANCE 1
+cglobal variance_%1x%1, 2, 3, 8
+	pxor m0, m0
+	pxor m1, m1
+	pxor m7, m7
+%if %1 * 2 == mmsize
+	; two rows per register
+	mov r2d, %1 / 2
+.loop:
+%if mmsize == 32
+		movu xm2, [r0]
+		vinserti128 m2, m2, [r0 + r1], 1
+%else
+		movq m2, [r0]
+		movhps m2, [r0 + r1]
+%endif
+		VARIANCE_ACCUMULATE
+		lea r0, [r0 + 2 * r1]
+		dec r2d
+		jg .loop
+%else
+	mov r2d, %1
+.loop:
+%assign i 0
+%rep %1 / mmsize
+		movu m2, [r0 + i]
+		VARIANCE_ACCUMULATE
+%assign i i + mmsize
+%endrep
+		add r0, r1
+		dec r2d
+		jg .loop
+%endif
+
+%if mmsize == 32
+	vextracti128 xm2, m0, 1
+	vextracti128 xm3, m1, 1
+	paddq xm0, xm2
+	paddd xm1, xm3
+%endif
+	movhlps xm2, xm0
+	paddq xm0, xm2
+	pshufd xm3, xm1, q0032
+	paddd xm1, xm3
+	pshufd xm3, xm1, q0001
+	paddd xm1, xm3
+
+	movd eax, xm0
+	movd r1d, xm1
+	shl r1, 32
+	or rax, r1
+	RET
+%endmacro
+
+INIT_XMM sse2
+VARIANCE 8
+VARIANCE 16
+VARIANCE 32
+VARIANCE 64
+INIT_YMM avx2
+VARIANCE 16
+VARIANCE 32
+VARIANCE 64
+
+%endif